@@ -0,0 +1,531 @@
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QFormLayout>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QtConcurrent>
+
+#include "BatchExport.h"
+#include "Project.h"
+
+using namespace Powder;
+
+BatchExportDialog::BatchExportDialog ( PowderTest *main, QDialog *parent )
+	: QDialog(parent)
+{
+	qDebug() << "Batch export dialog";
+
+	setWindowTitle("Batch export");
+
+	prevDir = QDir::homePath();
+
+	buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+	buttonBox->button(QDialogButtonBox::Ok)->setText("Export");
+	buttonBox->button(QDialogButtonBox::Ok)->setEnabled(false);
+	connect(buttonBox, &QDialogButtonBox::accepted, this, &BatchExportDialog::accept);
+	connect(buttonBox, &QDialogButtonBox::rejected, this, &BatchExportDialog::reject);
+
+	/* LabRadar directories and projects to export */
+
+	sourceList = new QListWidget();
+	sourceList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+	QPushButton *addButton = new QPushButton("Add LabRadar directory...");
+	connect(addButton, SIGNAL(clicked(bool)), this, SLOT(addClicked(bool)));
+
+	QPushButton *addProjectButton = new QPushButton("Add project...");
+	connect(addProjectButton, SIGNAL(clicked(bool)), this, SLOT(addProjectClicked(bool)));
+
+	QPushButton *removeButton = new QPushButton("Remove selected");
+	connect(removeButton, SIGNAL(clicked(bool)), this, SLOT(removeClicked(bool)));
+
+	QHBoxLayout *sourceButtonsLayout = new QHBoxLayout();
+	sourceButtonsLayout->addWidget(addButton);
+	sourceButtonsLayout->addWidget(addProjectButton);
+	sourceButtonsLayout->addWidget(removeButton);
+	sourceButtonsLayout->addStretch(0);
+
+	/* Charge weights, filled the same way as the auto-fill dialog */
+
+	QLabel *weightUnitsLabel;
+	if ( main->weightUnits->currentIndex() == GRAINS )
+	{
+		weightUnitsLabel = new QLabel("gr");
+	}
+	else
+	{
+		weightUnitsLabel = new QLabel("g");
+	}
+
+	QFormLayout *formLayout = new QFormLayout();
+
+	startingCharge = new QDoubleSpinBox();
+	startingCharge->setDecimals(2);
+	startingCharge->setSingleStep(0.1);
+	startingCharge->setMaximum(1000000);
+	startingCharge->setMinimumWidth(100);
+	startingCharge->setMaximumWidth(100);
+
+	QHBoxLayout *startingChargeLayout = new QHBoxLayout();
+	startingChargeLayout->addWidget(startingCharge);
+	startingChargeLayout->addWidget(weightUnitsLabel);
+
+	formLayout->addRow(new QLabel("Starting charge:"), startingChargeLayout);
+
+	interval = new QDoubleSpinBox();
+	interval->setDecimals(2);
+	interval->setSingleStep(0.1);
+	interval->setMaximum(1000000);
+	interval->setMinimumWidth(100);
+	interval->setMaximumWidth(100);
+
+	QHBoxLayout *intervalLayout = new QHBoxLayout();
+	intervalLayout->addWidget(interval);
+	intervalLayout->addWidget(new QLabel(weightUnitsLabel->text()));
+
+	formLayout->addRow(new QLabel("Interval:"), intervalLayout);
+
+	direction = new QComboBox();
+	direction->addItem("Values increasing", QVariant(true));
+	direction->addItem("Values decreasing", QVariant(false));
+	direction->setFixedWidth(direction->sizeHint().width());
+
+	formLayout->addRow(new QLabel("Direction:"), direction);
+
+	/* Where the graphs go */
+
+	outputDir = new QLineEdit();
+	connect(outputDir, &QLineEdit::textChanged, this, &BatchExportDialog::validate);
+
+	QPushButton *browseButton = new QPushButton("Browse...");
+	connect(browseButton, SIGNAL(clicked(bool)), this, SLOT(browseClicked(bool)));
+
+	QHBoxLayout *outputLayout = new QHBoxLayout();
+	outputLayout->addWidget(outputDir);
+	outputLayout->addWidget(browseButton);
+
+	formLayout->addRow(new QLabel("Output directory:"), outputLayout);
+
+	format = new QComboBox();
+	format->addItem("PNG image (*.png)", QVariant("png"));
+	format->addItem("JPG image (*.jpg)", QVariant("jpg"));
+	format->addItem("PDF file (*.pdf)", QVariant("pdf"));
+	format->setFixedWidth(format->sizeHint().width());
+
+	formLayout->addRow(new QLabel("Format:"), format);
+
+	QLabel *label = new QLabel("Render a graph for each LabRadar directory or saved project using the current graph options. Each graph is named after its directory or project. Projects keep their saved charge weights.\n");
+	label->setWordWrap(true);
+
+	QVBoxLayout *layout = new QVBoxLayout();
+	layout->addWidget(label);
+	layout->addWidget(sourceList);
+	layout->addLayout(sourceButtonsLayout);
+	layout->addLayout(formLayout);
+	layout->addWidget(buttonBox);
+
+	setLayout(layout);
+	resize(600, sizeHint().height());
+}
+
+void BatchExportDialog::addClicked ( bool state )
+{
+	qDebug() << "addClicked state =" << state;
+
+	QString path = QFileDialog::getExistingDirectory(this, "Select directory", prevDir);
+
+	if ( path.isEmpty() )
+	{
+		qDebug() << "User didn't select a directory";
+		return;
+	}
+
+	prevDir = path;
+
+	if ( sourceList->findItems(path, Qt::MatchExactly).empty() )
+	{
+		sourceList->addItem(path);
+	}
+
+	validate();
+}
+
+void BatchExportDialog::addProjectClicked ( bool state )
+{
+	qDebug() << "addProjectClicked state =" << state;
+
+	QStringList paths = QFileDialog::getOpenFileNames(this, "Select projects", prevDir, "ChronoPlotter project (*.chrono)");
+
+	if ( paths.isEmpty() )
+	{
+		qDebug() << "User didn't select a project";
+		return;
+	}
+
+	prevDir = QFileInfo(paths.first()).absolutePath();
+
+	for ( int i = 0; i < paths.size(); i++ )
+	{
+		if ( sourceList->findItems(paths.at(i), Qt::MatchExactly).empty() )
+		{
+			sourceList->addItem(paths.at(i));
+		}
+	}
+
+	validate();
+}
+
+void BatchExportDialog::removeClicked ( bool state )
+{
+	qDebug() << "removeClicked state =" << state;
+
+	qDeleteAll(sourceList->selectedItems());
+
+	validate();
+}
+
+void BatchExportDialog::browseClicked ( bool state )
+{
+	qDebug() << "browseClicked state =" << state;
+
+	QString path = QFileDialog::getExistingDirectory(this, "Select output directory", outputDir->text().isEmpty() ? prevDir : outputDir->text());
+
+	if ( ! path.isEmpty() )
+	{
+		outputDir->setText(path);
+	}
+}
+
+void BatchExportDialog::validate ( void )
+{
+	buttonBox->button(QDialogButtonBox::Ok)->setEnabled((sourceList->count() > 0) && (! outputDir->text().isEmpty()));
+}
+
+BatchSettings BatchExportDialog::getValues ( void )
+{
+	BatchSettings settings;
+
+	for ( int i = 0; i < sourceList->count(); i++ )
+	{
+		settings.sources.append(sourceList->item(i)->text());
+	}
+
+	settings.outputDir = outputDir->text();
+	settings.format = format->currentData().toString();
+	settings.startingCharge = startingCharge->value();
+	settings.interval = interval->value();
+	settings.increasing = direction->currentData().value<bool>();
+
+	return settings;
+}
+
+/*
+ * Worker thread side of the batch: parsing and file encoding. Neither touches any widgets.
+ */
+
+static BatchSource parseSource ( const QString &path )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	BatchSource source;
+	source.path = path;
+	source.project = path.endsWith(".chrono", Qt::CaseInsensitive);
+
+	if ( source.project )
+	{
+		source.series = Project::readPowderSeries(path, &source.error);
+	}
+	else
+	{
+		QString dataPath = path;
+		source.series = PowderTest::ReadLabRadarDirectory(dataPath, source.names);
+	}
+
+	source.parseTime = timer.elapsed();
+
+	return source;
+}
+
+// Returns the time taken to encode and write the image, or -1 if it couldn't be saved
+static qint64 encodeImage ( QImage image, const QString &path, const QByteArray &format )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// 96 DPI, matching QCustomPlot's own raster export
+	int dotsPerMeter = 96 / 0.0254;
+	image.setDotsPerMeterX(dotsPerMeter);
+	image.setDotsPerMeterY(dotsPerMeter);
+
+	if ( ! image.save(path, format.constData()) )
+	{
+		return -1;
+	}
+
+	return timer.elapsed();
+}
+
+BatchExport::BatchExport ( PowderTest *main, const BatchSettings &batchSettings, QObject *parent )
+	: QObject(parent)
+{
+	settings = batchSettings;
+	pendingEncodes = 0;
+	parsingDone = false;
+	wasCanceled = false;
+	finished = false;
+
+	// Independent of the tab the user is working in, so the batch doesn't disturb their data or preview
+	renderer = new PowderTest();
+	renderer->headless = true;
+	renderer->copyGraphOptions(main);
+
+	progress = new QProgressDialog("Exporting graphs...", "Cancel", 0, settings.sources.size(), main);
+	progress->setWindowTitle("Batch export");
+	progress->setWindowModality(Qt::WindowModal);
+	progress->setMinimumDuration(0);
+	connect(progress, SIGNAL(canceled()), this, SLOT(canceled()));
+
+	parseWatcher = new QFutureWatcher<BatchSource>(this);
+	connect(parseWatcher, SIGNAL(resultReadyAt(int)), this, SLOT(sourceParsed(int)));
+	connect(parseWatcher, SIGNAL(finished()), this, SLOT(parsingFinished()));
+}
+
+BatchExport::~BatchExport ( void )
+{
+	delete renderer;
+	delete progress;
+}
+
+void BatchExport::start ( void )
+{
+	qDebug() << "Starting batch export of" << settings.sources.size() << "sources";
+
+	timer.start();
+	progress->setValue(0);
+
+	parseWatcher->setFuture(QtConcurrent::mapped(settings.sources, parseSource));
+}
+
+void BatchExport::sourceParsed ( int index )
+{
+	BatchSource source = parseWatcher->resultAt(index);
+	delivered.insert(index);
+
+	qDebug() << "Parsed" << source.path << "in" << source.parseTime << "ms";
+
+	if ( wasCanceled )
+	{
+		qDeleteAll(source.series);
+		return;
+	}
+
+	renderSource(source);
+}
+
+void BatchExport::renderSource ( const BatchSource &source )
+{
+	QElapsedTimer renderTimer;
+	renderTimer.start();
+
+	BatchJob job;
+	job.name = source.project ? QFileInfo(source.path).completeBaseName() : QFileInfo(source.path).fileName();
+	job.output = QDir(settings.outputDir).filePath(QString("%1.%2").arg(job.name).arg(settings.format));
+	job.parseTime = source.parseTime;
+	job.renderTime = 0;
+	job.encodeTime = 0;
+
+	renderer->errors.clear();
+	renderer->warnings.clear();
+
+	if ( source.project )
+	{
+		// No options passed, so the renderer keeps the ones copied from the user's tab
+		renderer->restoreProject(QVariantMap(), source.series, false);
+
+		if ( renderer->seriesData.empty() )
+		{
+			job.error = source.error.isEmpty() ? "No powder test series in project" : source.error;
+			jobFinished(job);
+			return;
+		}
+	}
+	else
+	{
+		if ( ! renderer->importLabRadarSeries(source.series, source.names) )
+		{
+			job.error = "No LabRadar data found";
+			jobFinished(job);
+			return;
+		}
+
+		/* Fill in charge weights the same way auto-fill does */
+
+		double currentCharge = settings.startingCharge;
+		for ( int i = 0; i < renderer->seriesData.size(); i++ )
+		{
+			ChronoSeries *series = renderer->seriesData.at(i);
+			if ( (! series->deleted) && series->enabled )
+			{
+				series->chargeWeight = currentCharge;
+				currentCharge += settings.increasing ? settings.interval : -settings.interval;
+			}
+		}
+	}
+
+	renderer->setGraphTitle(job.name);
+
+	if ( ! renderer->populatePlot() )
+	{
+		job.error = renderer->errors.join("; ");
+		jobFinished(job);
+		return;
+	}
+
+	// PDFs are vector output drawn straight from the plot, so they can't be handed off
+	if ( settings.format == "pdf" )
+	{
+		if ( ! renderer->exportGraph(job.output) )
+		{
+			job.error = renderer->errors.join("; ");
+		}
+		job.renderTime = renderTimer.elapsed();
+		jobFinished(job);
+		return;
+	}
+
+	QImage image = renderer->renderImage();
+	job.renderTime = renderTimer.elapsed();
+
+	QByteArray format = settings.format.toUpper().toLatin1();
+
+	pendingEncodes++;
+
+	QFutureWatcher<qint64> *watcher = new QFutureWatcher<qint64>(this);
+	connect(watcher, &QFutureWatcher<qint64>::finished, this, [this, watcher, job] ( void ) {
+		BatchJob encoded = job;
+		encoded.encodeTime = watcher->result();
+		if ( encoded.encodeTime < 0 )
+		{
+			encoded.encodeTime = 0;
+			encoded.error = QString("Unable to save file to '%1'").arg(encoded.output);
+		}
+
+		pendingEncodes--;
+		watcher->deleteLater();
+
+		jobFinished(encoded);
+	});
+	watcher->setFuture(QtConcurrent::run(encodeImage, image, job.output, format));
+}
+
+void BatchExport::jobFinished ( const BatchJob &job )
+{
+	qDebug() << "Finished" << job.name << "parse" << job.parseTime << "render" << job.renderTime << "encode" << job.encodeTime << "error" << job.error;
+
+	jobs.append(job);
+	progress->setValue(jobs.size());
+
+	finishIfDone();
+}
+
+void BatchExport::parsingFinished ( void )
+{
+	qDebug() << "Finished parsing batch sources";
+
+	/*
+	 * Once cancelled, the watcher drops results that were ready but not yet delivered to sourceParsed. Free the series those
+	 * still hold.
+	 */
+	QFuture<BatchSource> future = parseWatcher->future();
+	for ( int i = 0; i < settings.sources.size(); i++ )
+	{
+		if ( (! delivered.contains(i)) && future.isResultReadyAt(i) )
+		{
+			BatchSource source = future.resultAt(i);
+
+			qDebug() << "Freeing undelivered" << source.path;
+
+			qDeleteAll(source.series);
+		}
+	}
+
+	parsingDone = true;
+
+	finishIfDone();
+}
+
+void BatchExport::canceled ( void )
+{
+	qDebug() << "Batch export cancelled";
+
+	wasCanceled = true;
+	parseWatcher->cancel();
+}
+
+void BatchExport::finishIfDone ( void )
+{
+	if ( finished || (! parsingDone) || (pendingEncodes > 0) )
+	{
+		return;
+	}
+
+	// Set before anything that runs the event loop
+	finished = true;
+
+	qint64 totalTime = timer.elapsed();
+
+	progress->reset();
+
+	/* Summarize how long each job took */
+
+	int numFailed = 0;
+	qint64 parseTotal = 0;
+	qint64 renderTotal = 0;
+	qint64 encodeTotal = 0;
+
+	QStringList details;
+	for ( int i = 0; i < jobs.size(); i++ )
+	{
+		const BatchJob &job = jobs.at(i);
+
+		parseTotal += job.parseTime;
+		renderTotal += job.renderTime;
+		encodeTotal += job.encodeTime;
+
+		if ( job.error.isEmpty() )
+		{
+			details.append(QString("%1: parse %2 ms, render %3 ms, encode %4 ms").arg(job.name).arg(job.parseTime).arg(job.renderTime).arg(job.encodeTime));
+		}
+		else
+		{
+			numFailed++;
+			details.append(QString("%1: failed, %2").arg(job.name).arg(job.error));
+		}
+	}
+
+	details.append("");
+	details.append(QString("Total parse %1 ms, render %2 ms, encode %3 ms").arg(parseTotal).arg(renderTotal).arg(encodeTotal));
+
+	QString text = QString("Exported %1 of %2 graphs to '%3' in %4 s.").arg(jobs.size() - numFailed).arg(settings.sources.size()).arg(settings.outputDir).arg(totalTime / 1000.0, 0, 'f', 1);
+	if ( wasCanceled )
+	{
+		text.append("\n\nThe export was cancelled.");
+	}
+
+	QMessageBox *msg = new QMessageBox();
+	msg->setIcon(numFailed ? QMessageBox::Warning : QMessageBox::Information);
+	msg->setText(text);
+	msg->setDetailedText(details.join("\n"));
+	msg->setWindowTitle("Batch export");
+	msg->setAttribute(Qt::WA_DeleteOnClose);
+	msg->show();
+
+	deleteLater();
+}
@@ -0,0 +1,121 @@
+#ifndef BATCHEXPORT_H
+#define BATCHEXPORT_H
+
+#include <QObject>
+#include <QDialog>
+#include <QDialogButtonBox>
+#include <QList>
+#include <QStringList>
+#include <QImage>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QFutureWatcher>
+#include <QListWidget>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QProgressDialog>
+
+#include "PowderTest.h"
+
+/*
+ * Renders a graph for each of a list of LabRadar directories or saved projects using the powder tab's current graph options.
+ *
+ * Sources are parsed across the global thread pool. Drawing has to happen on the GUI thread since QCustomPlot is a widget,
+ * so each parsed source is drawn into a QImage by a hidden PowderTest, separate from the one the user is working in. The
+ * images are then compressed and written back on the thread pool.
+ */
+
+namespace Powder
+{
+	struct BatchSettings
+	{
+		QStringList sources;
+		QString outputDir;
+		QString format; // png, jpg, or pdf
+		double startingCharge;
+		double interval;
+		bool increasing;
+	};
+
+	struct BatchSource
+	{
+		QString path;
+		bool project; // saved project, whose series keep their own names and charge weights
+		QStringList names;
+		QList<ChronoSeries *> series;
+		qint64 parseTime;
+		QString error;
+	};
+
+	struct BatchJob
+	{
+		QString name;
+		QString output;
+		qint64 parseTime;
+		qint64 renderTime;
+		qint64 encodeTime;
+		QString error;
+	};
+
+	class BatchExportDialog : public QDialog
+	{
+		Q_OBJECT
+
+		public:
+			BatchExportDialog(PowderTest *, QDialog *parent = 0);
+			~BatchExportDialog() {};
+			BatchSettings getValues();
+
+		public slots:
+			void addClicked(bool);
+			void addProjectClicked(bool);
+			void removeClicked(bool);
+			void browseClicked(bool);
+			void validate();
+
+		private:
+			QString prevDir;
+			QDialogButtonBox *buttonBox;
+			QListWidget *sourceList;
+			QLineEdit *outputDir;
+			QComboBox *format;
+			QDoubleSpinBox *startingCharge;
+			QDoubleSpinBox *interval;
+			QComboBox *direction;
+	};
+
+	class BatchExport : public QObject
+	{
+		Q_OBJECT
+
+		public:
+			BatchExport(PowderTest *, const BatchSettings &, QObject *parent = 0);
+			~BatchExport();
+			void start ( void );
+
+		public slots:
+			void sourceParsed(int);
+			void parsingFinished();
+			void canceled();
+
+		private:
+			void renderSource ( const BatchSource & );
+			void jobFinished ( const BatchJob & );
+			void finishIfDone ( void );
+
+			BatchSettings settings;
+			PowderTest *renderer;
+			QFutureWatcher<BatchSource> *parseWatcher;
+			QProgressDialog *progress;
+			QElapsedTimer timer;
+			QList<BatchJob> jobs;
+			QSet<int> delivered; // parse results handed to sourceParsed
+			int pendingEncodes;
+			bool parsingDone;
+			bool wasCanceled;
+			bool finished; // summary shown, finishIfDone() can be reached again through the progress dialog's event loop
+	};
+};
+
+#endif // BATCHEXPORT_H
@@ -27,6 +27,14 @@
 #include <QDialog>
 #include <QByteArray>
 #include <QJsonDocument>
+#include <QFutureWatcher>
+#include <QWindow>
+#include <QScreen>
+#include <QMenuBar>
+#include <QMenu>
+#include <QAction>
+#include <QHeaderView>
+#include <QtConcurrent>
 #include "qcustomplot/qcustomplot.h"
 
 #include "miniz.c"
@@ -36,6 +44,11 @@
 #include "SeatingDepthTest.h"
 #include "TunerTest.h"
 #include "About.h"
+#include "Headless.h"
+#include "Report.h"
+#include "Workbook.h"
+#include "Project.h"
+#include "History.h"
 
 int scaleFontSize ( int size )
 {
@@ -155,21 +168,211 @@ QString StringListJoin ( QStringList stringList, const char *separator )
 	return QString::fromStdString(result.str());
 }
 
-GraphPreview::GraphPreview ( QPixmap& image, QWidget *parent )
+/*
+ * Window hosting a tab's live plot. It's created hidden and shown for each preview, and closing it only hides it.
+ */
+GraphPreview::GraphPreview ( QCustomPlot *customPlot, QWidget *parent )
 	: QWidget(parent)
 {
-	label = new QLabel(this);
-	label->setPixmap(image);
-	label->setScaledContents(true);
-	setGeometry(300, 300, label->sizeHint().width() / 2, label->sizeHint().height() / 2);
+	plot = customPlot;
+	draft = false;
+
+	QVBoxLayout *layout = new QVBoxLayout();
+	layout->setContentsMargins(0, 0, 0, 0);
+	layout->addWidget(plot);
+	setLayout(layout);
+
+	setGeometry(300, 300, 1440, 625);
 	setWindowTitle("Graph preview");
+
+	// Restarted on every resize, so the full quality pass only happens once the user stops dragging
+	refineTimer = new QTimer(this);
+	refineTimer->setSingleShot(true);
+	refineTimer->setInterval(PREVIEW_REFINE_DELAY);
+	connect(refineTimer, SIGNAL(timeout()), this, SLOT(refine()));
+}
+
+void GraphPreview::setDraft ( bool enable )
+{
+	if ( enable == draft )
+	{
+		return;
+	}
+
+	draft = enable;
+
+	if ( draft )
+	{
+		antialiasedElements = plot->antialiasedElements();
+		plot->setAntialiasedElements(QCP::aeNone);
+		plot->setNotAntialiasedElements(QCP::aeAll);
+		plot->setPlottingHint(QCP::phFastPolylines, true);
+		plot->setBufferDevicePixelRatio(1.0);
+	}
+	else
+	{
+		plot->setNotAntialiasedElements(QCP::aeNone);
+		plot->setAntialiasedElements(antialiasedElements);
+		plot->setPlottingHint(QCP::phFastPolylines, false);
+		plot->setBufferDevicePixelRatio(devicePixelRatioF());
+	}
+}
+
+/*
+ * Shows the preview with a draft frame right away, then sharpens it
+ */
+void GraphPreview::present ( void )
+{
+	setDraft(true);
+	plot->replot();
+
 	show();
+	raise();
+	activateWindow();
+
+	refineTimer->start();
+}
+
+/*
+ * Brings the plot back to full quality, redrawing it if the preview is open
+ */
+void GraphPreview::refresh ( void )
+{
+	refineTimer->stop();
+	setDraft(false);
+
+	if ( isVisible() )
+	{
+		plot->replot();
+	}
+}
+
+void GraphPreview::refine ( void )
+{
+	qDebug() << "Refining preview at device pixel ratio" << devicePixelRatioF();
+
+	refresh();
 }
 
 void GraphPreview::resizeEvent ( QResizeEvent *event )
 {
-	qDebug() << "resizeEvent" << event;
-	label->setFixedSize(event->size());
+	QWidget::resizeEvent(event);
+
+	// The plot queues its own replot for the new size, which picks up the draft settings
+	if ( isVisible() )
+	{
+		setDraft(true);
+		refineTimer->start();
+	}
+}
+
+void GraphPreview::showEvent ( QShowEvent *event )
+{
+	QWidget::showEvent(event);
+
+	// Moving to a screen with a different pixel ratio needs a new buffer at that ratio
+	connect(windowHandle(), SIGNAL(screenChanged(QScreen *)), this, SLOT(refine()), Qt::UniqueConnection);
+}
+
+void showSaveResult ( QWidget *parent, const QString &path, bool res )
+{
+	if ( res )
+	{
+		QMessageBox::information(parent, "Save file", QString("Saved file to '%1'").arg(path), QMessageBox::Ok, QMessageBox::Ok);
+	}
+	else
+	{
+		QMessageBox::warning(parent, "Save file", QString("Unable to save file to '%1'\n\nPlease choose a different path").arg(path), QMessageBox::Ok, QMessageBox::Ok);
+	}
+}
+
+/*
+ * Compress and write an already rendered graph on the global thread pool, then report the result back on the GUI thread. The plot
+ * can only be rendered on the GUI thread, but encoding a 2880x1250 PNG is most of the time a save takes.
+ */
+void saveImageAsync ( QWidget *parent, const QImage &image, const QString &path, const char *format )
+{
+	QImage buffer = image;
+	QByteArray imageFormat(format);
+
+	// Same 96 DPI that QCustomPlot's savePng() and saveJpg() record
+	buffer.setDotsPerMeterX(96 / 0.0254);
+	buffer.setDotsPerMeterY(96 / 0.0254);
+
+	QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(parent);
+	QObject::connect(watcher, &QFutureWatcher<bool>::finished, parent, [=] ( void ) {
+		bool res = watcher->result();
+		qDebug() << "save file res =" << res;
+
+		showSaveResult(parent, path, res);
+		watcher->deleteLater();
+	});
+
+	watcher->setFuture(QtConcurrent::run([=] ( void ) {
+		return (! buffer.isNull()) && buffer.save(path, imageFormat.constData());
+	}));
+}
+
+/*
+ * Line edit text, combo box selections and check box states, keyed by the names they're listed under
+ */
+QVariantMap saveOptionWidgets ( const QList<QPair<QString, QWidget *> > &widgets )
+{
+	QVariantMap options;
+
+	for ( int i = 0; i < widgets.size(); i++ )
+	{
+		QWidget *widget = widgets.at(i).second;
+
+		if ( QLineEdit *lineEdit = qobject_cast<QLineEdit *>(widget) )
+		{
+			options.insert(widgets.at(i).first, lineEdit->text());
+		}
+		else if ( QComboBox *comboBox = qobject_cast<QComboBox *>(widget) )
+		{
+			options.insert(widgets.at(i).first, comboBox->currentIndex());
+		}
+		else if ( QCheckBox *checkBox = qobject_cast<QCheckBox *>(widget) )
+		{
+			options.insert(widgets.at(i).first, checkBox->isChecked());
+		}
+	}
+
+	return options;
+}
+
+/*
+ * Widgets without a saved value are left as they are, so options added in later versions keep their defaults
+ */
+void restoreOptionWidgets ( const QList<QPair<QString, QWidget *> > &widgets, const QVariantMap &options )
+{
+	for ( int i = 0; i < widgets.size(); i++ )
+	{
+		if ( ! options.contains(widgets.at(i).first) )
+		{
+			continue;
+		}
+
+		QVariant value = options.value(widgets.at(i).first);
+		QWidget *widget = widgets.at(i).second;
+
+		if ( QLineEdit *lineEdit = qobject_cast<QLineEdit *>(widget) )
+		{
+			lineEdit->setText(value.toString());
+		}
+		else if ( QComboBox *comboBox = qobject_cast<QComboBox *>(widget) )
+		{
+			int index = value.toInt();
+			if ( (index >= 0) && (index < comboBox->count()) )
+			{
+				comboBox->setCurrentIndex(index);
+			}
+		}
+		else if ( QCheckBox *checkBox = qobject_cast<QCheckBox *>(widget) )
+		{
+			checkBox->setChecked(value.toBool());
+		}
+	}
 }
 
 QHLine::QHLine ( QFrame *parent )
@@ -179,6 +382,79 @@ QHLine::QHLine ( QFrame *parent )
 	setFrameShadow(QFrame::Sunken);
 }
 
+SpinBoxDelegate::SpinBoxDelegate ( int decimals, double step, double maximum, QObject *parent )
+	: QStyledItemDelegate(parent), decimals(decimals), step(step), maximum(maximum)
+{
+}
+
+QString SpinBoxDelegate::displayText ( const QVariant &value, const QLocale &locale ) const
+{
+	if ( value.type() == QVariant::Double )
+	{
+		return locale.toString(value.toDouble(), 'f', decimals);
+	}
+
+	return QStyledItemDelegate::displayText(value, locale);
+}
+
+QWidget *SpinBoxDelegate::createEditor ( QWidget *parent, const QStyleOptionViewItem &, const QModelIndex & ) const
+{
+	QDoubleSpinBox *editor = new QDoubleSpinBox(parent);
+	editor->setFrame(false);
+	editor->setDecimals(decimals);
+	editor->setSingleStep(step);
+	editor->setMaximum(maximum);
+
+	return editor;
+}
+
+void SpinBoxDelegate::setEditorData ( QWidget *editor, const QModelIndex &index ) const
+{
+	static_cast<QDoubleSpinBox *>(editor)->setValue(index.data(Qt::EditRole).toDouble());
+}
+
+void SpinBoxDelegate::setModelData ( QWidget *editor, QAbstractItemModel *model, const QModelIndex &index ) const
+{
+	QDoubleSpinBox *spinBox = static_cast<QDoubleSpinBox *>(editor);
+	spinBox->interpretText();
+
+	model->setData(index, spinBox->value(), Qt::EditRole);
+}
+
+/*
+ * Table view shared by the series lists of every tab. Column 0 holds each row's checkbox and headerCheckBox is placed over its
+ * header section to check or uncheck every row at once.
+ */
+QTableView *createSeriesView ( QAbstractItemModel *model, QCheckBox *headerCheckBox )
+{
+	QTableView *view = new QTableView();
+	view->setModel(model);
+	view->setShowGrid(false);
+	view->setAlternatingRowColors(true);
+	view->setWordWrap(false);
+	view->setSelectionMode(QAbstractItemView::SingleSelection);
+	view->setEditTriggers(QAbstractItemView::AllEditTriggers);
+	view->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+	view->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+
+	// Rows are all the same height, so the view never has to measure the ones that aren't on screen
+	view->verticalHeader()->hide();
+	view->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+	view->verticalHeader()->setDefaultSectionSize(QDoubleSpinBox().sizeHint().height());
+
+	QHeaderView *header = view->horizontalHeader();
+	header->setDefaultAlignment(Qt::AlignLeft | Qt::AlignVCenter);
+	header->setHighlightSections(false);
+	header->setSectionResizeMode(QHeaderView::Stretch);
+	header->setSectionResizeMode(0, QHeaderView::Fixed);
+	header->resizeSection(0, headerCheckBox->sizeHint().width() + 10);
+
+	headerCheckBox->setParent(header);
+	headerCheckBox->move(5, (header->sizeHint().height() - headerCheckBox->sizeHint().height()) / 2);
+
+	return view;
+}
+
 template<typename T>
 double sampleStdev ( T vals )
 {
@@ -214,17 +490,29 @@ void MainWindow::closeEvent ( QCloseEvent *event )
 
 int main ( int argc, char *argv[] )
 {
+	// Command-line rendering has no display to talk to
+	bool headless = Headless::requested(argc, argv);
+	if ( headless )
+	{
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+	}
+
 	QApplication a(argc, argv);
 
 	int id = QFontDatabase::addApplicationFont(":/DejaVuSans.ttf");
 	QString family = QFontDatabase::applicationFontFamilies(id).at(0);
 	qDebug() << "id:" << id << "font family:" << family;
 
-	QWidget *powderTab = new Powder::PowderTest();
+	if ( headless )
+	{
+		return Headless::run(a);
+	}
 
-	QWidget *seatingTab = new SeatingDepth::SeatingDepthTest();
+	Powder::PowderTest *powderTab = new Powder::PowderTest();
 
-	QWidget *tunerTab = new Tuner::TunerTest();
+	SeatingDepth::SeatingDepthTest *seatingTab = new SeatingDepth::SeatingDepthTest();
+
+	Tuner::TunerTest *tunerTab = new Tuner::TunerTest();
 
 	QWidget *aboutTab = new About();
 
@@ -245,6 +533,25 @@ int main ( int argc, char *argv[] )
 	mainWindow->setCentralWidget(w);
 	mainWindow->setGeometry(300, 300, 1200, mainLayout->sizeHint().height());
 	mainWindow->setWindowTitle("ChronoPlotter");
+
+	QMenu *fileMenu = mainWindow->menuBar()->addMenu("File");
+	QAction *openAction = fileMenu->addAction("Open project...");
+	QObject::connect(openAction, &QAction::triggered, [=] ( void ) { Project::openProject(mainWindow, powderTab, seatingTab, tunerTab); });
+	QAction *saveAction = fileMenu->addAction("Save project...");
+	QObject::connect(saveAction, &QAction::triggered, [=] ( void ) { Project::saveProject(mainWindow, powderTab, seatingTab, tunerTab); });
+	fileMenu->addSeparator();
+	QAction *historyAction = fileMenu->addAction("Load history...");
+	QObject::connect(historyAction, &QAction::triggered, [=] ( void ) {
+		if ( History::showHistory(mainWindow, powderTab) )
+		{
+			tabs->setCurrentWidget(powderTab);
+		}
+	});
+	QAction *reportAction = fileMenu->addAction("Save load development report...");
+	QObject::connect(reportAction, &QAction::triggered, [=] ( void ) { Report::saveReport(mainWindow, powderTab, seatingTab, tunerTab); });
+	QAction *workbookAction = fileMenu->addAction("Save Excel workbook...");
+	QObject::connect(workbookAction, &QAction::triggered, [=] ( void ) { Workbook::saveWorkbook(mainWindow, powderTab, seatingTab, tunerTab); });
+
 	mainWindow->show();
 
 	return a.exec();
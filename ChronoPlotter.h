@@ -21,6 +21,9 @@
 #include <QGridLayout>
 #include <QDialog>
 #include <QMainWindow>
+#include <QTimer>
+#include <QTableView>
+#include <QStyledItemDelegate>
 #include "qcustomplot/qcustomplot.h"
 
 #define CHRONOPLOTTER_VERSION "2.2.0"
@@ -45,6 +48,8 @@
 #define XSTDEV 2
 #define RSD 3
 #define MR 4
+#define CEP50 5
+#define CEP90 6
 
 #define INCH 0
 #define MOA 1
@@ -57,6 +62,12 @@
 #define PROPORTIONAL 0
 #define CONSTANT 1
 
+// How long the preview waits after being shown or resized before redrawing at full quality, in milliseconds
+#define PREVIEW_REFINE_DELAY 150
+
+// Total shots above which powder scatter plots draw each string's distribution instead of every shot
+#define DENSITY_THRESHOLD 5000
+
 int scaleFontSize ( int );
 
 struct SplineSet
@@ -74,6 +85,12 @@ std::vector<double> GetLinearFit( QVector<double>&, QVector<double>& );
 
 QString StringListJoin ( QStringList, const char * );
 
+void showSaveResult ( QWidget *, const QString &, bool );
+void saveImageAsync ( QWidget *, const QImage &, const QString &, const char * );
+
+QVariantMap saveOptionWidgets ( const QList<QPair<QString, QWidget *> > & );
+void restoreOptionWidgets ( const QList<QPair<QString, QWidget *> > &, const QVariantMap & );
+
 template<typename T>
 double sampleStdev ( T );
 
@@ -96,17 +113,55 @@ class QHLine : public QFrame
 		~QHLine() {};
 };
 
+/*
+ * Editor for the numeric columns of the series tables. Values are shown with a fixed number of decimals, the same way the
+ * spin boxes that used to sit in every row showed them.
+ */
+class SpinBoxDelegate : public QStyledItemDelegate
+{
+	public:
+		SpinBoxDelegate(int, double, double, QObject *parent = 0);
+		~SpinBoxDelegate() {};
+		QString displayText ( const QVariant &, const QLocale & ) const;
+		QWidget *createEditor ( QWidget *, const QStyleOptionViewItem &, const QModelIndex & ) const;
+		void setEditorData ( QWidget *, const QModelIndex & ) const;
+		void setModelData ( QWidget *, QAbstractItemModel *, const QModelIndex & ) const;
+
+	private:
+		int decimals;
+		double step;
+		double maximum;
+};
+
+QTableView *createSeriesView ( QAbstractItemModel *, QCheckBox * );
+
+/*
+ * Window around a tab's live plot. It's drawn at the window's own size and device pixel ratio, with a quick draft frame
+ * (no antialiasing, 1x buffer) when it's shown or resized, followed by a full quality pass once things settle.
+ */
 class GraphPreview : public QWidget
 {
+	Q_OBJECT
+
 	public:
-		GraphPreview(QPixmap&, QWidget *parent = 0);
+		GraphPreview(QCustomPlot *, QWidget *parent = 0);
 		~GraphPreview() {};
+		void present ( void );
+		void refresh ( void );
+
+	public slots:
+		void refine();
 
 	protected:
-		virtual void resizeEvent(QResizeEvent *);
+		void resizeEvent(QResizeEvent *);
+		void showEvent(QShowEvent *);
 
 	private:
-		QLabel *label;
+		void setDraft ( bool );
+		QCustomPlot *plot;
+		QTimer *refineTimer;
+		QCP::AntialiasedElements antialiasedElements;
+		bool draft;
 };
 
 #endif // CHRONOPLOTTER_H
@@ -12,9 +12,9 @@ QXLSX_SOURCEPATH=./QXlsx/source/
 include(./QXlsx/QXlsx.pri)
 
 # Input
-HEADERS += ChronoPlotter.h qcustomplot/qcustomplot.h untar.h miniz.h PowderTest.h SeatingDepthTest.h TunerTest.h About.h
-SOURCES += ChronoPlotter.cpp qcustomplot/qcustomplot.cpp untar.cpp miniz.c PowderTest.cpp SeatingDepthTest.cpp TunerTest.cpp About.cpp
-QT += widgets printsupport
+HEADERS += ChronoPlotter.h qcustomplot/qcustomplot.h untar.h miniz.h PowderTest.h SeatingDepthTest.h TunerTest.h About.h Outliers.h Dispersion.h LabelLayout.h Headless.h BatchExport.h Report.h RenderCache.h Density.h ShotPattern.h RoundRobin.h SeriesArena.h Project.h History.h ShotArchive.h Workbook.h
+SOURCES += ChronoPlotter.cpp qcustomplot/qcustomplot.cpp untar.cpp miniz.c PowderTest.cpp SeatingDepthTest.cpp TunerTest.cpp About.cpp Outliers.cpp Dispersion.cpp LabelLayout.cpp Headless.cpp BatchExport.cpp Report.cpp RenderCache.cpp Density.cpp ShotPattern.cpp RoundRobin.cpp Project.cpp History.cpp ShotArchive.cpp Workbook.cpp
+QT += widgets printsupport concurrent sql
 
 CONFIG += console
 
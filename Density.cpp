@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <QDebug>
+#include <QtMath>
+#include <QtConcurrent>
+
+#include "Density.h"
+
+// Upper bound on the number of bins per string. Strings with fewer shots get fewer bins, roughly the square root of their size.
+#define MAX_BINS 48
+#define MIN_BINS 4
+
+// Binomial smoothing kernel applied to each histogram, wide enough to hide single-bin spikes without flattening the peak
+static const double kernel[] = { 1 / 16.0, 4 / 16.0, 6 / 16.0, 4 / 16.0, 1 / 16.0 };
+
+static void calculateProfile ( const QList<double> &velocities, Density::Profile *profile )
+{
+	profile->low = profile->high = 0;
+	profile->density.clear();
+
+	if ( velocities.isEmpty() )
+	{
+		return;
+	}
+
+	profile->low = *std::min_element(velocities.begin(), velocities.end());
+	profile->high = *std::max_element(velocities.begin(), velocities.end());
+
+	int numBins = qBound(MIN_BINS, qCeil(sqrt(velocities.size())), MAX_BINS);
+	double binHeight = (profile->high - profile->low) / numBins;
+
+	QVector<double> counts(numBins, 0);
+	for ( int i = 0; i < velocities.size(); i++ )
+	{
+		int bin = (binHeight > 0) ? (int)((velocities.at(i) - profile->low) / binHeight) : 0;
+		counts[qMin(bin, numBins - 1)] += 1;
+	}
+
+	/* Smooth, treating everything beyond the slowest and fastest shot as empty */
+
+	int radius = (sizeof(kernel) / sizeof(kernel[0])) / 2;
+	double peak = 0;
+
+	profile->density.resize(numBins);
+	for ( int i = 0; i < numBins; i++ )
+	{
+		double sum = 0;
+		for ( int k = -radius; k <= radius; k++ )
+		{
+			if ( (i + k >= 0) && (i + k < numBins) )
+			{
+				sum += kernel[k + radius] * counts.at(i + k);
+			}
+		}
+		profile->density[i] = sum;
+		peak = qMax(peak, sum);
+	}
+
+	for ( int i = 0; i < numBins; i++ )
+	{
+		profile->density[i] /= peak;
+	}
+}
+
+QVector<Density::Profile> Density::calculate ( const QVector<QList<double> > &strings )
+{
+	QVector<Profile> profiles(strings.size());
+
+	// Strings are binned independently, so spread them across the global thread pool. Each one writes only its own slot.
+	Profile *out = profiles.data();
+	QVector<int> indices(strings.size());
+	for ( int i = 0; i < indices.size(); i++ )
+	{
+		indices[i] = i;
+	}
+	QtConcurrent::blockingMap(indices, [&] ( int &i ) { calculateProfile(strings.at(i), out + i); });
+
+	return profiles;
+}
+
+/*
+ * Closed outline of the violin, as (x offset from the string's column, velocity) pairs. The densest bin reaches halfWidth on
+ * either side and the shape narrows to a point at the slowest and fastest shot.
+ */
+QVector<QPair<double, double> > Density::outline ( const Profile &profile, double halfWidth )
+{
+	QVector<QPair<double, double> > points;
+
+	int numBins = profile.density.size();
+	if ( numBins == 0 )
+	{
+		return points;
+	}
+
+	double binHeight = (profile.high - profile.low) / numBins;
+
+	points.append(QPair<double, double>(0, profile.low));
+	for ( int i = 0; i < numBins; i++ )
+	{
+		points.append(QPair<double, double>(halfWidth * profile.density.at(i), profile.low + (i + 0.5) * binHeight));
+	}
+	points.append(QPair<double, double>(0, profile.high));
+	for ( int i = numBins - 1; i >= 0; i-- )
+	{
+		points.append(QPair<double, double>(-halfWidth * profile.density.at(i), profile.low + (i + 0.5) * binHeight));
+	}
+	points.append(QPair<double, double>(0, profile.low));
+
+	return points;
+}
@@ -0,0 +1,26 @@
+#ifndef DENSITY_H
+#define DENSITY_H
+
+#include <QVector>
+#include <QList>
+#include <QPair>
+
+/*
+ * Distribution of a string's velocities, used in place of individual points once there are too many shots to plot them one by
+ * one. Each string is binned into a smoothed histogram between its slowest and fastest shot and drawn as a violin.
+ */
+
+namespace Density
+{
+	struct Profile
+	{
+		double low; // velocity of the slowest shot, where the first bin starts
+		double high;
+		QVector<double> density; // smoothed shots per bin, scaled so the densest bin is 1
+	};
+
+	QVector<Profile> calculate ( const QVector<QList<double> > & );
+	QVector<QPair<double, double> > outline ( const Profile &, double );
+};
+
+#endif // DENSITY_H
@@ -0,0 +1,182 @@
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <QDebug>
+#include <QtMath>
+#include <QtConcurrent>
+
+#include "Dispersion.h"
+
+// Number of simulated shots used to refine each group's CEP
+#define CEP_SAMPLES 16384
+
+// Standard normal quantile for the 90th percentile
+#define Z90 1.2815515655446004
+
+using namespace Dispersion;
+
+Ellipse Dispersion::calculate ( const QList<QPair<double, double> > &coordinates )
+{
+	Ellipse ellipse;
+	ellipse.isValid = false;
+	ellipse.centerX = ellipse.centerY = 0;
+	ellipse.varX = ellipse.varY = ellipse.covXY = 0;
+	ellipse.majorStdev = ellipse.minorStdev = 0;
+	ellipse.angle = 0;
+	ellipse.cep50 = ellipse.cep90 = qQNaN();
+
+	int totalShots = coordinates.size();
+	if ( totalShots < 2 )
+	{
+		return ellipse;
+	}
+
+	for ( int i = 0; i < totalShots; i++ )
+	{
+		ellipse.centerX += coordinates.at(i).first;
+		ellipse.centerY += coordinates.at(i).second;
+	}
+	ellipse.centerX /= totalShots;
+	ellipse.centerY /= totalShots;
+
+	/* Sample covariance matrix */
+
+	for ( int i = 0; i < totalShots; i++ )
+	{
+		double dx = coordinates.at(i).first - ellipse.centerX;
+		double dy = coordinates.at(i).second - ellipse.centerY;
+		ellipse.varX += dx * dx;
+		ellipse.varY += dy * dy;
+		ellipse.covXY += dx * dy;
+	}
+	ellipse.varX /= totalShots - 1;
+	ellipse.varY /= totalShots - 1;
+	ellipse.covXY /= totalShots - 1;
+
+	/* Principal axes are the eigenvectors of the covariance matrix, which has a closed form for 2x2 */
+
+	double halfTrace = (ellipse.varX + ellipse.varY) / 2;
+	double disc = sqrt( pow((ellipse.varX - ellipse.varY) / 2, 2) + pow(ellipse.covXY, 2) );
+	double major = halfTrace + disc;
+	double minor = qMax(halfTrace - disc, 0.0);
+
+	ellipse.majorStdev = sqrt(major);
+	ellipse.minorStdev = sqrt(minor);
+	ellipse.angle = atan2(2 * ellipse.covXY, ellipse.varX - ellipse.varY) / 2;
+
+	/*
+	 * Closed-form CEP estimate (Grubbs' Wilson-Hilferty approximation). The squared miss distance is a weighted sum of two
+	 * chi-squared variables, approximated by a scaled chi-squared matched on its first two moments.
+	 */
+
+	double m = major + minor;
+	if ( m > 0 )
+	{
+		double v = 2 * (major * major + minor * minor);
+		double k = v / (9 * m * m);
+		ellipse.cep50 = sqrt( m * pow(1 - k, 3) );
+		ellipse.cep90 = sqrt( m * pow(1 - k + Z90 * sqrt(k), 3) );
+	}
+	else
+	{
+		ellipse.cep50 = ellipse.cep90 = 0;
+	}
+
+	ellipse.isValid = true;
+
+	return ellipse;
+}
+
+/*
+ * Squared standard normal draws shared by every group. Using the same draws for all groups keeps the refined CEPs
+ * directly comparable between series, and means each group only needs a multiply-add per simulated shot.
+ */
+struct SamplePool
+{
+	QVector<double> u;
+	QVector<double> v;
+
+	SamplePool ( void )
+	{
+		std::mt19937 rng(CEP_SAMPLES);
+		std::normal_distribution<double> normal;
+
+		u.resize(CEP_SAMPLES);
+		v.resize(CEP_SAMPLES);
+		for ( int i = 0; i < CEP_SAMPLES; i++ )
+		{
+			double a = normal(rng);
+			double b = normal(rng);
+			u[i] = a * a;
+			v[i] = b * b;
+		}
+	}
+};
+
+static void refineEllipse ( Ellipse *ellipse, const SamplePool &pool )
+{
+	if ( ! ellipse->isValid )
+	{
+		return;
+	}
+
+	double major = ellipse->majorStdev * ellipse->majorStdev;
+	double minor = ellipse->minorStdev * ellipse->minorStdev;
+
+	QVector<double> r2(CEP_SAMPLES);
+	double *r = r2.data();
+	const double *u = pool.u.constData();
+	const double *v = pool.v.constData();
+	for ( int i = 0; i < CEP_SAMPLES; i++ )
+	{
+		r[i] = major * u[i] + minor * v[i];
+	}
+
+	// Quantiles only need a partial sort. The 50th percentile pass leaves everything above it in the upper half.
+	int mid = CEP_SAMPLES / 2;
+	std::nth_element(r, r + mid, r + CEP_SAMPLES);
+	ellipse->cep50 = sqrt(r[mid]);
+
+	int upper = (CEP_SAMPLES * 9) / 10;
+	std::nth_element(r + mid, r + upper, r + CEP_SAMPLES);
+	ellipse->cep90 = sqrt(r[upper]);
+}
+
+void Dispersion::refine ( const QVector<Ellipse *> &ellipses )
+{
+	static const SamplePool pool;
+
+	// Groups are independent of each other, so refine them across the global thread pool
+	QVector<Ellipse *> work = ellipses;
+	QtConcurrent::blockingMap(work, [&] ( Ellipse *ellipse ) { refineEllipse(ellipse, pool); });
+}
+
+/*
+ * Outline of the ellipse expected to contain the given fraction of shots, relative to the group center
+ */
+QVector<QPair<double, double> > Dispersion::outline ( const Ellipse &ellipse, double probability, int numPoints )
+{
+	QVector<QPair<double, double> > points;
+
+	if ( ! ellipse.isValid )
+	{
+		return points;
+	}
+
+	// Mahalanobis radius containing the requested probability mass of a bivariate normal
+	double k = sqrt(-2 * log(1 - probability));
+	double a = k * ellipse.majorStdev;
+	double b = k * ellipse.minorStdev;
+	double cosAngle = cos(ellipse.angle);
+	double sinAngle = sin(ellipse.angle);
+
+	for ( int i = 0; i <= numPoints; i++ )
+	{
+		double t = 2 * M_PI * i / numPoints;
+		double x = a * cos(t);
+		double y = b * sin(t);
+		points.append(QPair<double, double>(x * cosAngle - y * sinAngle, x * sinAngle + y * cosAngle));
+	}
+
+	return points;
+}
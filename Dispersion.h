@@ -0,0 +1,35 @@
+#ifndef DISPERSION_H
+#define DISPERSION_H
+
+#include <QVector>
+#include <QList>
+#include <QPair>
+
+/*
+ * Shape of a shot group, treating the impacts as a sample from a bivariate normal distribution. All lengths are in the
+ * same units as the coordinates they were calculated from (inches for ShotMarker data).
+ */
+
+namespace Dispersion
+{
+	struct Ellipse
+	{
+		bool isValid;
+		double centerX;
+		double centerY;
+		double varX;
+		double varY;
+		double covXY;
+		double majorStdev; // standard deviation along the principal axes
+		double minorStdev;
+		double angle; // radians from the x-axis to the major axis
+		double cep50;
+		double cep90;
+	};
+
+	Ellipse calculate ( const QList<QPair<double, double> > & );
+	void refine ( const QVector<Ellipse *> & );
+	QVector<QPair<double, double> > outline ( const Ellipse &, double, int );
+};
+
+#endif // DISPERSION_H
@@ -0,0 +1,228 @@
+#include <cstdio>
+#include <numeric>
+#include <algorithm>
+#include <QDebug>
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "Headless.h"
+#include "PowderTest.h"
+
+using namespace Powder;
+
+/*
+ * Checked before QApplication exists so the offscreen platform can be selected first
+ */
+bool Headless::requested ( int argc, char *argv[] )
+{
+	for ( int i = 1; i < argc; i++ )
+	{
+		QString arg(argv[i]);
+		if ( (arg == "--powder") || (arg == "--out") || arg.startsWith("--out=") )
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Weights are either start:interval (a negative interval for a decreasing ladder), or an explicit comma separated list
+ */
+static bool parseWeights ( const QString &spec, int count, QList<double> &weights )
+{
+	bool ok;
+
+	if ( spec.contains(":") )
+	{
+		QStringList parts = spec.split(":");
+		if ( parts.size() != 2 )
+		{
+			return false;
+		}
+
+		double start = parts.at(0).toDouble(&ok);
+		if ( ! ok )
+		{
+			return false;
+		}
+
+		double interval = parts.at(1).toDouble(&ok);
+		if ( ! ok )
+		{
+			return false;
+		}
+
+		for ( int i = 0; i < count; i++ )
+		{
+			weights.append(start + i * interval);
+		}
+	}
+	else
+	{
+		foreach ( QString part, spec.split(",") )
+		{
+			double weight = part.trimmed().toDouble(&ok);
+			if ( ! ok )
+			{
+				return false;
+			}
+			weights.append(weight);
+		}
+	}
+
+	return true;
+}
+
+static int finish ( QJsonObject &report, PowderTest *powderTest, int status )
+{
+	if ( powderTest )
+	{
+		report["errors"] = QJsonArray::fromStringList(powderTest->errors);
+		report["warnings"] = QJsonArray::fromStringList(powderTest->warnings);
+	}
+	report["status"] = status;
+
+	QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+	fwrite(json.constData(), 1, json.size(), stdout);
+	fflush(stdout);
+
+	return status;
+}
+
+static int usage ( QJsonObject &report, const QString &text )
+{
+	report["errors"] = QJsonArray::fromStringList(QStringList() << text);
+	report["warnings"] = QJsonArray();
+
+	return finish(report, NULL, HEADLESS_USAGE);
+}
+
+int Headless::run ( QApplication &app )
+{
+	QJsonObject report;
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Render a graph without opening a window");
+
+	QCommandLineOption powderOption("powder", "Render a powder charge ladder.");
+	QCommandLineOption labRadarOption("labradar", "LabRadar directory to read series from.", "dir");
+	QCommandLineOption weightsOption("weights", "Charge weights, either start:interval or a comma separated list.", "weights");
+	QCommandLineOption outOption("out", "Output file (.png, .jpg, or .pdf).", "file");
+	parser.addOption(powderOption);
+	parser.addOption(labRadarOption);
+	parser.addOption(weightsOption);
+	parser.addOption(outOption);
+
+	if ( ! parser.parse(app.arguments()) )
+	{
+		return usage(report, parser.errorText());
+	}
+
+	if ( ! parser.isSet(powderOption) )
+	{
+		return usage(report, "Only --powder graphs can be rendered from the command line");
+	}
+
+	if ( ! parser.isSet(labRadarOption) )
+	{
+		return usage(report, "--labradar is required");
+	}
+
+	if ( ! parser.isSet(weightsOption) )
+	{
+		return usage(report, "--weights is required");
+	}
+
+	if ( ! parser.isSet(outOption) )
+	{
+		return usage(report, "--out is required");
+	}
+
+	QString outPath = parser.value(outOption);
+	QString outExt = QFileInfo(outPath).suffix().toLower();
+	if ( (outExt != "png") && (outExt != "jpg") && (outExt != "pdf") )
+	{
+		return usage(report, QString("Unsupported output format '%1'").arg(outPath));
+	}
+
+	report["output"] = outPath;
+
+	/* Reuse the powder tab as-is, it just never gets shown */
+
+	PowderTest *powderTest = new PowderTest();
+	powderTest->headless = true;
+
+	if ( ! powderTest->importLabRadar(parser.value(labRadarOption)) )
+	{
+		return finish(report, powderTest, HEADLESS_NO_DATA);
+	}
+
+	QList<ChronoSeries *> enabledSeries;
+	for ( int i = 0; i < powderTest->seriesData.size(); i++ )
+	{
+		ChronoSeries *series = powderTest->seriesData.at(i);
+		if ( (! series->deleted) && series->enabled )
+		{
+			enabledSeries.append(series);
+		}
+	}
+
+	QList<double> weights;
+	if ( ! parseWeights(parser.value(weightsOption), enabledSeries.size(), weights) )
+	{
+		powderTest->errors.append(QString("Invalid --weights '%1'").arg(parser.value(weightsOption)));
+		return finish(report, powderTest, HEADLESS_USAGE);
+	}
+
+	if ( weights.size() != enabledSeries.size() )
+	{
+		powderTest->errors.append(QString("Got %1 charge weights for %2 series").arg(weights.size()).arg(enabledSeries.size()));
+		return finish(report, powderTest, HEADLESS_USAGE);
+	}
+
+	/* Same assignment the autofill dialog does, in series order */
+
+	QJsonArray seriesReport;
+	for ( int i = 0; i < enabledSeries.size(); i++ )
+	{
+		ChronoSeries *series = enabledSeries.at(i);
+		series->chargeWeight = weights.at(i);
+
+		const QList<double> &velocities = series->muzzleVelocities;
+
+		QJsonObject entry;
+		entry["name"] = series->name;
+		entry["chargeWeight"] = series->chargeWeight;
+		entry["shots"] = velocities.size();
+		if ( ! velocities.empty() )
+		{
+			double mean = std::accumulate(velocities.begin(), velocities.end(), 0.0) / static_cast<double>(velocities.size());
+			double minVelocity = *std::min_element(velocities.begin(), velocities.end());
+			double maxVelocity = *std::max_element(velocities.begin(), velocities.end());
+
+			entry["mean"] = mean;
+			entry["stdev"] = sampleStdev(velocities);
+			entry["es"] = maxVelocity - minVelocity;
+		}
+		entry["velocityUnits"] = series->velocityUnits;
+		seriesReport.append(entry);
+	}
+	report["series"] = seriesReport;
+
+	if ( ! powderTest->populatePlot() )
+	{
+		return finish(report, powderTest, HEADLESS_RENDER_FAILED);
+	}
+
+	if ( ! powderTest->exportGraph(outPath) )
+	{
+		return finish(report, powderTest, HEADLESS_WRITE_FAILED);
+	}
+
+	return finish(report, powderTest, HEADLESS_OK);
+}
@@ -0,0 +1,27 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QApplication>
+
+/*
+ * Command-line rendering, e.g.
+ *
+ *   ChronoPlotter --powder --labradar <dir> --weights 41.0:0.3 --out ladder.png
+ *
+ * Runs on the offscreen platform with no windows or dialogs. A JSON report is written to stdout and the exit code says how
+ * far the run got.
+ */
+
+#define HEADLESS_OK 0
+#define HEADLESS_USAGE 1
+#define HEADLESS_NO_DATA 2
+#define HEADLESS_RENDER_FAILED 3
+#define HEADLESS_WRITE_FAILED 4
+
+namespace Headless
+{
+	bool requested ( int, char *[] );
+	int run ( QApplication & );
+};
+
+#endif // HEADLESS_H
@@ -0,0 +1,747 @@
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QDialogButtonBox>
+#include <QMessageBox>
+#include <QMap>
+#include <QDateTime>
+#include <QHash>
+#include <QDataStream>
+#include <QThreadPool>
+#include <QCryptographicHash>
+#include <QCoreApplication>
+#include <QtConcurrent>
+
+#include "History.h"
+#include "ChronoPlotter.h"
+#include "PowderTest.h"
+#include "ShotArchive.h"
+
+#define HISTORY_CONNECTION "history"
+#define HISTORY_WRITER_CONNECTION "history-writer"
+
+// Stored in the database's user_version. Bump along with a migration in openDatabase() whenever the tables change.
+#define HISTORY_SCHEMA 2
+
+static const char *schema[] = {
+	"CREATE TABLE sessions (id INTEGER PRIMARY KEY, fingerprint BLOB NOT NULL UNIQUE, recorded TEXT NOT NULL, rifle TEXT, projectile TEXT, propellant TEXT, brass TEXT, primer TEXT, weight_units TEXT)",
+	"CREATE INDEX sessions_rifle ON sessions (rifle COLLATE NOCASE, recorded)",
+	"CREATE INDEX sessions_projectile ON sessions (projectile COLLATE NOCASE, recorded)",
+	"CREATE INDEX sessions_propellant ON sessions (propellant COLLATE NOCASE, recorded)",
+	"CREATE INDEX sessions_recorded ON sessions (recorded)",
+	"CREATE TABLE series (id INTEGER PRIMARY KEY, session_id INTEGER NOT NULL REFERENCES sessions (id) ON DELETE CASCADE, name TEXT, first_date TEXT, charge REAL, velocity_units TEXT, shots INTEGER, mean REAL, sd REAL, es REAL, velocities BLOB)",
+	"CREATE INDEX series_session ON series (session_id, charge)"
+};
+
+// Version 2 records seating depth and tuner sessions too
+static const char *schema2[] = {
+	"ALTER TABLE sessions ADD COLUMN test INTEGER NOT NULL DEFAULT 0",
+	"ALTER TABLE sessions ADD COLUMN group_units TEXT",
+	"ALTER TABLE series ADD COLUMN group_size REAL",
+	"CREATE INDEX sessions_test ON sessions (test, recorded)"
+};
+
+static bool execStatements ( QSqlQuery &query, const char **statements, unsigned int count )
+{
+	for ( unsigned int i = 0; i < count; i++ )
+	{
+		if ( ! query.exec(statements[i]) )
+		{
+			qDebug() << "Unable to update load history:" << query.lastError().text();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Opens the database on first use, creating or updating it if needed. History is a convenience, so failures are only logged.
+ * A connection can only be used from the thread that opened it, so the GUI thread and the writer each have their own.
+ */
+static QSqlDatabase openDatabase ( const QString &connection )
+{
+	if ( QSqlDatabase::contains(connection) )
+	{
+		return QSqlDatabase::database(connection);
+	}
+
+	QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+	QDir().mkpath(dir);
+
+	QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+	db.setDatabaseName(QDir(dir).filePath("history.sqlite"));
+	db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+
+	if ( ! db.open() )
+	{
+		qDebug() << "Unable to open load history:" << db.lastError().text();
+		return db;
+	}
+
+	QSqlQuery query(db);
+	query.exec("PRAGMA foreign_keys = ON");
+
+	query.exec("PRAGMA user_version");
+	int version = query.next() ? query.value(0).toInt() : 0;
+
+	qDebug() << "Opened load history" << db.databaseName() << "schema" << version;
+
+	if ( version < HISTORY_SCHEMA )
+	{
+		db.transaction();
+
+		bool res = true;
+		if ( version < 1 )
+		{
+			res = execStatements(query, schema, sizeof(schema) / sizeof(schema[0]));
+		}
+		if ( res && (version < 2) )
+		{
+			res = execStatements(query, schema2, sizeof(schema2) / sizeof(schema2[0]));
+		}
+
+		if ( ! res )
+		{
+			db.rollback();
+			db.close();
+			return db;
+		}
+
+		query.exec(QString("PRAGMA user_version = %1").arg(HISTORY_SCHEMA));
+		db.commit();
+	}
+
+	return db;
+}
+
+/*
+ * Sessions are written one at a time, in the order they were recorded, on a thread kept around for the writer's connection
+ */
+static QThreadPool *writer ( void )
+{
+	static QThreadPool *pool = NULL;
+
+	if ( pool == NULL )
+	{
+		pool = new QThreadPool(qApp);
+		pool->setMaxThreadCount(1);
+		pool->setExpiryTimeout(-1);
+
+		// Don't lose a write that's still queued when the app exits
+		QObject::connect(qApp, &QCoreApplication::aboutToQuit, [] ( void ) { pool->waitForDone(); });
+	}
+
+	return pool;
+}
+
+static QByteArray packVelocities ( const QList<double> &velocities )
+{
+	QVector<double> packed = velocities.toVector();
+	return QByteArray((const char *)packed.constData(), packed.size() * sizeof(double));
+}
+
+static QList<double> unpackVelocities ( const QByteArray &blob )
+{
+	QVector<double> packed(blob.size() / sizeof(double));
+	memcpy(packed.data(), blob.constData(), packed.size() * sizeof(double));
+	return packed.toList();
+}
+
+static QVariant storedStatistic ( double value )
+{
+	return qIsNaN(value) ? QVariant(QVariant::Double) : QVariant(value);
+}
+
+/*
+ * Replaces whatever was recorded for the same loaded data before, keeping the date it was first recorded. Runs on the writer.
+ */
+static bool writeSession ( const History::Session &session )
+{
+	QSqlDatabase db = openDatabase(HISTORY_WRITER_CONNECTION);
+	if ( ! db.isOpen() )
+	{
+		return false;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	db.transaction();
+
+	QSqlQuery query(db);
+
+	QDate recorded = session.recorded;
+	query.prepare("SELECT recorded FROM sessions WHERE fingerprint = ?");
+	query.addBindValue(session.fingerprint);
+	query.exec();
+	if ( query.next() )
+	{
+		recorded = QDate::fromString(query.value(0).toString(), Qt::ISODate);
+	}
+
+	query.prepare("DELETE FROM sessions WHERE fingerprint = ?");
+	query.addBindValue(session.fingerprint);
+	query.exec();
+
+	query.prepare("INSERT INTO sessions (fingerprint, test, recorded, rifle, projectile, propellant, brass, primer, weight_units, group_units) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+	query.addBindValue(session.fingerprint);
+	query.addBindValue(session.test);
+	query.addBindValue(recorded.toString(Qt::ISODate));
+	query.addBindValue(session.rifle);
+	query.addBindValue(session.projectile);
+	query.addBindValue(session.propellant);
+	query.addBindValue(session.brass);
+	query.addBindValue(session.primer);
+	query.addBindValue(session.weightUnits);
+	query.addBindValue(session.groupUnits);
+
+	if ( ! query.exec() )
+	{
+		qDebug() << "Unable to record session:" << query.lastError().text();
+		db.rollback();
+		return false;
+	}
+
+	QVariant sessionId = query.lastInsertId();
+
+	query.prepare("INSERT INTO series (session_id, name, first_date, charge, velocity_units, shots, mean, sd, es, velocities, group_size) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+
+	for ( int i = 0; i < session.series.size(); i++ )
+	{
+		const History::Series &series = session.series.at(i);
+
+		query.addBindValue(sessionId);
+		query.addBindValue(series.name);
+		query.addBindValue(series.firstDate);
+		query.addBindValue(series.charge);
+		query.addBindValue(series.velocityUnits);
+		query.addBindValue(series.shots);
+		query.addBindValue(storedStatistic(series.mean));
+		query.addBindValue(storedStatistic(series.sd));
+		query.addBindValue(storedStatistic(series.es));
+		query.addBindValue(packVelocities(series.velocities));
+		query.addBindValue(storedStatistic(series.groupSize));
+
+		if ( ! query.exec() )
+		{
+			qDebug() << "Unable to record series:" << query.lastError().text();
+			db.rollback();
+			return false;
+		}
+	}
+
+	db.commit();
+
+	qDebug() << "Recorded" << session.series.size() << "series in load history in" << timer.elapsed() << "ms";
+
+	return true;
+}
+
+/*
+ * Hash of everything stored for a session except the date, to tell whether recording it again would change anything
+ */
+static QByteArray sessionContents ( const History::Session &session )
+{
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
+
+	stream << session.test << session.rifle << session.projectile << session.propellant << session.brass << session.primer;
+	stream << session.weightUnits << session.groupUnits;
+
+	for ( int i = 0; i < session.series.size(); i++ )
+	{
+		const History::Series &series = session.series.at(i);
+		stream << series.name << series.firstDate << series.charge << series.velocityUnits << series.velocities << series.shots << series.groupSize;
+	}
+
+	return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+/*
+ * Queues the session to be written, unless it's the same as what was last recorded for its data in this run
+ */
+void History::record ( const Session &session )
+{
+	// Only touched from the GUI thread
+	static QHash<QByteArray, QByteArray> recordedContents;
+
+	QByteArray contents = sessionContents(session);
+	if ( recordedContents.value(session.fingerprint) == contents )
+	{
+		qDebug() << "Session is already in the load history";
+		return;
+	}
+
+	recordedContents.insert(session.fingerprint, contents);
+
+	QtConcurrent::run(writer(), writeSession, session);
+}
+
+QList<History::Session> History::query ( const Filter &filter )
+{
+	QList<Session> sessions;
+
+	QSqlDatabase db = openDatabase(HISTORY_CONNECTION);
+	if ( ! db.isOpen() )
+	{
+		return sessions;
+	}
+
+	/* Only filter on what's been filled in, so each lookup can use its index */
+
+	QStringList conditions;
+	QVariantList values;
+
+	if ( filter.test >= 0 )
+	{
+		conditions << "s.test = ?";
+		values << filter.test;
+	}
+	if ( ! filter.rifle.isEmpty() )
+	{
+		conditions << "s.rifle = ? COLLATE NOCASE";
+		values << filter.rifle;
+	}
+	if ( ! filter.projectile.isEmpty() )
+	{
+		conditions << "s.projectile = ? COLLATE NOCASE";
+		values << filter.projectile;
+	}
+	if ( ! filter.propellant.isEmpty() )
+	{
+		conditions << "s.propellant = ? COLLATE NOCASE";
+		values << filter.propellant;
+	}
+	if ( filter.from.isValid() )
+	{
+		conditions << "s.recorded >= ?";
+		values << filter.from.toString(Qt::ISODate);
+	}
+	if ( filter.to.isValid() )
+	{
+		conditions << "s.recorded <= ?";
+		values << filter.to.toString(Qt::ISODate);
+	}
+
+	if ( filter.minCharge > 0 )
+	{
+		conditions << "r.charge >= ?";
+		values << filter.minCharge;
+	}
+	if ( filter.maxCharge > 0 )
+	{
+		conditions << "r.charge <= ?";
+		values << filter.maxCharge;
+	}
+
+	QString sql("SELECT s.id, s.recorded, s.rifle, s.projectile, s.propellant, s.brass, s.primer, s.weight_units, r.name, r.first_date, r.charge, r.velocity_units, r.mean, r.sd, r.es, r.velocities, s.fingerprint, s.test, s.group_units, r.shots, r.group_size FROM sessions s JOIN series r ON r.session_id = s.id");
+	if ( ! conditions.isEmpty() )
+	{
+		sql.append(" WHERE ").append(conditions.join(" AND "));
+	}
+	sql.append(" ORDER BY s.recorded, s.id, r.charge");
+
+	QElapsedTimer timer;
+	timer.start();
+
+	QSqlQuery query(db);
+	query.setForwardOnly(true);
+	query.prepare(sql);
+	for ( int i = 0; i < values.size(); i++ )
+	{
+		query.addBindValue(values.at(i));
+	}
+
+	if ( ! query.exec() )
+	{
+		qDebug() << "Unable to query load history:" << query.lastError().text();
+		return sessions;
+	}
+
+	qint64 lastId = -1;
+	while ( query.next() )
+	{
+		qint64 id = query.value(0).toLongLong();
+		if ( id != lastId )
+		{
+			Session session;
+			session.recorded = QDate::fromString(query.value(1).toString(), Qt::ISODate);
+			session.rifle = query.value(2).toString();
+			session.projectile = query.value(3).toString();
+			session.propellant = query.value(4).toString();
+			session.brass = query.value(5).toString();
+			session.primer = query.value(6).toString();
+			session.weightUnits = query.value(7).toString();
+			session.fingerprint = query.value(16).toByteArray();
+			session.test = query.value(17).toInt();
+			session.groupUnits = query.value(18).toString();
+			sessions.append(session);
+			lastId = id;
+		}
+
+		Series series;
+		series.name = query.value(8).toString();
+		series.firstDate = query.value(9).toString();
+		series.charge = query.value(10).toDouble();
+		series.velocityUnits = query.value(11).toString();
+		series.mean = query.value(12).isNull() ? qQNaN() : query.value(12).toDouble();
+		series.sd = query.value(13).isNull() ? qQNaN() : query.value(13).toDouble();
+		series.es = query.value(14).isNull() ? qQNaN() : query.value(14).toDouble();
+		series.velocities = unpackVelocities(query.value(15).toByteArray());
+		series.shots = query.value(19).toInt();
+		series.groupSize = query.value(20).isNull() ? qQNaN() : query.value(20).toDouble();
+		sessions.last().series.append(series);
+	}
+
+	qDebug() << "Load history query matched" << sessions.size() << "sessions in" << timer.elapsed() << "ms";
+
+	return sessions;
+}
+
+/*
+ * Every value recorded for one of the component columns, for filling in the filters
+ */
+QStringList History::components ( const QString &column )
+{
+	QStringList values;
+
+	QStringList allowed;
+	allowed << "rifle" << "projectile" << "propellant" << "brass" << "primer";
+	if ( ! allowed.contains(column) )
+	{
+		return values;
+	}
+
+	QSqlDatabase db = openDatabase(HISTORY_CONNECTION);
+	if ( ! db.isOpen() )
+	{
+		return values;
+	}
+
+	QSqlQuery query(db);
+	query.exec(QString("SELECT DISTINCT %1 FROM sessions WHERE %1 != '' ORDER BY %1 COLLATE NOCASE").arg(column));
+	while ( query.next() )
+	{
+		values.append(query.value(0).toString());
+	}
+
+	return values;
+}
+
+static QString component ( const History::Session &session, const QString &column )
+{
+	if ( column == "rifle" ) return session.rifle;
+	if ( column == "projectile" ) return session.projectile;
+	if ( column == "propellant" ) return session.propellant;
+	if ( column == "brass" ) return session.brass;
+	if ( column == "primer" ) return session.primer;
+	return QString();
+}
+
+static QComboBox *componentFilter ( const QString &column )
+{
+	QComboBox *comboBox = new QComboBox();
+	comboBox->setEditable(true);
+	comboBox->addItem("");
+	comboBox->addItems(History::components(column));
+	comboBox->setMinimumWidth(200);
+	return comboBox;
+}
+
+History::HistoryDialog::HistoryDialog ( Powder::PowderTest *powderTest, QWidget *parent )
+	: QDialog(parent), powderTest(powderTest)
+{
+	qDebug() << "History dialog";
+
+	setWindowTitle("Load history");
+
+	QLabel *label = new QLabel("Every powder charge session you import or graph is kept here. Look up past sessions by their components and graph them together.\n");
+	label->setWordWrap(true);
+
+	rifle = componentFilter("rifle");
+	projectile = componentFilter("projectile");
+	propellant = componentFilter("propellant");
+
+	from = new QDateEdit(QDate::currentDate().addYears(-1));
+	from->setCalendarPopup(true);
+	to = new QDateEdit(QDate::currentDate());
+	to->setCalendarPopup(true);
+
+	QHBoxLayout *datesLayout = new QHBoxLayout();
+	datesLayout->addWidget(from);
+	datesLayout->addWidget(new QLabel("to"));
+	datesLayout->addWidget(to);
+	datesLayout->addStretch(0);
+
+	minCharge = new QDoubleSpinBox();
+	minCharge->setDecimals(2);
+	minCharge->setMaximum(1000);
+	minCharge->setSpecialValueText("Any");
+	maxCharge = new QDoubleSpinBox();
+	maxCharge->setDecimals(2);
+	maxCharge->setMaximum(1000);
+	maxCharge->setSpecialValueText("Any");
+
+	QHBoxLayout *chargesLayout = new QHBoxLayout();
+	chargesLayout->addWidget(minCharge);
+	chargesLayout->addWidget(new QLabel("to"));
+	chargesLayout->addWidget(maxCharge);
+	chargesLayout->addStretch(0);
+
+	QFormLayout *formLayout = new QFormLayout();
+	formLayout->addRow(new QLabel("Rifle:"), rifle);
+	formLayout->addRow(new QLabel("Projectile:"), projectile);
+	formLayout->addRow(new QLabel("Propellant:"), propellant);
+	formLayout->addRow(new QLabel("Recorded:"), datesLayout);
+	formLayout->addRow(new QLabel("Charge:"), chargesLayout);
+
+	QPushButton *searchButton = new QPushButton("Search");
+	connect(searchButton, &QPushButton::clicked, this, [=] ( void ) { search(); });
+
+	results = new QTableWidget(0, 9);
+	results->setHorizontalHeaderLabels(QStringList() << "Recorded" << "Rifle" << "Projectile" << "Propellant" << "Series" << "Charge" << "Shots" << "SD" << "ES");
+	results->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	results->setSelectionMode(QAbstractItemView::NoSelection);
+	results->verticalHeader()->setVisible(false);
+	results->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+	results->setMinimumSize(800, 300);
+
+	status = new QLabel();
+
+	QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
+	QPushButton *graphButton = buttonBox->addButton("Graph results", QDialogButtonBox::AcceptRole);
+	connect(graphButton, &QPushButton::clicked, this, [=] ( void ) { graph(); });
+	QPushButton *poolButton = buttonBox->addButton("Pool shots by charge", QDialogButtonBox::AcceptRole);
+	connect(poolButton, &QPushButton::clicked, this, [=] ( void ) { pool(); });
+	connect(buttonBox, &QDialogButtonBox::rejected, this, &HistoryDialog::reject);
+
+	QVBoxLayout *layout = new QVBoxLayout();
+	layout->addWidget(label);
+	layout->addLayout(formLayout);
+	layout->addWidget(searchButton, 0, Qt::AlignLeft);
+	layout->addWidget(results);
+	layout->addWidget(status);
+	layout->addWidget(buttonBox);
+	setLayout(layout);
+
+	search();
+}
+
+void History::HistoryDialog::search ( void )
+{
+	Filter filter;
+	filter.test = ARCHIVE_POWDER;
+	filter.rifle = rifle->currentText().trimmed();
+	filter.projectile = projectile->currentText().trimmed();
+	filter.propellant = propellant->currentText().trimmed();
+	filter.from = from->date();
+	filter.to = to->date();
+	filter.minCharge = minCharge->value();
+	filter.maxCharge = maxCharge->value();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	sessions = query(filter);
+
+	qint64 elapsed = timer.elapsed();
+
+	int numSeries = 0;
+	for ( int i = 0; i < sessions.size(); i++ )
+	{
+		numSeries += sessions.at(i).series.size();
+	}
+
+	results->setRowCount(numSeries);
+
+	int row = 0;
+	for ( int i = 0; i < sessions.size(); i++ )
+	{
+		const Session &session = sessions.at(i);
+
+		for ( int j = 0; j < session.series.size(); j++ )
+		{
+			const Series &series = session.series.at(j);
+
+			QStringList cells;
+			cells << session.recorded.toString(Qt::ISODate) << session.rifle << session.projectile << session.propellant << series.name;
+			cells << QString("%1 %2").arg(series.charge).arg(session.weightUnits);
+			cells << QString::number(series.velocities.size());
+			cells << (qIsNaN(series.sd) ? QString("-") : QString::number(series.sd, 'f', 1));
+			cells << (qIsNaN(series.es) ? QString("-") : QString::number(series.es, 'f', 1));
+
+			for ( int k = 0; k < cells.size(); k++ )
+			{
+				results->setItem(row, k, new QTableWidgetItem(cells.at(k)));
+			}
+
+			row++;
+		}
+	}
+
+	status->setText(QString("%1 series from %2 sessions (%3 ms)").arg(numSeries).arg(sessions.size()).arg(elapsed));
+}
+
+/*
+ * Hands the strings found to the powder charge tab, in charge weight order across all sessions
+ */
+void History::HistoryDialog::graph ( void )
+{
+	if ( sessions.isEmpty() )
+	{
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText("No sessions match the search.");
+		msg.setWindowTitle("Error");
+		msg.exec();
+		return;
+	}
+
+	QList<Powder::ChronoSeries *> seriesList;
+	for ( int i = 0; i < sessions.size(); i++ )
+	{
+		const Session &session = sessions.at(i);
+
+		for ( int j = 0; j < session.series.size(); j++ )
+		{
+			const Series &series = session.series.at(j);
+
+			Powder::ChronoSeries *chronoSeries = new Powder::ChronoSeries();
+			chronoSeries->isValid = true;
+			chronoSeries->enabled = true;
+			chronoSeries->deleted = false;
+			chronoSeries->name = (sessions.size() == 1) ? series.name : QString("%1 %2").arg(session.recorded.toString(Qt::ISODate)).arg(series.name);
+			chronoSeries->firstDate = series.firstDate;
+			chronoSeries->chargeWeight = series.charge;
+			chronoSeries->velocityUnits = series.velocityUnits;
+			chronoSeries->muzzleVelocities = series.velocities;
+			seriesList.append(chronoSeries);
+		}
+	}
+
+	std::stable_sort(seriesList.begin(), seriesList.end(), [] ( Powder::ChronoSeries *one, Powder::ChronoSeries *two ) { return one->chargeWeight < two->chargeWeight; });
+	for ( int i = 0; i < seriesList.size(); i++ )
+	{
+		seriesList.at(i)->seriesNum = i + 1;
+	}
+
+	/* Components shared by every session found carry over to the graph */
+
+	QVariantMap options;
+	options.insert("weightUnits", (sessions.first().weightUnits == "g") ? GRAMS : GRAINS);
+
+	QStringList columns;
+	columns << "rifle" << "projectile" << "propellant" << "brass" << "primer";
+	for ( int i = 0; i < columns.size(); i++ )
+	{
+		QString value = component(sessions.first(), columns.at(i));
+		for ( int j = 1; j < sessions.size(); j++ )
+		{
+			if ( component(sessions.at(j), columns.at(i)) != value )
+			{
+				value.clear();
+			}
+		}
+		options.insert(columns.at(i), value);
+	}
+
+	powderTest->graphHistory(options, seriesList);
+
+	accept();
+}
+
+/*
+ * Graphs every archived shot of the sessions found, one string per charge weight. The shots come straight out of the shot
+ * archive, which only reads the blocks of these sessions that overlap the charge range.
+ */
+void History::HistoryDialog::pool ( void )
+{
+	ShotArchive::Range range;
+	range.test = ARCHIVE_POWDER;
+	if ( minCharge->value() > 0 )
+	{
+		range.minValue = minCharge->value();
+	}
+	if ( maxCharge->value() > 0 )
+	{
+		range.maxValue = maxCharge->value();
+	}
+	for ( int i = 0; i < sessions.size(); i++ )
+	{
+		range.sessions.insert(ShotArchive::sessionKey(sessions.at(i).fingerprint));
+	}
+
+	QVector<ShotArchive::Shot> shots;
+	if ( ! sessions.isEmpty() )
+	{
+		shots = ShotArchive::scan(range);
+	}
+
+	if ( shots.isEmpty() )
+	{
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText("No archived shots match the search.");
+		msg.setWindowTitle("Error");
+		msg.exec();
+		return;
+	}
+
+	QMap<double, Powder::ChronoSeries *> byCharge;
+	for ( int i = 0; i < shots.size(); i++ )
+	{
+		const ShotArchive::Shot &shot = shots.at(i);
+
+		Powder::ChronoSeries *chronoSeries = byCharge.value(shot.value);
+		if ( chronoSeries == NULL )
+		{
+			chronoSeries = new Powder::ChronoSeries();
+			chronoSeries->isValid = true;
+			chronoSeries->enabled = true;
+			chronoSeries->deleted = false;
+			chronoSeries->chargeWeight = shot.value;
+			chronoSeries->velocityUnits = sessions.first().series.first().velocityUnits;
+			chronoSeries->firstDate = QDateTime::fromMSecsSinceEpoch(shot.time).date().toString(Qt::ISODate);
+			byCharge.insert(shot.value, chronoSeries);
+		}
+		chronoSeries->muzzleVelocities.append(shot.velocity);
+	}
+
+	QList<Powder::ChronoSeries *> seriesList = byCharge.values();
+	for ( int i = 0; i < seriesList.size(); i++ )
+	{
+		seriesList.at(i)->seriesNum = i + 1;
+		seriesList.at(i)->name = QString("%1 shots").arg(seriesList.at(i)->muzzleVelocities.size());
+	}
+
+	QVariantMap options;
+	options.insert("weightUnits", (sessions.first().weightUnits == "g") ? GRAMS : GRAINS);
+
+	powderTest->graphHistory(options, seriesList);
+
+	accept();
+}
+
+bool History::showHistory ( QWidget *parent, Powder::PowderTest *powderTest )
+{
+	// Let sessions still being written show up in the search
+	writer()->waitForDone();
+
+	HistoryDialog dialog(powderTest, parent);
+	return (dialog.exec() == QDialog::Accepted);
+}
@@ -0,0 +1,98 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <QDialog>
+#include <QDate>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QComboBox>
+#include <QDateEdit>
+#include <QDoubleSpinBox>
+#include <QTableWidget>
+#include <QLabel>
+
+namespace Powder { class PowderTest; };
+
+/*
+ * Load history: every session imported into any of the tabs is kept in a SQLite database in the user's app data directory,
+ * along with its components and each string's or group's statistics. It's recorded again when graphed, if the charges,
+ * components or shots changed since. Writes happen on a background thread. Sessions are looked up by test, component and date
+ * through indexed columns, and powder charge strings found can be graphed again in the powder charge tab.
+ */
+
+namespace History
+{
+	struct Series
+	{
+		QString name;
+		QString firstDate;
+		double charge; // charge weight, cartridge length or tuner setting, depending on the test
+		QString velocityUnits;
+		QList<double> velocities;
+		int shots;
+		double mean; // statistics as stored, NaN where there are too few shots
+		double sd;
+		double es;
+		double groupSize; // seating depth and tuner groups only, NaN otherwise
+	};
+
+	struct Session
+	{
+		QByteArray fingerprint; // identifies the loaded data, so graphing it again replaces the earlier record
+		int test; // ARCHIVE_ value of the tab it was imported into
+		QDate recorded;
+		QString rifle;
+		QString projectile;
+		QString propellant;
+		QString brass;
+		QString primer;
+		QString weightUnits; // units of each series' charge
+		QString groupUnits; // how group sizes were measured, empty for powder charge sessions
+		QList<Series> series;
+	};
+
+	// Empty strings, invalid dates, charges of 0 and a negative test match everything
+	struct Filter
+	{
+		int test;
+		QString rifle;
+		QString projectile;
+		QString propellant;
+		QDate from;
+		QDate to;
+		double minCharge;
+		double maxCharge;
+	};
+
+	void record ( const Session & );
+	QList<Session> query ( const Filter & );
+	QStringList components ( const QString & );
+	bool showHistory ( QWidget *, Powder::PowderTest * );
+
+	class HistoryDialog : public QDialog
+	{
+		public:
+			HistoryDialog(Powder::PowderTest *, QWidget *parent = 0);
+			~HistoryDialog() {};
+
+		private:
+			void search ( void );
+			void graph ( void );
+			void pool ( void );
+			Powder::PowderTest *powderTest;
+			QComboBox *rifle;
+			QComboBox *projectile;
+			QComboBox *propellant;
+			QDateEdit *from;
+			QDateEdit *to;
+			QDoubleSpinBox *minCharge;
+			QDoubleSpinBox *maxCharge;
+			QTableWidget *results;
+			QLabel *status;
+			QList<Session> sessions;
+	};
+};
+
+#endif // HISTORY_H
@@ -0,0 +1,265 @@
+#include <map>
+#include <limits>
+#include <algorithm>
+#include <QDebug>
+#include <QFontMetricsF>
+#include <QPair>
+#include <QMap>
+#include <QtMath>
+
+#include "LabelLayout.h"
+
+// Number of steps a label may be pushed away from its anchor on either side before settling for the least overlap
+#define MAX_LEVELS 4
+
+// Pixels kept clear between neighboring labels
+#define LABEL_SPACING 2
+
+// Size the plot's margins, titles and tick labels are measured at
+#define REFERENCE_WIDTH 1440
+#define REFERENCE_HEIGHT 625
+
+// Bounds on the automatically sized canvas. The minimums are the size graphs were always exported at before, so canvases only grow.
+#define MIN_CANVAS_WIDTH REFERENCE_WIDTH
+#define MAX_CANVAS_WIDTH 4320
+#define MIN_CANVAS_HEIGHT REFERENCE_HEIGHT
+#define MAX_CANVAS_HEIGHT 1600
+
+// Pixels kept clear between neighboring columns of labels
+#define COLUMN_SPACING 12
+
+// Share of the axis rect above the highest point and below the lowest. Every tab scales the value axis by 1.3 around its data.
+#define HEADROOM (0.15 / 1.3)
+
+/*
+ * Lay the plot out at the given size without painting it, so pixel positions match what will be exported. Returns the previous
+ * viewport so the caller can lay the plot back out at its on-screen size once it's done measuring.
+ */
+QRect LabelLayout::layoutAt ( QCustomPlot *plot, const QSize &size )
+{
+	QRect viewport = plot->viewport();
+
+	plot->setViewport(QRect(QPoint(0, 0), size));
+	plot->plotLayout()->update(QCPLayoutElement::upPreparation);
+	plot->plotLayout()->update(QCPLayoutElement::upMargins);
+	plot->plotLayout()->update(QCPLayoutElement::upLayout);
+
+	return viewport;
+}
+
+static QRectF labelRect ( const QPointF &anchor, const QSizeF &size, int side, double distance )
+{
+	double top = (side == LabelLayout::ABOVE) ? anchor.y() - distance - size.height() : anchor.y() + distance;
+
+	return QRectF(anchor.x() - size.width() / 2, top, size.width(), size.height());
+}
+
+static void placeLabel ( QCPItemText *label, int side, double distance )
+{
+	if ( side == LabelLayout::ABOVE )
+	{
+		label->position->setCoords(0, -distance);
+		label->setPositionAlignment(Qt::AlignHCenter | Qt::AlignBottom);
+	}
+	else
+	{
+		label->position->setCoords(0, distance);
+		label->setPositionAlignment(Qt::AlignHCenter | Qt::AlignTop);
+	}
+}
+
+static QSizeF labelSize ( QCPItemText *label )
+{
+	QFontMetricsF metrics(label->font());
+	QSizeF textSize = metrics.boundingRect(QRectF(), Qt::AlignCenter, label->text()).size();
+	QMargins padding = label->padding();
+
+	return textSize + QSizeF(padding.left() + padding.right(), padding.top() + padding.bottom());
+}
+
+static bool leftEdgeLess ( const QRectF &one, const QRectF &two )
+{
+	return (one.left() < two.left());
+}
+
+/*
+ * Each label must be positioned relative to a parent anchor, sides holds the side it would prefer to be on, and obstacles are
+ * the pixel extents of the plotted markers. gap is the distance a label normally keeps from its anchor.
+ */
+void LabelLayout::arrange ( const QList<QCPItemText *> &labels, const QVector<int> &sides, const QVector<QRectF> &obstacles, double gap )
+{
+	int numLabels = labels.size();
+
+	/* Measure every label once */
+
+	QVector<QPointF> anchors(numLabels);
+	QVector<QSizeF> sizes(numLabels);
+	QVector<QPair<double, int> > order; // left edge and index of each label taking part
+
+	for ( int i = 0; i < numLabels; i++ )
+	{
+		QCPItemText *label = labels.at(i);
+		placeLabel(label, sides.at(i), gap);
+
+		if ( (! label->visible()) || label->text().isEmpty() || (! label->position->parentAnchor()) )
+		{
+			continue;
+		}
+
+		anchors[i] = label->position->parentAnchor()->pixelPosition();
+		sizes[i] = labelSize(label);
+
+		// Candidates only ever move vertically, so a label's horizontal extent is fixed and the sweep can be ordered up front
+		order.append(qMakePair(anchors[i].x() - sizes[i].width() / 2, i));
+	}
+
+	std::sort(order.begin(), order.end());
+
+	QVector<QRectF> markers = obstacles;
+	std::sort(markers.begin(), markers.end(), leftEdgeLess);
+
+	/*
+	 * Sweep left to right. The active set holds everything already placed whose right edge hasn't been passed yet, keyed on that
+	 * right edge so expired entries come off the front. Markers join it as soon as a label reaches them.
+	 */
+
+	std::multimap<double, QRectF> active;
+	int nextMarker = 0;
+
+	for ( int i = 0; i < order.size(); i++ )
+	{
+		int index = order.at(i).second;
+		double left = order.at(i).first;
+		double right = left + sizes.at(index).width();
+
+		while ( (! active.empty()) && (active.begin()->first <= left) )
+		{
+			active.erase(active.begin());
+		}
+
+		while ( (nextMarker < markers.size()) && (markers.at(nextMarker).left() < right) )
+		{
+			active.insert(std::make_pair(markers.at(nextMarker).right(), markers.at(nextMarker)));
+			nextMarker++;
+		}
+
+		int bestSide = sides.at(index);
+		double bestDistance = gap;
+		double bestOverlap = std::numeric_limits<double>::infinity();
+
+		for ( int level = 0; (level < MAX_LEVELS) && (bestOverlap > 0); level++ )
+		{
+			for ( int k = 0; (k < 2) && (bestOverlap > 0); k++ )
+			{
+				int side = (k == 0) ? sides.at(index) : 1 - sides.at(index);
+				double distance = gap + level * (sizes.at(index).height() + LABEL_SPACING);
+				QRectF candidate = labelRect(anchors.at(index), sizes.at(index), side, distance);
+
+				double overlap = 0;
+				for ( std::multimap<double, QRectF>::const_iterator it = active.begin(); it != active.end(); ++it )
+				{
+					QRectF shared = candidate.intersected(it->second);
+					if ( ! shared.isEmpty() )
+					{
+						overlap += shared.width() * shared.height();
+					}
+				}
+
+				if ( overlap < bestOverlap )
+				{
+					bestOverlap = overlap;
+					bestSide = side;
+					bestDistance = distance;
+				}
+			}
+		}
+
+		if ( bestOverlap > 0 )
+		{
+			qDebug() << "No free spot for label" << labels.at(index)->text() << "overlap =" << bestOverlap;
+		}
+
+		placeLabel(labels.at(index), bestSide, bestDistance);
+
+		QRectF placed = labelRect(anchors.at(index), sizes.at(index), bestSide, bestDistance).adjusted(-LABEL_SPACING, -LABEL_SPACING, LABEL_SPACING, LABEL_SPACING);
+		active.insert(std::make_pair(placed.right(), placed));
+	}
+}
+
+/*
+ * Works out how big the graph needs to be from what's on it, using only a layout pass. Each x-axis column needs room for its
+ * tick label, its annotations and minColumnWidth pixels of markers, and the columns closest together in plot coordinates set
+ * the scale for the whole axis. The height leaves enough headroom for the tallest stack of labels above or below a point.
+ */
+QSize LabelLayout::canvasSize ( QCustomPlot *plot, const QList<QCPItemText *> &labels, const QVector<int> &sides, double gap, double minColumnWidth )
+{
+	QMap<double, double> columnWidths; // keyed on plot x
+	double stackAbove = 0;
+	double stackBelow = 0;
+
+	QSharedPointer<QCPAxisTickerText> ticker = plot->xAxis->ticker().dynamicCast<QCPAxisTickerText>();
+	if ( ticker )
+	{
+		QFontMetricsF metrics(plot->xAxis->tickLabelFont());
+		for ( QMap<double, QString>::const_iterator it = ticker->ticks().constBegin(); it != ticker->ticks().constEnd(); ++it )
+		{
+			columnWidths[it.key()] = qMax(minColumnWidth, metrics.horizontalAdvance(it.value()));
+		}
+	}
+
+	for ( int i = 0; i < labels.size(); i++ )
+	{
+		QCPItemText *label = labels.at(i);
+		QCPItemPosition *anchor = dynamic_cast<QCPItemPosition *>(label->position->parentAnchor());
+
+		if ( (! label->visible()) || label->text().isEmpty() || (! anchor) )
+		{
+			continue;
+		}
+
+		QSizeF size = labelSize(label);
+
+		columnWidths[anchor->key()] = qMax(columnWidths.value(anchor->key(), minColumnWidth), size.width());
+
+		if ( sides.at(i) == ABOVE )
+		{
+			stackAbove = qMax(stackAbove, gap + size.height());
+		}
+		else
+		{
+			stackBelow = qMax(stackBelow, gap + size.height());
+		}
+	}
+
+	/* Pixels per x unit so that no two neighboring columns overlap */
+
+	double pixelsPerUnit = 0;
+	QList<double> keys = columnWidths.keys();
+	for ( int i = 1; i < keys.size(); i++ )
+	{
+		double distance = keys.at(i) - keys.at(i - 1);
+		double needed = (columnWidths.value(keys.at(i)) + columnWidths.value(keys.at(i - 1))) / 2 + COLUMN_SPACING;
+
+		if ( distance > 0 )
+		{
+			pixelsPerUnit = qMax(pixelsPerUnit, needed / distance);
+		}
+	}
+
+	double axisWidth = pixelsPerUnit * plot->xAxis->range().size();
+	double axisHeight = qMax(stackAbove, stackBelow) / HEADROOM;
+
+	/* Everything outside the axis rect stays the same size, so measure it once at the reference size */
+
+	QRect viewport = layoutAt(plot, QSize(REFERENCE_WIDTH, REFERENCE_HEIGHT));
+	int chromeWidth = REFERENCE_WIDTH - plot->axisRect()->width();
+	int chromeHeight = REFERENCE_HEIGHT - plot->axisRect()->height();
+	plot->setViewport(viewport);
+
+	int width = qBound(MIN_CANVAS_WIDTH, chromeWidth + qCeil(axisWidth), MAX_CANVAS_WIDTH);
+	int height = qBound(MIN_CANVAS_HEIGHT, chromeHeight + qCeil(axisHeight), MAX_CANVAS_HEIGHT);
+
+	qDebug() << "Canvas size" << width << "x" << height << "for" << keys.size() << "columns";
+
+	return QSize(width, height);
+}
@@ -0,0 +1,32 @@
+#ifndef LABELLAYOUT_H
+#define LABELLAYOUT_H
+
+#include <QVector>
+#include <QList>
+#include <QRect>
+#include <QRectF>
+#include <QSize>
+
+#include "qcustomplot/qcustomplot.h"
+
+/*
+ * Placement of the text annotations hung above and below each series. Every label is measured once, then the labels are swept
+ * left to right by their horizontal extent and each one takes the first candidate position (preferred side, other side, then
+ * pushed progressively further out) that doesn't collide with a label or marker already in its way.
+ */
+
+namespace LabelLayout
+{
+	// Sides a label can hang off its anchor, matching the ABOVE_STRING and BELOW_STRING option values
+	enum
+	{
+		ABOVE = 0,
+		BELOW = 1
+	};
+
+	QRect layoutAt ( QCustomPlot *, const QSize & );
+	void arrange ( const QList<QCPItemText *> &, const QVector<int> &, const QVector<QRectF> &, double );
+	QSize canvasSize ( QCustomPlot *, const QList<QCPItemText *> &, const QVector<int> &, double, double );
+};
+
+#endif // LABELLAYOUT_H
@@ -0,0 +1,323 @@
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <QDebug>
+#include <QtMath>
+#include <QStringList>
+
+#include "Outliers.h"
+
+// Significance level for the Grubbs and Dixon tests
+#define OUTLIER_ALPHA 0.05
+
+// Modified z-score cutoff recommended by Iglewicz and Hoaglin
+#define MAD_CUTOFF 3.5
+
+// Dixon's Q critical values (r10, 95% confidence) for n = 3 through 10
+static const double dixonQ95[] = { 0.970, 0.829, 0.710, 0.625, 0.568, 0.526, 0.493, 0.466 };
+
+void Outliers::Batch::appendSeries ( const QList<double> &series )
+{
+	for ( int i = 0; i < series.size(); i++ )
+	{
+		values.append(series.at(i));
+	}
+
+	offsets.append(values.size());
+}
+
+/*
+ * Inverse of the standard normal CDF (Acklam's rational approximation, relative error < 1.15e-9)
+ */
+static double normalQuantile ( double p )
+{
+	static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00 };
+	static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+	static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00, -2.549671362388222e+00, 4.374664141464968e+00, 2.938163982698783e+00 };
+	static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00, 3.754408661907416e+00 };
+
+	if ( p < 0.02425 )
+	{
+		double q = sqrt(-2 * log(p));
+		return (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+	}
+	else if ( p > 1 - 0.02425 )
+	{
+		double q = sqrt(-2 * log(1 - p));
+		return -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1);
+	}
+
+	double q = p - 0.5;
+	double r = q * q;
+	return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1);
+}
+
+/*
+ * Critical value t such that P(|T| > t) = p for Student's t with df degrees of freedom (Hill's algorithm 396)
+ */
+static double studentQuantile ( double p, int df )
+{
+	if ( df == 1 )
+	{
+		return 1 / tan(p * M_PI / 2);
+	}
+	else if ( df == 2 )
+	{
+		return sqrt(2 / (p * (2 - p)) - 2);
+	}
+
+	double n = df;
+	double a = 1 / (n - 0.5);
+	double b = 48 / (a * a);
+	double c = ((20700 * a / b - 98) * a - 16) * a + 96.36;
+	double d = ((94.5 / (b + c) - 3) / b + 1) * sqrt(a * M_PI / 2) * n;
+	double y = pow(d * p, 2.0 / n);
+
+	if ( y > 0.05 + a )
+	{
+		// Asymptotic inverse expansion about the normal distribution
+		double x = normalQuantile(0.5 * p);
+		y = x * x;
+		if ( df < 5 )
+		{
+			c += 0.3 * (n - 4.5) * (x + 0.6);
+		}
+		c = (((0.05 * d * x - 5) * x - 7) * x - 2) * x + b + c;
+		y = (((((0.4 * y + 6.3) * y + 36) * y + 94.5) / c - y - 3) / b + 1) * x;
+		y = expm1(a * y * y);
+	}
+	else
+	{
+		y = ((1 / (((n + 6) / (n * y) - 0.089 * d - 0.822) * (n + 2) * 3) + 0.5 / (n + 4)) * y - 1) * (n + 1) / (n + 2) + 1 / y;
+	}
+
+	return sqrt(n * y);
+}
+
+static double grubbsCritical ( int n, bool upperOnly )
+{
+	// Two-sided tests split alpha across both tails, one-sided tests put it all in the upper tail
+	double t = studentQuantile(upperOnly ? 2 * OUTLIER_ALPHA / n : OUTLIER_ALPHA / n, n - 2);
+
+	return ((n - 1) / sqrt((double)n)) * sqrt((t * t) / (n - 2 + t * t));
+}
+
+static double sortedMedian ( const double *x, int n )
+{
+	return (n % 2) ? x[n / 2] : (x[n / 2 - 1] + x[n / 2]) / 2;
+}
+
+/*
+ * Each test is reduced to a pair of cutoffs per series: a shot is flagged by a test if it's at or beyond either cutoff.
+ * Index 0 is Grubbs, 1 is MAD, and 2 is Dixon, matching the flag bit order.
+ */
+struct Cutoffs
+{
+	double low[3];
+	double high[3];
+};
+
+QVector<quint8> Outliers::detect ( const Batch &batch, bool upperOnly )
+{
+	int numSeries = batch.seriesCount();
+	int numValues = batch.values.size();
+
+	QVector<quint8> flags(numValues, 0);
+
+	if ( numValues == 0 )
+	{
+		return flags;
+	}
+
+	const double inf = std::numeric_limits<double>::infinity();
+
+	Cutoffs none;
+	for ( int t = 0; t < 3; t++ )
+	{
+		none.low[t] = -inf;
+		none.high[t] = inf;
+	}
+
+	QVector<Cutoffs> cutoffs(numSeries, none);
+
+	// Every test only needs order statistics and running sums, so sort a copy of the buffer one series at a time
+	QVector<double> sorted = batch.values;
+	QVector<double> deviations(numValues);
+
+	for ( int s = 0; s < numSeries; s++ )
+	{
+		int begin = batch.offsets.at(s);
+		int n = batch.offsets.at(s + 1) - begin;
+
+		if ( n < 3 )
+		{
+			continue;
+		}
+
+		double *x = sorted.data() + begin;
+		std::sort(x, x + n);
+
+		Cutoffs &cut = cutoffs[s];
+		double median = sortedMedian(x, n);
+
+		/* Grubbs, applied iteratively. The most extreme remaining shot is always at one end of the sorted run. */
+
+		// Sums are taken relative to the median to avoid cancellation with large velocities
+		double sum = 0;
+		double sumSq = 0;
+		for ( int i = 0; i < n; i++ )
+		{
+			sum += x[i] - median;
+			sumSq += (x[i] - median) * (x[i] - median);
+		}
+
+		int lo = 0;
+		int hi = n - 1;
+		while ( hi - lo + 1 >= 3 )
+		{
+			int m = hi - lo + 1;
+			double mean = sum / m;
+			double variance = (sumSq - sum * mean) / (m - 1);
+
+			if ( variance <= 0 )
+			{
+				break;
+			}
+
+			double stdev = sqrt(variance);
+			double gHigh = ((x[hi] - median) - mean) / stdev;
+			double gLow = upperOnly ? 0 : (mean - (x[lo] - median)) / stdev;
+			double critical = grubbsCritical(m, upperOnly);
+
+			if ( gHigh >= gLow && gHigh > critical )
+			{
+				cut.high[0] = x[hi];
+				sum -= x[hi] - median;
+				sumSq -= (x[hi] - median) * (x[hi] - median);
+				hi--;
+			}
+			else if ( gLow > gHigh && gLow > critical )
+			{
+				cut.low[0] = x[lo];
+				sum -= x[lo] - median;
+				sumSq -= (x[lo] - median) * (x[lo] - median);
+				lo++;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		/* Median absolute deviation */
+
+		double *dev = deviations.data() + begin;
+		for ( int i = 0; i < n; i++ )
+		{
+			dev[i] = fabs(x[i] - median);
+		}
+		std::sort(dev, dev + n);
+
+		double mad = sortedMedian(dev, n);
+		if ( mad > 0 )
+		{
+			// modified z-score = 0.6745 * (x - median) / MAD
+			double reach = MAD_CUTOFF * mad / 0.6745;
+
+			const double *above = std::upper_bound(x, x + n, median + reach);
+			if ( above != x + n )
+			{
+				cut.high[1] = *above;
+			}
+
+			const double *below = std::lower_bound(x, x + n, median - reach);
+			if ( ! upperOnly && below != x )
+			{
+				cut.low[1] = *(below - 1);
+			}
+		}
+
+		/* Dixon's Q, only tabulated for small strings */
+
+		double range = x[n - 1] - x[0];
+		if ( n <= 10 && range > 0 )
+		{
+			double q = dixonQ95[n - 3];
+
+			if ( (x[n - 1] - x[n - 2]) / range > q )
+			{
+				cut.high[2] = x[n - 1];
+			}
+
+			if ( ! upperOnly && (x[1] - x[0]) / range > q )
+			{
+				cut.low[2] = x[0];
+			}
+		}
+	}
+
+	/* Single sweep over the original buffer to flag each shot against its series' cutoffs */
+
+	for ( int s = 0; s < numSeries; s++ )
+	{
+		const Cutoffs &cut = cutoffs.at(s);
+		const double *v = batch.values.constData();
+		quint8 *f = flags.data();
+
+		for ( int i = batch.offsets.at(s); i < batch.offsets.at(s + 1); i++ )
+		{
+			f[i] = ((v[i] <= cut.low[0] || v[i] >= cut.high[0]) ? GRUBBS : 0)
+			     | ((v[i] <= cut.low[1] || v[i] >= cut.high[1]) ? MAD : 0)
+			     | ((v[i] <= cut.low[2] || v[i] >= cut.high[2]) ? DIXON : 0);
+		}
+	}
+
+	return flags;
+}
+
+QList<double> Outliers::radialDistances ( const QList<QPair<double, double> > &coordinates )
+{
+	QList<double> distances;
+
+	if ( coordinates.empty() )
+	{
+		return distances;
+	}
+
+	double xMean = 0;
+	double yMean = 0;
+	for ( int i = 0; i < coordinates.size(); i++ )
+	{
+		xMean += coordinates.at(i).first;
+		yMean += coordinates.at(i).second;
+	}
+	xMean /= coordinates.size();
+	yMean /= coordinates.size();
+
+	for ( int i = 0; i < coordinates.size(); i++ )
+	{
+		distances.append(sqrt( pow(coordinates.at(i).first - xMean, 2) + pow(coordinates.at(i).second - yMean, 2) ));
+	}
+
+	return distances;
+}
+
+QString Outliers::describe ( quint8 flags )
+{
+	QStringList tests;
+
+	if ( flags & GRUBBS )
+	{
+		tests.append("Grubbs");
+	}
+	if ( flags & MAD )
+	{
+		tests.append("MAD");
+	}
+	if ( flags & DIXON )
+	{
+		tests.append("Dixon");
+	}
+
+	return tests.join(", ");
+}
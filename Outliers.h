@@ -0,0 +1,40 @@
+#ifndef OUTLIERS_H
+#define OUTLIERS_H
+
+#include <QVector>
+#include <QList>
+#include <QPair>
+#include <QString>
+
+/*
+ * Flyer detection shared by all three tabs. Every series' samples (muzzle velocities, or radial distances from the
+ * group center) are packed back to back into a single contiguous buffer so that one pass can test all series at once,
+ * no matter how many were imported.
+ */
+
+namespace Outliers
+{
+	// Bits set in a shot's flag byte, one per test that considers it an outlier
+	enum
+	{
+		GRUBBS = 0x1,
+		MAD = 0x2,
+		DIXON = 0x4
+	};
+
+	struct Batch
+	{
+		QVector<double> values;
+		QVector<int> offsets; // series i occupies values[offsets[i]] through values[offsets[i + 1] - 1]
+
+		Batch() { offsets.append(0); };
+		void appendSeries ( const QList<double> & );
+		int seriesCount ( void ) const { return offsets.size() - 1; };
+	};
+
+	QVector<quint8> detect ( const Batch &, bool upperOnly );
+	QList<double> radialDistances ( const QList<QPair<double, double> > & );
+	QString describe ( quint8 );
+};
+
+#endif // OUTLIERS_H
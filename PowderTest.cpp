@@ -1,9 +1,20 @@
 #include <sstream>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QHeaderView>
+#include <QtConcurrent>
 
 #include "untar.h"
 #include "miniz.h"
 #include "ChronoPlotter.h"
 #include "PowderTest.h"
+#include "Outliers.h"
+#include "LabelLayout.h"
+#include "Density.h"
+#include "History.h"
+#include "ShotArchive.h"
+#include "RenderCache.h"
+#include "BatchExport.h"
 
 #include "xlsxdocument.h"
 #include "xlsxchartsheet.h"
@@ -20,6 +31,12 @@ PowderTest::PowderTest ( QWidget *parent )
 	qDebug() << "Powder test";
 
 	graphPreview = NULL;
+	headless = false;
+	fromHistory = false;
+	importDevice = DEVICE_UNKNOWN;
+	scrollWidget = NULL;
+	seriesView = NULL;
+	seriesModel = new SeriesModel(&seriesData, this);
 	prevLabRadarDir = QDir::homePath();
 	prevMagnetoSpeedDir = QDir::homePath();
 	prevProChronoDir = QDir::homePath();
@@ -247,6 +264,10 @@ PowderTest::PowderTest ( QWidget *parent )
 	connect(saveGraphButton, SIGNAL(clicked(bool)), this, SLOT(saveGraph(bool)));
 	graphButtonsLayout->addWidget(saveGraphButton);
 
+	QPushButton *batchExportButton = new QPushButton("Batch export...");
+	connect(batchExportButton, SIGNAL(clicked(bool)), this, SLOT(batchExportClicked(bool)));
+	graphButtonsLayout->addWidget(batchExportButton);
+
 	graphButtonsLayout->addStretch(0);
 
 	/* Vertically position graph options and generate graph buttons */
@@ -260,6 +281,13 @@ PowderTest::PowderTest ( QWidget *parent )
 	pageLayout->addLayout(rightLayout, 0);
 
 	this->setLayout(pageLayout);
+
+	// Buttons in manually entered rows are greyed out along with the rest of their row
+	connect(seriesModel, &QAbstractItemModel::dataChanged, this, [=] ( const QModelIndex &topLeft, const QModelIndex &bottomRight ) {
+		updateSeriesButtons(topLeft.row(), bottomRight.row());
+	});
+
+	setupPlot();
 }
 
 static bool ChronoSeriesComparator ( ChronoSeries *one, ChronoSeries *two )
@@ -267,6 +295,244 @@ static bool ChronoSeriesComparator ( ChronoSeries *one, ChronoSeries *two )
 	return (one->seriesNum < two->seriesNum);
 }
 
+/*
+ * Series table
+ */
+
+SeriesModel::SeriesModel ( QList<ChronoSeries *> *seriesData, QObject *parent )
+	: QAbstractTableModel(parent), seriesData(seriesData), manual(false)
+{
+}
+
+/*
+ * Call after seriesData has been replaced or reordered
+ */
+void SeriesModel::reload ( bool manualEntry )
+{
+	beginResetModel();
+	manual = manualEntry;
+	endResetModel();
+}
+
+void SeriesModel::appendSeries ( ChronoSeries *series )
+{
+	beginInsertRows(QModelIndex(), seriesData->size(), seriesData->size());
+	seriesData->append(series);
+	endInsertRows();
+}
+
+/*
+ * Call after series have been changed in place
+ */
+void SeriesModel::refresh ( void )
+{
+	if ( ! seriesData->isEmpty() )
+	{
+		emit dataChanged(index(0, 0), index(seriesData->size() - 1, columnCount() - 1));
+	}
+}
+
+void SeriesModel::refreshSeries ( ChronoSeries *series )
+{
+	int row = seriesData->indexOf(series);
+	emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+}
+
+void SeriesModel::setAllEnabled ( bool enabled )
+{
+	for ( int i = 0; i < seriesData->size(); i++ )
+	{
+		seriesData->at(i)->enabled = enabled;
+	}
+
+	refresh();
+}
+
+int SeriesModel::rowCount ( const QModelIndex &parent ) const
+{
+	return parent.isValid() ? 0 : seriesData->size();
+}
+
+int SeriesModel::columnCount ( const QModelIndex &parent ) const
+{
+	if ( parent.isValid() )
+	{
+		return 0;
+	}
+
+	return manual ? DELETE_COLUMN + 1 : DATE_COLUMN + 1;
+}
+
+/*
+ * Summary of a series' shots, with the shots flagged as possible flyers in flagged
+ */
+static QString seriesResult ( ChronoSeries *series, QStringList &flagged )
+{
+	int totalShots = series->muzzleVelocities.size();
+	if ( totalShots == 0 )
+	{
+		return QString("0 shots, 0-0 %1").arg(series->velocityUnits);
+	}
+
+	for ( int j = 0; j < qMin(totalShots, series->outlierFlags.size()); j++ )
+	{
+		if ( series->outlierFlags.at(j) )
+		{
+			flagged.append(QString("Shot %1: %2 %3 (%4)").arg(j + 1).arg(series->muzzleVelocities.at(j)).arg(series->velocityUnits).arg(Outliers::describe(series->outlierFlags.at(j))));
+		}
+	}
+
+	double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
+	double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
+	QString resultText = QString("%1 shot%2, %3-%4 %5").arg(totalShots).arg(totalShots > 1 ? "s" : "").arg(velocityMin).arg(velocityMax).arg(series->velocityUnits);
+
+	if ( ! flagged.empty() )
+	{
+		return QString("%1 (%2 flagged)").arg(resultText).arg(flagged.size());
+	}
+
+	return resultText;
+}
+
+QVariant SeriesModel::data ( const QModelIndex &index, int role ) const
+{
+	if ( ! index.isValid() )
+	{
+		return QVariant();
+	}
+
+	ChronoSeries *series = seriesData->at(index.row());
+
+	if ( index.column() == ENABLED_COLUMN )
+	{
+		if ( role == Qt::CheckStateRole )
+		{
+			return series->enabled ? Qt::Checked : Qt::Unchecked;
+		}
+
+		return QVariant();
+	}
+
+	if ( (role == Qt::DisplayRole) || (role == Qt::EditRole) )
+	{
+		switch ( index.column() )
+		{
+			case NAME_COLUMN:
+				return series->name;
+			case WEIGHT_COLUMN:
+				return series->chargeWeight;
+			case RESULT_COLUMN:
+			{
+				QStringList flagged;
+				return seriesResult(series, flagged);
+			}
+			case DATE_COLUMN:
+				if ( ! manual )
+				{
+					return QString("%1 %2").arg(series->firstDate).arg(series->firstTime);
+				}
+		}
+	}
+	else if ( (index.column() == RESULT_COLUMN) && ((role == Qt::ToolTipRole) || (role == Qt::ForegroundRole)) )
+	{
+		QStringList flagged;
+		seriesResult(series, flagged);
+
+		if ( flagged.empty() )
+		{
+			return QVariant();
+		}
+
+		if ( role == Qt::ToolTipRole )
+		{
+			return QString("Possible flyers:\n%1").arg(flagged.join("\n"));
+		}
+
+		return QColor("#c00000");
+	}
+
+	return QVariant();
+}
+
+QVariant SeriesModel::headerData ( int section, Qt::Orientation orientation, int role ) const
+{
+	if ( (orientation != Qt::Horizontal) || (role != Qt::DisplayRole) )
+	{
+		return QVariant();
+	}
+
+	switch ( section )
+	{
+		case NAME_COLUMN:
+			return QString("Series Name");
+		case WEIGHT_COLUMN:
+			return QString("Charge Weight");
+		case RESULT_COLUMN:
+			return QString("Series Result");
+		case DATE_COLUMN:
+			return manual ? QString() : QString("Series Date");
+	}
+
+	return QVariant();
+}
+
+Qt::ItemFlags SeriesModel::flags ( const QModelIndex &index ) const
+{
+	if ( ! index.isValid() )
+	{
+		return Qt::NoItemFlags;
+	}
+
+	if ( index.column() == ENABLED_COLUMN )
+	{
+		return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+	}
+
+	// The rest of an unchecked series' row is greyed out
+	if ( ! seriesData->at(index.row())->enabled )
+	{
+		return Qt::NoItemFlags;
+	}
+
+	if ( index.column() == WEIGHT_COLUMN )
+	{
+		return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+	}
+
+	return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+bool SeriesModel::setData ( const QModelIndex &index, const QVariant &value, int role )
+{
+	if ( ! index.isValid() )
+	{
+		return false;
+	}
+
+	ChronoSeries *series = seriesData->at(index.row());
+
+	if ( (index.column() == ENABLED_COLUMN) && (role == Qt::CheckStateRole) )
+	{
+		series->enabled = (value.toInt() == Qt::Checked);
+
+		qDebug() << "Series" << series->seriesNum << "enabled =" << series->enabled;
+
+		// Grey out or restore the whole row
+		emit dataChanged(index, index.sibling(index.row(), columnCount() - 1));
+		return true;
+	}
+
+	if ( (index.column() == WEIGHT_COLUMN) && (role == Qt::EditRole) )
+	{
+		series->chargeWeight = value.toDouble();
+
+		emit dataChanged(index, index);
+		return true;
+	}
+
+	return false;
+}
+
 void PowderTest::DisplaySeriesData ( void )
 {
 	// Sort the list by series number
@@ -275,24 +541,20 @@ void PowderTest::DisplaySeriesData ( void )
 	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
 	stackedWidget->removeWidget(scrollWidget);
 
-	QVBoxLayout *scrollLayout = new QVBoxLayout();
+	seriesModel->reload(false);
 
-	// Wrap grid in a widget to make the grid scrollable
-	QWidget *scrollAreaWidget = new QWidget();
+	qDebug() << "Displaying" << seriesData.size() << "series," << SeriesArena<ChronoSeries>::live() << "live";
 
-	seriesGrid = new QGridLayout(scrollAreaWidget);
-	seriesGrid->setColumnStretch(0, 0);
-	seriesGrid->setColumnStretch(1, 1);
-	seriesGrid->setColumnStretch(2, 2);
-	seriesGrid->setColumnStretch(3, 3);
-	seriesGrid->setColumnStretch(4, 3);
-	seriesGrid->setHorizontalSpacing(25);
+	QVBoxLayout *scrollLayout = new QVBoxLayout();
+
+	QCheckBox *headerCheckBox = new QCheckBox();
+	headerCheckBox->setChecked(true);
+	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
 
-	scrollArea = new QScrollArea();
-	scrollArea->setWidget(scrollAreaWidget);
-	scrollArea->setWidgetResizable(true);
+	seriesView = createSeriesView(seriesModel, headerCheckBox);
+	seriesView->setItemDelegateForColumn(SeriesModel::WEIGHT_COLUMN, new SpinBoxDelegate(2, 0.1, 1000000, seriesView));
 
-	scrollLayout->addWidget(scrollArea);
+	scrollLayout->addWidget(seriesView);
 
 	/* Create utilities toolbar under scroll area */
 
@@ -301,7 +563,7 @@ void PowderTest::DisplaySeriesData ( void )
 	loadNewButton->setMinimumWidth(225);
 	loadNewButton->setMaximumWidth(225);
 
-	QPushButton *rrButton = new QPushButton("Convert from round-robin");
+	QPushButton *rrButton = new QPushButton(rrOriginalSeries.isEmpty() ? "Convert from round-robin" : "Undo round-robin conversion");
 	connect(rrButton, SIGNAL(clicked(bool)), this, SLOT(rrClicked(bool)));
 	rrButton->setMinimumWidth(225);
 	rrButton->setMaximumWidth(225);
@@ -311,10 +573,22 @@ void PowderTest::DisplaySeriesData ( void )
 	autofillButton->setMinimumWidth(225);
 	autofillButton->setMaximumWidth(225);
 
+	excludeOutliersButton = new QPushButton("Exclude flagged shots");
+	connect(excludeOutliersButton, SIGNAL(clicked(bool)), this, SLOT(excludeOutliersClicked(bool)));
+	excludeOutliersButton->setMinimumWidth(225);
+	excludeOutliersButton->setMaximumWidth(225);
+
+	restoreShotsButton = new QPushButton("Restore excluded shots");
+	connect(restoreShotsButton, SIGNAL(clicked(bool)), this, SLOT(restoreShotsClicked(bool)));
+	restoreShotsButton->setMinimumWidth(225);
+	restoreShotsButton->setMaximumWidth(225);
+
 	QHBoxLayout *utilitiesLayout = new QHBoxLayout();
 	utilitiesLayout->addWidget(loadNewButton);
 	utilitiesLayout->addWidget(rrButton);
 	utilitiesLayout->addWidget(autofillButton);
+	utilitiesLayout->addWidget(excludeOutliersButton);
+	utilitiesLayout->addWidget(restoreShotsButton);
 
 	scrollLayout->addLayout(utilitiesLayout);
 
@@ -324,54 +598,108 @@ void PowderTest::DisplaySeriesData ( void )
 	stackedWidget->addWidget(scrollWidget);
 	stackedWidget->setCurrentWidget(scrollWidget);
 
-	QCheckBox *headerCheckBox = new QCheckBox();
-	headerCheckBox->setChecked(true);
-	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
-	seriesGrid->addWidget(headerCheckBox, 0, 0);
+	// Flag any flyers in the newly displayed data
+	DetectOutliers();
+}
+
+void PowderTest::DetectOutliers ( void )
+{
+	/* Pack every series' velocities into one buffer so all series are tested in a single pass */
+
+	Outliers::Batch batch;
+	for ( int i = 0; i < seriesData.size(); i++ )
+	{
+		batch.appendSeries(seriesData.at(i)->muzzleVelocities);
+	}
 
-	/* Headers for series data */
+	QVector<quint8> flags = Outliers::detect(batch, false);
 
-	QLabel *headerName = new QLabel("Series Name");
-	seriesGrid->addWidget(headerName, 0, 1, Qt::AlignVCenter);
-	QLabel *headerChargeWeight = new QLabel("Charge Weight");
-	seriesGrid->addWidget(headerChargeWeight, 0, 2, Qt::AlignVCenter);
-	headerResult = new QLabel("Series Result");
-	seriesGrid->addWidget(headerResult, 0, 3, Qt::AlignVCenter);
-	QLabel *headerDate = new QLabel("Series Date");
-	seriesGrid->addWidget(headerDate, 0, 4, Qt::AlignVCenter);
+	int totalFlagged = 0;
+	int totalExcluded = 0;
 
 	for ( int i = 0; i < seriesData.size(); i++ )
 	{
 		ChronoSeries *series = seriesData.at(i);
 
-		connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesCheckBoxChanged(int)));
+		int offset = batch.offsets.at(i);
+		series->outlierFlags = flags.mid(offset, batch.offsets.at(i + 1) - offset);
 
-		seriesGrid->addWidget(series->enabled, i + 1, 0);
-		seriesGrid->addWidget(series->name, i + 1, 1, Qt::AlignVCenter);
+		totalExcluded += series->excludedShots.size();
 
-		QHBoxLayout *chargeWeightLayout = new QHBoxLayout();
-		chargeWeightLayout->addWidget(series->chargeWeight);
-		chargeWeightLayout->addStretch(0);
-		seriesGrid->addLayout(chargeWeightLayout, i + 1, 2);
+		int seriesFlagged = series->outlierFlags.size() - series->outlierFlags.count(0);
+		if ( seriesFlagged > 0 )
+		{
+			qDebug() << "Series" << series->seriesNum << "has" << seriesFlagged << "flagged shots";
 
-		int totalShots = series->muzzleVelocities.size();
-		double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-		double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-		QLabel *resultLabel = new QLabel(QString("%1 shot%2, %3-%4 %5").arg(totalShots).arg(totalShots > 1 ? "s" : "").arg(velocityMin).arg(velocityMax).arg(series->velocityUnits));
-		seriesGrid->addWidget(resultLabel, i + 1, 3, Qt::AlignVCenter);
+			totalFlagged += seriesFlagged;
+		}
+	}
+
+	// Flagged shots are listed in each series' result
+	seriesModel->refresh();
+
+	qDebug() << "Flagged" << totalFlagged << "shots across" << seriesData.size() << "series";
+
+	excludeOutliersButton->setEnabled(totalFlagged > 0);
+	restoreShotsButton->setEnabled(totalExcluded > 0);
+}
+
+void PowderTest::excludeOutliersClicked ( bool state )
+{
+	qDebug() << "excludeOutliersClicked state =" << state;
+
+	for ( int i = 0; i < seriesData.size(); i++ )
+	{
+		ChronoSeries *series = seriesData.at(i);
+
+		// Leave series the user has unchecked as they are
+		if ( series->deleted || !series->enabled )
+		{
+			continue;
+		}
+
+		QList<double> kept;
+		for ( int j = 0; j < series->muzzleVelocities.size(); j++ )
+		{
+			if ( (j < series->outlierFlags.size()) && series->outlierFlags.at(j) )
+			{
+				qDebug() << "Excluding" << series->muzzleVelocities.at(j) << "from Series" << series->seriesNum;
 
-		QLabel *datetimeLabel = new QLabel(QString("%1 %2").arg(series->firstDate).arg(series->firstTime));
-		seriesGrid->addWidget(datetimeLabel, i + 1, 4, Qt::AlignVCenter);
+				series->excludedShots.append(qMakePair(kept.size(), series->muzzleVelocities.at(j)));
+			}
+			else
+			{
+				kept.append(series->muzzleVelocities.at(j));
+			}
+		}
 
-		seriesGrid->setRowMinimumHeight(0, series->chargeWeight->sizeHint().height());
+		series->muzzleVelocities = kept;
 	}
 
-	// Add an empty stretch row at the end for proper spacing
-	seriesGrid->setRowStretch(seriesData.size() + 1, 1);
+	// Update the series results with the remaining shots
+	DetectOutliers();
+}
+
+void PowderTest::restoreShotsClicked ( bool state )
+{
+	qDebug() << "restoreShotsClicked state =" << state;
+
+	for ( int i = 0; i < seriesData.size(); i++ )
+	{
+		ChronoSeries *series = seriesData.at(i);
+
+		// Put shots back newest first so each one lands where it was taken out
+		while ( !series->excludedShots.isEmpty() )
+		{
+			QPair<int, double> shot = series->excludedShots.takeLast();
+
+			qDebug() << "Restoring" << shot.second << "to Series" << series->seriesNum;
+
+			series->muzzleVelocities.insert(qMin(shot.first, series->muzzleVelocities.size()), shot.second);
+		}
+	}
 
-	scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-	scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-	scrollArea->setWidgetResizable(true);
+	DetectOutliers();
 }
 
 void PowderTest::addNewClicked ( bool state )
@@ -381,22 +709,10 @@ void PowderTest::addNewClicked ( bool state )
 	// un-bold the button after the first click
 	addNewButton->setStyleSheet("");
 
-	int numRows = seriesGrid->rowCount();
-
-	// Remove the stretch from the last row, we'll be using the row for our new series
-	seriesGrid->setRowStretch(numRows - 1, 0);
-
-	qDebug() << "numRows =" << numRows;
-
 	ChronoSeries *series = new ChronoSeries();
 
 	series->deleted = false;
-
-	series->enabled = new QCheckBox();
-	series->enabled->setChecked(true);
-
-	connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesManualCheckBoxChanged(int)));
-	seriesGrid->addWidget(series->enabled, numRows - 1, 0);
+	series->enabled = true;
 
 	int newSeriesNum = 1;
 	for ( int i = seriesData.size() - 1; i >= 0; i-- )
@@ -405,56 +721,70 @@ void PowderTest::addNewClicked ( bool state )
 		if ( ! series->deleted )
 		{
 			newSeriesNum = series->seriesNum + 1;
-			qDebug() << "Found last un-deleted series" << series->seriesNum << "(" << series->name->text() << ") at index" << i;
+			qDebug() << "Found last un-deleted series" << series->seriesNum << "(" << series->name << ") at index" << i;
 			break;
 		}
 	}
 
 	series->seriesNum = newSeriesNum;
+	series->name = QString("Series %1").arg(newSeriesNum);
+	series->chargeWeight = 0;
 
-	series->name = new QLabel(QString("Series %1").arg(newSeriesNum));
-	seriesGrid->addWidget(series->name, numRows - 1, 1);
-
-	series->chargeWeight = new QDoubleSpinBox();
-	series->chargeWeight->setDecimals(2);
-	series->chargeWeight->setSingleStep(0.1);
-	series->chargeWeight->setMaximum(1000000);
-	series->chargeWeight->setMinimumWidth(100);
-	series->chargeWeight->setMaximumWidth(100);
-
-	QHBoxLayout *chargeWeightLayout = new QHBoxLayout();
-	chargeWeightLayout->addWidget(series->chargeWeight);
-	chargeWeightLayout->addStretch(0);
-	seriesGrid->addLayout(chargeWeightLayout, numRows - 1, 2);
-
-	const char *velocityUnits2;
 	if ( velocityUnits->currentIndex() == FPS )
 	{
-		velocityUnits2 = "ft/s";
+		series->velocityUnits = "ft/s";
 	}
 	else
 	{
-		velocityUnits2 = "m/s";
+		series->velocityUnits = "m/s";
 	}
 
-	series->result = new QLabel(QString("0 shots, 0-0 %1").arg(velocityUnits2));
-	seriesGrid->addWidget(series->result, numRows - 1, 3, Qt::AlignVCenter);
-
-	series->enterDataButton = new QPushButton("Enter velocity data");
-	connect(series->enterDataButton, SIGNAL(clicked(bool)), this, SLOT(enterDataClicked(bool)));
-	series->enterDataButton->setFixedSize(series->enterDataButton->minimumSizeHint());
-	seriesGrid->addWidget(series->enterDataButton, numRows - 1, 4, Qt::AlignLeft);
+	seriesModel->appendSeries(arena.adopt(series));
+	addSeriesButtons(seriesData.size() - 1);
+}
 
-	series->deleteButton = new QPushButton();
-	connect(series->deleteButton, SIGNAL(clicked(bool)), this, SLOT(deleteClicked(bool)));
-	series->deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
-	series->deleteButton->setFixedSize(series->deleteButton->minimumSizeHint());
-	seriesGrid->addWidget(series->deleteButton, numRows - 1, 5, Qt::AlignLeft);
+/*
+ * Manually entered series have a button to enter their velocities and another to delete them, at the end of their row
+ */
+void PowderTest::addSeriesButtons ( int row )
+{
+	ChronoSeries *series = seriesData.at(row);
+
+	QPushButton *enterDataButton = new QPushButton("Enter velocity data");
+	connect(enterDataButton, &QPushButton::clicked, this, [=] ( void ) { enterDataClicked(series); });
+	enterDataButton->setFixedSize(enterDataButton->minimumSizeHint());
+	seriesView->setIndexWidget(seriesModel->index(row, SeriesModel::ENTER_DATA_COLUMN), enterDataButton);
+
+	QPushButton *deleteButton = new QPushButton();
+	connect(deleteButton, &QPushButton::clicked, this, [=] ( void ) { deleteClicked(series); });
+	deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
+	deleteButton->setFixedSize(deleteButton->minimumSizeHint());
+	seriesView->setIndexWidget(seriesModel->index(row, SeriesModel::DELETE_COLUMN), deleteButton);
+
+	// Every row is the same height, so make it tall enough for the buttons
+	QHeaderView *rows = seriesView->verticalHeader();
+	rows->setDefaultSectionSize(qMax(rows->defaultSectionSize(), enterDataButton->height()));
+}
 
-	seriesData.append(series);
+void PowderTest::updateSeriesButtons ( int first, int last )
+{
+	// Only manually entered series have buttons
+	if ( (seriesView == NULL) || (seriesModel->columnCount() <= SeriesModel::DELETE_COLUMN) )
+	{
+		return;
+	}
 
-	// Add an empty stretch row at the end for proper spacing
-	seriesGrid->setRowStretch(numRows, 1);
+	for ( int i = first; i <= last; i++ )
+	{
+		for ( int column = SeriesModel::ENTER_DATA_COLUMN; column <= SeriesModel::DELETE_COLUMN; column++ )
+		{
+			QWidget *button = seriesView->indexWidget(seriesModel->index(i, column));
+			if ( button )
+			{
+				button->setEnabled(seriesData.at(i)->enabled);
+			}
+		}
+	}
 }
 
 EnterVelocitiesDialog::EnterVelocitiesDialog ( ChronoSeries *series, QDialog *parent )
@@ -550,23 +880,9 @@ QList<double> EnterVelocitiesDialog::getValues ( void )
 	return values;
 }
 
-void PowderTest::enterDataClicked ( bool state )
+void PowderTest::enterDataClicked ( ChronoSeries *series )
 {
-	QPushButton *enterDataButton = qobject_cast<QPushButton *>(sender());
-
-	qDebug() << "enterDataClicked state =" << state;
-
-	// We have the button object, now locate its ChronoSeries object
-	ChronoSeries *series = NULL;
-	for ( int i = 0; i < seriesData.size(); i++ )
-	{
-		ChronoSeries *curSeries = seriesData.at(i);
-		if ( enterDataButton == curSeries->enterDataButton )
-		{
-			series = curSeries;
-			break;
-		}
-	}
+	qDebug() << "enterDataClicked series =" << series->seriesNum;
 
 	EnterVelocitiesDialog *dialog = new EnterVelocitiesDialog(series);
 	int result = dialog->exec();
@@ -582,114 +898,108 @@ void PowderTest::enterDataClicked ( bool state )
 		if ( values.size() == 0 )
 		{
 			qDebug() << "No valid velocities were provided, bailing...";
+			delete dialog;
 			return;
 		}
 
-		// We have the button object, now locate its row in the grid
-		for ( int i = 0; i < seriesData.size(); i++ )
-		{
-			ChronoSeries *series = seriesData.at(i);
-			if ( enterDataButton == series->enterDataButton )
-			{
-				qDebug() << "Setting velocities for Series" << series->seriesNum;
-
-				series->muzzleVelocities = values;
-
-				const char *velocityUnits2;
-				if ( velocityUnits->currentIndex() == FPS )
-				{
-					velocityUnits2 = "ft/s";
-				}
-				else
-				{
-					velocityUnits2 = "m/s";
-				}
+		qDebug() << "Setting velocities for Series" << series->seriesNum;
 
-				// Update the series result
-				int totalShots = series->muzzleVelocities.size();
-				double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-				double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-				series->result->setText(QString("%1 shot%2, %3-%4 %5").arg(totalShots).arg(totalShots > 1 ? "s" : "").arg(velocityMin).arg(velocityMax).arg(velocityUnits2));
+		series->muzzleVelocities = values;
 
-				break;
-			}
-		}
+		// Update the series result
+		seriesModel->refreshSeries(series);
 	}
 	else
 	{
 		qDebug() << "User cancelled dialog";
 	}
+
+	delete dialog;
 }
 
-void PowderTest::deleteClicked ( bool state )
+void PowderTest::deleteClicked ( ChronoSeries *series )
 {
-	QPushButton *deleteButton = qobject_cast<QPushButton *>(sender());
+	int row = seriesData.indexOf(series);
 
-	qDebug() << "deleteClicked state =" << state;
+	qDebug() << "Series" << series->seriesNum << "(" << series->name << ") was deleted";
 
-	int newSeriesNum = -1;
+	series->deleted = true;
+	seriesView->setRowHidden(row, true);
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seriesData.size(); i++ )
+	// Renumber the series after it
+	int newSeriesNum = series->seriesNum;
+	for ( int i = row + 1; i < seriesData.size(); i++ )
 	{
 		ChronoSeries *series = seriesData.at(i);
-		if ( deleteButton == series->deleteButton )
-		{
-			qDebug() << "Series" << series->seriesNum << "(" << series->name->text() << ") was deleted";
-
-			series->deleted = true;
-
-			series->enabled->hide();
-			series->name->hide();
-			series->chargeWeight->hide();
-			series->result->hide();
-			series->enterDataButton->hide();
-			series->deleteButton->hide();
-
-			newSeriesNum = series->seriesNum;
-		}
-		else if ( (! series->deleted) && newSeriesNum > 0 )
+		if ( ! series->deleted )
 		{
 			qDebug() << "Updating Series" << series->seriesNum << "to Series" << newSeriesNum;
 
 			series->seriesNum = newSeriesNum;
-			series->name->setText(QString("Series %1").arg(newSeriesNum));
+			series->name = QString("Series %1").arg(newSeriesNum);
 
 			newSeriesNum++;
 		}
 	}
+
+	seriesModel->refresh();
 }
 
 void PowderTest::manualDataEntry ( bool state )
 {
 	qDebug() << "manualDataEntry state =" << state;
 
-	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
-	stackedWidget->removeWidget(scrollWidget);
+	showManualEntry();
 
-	QVBoxLayout *scrollLayout = new QVBoxLayout();
+	/* Create initial row */
 
-	// Wrap grid in a widget to make the grid scrollable
-	QWidget *scrollAreaWidget = new QWidget();
+	ChronoSeries *series = new ChronoSeries();
 
-	seriesGrid = new QGridLayout(scrollAreaWidget);
-	seriesGrid->setColumnStretch(0, 0);
-	seriesGrid->setColumnStretch(1, 1);
-	seriesGrid->setColumnStretch(2, 2);
-	seriesGrid->setColumnStretch(3, 3);
-	seriesGrid->setColumnStretch(4, 3);
-	seriesGrid->setColumnStretch(5, 3);
-	seriesGrid->setHorizontalSpacing(25);
+	series->deleted = false;
+	series->enabled = true;
+	series->seriesNum = 1;
+	series->name = "Series 1";
+	series->chargeWeight = 0;
 
-	scrollArea = new QScrollArea();
-	scrollArea->setWidget(scrollAreaWidget);
-	scrollArea->setWidgetResizable(true);
+	if ( velocityUnits->currentIndex() == FPS )
+	{
+		series->velocityUnits = "ft/s";
+	}
+	else
+	{
+		series->velocityUnits = "m/s";
+	}
 
-	scrollLayout->addWidget(scrollArea);
+	seriesModel->appendSeries(arena.adopt(series));
+	addSeriesButtons(seriesData.size() - 1);
+}
 
-	/* Create utilities toolbar under scroll area */
+/*
+ * Shows the manual data entry table for whatever is in seriesData, without any rows' buttons
+ */
+void PowderTest::showManualEntry ( void )
+{
+	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
+	stackedWidget->removeWidget(scrollWidget);
 
-	addNewButton = new QPushButton("Add new series");
+	seriesModel->reload(true);
+
+	importDevice = DEVICE_MANUAL;
+
+	QVBoxLayout *scrollLayout = new QVBoxLayout();
+
+	QCheckBox *headerCheckBox = new QCheckBox();
+	headerCheckBox->setChecked(true);
+	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
+
+	seriesView = createSeriesView(seriesModel, headerCheckBox);
+	seriesView->setItemDelegateForColumn(SeriesModel::WEIGHT_COLUMN, new SpinBoxDelegate(2, 0.1, 1000000, seriesView));
+
+	scrollLayout->addWidget(seriesView);
+
+	/* Create utilities toolbar under scroll area */
+
+	addNewButton = new QPushButton("Add new series");
 	addNewButton->setStyleSheet("font-weight: bold");
 	connect(addNewButton, SIGNAL(clicked(bool)), this, SLOT(addNewClicked(bool)));
 	addNewButton->setMinimumWidth(225);
@@ -718,139 +1028,608 @@ void PowderTest::manualDataEntry ( bool state )
 	stackedWidget->addWidget(scrollWidget);
 	stackedWidget->setCurrentWidget(scrollWidget);
 
-	QCheckBox *headerCheckBox = new QCheckBox();
-	headerCheckBox->setChecked(true);
-	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
-	seriesGrid->addWidget(headerCheckBox, 0, 0);
-
-	QLabel *headerName = new QLabel("Series Name");
-	seriesGrid->addWidget(headerName, 0, 1, Qt::AlignVCenter);
-	QLabel *headerChargeWeight = new QLabel("Charge Weight");
-	seriesGrid->addWidget(headerChargeWeight, 0, 2, Qt::AlignVCenter);
-	headerResult = new QLabel("Series Result");
-	seriesGrid->addWidget(headerResult, 0, 3, Qt::AlignVCenter);
-	QLabel *headerEnterData = new QLabel("");
-	seriesGrid->addWidget(headerEnterData, 0, 4, Qt::AlignVCenter);
-	QLabel *headerDelete = new QLabel("");
-	seriesGrid->addWidget(headerDelete, 0, 5, Qt::AlignVCenter);
-
 	// Only connect this signal for manual data entry
 	connect(velocityUnits, SIGNAL(activated(int)), this, SLOT(velocityUnitsChanged(int)));
+}
 
-	/* Create initial row */
+void PowderTest::showGraph ( bool state )
+{
+	qDebug() << "showGraph state =" << state;
 
-	ChronoSeries *series = new ChronoSeries();
+	renderGraph(true);
+}
 
-	series->deleted = false;
+void PowderTest::saveGraph ( bool state )
+{
+	qDebug() << "showGraph state =" << state;
 
-	series->enabled = new QCheckBox();
-	series->enabled->setChecked(true);
+	renderGraph(false);
+}
 
-	connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesManualCheckBoxChanged(int)));
-	seriesGrid->addWidget(series->enabled, 1, 0);
+void PowderTest::batchExportClicked ( bool state )
+{
+	qDebug() << "batchExportClicked state =" << state;
 
-	series->seriesNum = 1;
+	BatchExportDialog *dialog = new BatchExportDialog(this);
+	int result = dialog->exec();
 
-	series->name = new QLabel("Series 1");
-	seriesGrid->addWidget(series->name, 1, 1);
+	qDebug() << "dialog result:" << result;
 
-	series->chargeWeight = new QDoubleSpinBox();
-	series->chargeWeight->setDecimals(2);
-	series->chargeWeight->setSingleStep(0.1);
-	series->chargeWeight->setMaximum(1000000);
-	series->chargeWeight->setMinimumWidth(100);
-	series->chargeWeight->setMaximumWidth(100);
+	if ( result )
+	{
+		qDebug() << "User OK'd dialog";
 
-	QHBoxLayout *chargeWeightLayout = new QHBoxLayout();
-	chargeWeightLayout->addWidget(series->chargeWeight);
-	chargeWeightLayout->addStretch(0);
-	seriesGrid->addLayout(chargeWeightLayout, 1, 2);
+		// Cleans itself up once every job is done
+		BatchExport *batch = new BatchExport(this, dialog->getValues());
+		batch->start();
+	}
+	else
+	{
+		qDebug() << "User cancelled dialog";
+	}
 
-	const char *velocityUnits2;
-	if ( velocityUnits->currentIndex() == FPS )
+	delete dialog;
+}
+
+static bool ChargeWeightComparator ( ChronoSeries *one, ChronoSeries *two )
+{
+	return (one->chargeWeight < two->chargeWeight);
+}
+
+/*
+ * The graph is built once and reused for every preview and save. renderGraph() only updates the data, text, and visibility of what's created here.
+ */
+void PowderTest::setupPlot ( void )
+{
+	customPlot = new QCustomPlot();
+	// Export size until the first render works it out from the graph's contents, see LabelLayout::canvasSize()
+	canvasSize = QSize(1440, 625);
+	customPlot->setGeometry(40, 40, canvasSize.width(), canvasSize.height());
+	customPlot->setAntialiasedElements(QCP::aeAll);
+	customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+
+	/*
+	 * The data, trend line, and annotations each get their own paint buffer, so toggling the trend line or an annotation only
+	 * repaints that layer instead of the whole plot.
+	 */
+	customPlot->addLayer("scatter", customPlot->layer("main"), QCustomPlot::limAbove);
+	customPlot->addLayer("trend", customPlot->layer("scatter"), QCustomPlot::limAbove);
+	customPlot->addLayer("annotations", customPlot->layer("overlay"), QCustomPlot::limAbove);
+	customPlot->layer("scatter")->setMode(QCPLayer::lmBuffered);
+	customPlot->layer("trend")->setMode(QCPLayer::lmBuffered);
+	customPlot->layer("annotations")->setMode(QCPLayer::lmBuffered);
+
+	/* Average line */
+
+	QPen avgLinePen(Qt::SolidLine);
+	QColor avgLineColor("#1c57eb");
+	avgLineColor.setAlphaF(0.65);
+	avgLinePen.setColor(avgLineColor);
+	avgLinePen.setWidthF(1.5);
+
+	averageLine = customPlot->addGraph();
+	averageLine->setScatterStyle(QCPScatterStyle::ssNone);
+	averageLine->setPen(avgLinePen);
+	averageLine->setLayer("scatter");
+
+	/* Scatter plot */
+
+	scatterPlot = customPlot->addGraph();
+	scatterPlot->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, QColor("#0536b0"), 6.0));
+	scatterPlot->setLineStyle(QCPGraph::lsNone);
+	scatterPlot->setLayer("scatter");
+
+	// Scatter plots switch to violins past DENSITY_THRESHOLD shots, which updateDensity() creates on demand
+	densityMode = false;
+
+	/* SD error bars, only shown for line + SD bar charts */
+
+	errorBars = new QCPErrorBars(customPlot->xAxis, customPlot->yAxis);
+	errorBars->setDataPlottable(averageLine);
+	errorBars->setVisible(false);
+	errorBars->setLayer("scatter");
+
+	/* Trend line */
+
+	trendLine = customPlot->addGraph();
+	trendLine->setScatterStyle(QCPScatterStyle::ssNone);
+	trendLine->setVisible(false);
+	trendLine->setLayer("trend");
+
+	/* Title and subtitle */
+
+	plotTitle = new QCPTextElement(customPlot);
+	plotTitle->setFont(QFont("DejaVu Sans", scaleFontSize(24)));
+	plotTitle->setTextColor(QColor("#4d4d4d"));
+	customPlot->plotLayout()->insertRow(0);
+	customPlot->plotLayout()->addElement(0, 0, plotTitle);
+
+	plotSubtitle = new QCPTextElement(customPlot);
+	plotSubtitle->setFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	plotSubtitle->setTextColor(QColor("#4d4d4d"));
+	customPlot->plotLayout()->insertRow(1);
+	customPlot->plotLayout()->addElement(1, 0, plotSubtitle);
+
+	/* Axes */
+
+	QPen gridPen(Qt::SolidLine);
+	gridPen.setColor("#d9d9d9");
+
+	QPen axisBasePen(Qt::SolidLine);
+	axisBasePen.setColor("#d9d9d9");
+	axisBasePen.setWidth(2);
+
+	customPlot->xAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	customPlot->xAxis->setTickLabelColor(QColor("#4d4d4d"));
+	customPlot->xAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	customPlot->xAxis->setLabelColor(QColor("#4d4d4d"));
+	customPlot->xAxis->grid()->setZeroLinePen(Qt::NoPen);
+	customPlot->xAxis->grid()->setPen(gridPen);
+	customPlot->xAxis->setBasePen(axisBasePen);
+	customPlot->xAxis->setTickPen(Qt::NoPen);
+	customPlot->xAxis->setSubTickPen(Qt::NoPen);
+	customPlot->xAxis->setLabelPadding(13);
+	customPlot->xAxis->setPadding(20);
+
+	customPlot->xAxis2->setBasePen(axisBasePen);
+	customPlot->xAxis2->setTickPen(Qt::NoPen);
+	customPlot->xAxis2->setSubTickPen(Qt::NoPen);
+	customPlot->xAxis2->setPadding(20);
+
+	customPlot->yAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	customPlot->yAxis->setTickLabelColor(QColor("#4d4d4d"));
+	customPlot->yAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	customPlot->yAxis->setLabelColor(QColor("#4d4d4d"));
+	customPlot->yAxis->grid()->setZeroLinePen(Qt::NoPen);
+	customPlot->yAxis->grid()->setPen(gridPen);
+	customPlot->yAxis->setBasePen(axisBasePen);
+	customPlot->yAxis->setTickPen(Qt::NoPen);
+	customPlot->yAxis->setSubTickPen(Qt::NoPen);
+	customPlot->yAxis->setLabelPadding(20);
+	customPlot->yAxis->setPadding(20);
+
+	customPlot->yAxis2->setBasePen(axisBasePen);
+	customPlot->yAxis2->setTickPen(Qt::NoPen);
+	customPlot->yAxis2->setSubTickPen(Qt::NoPen);
+	customPlot->yAxis2->setPadding(20);
+
+	// seems to strike a good balance of tick frequency and readability
+	customPlot->yAxis->ticker()->setTickCount(6);
+
+	// The preview window takes ownership of the plot and is only hidden when closed
+	graphPreview = new GraphPreview(customPlot);
+}
+
+/*
+ * Annotations are pooled across renders. Returns the pool's item at index, creating it if the pool isn't that large yet.
+ */
+QCPItemText *PowderTest::annotationItem ( QList<QCPItemText *> &pool, QList<QCPItemTracer *> &anchors, int index )
+{
+	if ( index < pool.size() )
 	{
-		velocityUnits2 = "ft/s";
+		pool.at(index)->setVisible(true);
+		return pool.at(index);
+	}
+
+	// Annotations sit a fixed number of pixels away from an invisible anchor in plot coordinates, so they follow the plot when it's resized
+	QCPItemTracer *anchor = new QCPItemTracer(customPlot);
+	anchor->setStyle(QCPItemTracer::tsNone);
+	anchor->setLayer("annotations");
+	anchors.append(anchor);
+
+	QCPItemText *annotation = new QCPItemText(customPlot);
+	annotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	annotation->setColor(QColor("#4d4d4d"));
+	annotation->position->setType(QCPItemPosition::ptAbsolute);
+	annotation->position->setParentAnchor(anchor->position);
+	annotation->setTextAlignment(Qt::AlignCenter);
+	annotation->setBrush(QBrush(Qt::white));
+	annotation->setClipToAxisRect(false);
+	annotation->setLayer("annotations");
+
+	pool.append(annotation);
+	return annotation;
+}
+
+/*
+ * Trend line over every shot being graphed. Called on each render, and on its own when the trend line is toggled.
+ */
+void PowderTest::updateTrendLine ( void )
+{
+	if ( trendCheckBox->isChecked() && (! trendXPoints.empty()) )
+	{
+		std::vector<double> res = GetLinearFit(trendXPoints, trendYPoints);
+		qDebug() << "linear fit:" << res[0] << res[1];
+
+		QVector<double> xTrendPoints;
+		QVector<double> yTrendPoints;
+		xTrendPoints.push_back(trendXPoints.first());
+		yTrendPoints.push_back(res[1] + (trendXPoints.first() * res[0]));
+		xTrendPoints.push_back(trendXPoints.last());
+		yTrendPoints.push_back(res[1] + (trendXPoints.last() * res[0]));
+
+		qDebug() << "xTrendPoints:" << xTrendPoints;
+		qDebug() << "yTrendPoints:" << yTrendPoints;
+
+		Qt::PenStyle lineType;
+		if ( trendLineType->currentIndex() == SOLID_LINE )
+		{
+			lineType = Qt::SolidLine;
+		}
+		else
+		{
+			lineType = Qt::DashLine;
+		}
+
+		QPen trendLinePen(lineType);
+		QColor trendLineColor(Qt::red);
+		trendLineColor.setAlphaF(0.65);
+		trendLinePen.setColor(trendLineColor);
+		trendLinePen.setWidthF(1.5);
+
+		trendLine->setData(xTrendPoints, yTrendPoints);
+		trendLine->setPen(trendLinePen);
+		trendLine->setVisible(true);
 	}
 	else
 	{
-		velocityUnits2 = "m/s";
+		trendLine->data()->clear();
+		trendLine->setVisible(false);
 	}
+}
+
+/*
+ * One filled violin per string in place of the scatter plot's points. Drawing a few dozen vertices per string keeps rendering
+ * and vector export fast no matter how many shots are merged, and shows where shots bunch up instead of overplotting them.
+ */
+void PowderTest::updateDensity ( void )
+{
+	int numCurves = 0;
+
+	if ( densityMode )
+	{
+		// Violins reach 40% of the way to the closest neighboring string on either side
+		double halfWidth = 0.4;
+		if ( xAxisSpacing->currentIndex() == PROPORTIONAL )
+		{
+			double minGap = 0;
+			for ( int i = 1; i < graphedX.size(); i++ )
+			{
+				double gap = graphedX.at(i) - graphedX.at(i - 1);
+				if ( (gap > 0) && ((minGap == 0) || (gap < minGap)) )
+				{
+					minGap = gap;
+				}
+			}
+			halfWidth *= minGap;
+		}
+
+		QVector<QList<double> > strings;
+		for ( int i = 0; i < graphedSeries.size(); i++ )
+		{
+			strings.append(graphedSeries.at(i)->muzzleVelocities);
+		}
 
-	series->result = new QLabel(QString("0 shots, 0-0 %1").arg(velocityUnits2));
-	seriesGrid->addWidget(series->result, 1, 3, Qt::AlignVCenter);
+		QVector<Density::Profile> profiles = Density::calculate(strings);
 
-	series->enterDataButton = new QPushButton("Enter velocity data");
-	connect(series->enterDataButton, SIGNAL(clicked(bool)), this, SLOT(enterDataClicked(bool)));
-	series->enterDataButton->setFixedSize(series->enterDataButton->minimumSizeHint());
-	seriesGrid->addWidget(series->enterDataButton, 1, 4, Qt::AlignLeft);
+		for ( int i = 0; i < profiles.size(); i++ )
+		{
+			QCPCurve *curve;
+			if ( i < densityCurves.size() )
+			{
+				curve = densityCurves.at(i);
+			}
+			else
+			{
+				curve = new QCPCurve(customPlot->xAxis, customPlot->yAxis);
+				QColor fillColor("#0536b0");
+				fillColor.setAlphaF(0.35);
+				QPen curvePen("#0536b0");
+				curvePen.setWidthF(1.3);
+				curve->setPen(curvePen);
+				curve->setBrush(fillColor);
+				curve->setLayer("scatter");
+				densityCurves.append(curve);
+			}
 
-	series->deleteButton = new QPushButton();
-	connect(series->deleteButton, SIGNAL(clicked(bool)), this, SLOT(deleteClicked(bool)));
-	series->deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
-	series->deleteButton->setFixedSize(series->deleteButton->minimumSizeHint());
-	seriesGrid->addWidget(series->deleteButton, 1, 5, Qt::AlignLeft);
+			QVector<QPair<double, double> > outline = Density::outline(profiles.at(i), halfWidth);
+			QVector<double> keys;
+			QVector<double> values;
+			for ( int j = 0; j < outline.size(); j++ )
+			{
+				keys.push_back(graphedX.at(i) + outline.at(j).first);
+				values.push_back(outline.at(j).second);
+			}
 
-	seriesGrid->setRowMinimumHeight(0, series->chargeWeight->sizeHint().height());
+			curve->setData(keys, values);
+			curve->setVisible(true);
+			curve->rescaleAxes(i > 0);
+		}
 
-	seriesData.append(series);
+		numCurves = profiles.size();
+	}
 
-	// Add an empty stretch row at the end for proper spacing
-	seriesGrid->setRowStretch(seriesGrid->rowCount(), 1);
+	// Hide pooled curves left over from a previous render with more strings
+	for ( int i = numCurves; i < densityCurves.size(); i++ )
+	{
+		densityCurves.at(i)->data()->clear();
+		densityCurves.at(i)->setVisible(false);
+	}
 }
 
-void PowderTest::showGraph ( bool state )
+/*
+ * Per-series bounding boxes and text annotations, anchored to the series' points in plot coordinates. Called on each render,
+ * and on its own when an annotation is toggled.
+ */
+void PowderTest::updateAnnotations ( void )
 {
-	qDebug() << "showGraph state =" << state;
+	bool prevMeanSet = false;
+	double prevMean = 0;
 
-	renderGraph(true);
+	for ( int i = 0; i < graphedSeries.size(); i++ )
+	{
+		ChronoSeries *series = graphedSeries.at(i);
+
+		// Collect annotation contents. Only display ES and SD if there are 2+ shots in the series.
+
+		int totalShots = series->muzzleVelocities.size();
+		double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
+		double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
+		double mean = std::accumulate(series->muzzleVelocities.begin(), series->muzzleVelocities.end(), 0.0) / static_cast<double>(totalShots);
+		int es = velocityMax - velocityMin;
+		double stdev = sampleStdev(series->muzzleVelocities);
+		QStringList aboveAnnotationText;
+		QStringList belowAnnotationText;
+
+		if ( esCheckBox->isChecked() && (series->muzzleVelocities.size() > 1) )
+		{
+			QString annotation = QString("ES: %1").arg(es);
+			if ( esLocation->currentIndex() == ABOVE_STRING )
+			{
+				aboveAnnotationText.append(annotation);
+			}
+			else
+			{
+				belowAnnotationText.append(annotation);
+			}
+		}
+
+		if ( sdCheckBox->isChecked() && (series->muzzleVelocities.size() > 1) )
+		{
+			QString annotation = QString("SD: %1").arg(stdev, 0, 'f', 1);
+			if ( sdLocation->currentIndex() == ABOVE_STRING )
+			{
+				aboveAnnotationText.append(annotation);
+			}
+			else
+			{
+				belowAnnotationText.append(annotation);
+			}
+		}
+
+		if ( avgCheckBox->isChecked() )
+		{
+			QString annotation;
+			if ( series->muzzleVelocities.size() > 1 )
+			{
+				annotation = QString("x\u0305: %1").arg(mean, 0, 'f', 1);
+			}
+			else
+			{
+				annotation = QString::number(mean);
+			}
+
+			if ( avgLocation->currentIndex() == ABOVE_STRING )
+			{
+				aboveAnnotationText.append(annotation);
+			}
+			else
+			{
+				belowAnnotationText.append(annotation);
+			}
+		}
+
+		if ( vdCheckBox->isChecked() )
+		{
+			if ( prevMeanSet )
+			{
+				QString sign;
+				int delta = round(mean - prevMean);
+				if ( delta < 0 )
+				{
+					sign = QString("-");
+				}
+				else
+				{
+					sign = QString("+");
+				}
+
+				QString annotation = QString("%1%2").arg(sign).arg(abs(delta));
+				if ( vdLocation->currentIndex() == ABOVE_STRING )
+				{
+					aboveAnnotationText.append(annotation);
+				}
+				else
+				{
+					belowAnnotationText.append(annotation);
+				}
+			}
+		}
+
+		// Anchor points. We need the min/max points for scatter plots and stdev for line + SD bar charts.
+
+		double yCoordBelow;
+		double yCoordAbove;
+
+		if ( graphType->currentIndex() == SCATTER )
+		{
+			yCoordBelow = velocityMin;
+			yCoordAbove = velocityMax;
+		}
+		else
+		{
+			if ( qIsNaN(stdev) )
+			{
+				yCoordBelow = mean;
+				yCoordAbove = mean;
+			}
+			else
+			{
+				yCoordBelow = mean - stdev;
+				yCoordAbove = mean + stdev;
+			}
+		}
+
+		QCPItemText *belowAnnotation = annotationItem(belowAnnotations, belowAnchors, i);
+		belowAnnotation->setText(belowAnnotationText.join('\n'));
+		belowAnchors.at(i)->position->setCoords(graphedX.at(i), yCoordBelow);
+
+		QCPItemText *aboveAnnotation = annotationItem(aboveAnnotations, aboveAnchors, i);
+		aboveAnnotation->setText(aboveAnnotationText.join('\n'));
+		aboveAnchors.at(i)->position->setCoords(graphedX.at(i), yCoordAbove);
+
+		// Scatter plots also box in each string, which shares the annotations' anchors at the min/max velocity. Violins already
+		// span exactly that range.
+		if ( (graphType->currentIndex() == SCATTER) && (! densityMode) )
+		{
+			QCPItemRect *rect;
+			if ( i < rangeRects.size() )
+			{
+				rect = rangeRects.at(i);
+				rect->setVisible(true);
+			}
+			else
+			{
+				rect = new QCPItemRect(customPlot);
+				QPen rectPen("#0536b0");
+				rectPen.setWidthF(1.3);
+				rect->setPen(rectPen);
+				rect->setLayer("annotations");
+				rect->topLeft->setType(QCPItemPosition::ptAbsolute);
+				rect->bottomRight->setType(QCPItemPosition::ptAbsolute);
+				rangeRects.append(rect);
+			}
+			rect->topLeft->setParentAnchor(aboveAnchors.at(i)->position);
+			rect->topLeft->setCoords(-7, -7);
+			rect->bottomRight->setParentAnchor(belowAnchors.at(i)->position);
+			rect->bottomRight->setCoords(7, 7);
+		}
+
+		prevMean = mean;
+		prevMeanSet = true;
+	}
+
+	// Hide pooled items left over from a previous render with more series
+	for ( int i = ((graphType->currentIndex() == SCATTER) && (! densityMode)) ? graphedSeries.size() : 0; i < rangeRects.size(); i++ )
+	{
+		rangeRects.at(i)->setVisible(false);
+	}
+	for ( int i = graphedSeries.size(); i < belowAnnotations.size(); i++ )
+	{
+		belowAnnotations.at(i)->setVisible(false);
+	}
+	for ( int i = graphedSeries.size(); i < aboveAnnotations.size(); i++ )
+	{
+		aboveAnnotations.at(i)->setVisible(false);
+	}
+
+	/* Resolve overlaps between every label on the graph */
+
+	QList<QCPItemText *> labels;
+	QVector<int> sides;
+	for ( int i = 0; i < graphedSeries.size(); i++ )
+	{
+		labels.append(aboveAnnotations.at(i));
+		sides.append(LabelLayout::ABOVE);
+		labels.append(belowAnnotations.at(i));
+		sides.append(LabelLayout::BELOW);
+	}
+
+	// Size the canvas to fit, then lay the graph out at that size since labels are placed in pixels
+	canvasSize = LabelLayout::canvasSize(customPlot, labels, sides, 10, 14);
+	QRect viewport = LabelLayout::layoutAt(customPlot, canvasSize);
+
+	// Keep labels off each string's markers, which span the same pixels as its range box
+	QVector<QRectF> markers;
+	for ( int i = 0; i < graphedSeries.size(); i++ )
+	{
+		QPointF abovePixel = aboveAnchors.at(i)->position->pixelPosition();
+		QPointF belowPixel = belowAnchors.at(i)->position->pixelPosition();
+		markers.append(QRectF(QPointF(abovePixel.x() - 7, abovePixel.y() - 7), QPointF(belowPixel.x() + 7, belowPixel.y() + 7)));
+	}
+
+	LabelLayout::arrange(labels, sides, markers, 10);
+
+	// Lay the graph back out for the on-screen preview
+	LabelLayout::layoutAt(customPlot, viewport.size());
 }
 
-void PowderTest::saveGraph ( bool state )
+/*
+ * Repaint only the annotation or trend line layer of an open preview after its option was toggled
+ */
+void PowderTest::replotAnnotations ( void )
 {
-	qDebug() << "showGraph state =" << state;
-
-	renderGraph(false);
+	if ( graphPreview->isVisible() )
+	{
+		updateAnnotations();
+		customPlot->layer("annotations")->replot();
+	}
 }
 
-static bool ChargeWeightComparator ( ChronoSeries *one, ChronoSeries *two )
+void PowderTest::replotTrendLine ( void )
 {
-	return (one->chargeWeight->value() < two->chargeWeight->value());
+	if ( graphPreview->isVisible() )
+	{
+		updateTrendLine();
+		customPlot->layer("trend")->replot();
+	}
 }
 
-void PowderTest::renderGraph ( bool displayGraphPreview )
+/*
+ * Errors found while building the graph. Interactive sessions get a dialog, headless runs collect them for the caller to report.
+ */
+void PowderTest::reportError ( const QString &text )
 {
-	qDebug() << "renderGraph displayGraphPreview =" << displayGraphPreview;
+	if ( headless )
+	{
+		errors.append(text);
+		return;
+	}
+
+	QMessageBox msg;
+	msg.setIcon(QMessageBox::Critical);
+	msg.setText(text);
+	msg.setWindowTitle("Error");
+	msg.exec();
+}
 
+/*
+ * Validates the series and updates the persistent plot in place. Returns false if there's nothing to graph.
+ */
+bool PowderTest::populatePlot ( void )
+{
 	/* Validate series before continuing */
 
 	int numEnabled = 0;
 	for ( int i = 0; i < seriesData.size(); i++ )
 	{
 		ChronoSeries *series = seriesData.at(i);
-		if ( (! series->deleted) && series->enabled->isChecked() )
+		if ( (! series->deleted) && series->enabled )
 		{
 			numEnabled += 1;
-			if ( series->chargeWeight->value() == 0 )
+			if ( series->chargeWeight == 0 )
 			{
-				qDebug() << series->name->text() << "is missing charge weight, bailing";
-
-				QMessageBox *msg = new QMessageBox();
-				msg->setIcon(QMessageBox::Critical);
-				msg->setText(QString("'%1' is missing charge weight!").arg(series->name->text()));
-				msg->setWindowTitle("Error");
-				msg->exec();
-				return;
+				qDebug() << series->name << "is missing charge weight, bailing";
+
+				reportError(QString("'%1' is missing charge weight!").arg(series->name));
+				return false;
 			}
 			else if ( series->muzzleVelocities.size() == 0 )
 			{
-				qDebug() << series->name->text() << "is missing velocities, bailing";
-
-				QMessageBox *msg = new QMessageBox();
-				msg->setIcon(QMessageBox::Critical);
-				msg->setText(QString("'%1' is missing velocities!").arg(series->name->text()));
-				msg->setWindowTitle("Error");
-				msg->exec();
-				return;
+				qDebug() << series->name << "is missing velocities, bailing";
+
+				reportError(QString("'%1' is missing velocities!").arg(series->name));
+				return false;
 			}
 		}
 	}
@@ -859,19 +1638,10 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 	{
 		qDebug() << "Only" << numEnabled << "series enabled, bailing";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText("At least two series are required to graph!");
-		msg->setWindowTitle("Error");
-		msg->exec();
-		return;
+		reportError("At least two series are required to graph!");
+		return false;
 	}
 
-	QCustomPlot *customPlot = new QCustomPlot();
-	// TODO: dynamically calculate width based on graph contents
-	customPlot->setGeometry(40, 40, 1440, 625);
-	customPlot->setAntialiasedElements(QCP::aeAll);
-
 	/* Make a copy of the subset of data actually being graphed */
 
 	QList<ChronoSeries *> seriesToGraph;
@@ -879,7 +1649,7 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 	{
 		ChronoSeries *series = seriesData.at(i);
 
-		if ( (! series->deleted) && series->enabled->isChecked() )
+		if ( (! series->deleted) && series->enabled )
 		{
 			seriesToGraph.append(series);
 		}
@@ -902,10 +1672,19 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 		{
 			ChronoSeries *series = seriesToGraph.at(i);
 
-			double chargeWeight = series->chargeWeight->value();
+			double chargeWeight = series->chargeWeight;
 
 			if ( chargeWeight == lastChargeWeight )
 			{
+				if ( headless )
+				{
+					qDebug() << "Duplicate charge weight detected" << chargeWeight << ", switching to constant x-axis spacing";
+
+					warnings.append(QString("Duplicate charge weight %1, switched to constant x-axis spacing").arg(chargeWeight));
+					xAxisSpacing->setCurrentIndex(CONSTANT);
+					break;
+				}
+
 				qDebug() << "Duplicate charge weight detected" << chargeWeight << ", prompting user to switch to constant x-axis spacing";
 
 				QMessageBox::StandardButton reply;
@@ -921,7 +1700,7 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 				else
 				{
 					qDebug() << "User cancel, bailing out";
-					return;
+					return false;
 				}
 			}
 
@@ -933,6 +1712,24 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 		qDebug() << "Constant x-axis spacing selected, skipping duplicate check";
 	}
 
+	/* Very large scatter plots switch to drawing each string's distribution instead of every shot */
+
+	densityMode = false;
+	if ( graphType->currentIndex() == SCATTER )
+	{
+		int numShots = 0;
+		for ( int i = 0; i < seriesToGraph.size(); i++ )
+		{
+			numShots += seriesToGraph.at(i)->muzzleVelocities.size();
+		}
+
+		if ( numShots > DENSITY_THRESHOLD )
+		{
+			qDebug() << numShots << "shots to graph, drawing density instead of individual points";
+			densityMode = true;
+		}
+	}
+
 	/* Collect the data to graph */
 
 	QSharedPointer<QCPAxisTickerText> textTicker(new QCPAxisTickerText);
@@ -949,7 +1746,7 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 	{
 		ChronoSeries *series = seriesToGraph.at(i);
 
-		double chargeWeight = series->chargeWeight->value();
+		double chargeWeight = series->chargeWeight;
 
 		qDebug() << QString("Series %1 (%2 gr)").arg(series->seriesNum).arg(chargeWeight);
 		qDebug() << series->muzzleVelocities;
@@ -983,17 +1780,15 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 		{
 			for ( int j = 0; j < totalShots; j++ )
 			{
-				if ( xAxisSpacing->currentIndex() == CONSTANT )
-				{
-					xPoints.push_back(i);
-					allXPoints.push_back(i);
-				}
-				else
+				double x = (xAxisSpacing->currentIndex() == CONSTANT) ? i : chargeWeight;
+
+				// In density mode the shots are left out of the scatter plot altogether
+				if ( ! densityMode )
 				{
-					xPoints.push_back(chargeWeight);
-					allXPoints.push_back(chargeWeight);
+					xPoints.push_back(x);
+					yPoints.push_back(series->muzzleVelocities.at(j));
 				}
-				yPoints.push_back(series->muzzleVelocities.at(j));
+				allXPoints.push_back(x);
 				allYPoints.push_back(series->muzzleVelocities.at(j));
 			}
 		}
@@ -1026,86 +1821,52 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 
 		if ( xAxisSpacing->currentIndex() == CONSTANT )
 		{
-			textTicker->addTick(i, QString::number(series->chargeWeight->value()));
+			textTicker->addTick(i, QString::number(series->chargeWeight));
 		}
 		else
 		{
-			textTicker->addTick(chargeWeight, QString::number(series->chargeWeight->value()));
+			textTicker->addTick(chargeWeight, QString::number(series->chargeWeight));
 		}
 	}
 
-	/* Create average line */
+	// Keep what's being graphed around so annotations and the trend line can be updated on their own
+	graphedSeries = seriesToGraph;
+	graphedX = xAvgPoints;
+	trendXPoints = allXPoints;
+	trendYPoints = allYPoints;
 
-	QPen avgLinePen(Qt::SolidLine);
-	QColor avgLineColor("#1c57eb");
-	avgLineColor.setAlphaF(0.65);
-	avgLinePen.setColor(avgLineColor);
-	avgLinePen.setWidthF(1.5);
+	/* Update average line and scatter plot */
 
-	QCPGraph *averageLine = customPlot->addGraph();
 	averageLine->setData(xAvgPoints, yAvgPoints);
-	averageLine->setScatterStyle(QCPScatterStyle::ssNone);
-	averageLine->setPen(avgLinePen);
 
-	/* Create scatter plot */
-
-	QCPGraph *scatterPlot = customPlot->addGraph();
 	scatterPlot->setData(xPoints, yPoints);
-	scatterPlot->rescaleAxes();
-	scatterPlot->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, QColor("#0536b0"), 6.0));
-	scatterPlot->setLineStyle(QCPGraph::lsNone);
+	updateDensity();
+	if ( ! densityMode )
+	{
+		scatterPlot->rescaleAxes();
+	}
 
 	/* Draw SD error bars if necessary */
 
 	if ( graphType->currentIndex() == LINE_SD )
 	{
-		QCPErrorBars *errorBars = new QCPErrorBars(customPlot->xAxis, customPlot->yAxis);
 		errorBars->setData(yError);
-		errorBars->setDataPlottable(averageLine);
+		errorBars->setVisible(true);
 		errorBars->rescaleAxes();
 
 		// Also disable the x grid lines for readability
 		customPlot->xAxis->grid()->setVisible(false);
 	}
-
-	/* Draw trend line if necessary */
-
-	if ( trendCheckBox->isChecked() )
+	else
 	{
-		std::vector<double> res = GetLinearFit(allXPoints, allYPoints);
-		qDebug() << "linear fit:" << res[0] << res[1];
-
-		QVector<double> xTrendPoints;
-		QVector<double> yTrendPoints;
-		xTrendPoints.push_back(allXPoints.first());
-		yTrendPoints.push_back(res[1] + (allXPoints.first() * res[0]));
-		xTrendPoints.push_back(allXPoints.last());
-		yTrendPoints.push_back(res[1] + (allXPoints.last() * res[0]));
-
-		qDebug() << "xTrendPoints:" << xTrendPoints;
-		qDebug() << "yTrendPoints:" << yTrendPoints;
-
-		Qt::PenStyle lineType;
-		if ( trendLineType->currentIndex() == SOLID_LINE )
-		{
-			lineType = Qt::SolidLine;
-		}
-		else
-		{
-			lineType = Qt::DashLine;
-		}
+		errorBars->data()->clear();
+		errorBars->setVisible(false);
+		customPlot->xAxis->grid()->setVisible(true);
+	}
 
-		QPen trendLinePen(lineType);
-		QColor trendLineColor(Qt::red);
-		trendLineColor.setAlphaF(0.65);
-		trendLinePen.setColor(trendLineColor);
-		trendLinePen.setWidthF(1.5);
+	/* Draw trend line if necessary */
 
-		QCPGraph *trendLine = customPlot->addGraph();
-		trendLine->setData(xTrendPoints, yTrendPoints);
-		trendLine->setScatterStyle(QCPScatterStyle::ssNone);
-		trendLine->setPen(trendLinePen);
-	}
+	updateTrendLine();
 
 	/* Configure rest of the graph */
 
@@ -1129,286 +1890,65 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 		velocityUnits2 = "m/s";
 	}
 
-	QCPTextElement *title = new QCPTextElement(customPlot);
-	title->setText(QString("\n%1").arg(graphTitle->text()));
-	title->setFont(QFont("DejaVu Sans", scaleFontSize(24)));
-	title->setTextColor(QColor("#4d4d4d"));
-	customPlot->plotLayout()->insertRow(0);
-	customPlot->plotLayout()->addElement(0, 0, title);
+	plotTitle->setText(QString("\n%1").arg(graphTitle->text()));
 
-	QCPTextElement *subtitle = new QCPTextElement(customPlot);
 	QStringList subtitleText;
 	subtitleText << rifle->text() << propellant->text() << projectile->text() << brass->text() << primer->text() << weather->text();
-	subtitle->setText(StringListJoin(subtitleText, ", ") + "\n");
-	subtitle->setFont(QFont("DejaVu Sans", scaleFontSize(12)));
-	subtitle->setTextColor(QColor("#4d4d4d"));
-	customPlot->plotLayout()->insertRow(1);
-	customPlot->plotLayout()->addElement(1, 0, subtitle);
-
-	QPen gridPen(Qt::SolidLine);
-	gridPen.setColor("#d9d9d9");
-
-	QPen axisBasePen(Qt::SolidLine);
-	axisBasePen.setColor("#d9d9d9");
-	axisBasePen.setWidth(2);
+	plotSubtitle->setText(StringListJoin(subtitleText, ", ") + "\n");
 
 	customPlot->xAxis->setLabel(QString("Powder charge (%1)").arg(weightUnits2));
 	customPlot->xAxis->scaleRange(1.1);
 	customPlot->xAxis->setTicker(textTicker);
-	customPlot->xAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
-	customPlot->xAxis->setTickLabelColor(QColor("#4d4d4d"));
-	customPlot->xAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
-	customPlot->xAxis->setLabelColor(QColor("#4d4d4d"));
-	customPlot->xAxis->grid()->setZeroLinePen(Qt::NoPen);
-	customPlot->xAxis->grid()->setPen(gridPen);
-	customPlot->xAxis->setBasePen(axisBasePen);
-	customPlot->xAxis->setTickPen(Qt::NoPen);
-	customPlot->xAxis->setSubTickPen(Qt::NoPen);
-	customPlot->xAxis->setLabelPadding(13);
-	customPlot->xAxis->setPadding(20);
-
-	customPlot->xAxis2->setBasePen(axisBasePen);
-	customPlot->xAxis2->setTickPen(Qt::NoPen);
-	customPlot->xAxis2->setSubTickPen(Qt::NoPen);
-	customPlot->xAxis2->setPadding(20);
 
 	customPlot->yAxis->setLabel(QString("Velocity (%1)").arg(velocityUnits2));
 	customPlot->yAxis->scaleRange(1.3);
-	customPlot->yAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
-	customPlot->yAxis->setTickLabelColor(QColor("#4d4d4d"));
-	customPlot->yAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
-	customPlot->yAxis->setLabelColor(QColor("#4d4d4d"));
-	customPlot->yAxis->grid()->setZeroLinePen(Qt::NoPen);
-	customPlot->yAxis->grid()->setPen(gridPen);
-	customPlot->yAxis->setBasePen(axisBasePen);
-	customPlot->yAxis->setTickPen(Qt::NoPen);
-	customPlot->yAxis->setSubTickPen(Qt::NoPen);
-	customPlot->yAxis->setLabelPadding(20);
-	customPlot->yAxis->setPadding(20);
-
-	customPlot->yAxis2->setBasePen(axisBasePen);
-	customPlot->yAxis2->setTickPen(Qt::NoPen);
-	customPlot->yAxis2->setSubTickPen(Qt::NoPen);
-	customPlot->yAxis2->setPadding(20);
-
-	// seems to strike a good balance of tick frequency and readability
-	customPlot->yAxis->ticker()->setTickCount(6);
 
 	customPlot->axisRect()->setupFullAxesBox();
 
-	// Render the graph off-screen
-	QPixmap picture(QSize(1440, 625));
-	QCPPainter painter(&picture);
-	customPlot->toPainter(&painter, 1440, 625);
-
-	/*
-	 * Generate bounding boxes and text annotations. We need to do this after rendering the graph so that coordToPixel() works.
-	 */
-
-	bool prevMeanSet = false;
-	double prevMean = 0;
-
-	for ( int i = 0; i < seriesToGraph.size(); i++ )
-	{
-		ChronoSeries *series = seriesToGraph.at(i);
-
-		// Collect annotation contents. Only display ES and SD if there are 2+ shots in the series.
-
-		double chargeWeight = series->chargeWeight->value();
-
-		int totalShots = series->muzzleVelocities.size();
-		double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-		double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-		double mean = std::accumulate(series->muzzleVelocities.begin(), series->muzzleVelocities.end(), 0.0) / static_cast<double>(totalShots);
-		int es = velocityMax - velocityMin;
-		double stdev = sampleStdev(series->muzzleVelocities);
-		QStringList aboveAnnotationText;
-		QStringList belowAnnotationText;
-
-		if ( graphType->currentIndex() == SCATTER )
-		{
-			QCPItemRect *rect = new QCPItemRect(customPlot);
-			QPen rectPen("#0536b0");
-			rectPen.setWidthF(1.3);
-			rect->setPen(rectPen);
-			rect->topLeft->setType(QCPItemPosition::ptAbsolute);
-			rect->bottomRight->setType(QCPItemPosition::ptAbsolute);
-			if ( xAxisSpacing->currentIndex() == CONSTANT )
-			{
-				rect->topLeft->setCoords(customPlot->xAxis->coordToPixel(i) - 7, customPlot->yAxis->coordToPixel(velocityMax) - 7);
-				rect->bottomRight->setCoords(customPlot->xAxis->coordToPixel(i) + 7, customPlot->yAxis->coordToPixel(velocityMin) + 7);
-			}
-			else
-			{
-				rect->topLeft->setCoords(customPlot->xAxis->coordToPixel(chargeWeight) - 7, customPlot->yAxis->coordToPixel(velocityMax) - 7);
-				rect->bottomRight->setCoords(customPlot->xAxis->coordToPixel(chargeWeight) + 7, customPlot->yAxis->coordToPixel(velocityMin) + 7);
-			}
-		}
-
-		if ( esCheckBox->isChecked() && (series->muzzleVelocities.size() > 1) )
-		{
-			QString annotation = QString("ES: %1").arg(es);
-			if ( esLocation->currentIndex() == ABOVE_STRING )
-			{
-				aboveAnnotationText.append(annotation);
-			}
-			else
-			{
-				belowAnnotationText.append(annotation);
-			}
-		}
-
-		if ( sdCheckBox->isChecked() && (series->muzzleVelocities.size() > 1) )
-		{
-			QString annotation = QString("SD: %1").arg(stdev, 0, 'f', 1);
-			if ( sdLocation->currentIndex() == ABOVE_STRING )
-			{
-				aboveAnnotationText.append(annotation);
-			}
-			else
-			{
-				belowAnnotationText.append(annotation);
-			}
-		}
-
-		if ( avgCheckBox->isChecked() )
-		{
-			QString annotation;
-			if ( series->muzzleVelocities.size() > 1 )
-			{
-				annotation = QString("x\u0305: %1").arg(mean, 0, 'f', 1);
-			}
-			else
-			{
-				annotation = QString::number(mean);
-			}
-
-			if ( avgLocation->currentIndex() == ABOVE_STRING )
-			{
-				aboveAnnotationText.append(annotation);
-			}
-			else
-			{
-				belowAnnotationText.append(annotation);
-			}
-		}
-
-		if ( vdCheckBox->isChecked() )
-		{
-			if ( prevMeanSet )
-			{
-				QString sign;
-				int delta = round(mean - prevMean);
-				if ( delta < 0 )
-				{
-					sign = QString("-");
-				}
-				else
-				{
-					sign = QString("+");
-				}
-
-				QString annotation = QString("%1%2").arg(sign).arg(abs(delta));
-				if ( vdLocation->currentIndex() == ABOVE_STRING )
-				{
-					aboveAnnotationText.append(annotation);
-				}
-				else
-				{
-					belowAnnotationText.append(annotation);
-				}
-			}
-		}
-
-		// Obtain pixel coordinates for points. We need the min/max points for scatter plots and stdev for line + SD bar charts.
-
-		double yCoordBelow;
-		double yCoordAbove;
-
-		if ( graphType->currentIndex() == SCATTER )
-		{
-			yCoordBelow = velocityMin;
-			yCoordAbove = velocityMax;
-		}
-		else
-		{
-			if ( qIsNaN(stdev) )
-			{
-				yCoordBelow = mean;
-				yCoordAbove = mean;
-			}
-			else
-			{
-				yCoordBelow = mean - stdev;
-				yCoordAbove = mean + stdev;
-			}
-		}
-
-		QCPItemText *belowAnnotation = new QCPItemText(customPlot);
-		belowAnnotation->setText(belowAnnotationText.join('\n'));
-		belowAnnotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
-		belowAnnotation->setColor(QColor("#4d4d4d"));
-		belowAnnotation->position->setType(QCPItemPosition::ptAbsolute);
-		if ( xAxisSpacing->currentIndex() == CONSTANT )
-		{
-			belowAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(i), customPlot->yAxis->coordToPixel(yCoordBelow) + 10);
-		}
-		else
-		{
-			belowAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(chargeWeight), customPlot->yAxis->coordToPixel(yCoordBelow) + 10);
-		}
-		belowAnnotation->setPositionAlignment(Qt::AlignHCenter | Qt::AlignTop);
-		belowAnnotation->setTextAlignment(Qt::AlignCenter);
-		belowAnnotation->setBrush(QBrush(Qt::white));
-		belowAnnotation->setClipToAxisRect(false);
-		belowAnnotation->setLayer(customPlot->layer(5));
-		qDebug() << "min pixel coords:" << belowAnnotation->position->pixelPosition() << "layer:" << belowAnnotation->layer()->name() << "rect:" << customPlot->axisRect()->layer()->name();
+	/* Generate bounding boxes and text annotations */
 
-		QCPItemText *aboveAnnotation = new QCPItemText(customPlot);
-		aboveAnnotation->setText(aboveAnnotationText.join('\n'));
-		aboveAnnotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
-		aboveAnnotation->setColor(QColor("#4d4d4d"));
-		aboveAnnotation->position->setType(QCPItemPosition::ptAbsolute);
-		if ( xAxisSpacing->currentIndex() == CONSTANT )
-		{
-			aboveAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(i), customPlot->yAxis->coordToPixel(yCoordAbove) - 10);
-		}
-		else
+	updateAnnotations();
+
+	qDebug() << "xPoints:" << xPoints;
+	qDebug() << "yPoints:" << yPoints;
+	qDebug() << "allXPoints:" << allXPoints;
+	qDebug() << "allYPoints:" << allYPoints;
+
+	plottedKey = renderKey();
+
+	return true;
+}
+
+void PowderTest::renderGraph ( bool displayGraphPreview )
+{
+	qDebug() << "renderGraph displayGraphPreview =" << displayGraphPreview;
+
+	// Skip rebuilding the plot if nothing that goes into it has changed since the last time
+	if ( renderKey() == plottedKey )
+	{
+		qDebug() << "Plot is already up to date";
+	}
+	else
+	{
+		if ( ! populatePlot() )
 		{
-			aboveAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(chargeWeight), customPlot->yAxis->coordToPixel(yCoordAbove) - 10);
+			return;
 		}
-		aboveAnnotation->setPositionAlignment(Qt::AlignHCenter | Qt::AlignBottom);
-		aboveAnnotation->setTextAlignment(Qt::AlignCenter);
-		aboveAnnotation->setBrush(QBrush(Qt::white));
-		aboveAnnotation->setClipToAxisRect(false);
-		aboveAnnotation->setLayer(customPlot->layer(5));
-		qDebug() << "max pixel coords:" << aboveAnnotation->position->pixelPosition() << "layer:" << aboveAnnotation->layer()->name() << "rect:" << customPlot->axisRect()->layer()->name();
 
-		prevMean = mean;
-		prevMeanSet = true;
+		recordHistory();
 	}
 
 	if ( displayGraphPreview )
 	{
 		qDebug() << "Showing graph preview";
 
-		//customPlot->show();
-		QPixmap preview = customPlot->toPixmap(1440, 625, 2.0);
-
-		if ( graphPreview )
-		{
-			graphPreview->deleteLater();
-		}
-
-		qDebug() << "xPoints:" << xPoints;
-		qDebug() << "yPoints:" << yPoints;
-		qDebug() << "allXPoints:" << allXPoints;
-		qDebug() << "allYPoints:" << allYPoints;
-
-		graphPreview = new GraphPreview(preview);
+		graphPreview->present();
 	}
 	else
 	{
+		// Keep an open preview in sync with what's being saved, and make sure the plot isn't left in its draft state for export
+		graphPreview->refresh();
+
 		QString fileName;
 		if ( graphTitle->text().isEmpty() )
 		{
@@ -1449,149 +1989,179 @@ void PowderTest::renderGraph ( bool displayGraphPreview )
 
 		qDebug() << "Using save path:" << path;
 
-		bool res;
+		// Images are rendered here, then compressed and written on a worker thread so the UI stays responsive
 		if ( pathExt == "png")
 		{
-			res = customPlot->savePng(path, 1440, 625, 2.0);
+			saveImageAsync(this, renderImage(), path, "PNG");
 		}
 		else if ( pathExt == "jpg" )
 		{
-			res = customPlot->saveJpg(path, 1440, 625, 2.0);
+			saveImageAsync(this, renderImage(), path, "JPG");
 		}
 		else if ( pathExt == "pdf" )
 		{
-			res = customPlot->savePdf(path, 1440, 625);
+			bool res = customPlot->savePdf(path, canvasSize.width(), canvasSize.height());
+			qDebug() << "save file res =" << res;
+
+			showSaveResult(this, path, res);
 		}
 		else
 		{
 			qDebug() << "error, shouldn't be reached";
-			res = false;
-		}
-
-		qDebug() << "save file res =" << res;
-
-		if ( res )
-		{
-			QMessageBox::information(this, "Save file", QString("Saved file to '%1'").arg(path), QMessageBox::Ok, QMessageBox::Ok);
-		}
-		if ( res == false )
-		{
-			QMessageBox::warning(this, "Save file", QString("Unable to save file to '%1'\n\nPlease choose a different path").arg(path), QMessageBox::Ok, QMessageBox::Ok);
+			showSaveResult(this, path, false);
 		}
 	}
 }
 
-void PowderTest::seriesCheckBoxChanged ( int state )
+/*
+ * Hash of everything populatePlot() reads and the axis ranges it leaves. Two graphs with the same key are drawn identically.
+ */
+QByteArray PowderTest::renderKey ( void )
 {
-	QCheckBox *checkBox = qobject_cast<QCheckBox *>(sender());
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
 
-	qDebug() << "seriesCheckBoxChanged state =" << state << " checkBox =" << checkBox;
+	// Tabs share the render cache, so keep their keys apart
+	stream << QString("powder");
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seriesGrid->rowCount() - 1; i++ )
+	for ( int i = 0; i < seriesData.size(); i++ )
 	{
-		QWidget *rowCheckBox = seriesGrid->itemAtPosition(i, 0)->widget();
-
-		if ( checkBox == rowCheckBox )
+		ChronoSeries *series = seriesData.at(i);
+		if ( (! series->deleted) && series->enabled )
 		{
-			QWidget *seriesName = seriesGrid->itemAtPosition(i, 1)->widget();
-			QWidget *chargeWeight = seriesGrid->itemAtPosition(i, 2)->layout()->itemAt(0)->widget();
-			QWidget *seriesResult = seriesGrid->itemAtPosition(i, 3)->widget();
-			QWidget *seriesDate = seriesGrid->itemAtPosition(i, 4)->widget();
-
-			if ( checkBox->isChecked() )
-			{
-				qDebug() << "Grid row" << i << "was checked";
+			stream << series->name << series->chargeWeight << series->muzzleVelocities;
+		}
+	}
 
-				seriesName->setEnabled(true);
-				chargeWeight->setEnabled(true);
-				seriesResult->setEnabled(true);
-				seriesDate->setEnabled(true);
-			}
-			else
-			{
-				qDebug() << "Grid row" << i << "was unchecked";
+	stream << graphType->currentIndex() << weightUnits->currentIndex() << velocityUnits->currentIndex() << xAxisSpacing->currentIndex();
+	stream << esCheckBox->isChecked() << esLocation->currentIndex();
+	stream << sdCheckBox->isChecked() << sdLocation->currentIndex();
+	stream << avgCheckBox->isChecked() << avgLocation->currentIndex();
+	stream << vdCheckBox->isChecked() << vdLocation->currentIndex();
+	stream << trendCheckBox->isChecked() << trendLineType->currentIndex();
+	stream << graphTitle->text() << rifle->text() << projectile->text() << propellant->text() << brass->text() << primer->text() << weather->text();
 
-				seriesName->setEnabled(false);
-				chargeWeight->setEnabled(false);
-				seriesResult->setEnabled(false);
-				seriesDate->setEnabled(false);
-			}
+	// Dragging or zooming the preview moves the axes away from where populatePlot() put them. Keying on the ranges means a moved
+	// view is never skipped as up to date or matched to a cached export of the untouched graph.
+	stream << customPlot->xAxis->range().lower << customPlot->xAxis->range().upper;
+	stream << customPlot->yAxis->range().lower << customPlot->yAxis->range().upper;
 
-			return;
-		}
-	}
+	return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
 }
 
-void PowderTest::seriesManualCheckBoxChanged ( int state )
+/*
+ * The graph built by populatePlot() at export resolution, reusing an earlier render of the same graph if there is one
+ */
+QImage PowderTest::renderImage ( void )
 {
-	QCheckBox *checkBox = qobject_cast<QCheckBox *>(sender());
+	QByteArray key = renderKey();
 
-	qDebug() << "seriesManualCheckBoxChanged state =" << state << " checkBox =" << checkBox;
-
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seriesGrid->rowCount() - 1; i++ )
+	QImage image = RenderCache::find(key);
+	if ( image.isNull() )
 	{
-		QWidget *rowCheckBox = seriesGrid->itemAtPosition(i, 0)->widget();
+		image = customPlot->toImage(canvasSize.width(), canvasSize.height(), 2.0);
+		RenderCache::insert(key, image);
+	}
 
-		if ( checkBox == rowCheckBox )
-		{
-			QWidget *seriesName = seriesGrid->itemAtPosition(i, 1)->widget();
-			QWidget *chargeWeight = seriesGrid->itemAtPosition(i, 2)->layout()->itemAt(0)->widget();
-			QWidget *seriesResult = seriesGrid->itemAtPosition(i, 3)->widget();
-			QWidget *seriesEnterData = seriesGrid->itemAtPosition(i, 4)->widget();
-			QWidget *seriesDelete = seriesGrid->itemAtPosition(i, 5)->widget();
+	return image;
+}
 
-			if ( checkBox->isChecked() )
-			{
-				qDebug() << "Grid row" << i << "was checked";
+/*
+ * Draws the graph built by populatePlot() into a painter that's already set up, at the same size it's exported at
+ */
+void PowderTest::paintGraph ( QCPPainter *painter )
+{
+	customPlot->toPainter(painter, canvasSize.width(), canvasSize.height());
 
-				seriesName->setEnabled(true);
-				chargeWeight->setEnabled(true);
-				seriesResult->setEnabled(true);
-				seriesEnterData->setEnabled(true);
-				seriesDelete->setEnabled(true);
-			}
-			else
-			{
-				qDebug() << "Grid row" << i << "was unchecked";
+	// toPainter() only restores the viewport, so lay the plot back out for an open preview
+	LabelLayout::layoutAt(customPlot, customPlot->viewport().size());
+}
 
-				seriesName->setEnabled(false);
-				chargeWeight->setEnabled(false);
-				seriesResult->setEnabled(false);
-				seriesEnterData->setEnabled(false);
-				seriesDelete->setEnabled(false);
-			}
+/*
+ * The load details filled in on this tab, labeled as they are in the form
+ */
+QList<QPair<QString, QString> > PowderTest::reportDetails ( void )
+{
+	QList<QPair<QString, QString> > details;
+	details << qMakePair(QString("Rifle"), rifle->text());
+	details << qMakePair(QString("Projectile"), projectile->text());
+	details << qMakePair(QString("Propellant"), propellant->text());
+	details << qMakePair(QString("Brass"), brass->text());
+	details << qMakePair(QString("Primer"), primer->text());
+	details << qMakePair(QString("Weather"), weather->text());
+
+	return details;
+}
 
-			return;
-		}
+/*
+ * Statistics for each series in the last graph built by populatePlot(), with a header row first
+ */
+QList<QStringList> PowderTest::seriesTable ( void )
+{
+	QList<QStringList> table;
+	table << (QStringList() << "Series" << customPlot->xAxis->label() << "Shots" << customPlot->yAxis->label().replace("Velocity", "Mean") << "SD" << "ES");
+
+	for ( int i = 0; i < graphedSeries.size(); i++ )
+	{
+		ChronoSeries *series = graphedSeries.at(i);
+		const QList<double> &velocities = series->muzzleVelocities;
+
+		double mean = std::accumulate(velocities.begin(), velocities.end(), 0.0) / static_cast<double>(velocities.size());
+		double minVelocity = *std::min_element(velocities.begin(), velocities.end());
+		double maxVelocity = *std::max_element(velocities.begin(), velocities.end());
+
+		QStringList row;
+		row << series->name;
+		row << QString::number(series->chargeWeight);
+		row << QString::number(velocities.size());
+		row << QString::number(mean, 'f', 1);
+		row << QString::number(sampleStdev(velocities), 'f', 1);
+		row << QString::number(maxVelocity - minVelocity, 'f', 1);
+		table << row;
 	}
+
+	return table;
 }
 
-void PowderTest::headerCheckBoxChanged ( int state )
+/*
+ * Writes the graph built by populatePlot() straight to disk without any dialogs, for command-line use. The format is picked
+ * from the file extension.
+ */
+bool PowderTest::exportGraph ( const QString &path )
 {
-	qDebug() << "headerCheckBoxChanged state =" << state;
+	qDebug() << "exportGraph path =" << path;
 
-	if ( state == Qt::Checked )
-	{
-		qDebug() << "Header checkbox was checked";
+	QString pathExt = QFileInfo(path).suffix().toLower();
 
-		for ( int i = 0; i < seriesGrid->rowCount() - 1; i++ )
-		{
-			QCheckBox *checkBox = qobject_cast<QCheckBox *>(seriesGrid->itemAtPosition(i, 0)->widget());
-			checkBox->setChecked(true);
-		}
+	bool res;
+	if ( pathExt == "pdf" )
+	{
+		res = customPlot->savePdf(path, canvasSize.width(), canvasSize.height());
+	}
+	else if ( pathExt == "jpg" )
+	{
+		res = customPlot->saveJpg(path, canvasSize.width(), canvasSize.height(), 2.0, -1, 96);
 	}
 	else
 	{
-		qDebug() << "Header checkbox was unchecked";
+		res = customPlot->savePng(path, canvasSize.width(), canvasSize.height(), 2.0, -1, 96);
+	}
 
-		for ( int i = 0; i < seriesGrid->rowCount() - 1; i++ )
-		{
-			QCheckBox *checkBox = qobject_cast<QCheckBox *>(seriesGrid->itemAtPosition(i, 0)->widget());
-			checkBox->setChecked(false);
-		}
+	qDebug() << "save file res =" << res;
+
+	if ( ! res )
+	{
+		errors.append(QString("Unable to save file to '%1'").arg(path));
 	}
+
+	return res;
+}
+
+void PowderTest::headerCheckBoxChanged ( int state )
+{
+	qDebug() << "headerCheckBoxChanged state =" << state;
+
+	seriesModel->setAllEnabled(state == Qt::Checked);
 }
 
 void PowderTest::velocityUnitsChanged ( int index )
@@ -1621,19 +2191,11 @@ void PowderTest::velocityUnitsChanged ( int index )
 		{
 			qDebug() << "Setting series" << i << "velocity unit to" << velocityUnit;
 
-			if ( series->muzzleVelocities.size() == 0 )
-			{
-				series->result->setText(QString("0 shots, 0-0 %1").arg(velocityUnit));
-			}
-			else
-			{
-				int totalShots = series->muzzleVelocities.size();
-				double velocityMin = *std::min_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-				double velocityMax = *std::max_element(series->muzzleVelocities.begin(), series->muzzleVelocities.end());
-				series->result->setText(QString("%1 shot%2, %3-%4 %5").arg(totalShots).arg(totalShots > 1 ? "s" : "").arg(velocityMin).arg(velocityMax).arg(velocityUnit));
-			}
+			series->velocityUnits = velocityUnit;
 		}
 	}
+
+	seriesModel->refresh();
 }
 
 void PowderTest::esCheckBoxChanged ( bool state )
@@ -1641,6 +2203,7 @@ void PowderTest::esCheckBoxChanged ( bool state )
 	qDebug() << "esCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(esCheckBox, esLabel, esLocation);
+	replotAnnotations();
 }
 
 void PowderTest::sdCheckBoxChanged ( bool state )
@@ -1648,6 +2211,7 @@ void PowderTest::sdCheckBoxChanged ( bool state )
 	qDebug() << "sdsCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(sdCheckBox, sdLabel, sdLocation);
+	replotAnnotations();
 }
 
 void PowderTest::avgCheckBoxChanged ( bool state )
@@ -1655,6 +2219,7 @@ void PowderTest::avgCheckBoxChanged ( bool state )
 	qDebug() << "avgCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(avgCheckBox, avgLabel, avgLocation);
+	replotAnnotations();
 }
 
 void PowderTest::vdCheckBoxChanged ( bool state )
@@ -1662,6 +2227,7 @@ void PowderTest::vdCheckBoxChanged ( bool state )
 	qDebug() << "vdCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(vdCheckBox, vdLabel, vdLocation);
+	replotAnnotations();
 }
 
 void PowderTest::trendCheckBoxChanged ( bool state )
@@ -1669,6 +2235,7 @@ void PowderTest::trendCheckBoxChanged ( bool state )
 	qDebug() << "trendCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(trendCheckBox, trendLabel, trendLineType);
+	replotTrendLine();
 }
 
 void PowderTest::xAxisSpacingChanged ( int index )
@@ -1704,6 +2271,44 @@ void PowderTest::optionCheckBoxChanged ( QCheckBox *checkBox, QLabel *label, QCo
 	}
 }
 
+/*
+ * Frees every series loaded since the last call, ahead of loading new data. The graph preview is closed since it was drawn
+ * from series that no longer exist.
+ */
+void PowderTest::clearSeries ( void )
+{
+	if ( graphPreview != NULL )
+	{
+		graphPreview->hide();
+	}
+
+	graphedSeries.clear();
+	seriesData.clear();
+	plottedKey.clear(); // the plot no longer matches anything, even if the same data is loaded again
+	rrOriginalSeries.clear();
+	rrConversion = RoundRobin::Conversion();
+	fromHistory = false;
+	importDevice = DEVICE_UNKNOWN;
+	seriesModel->reload(false);
+
+	arena.clear();
+}
+
+/*
+ * Returns to the initial screen to choose a new chronograph file, freeing the loaded data
+ */
+void PowderTest::unloadData ( void )
+{
+	// Hide the chronograph data screen
+	stackedWidget->removeWidget(scrollWidget);
+
+	// Delete the loaded chronograph data
+	clearSeries();
+
+	// Disconnect the velocity units header signal (used in manual data entry), if necessary
+	disconnect(velocityUnits, SIGNAL(activated(int)), this, SLOT(velocityUnitsChanged(int)));
+}
+
 void PowderTest::loadNewChronographData ( bool state )
 {
 	qDebug() << "loadNewChronographData state =" << state;
@@ -1711,145 +2316,477 @@ void PowderTest::loadNewChronographData ( bool state )
 	QMessageBox::StandardButton reply;
 	reply = QMessageBox::question(this, "Load new data", "Are you sure you want to load new chronograph data?\n\nThis will clear your current work.", QMessageBox::Yes | QMessageBox::Cancel);
 
-	if ( reply == QMessageBox::Yes )
+	if ( reply == QMessageBox::Yes )
+	{
+		qDebug() << "User said yes";
+
+		unloadData();
+	}
+	else
+	{
+		qDebug() << "User said cancel";
+	}
+}
+
+/*
+ * Parses every series in a LabRadar directory along with the name of the directory it came from. This only touches plain data,
+ * so it's safe to call from worker threads. path is updated to the directory the series were actually read from.
+ */
+QList<ChronoSeries *> PowderTest::ReadLabRadarDirectory ( QString &path, QStringList &names )
+{
+	QList<ChronoSeries *> seriesList;
+
+	/*
+	 * Look for LabRadar data. LabRadar has a LBR/ directory in the root of its drive filled with SR####/ directories.
+	 * We handle the case where the user selected the root of the SD card (and the series directories are actually in LBR/),
+	 * or if we're inside one of the actual series directories and we need to be one directory up to enumerate all of them.
+	 */
+
+	QDir lbrPath(path);
+	lbrPath.setPath(lbrPath.filePath("LBR"));
+	if ( lbrPath.exists() )
+	{
+		path = lbrPath.path();
+		qDebug() << "Detected LabRadar directory" << path << ". Using that directory instead.";
+	}
+
+	QDir trkPath(path);
+	trkPath.setPath(trkPath.filePath("TRK"));
+	if ( trkPath.exists() )
+	{
+		trkPath.setPath(trkPath.filePath("../.."));
+		path = trkPath.canonicalPath();
+		qDebug() << "Detected LabRadar directory" << path << ". Using one directory level up instead.";
+	}
+
+	qDebug() << "path:" << path;
+
+	/* Enumerate the LabRadar directory */
+
+	QRegularExpression re;
+	re.setPattern("^SR\\d\\d\\d\\d.*");
+
+	QDir dir(path);
+	QStringList items = dir.entryList(QStringList(), QDir::AllDirs | QDir::NoDotAndDotDot);
+
+	QStringList seriesDirs;
+
+	foreach ( QString fileName, items )
+	{
+		qDebug() << "Entry:" << fileName;
+		if ( re.match(fileName).hasMatch() )
+		{
+			qDebug() << "Detected LabRadar series directory" << fileName;
+			seriesDirs.append(fileName);
+		}
+	}
+
+	/* Series directories are parsed independently, so spread them across the global thread pool. Each one writes only its own slot. */
+
+	QVector<ChronoSeries *> parsed(seriesDirs.size(), NULL);
+	ChronoSeries **out = parsed.data();
+	QVector<int> indices(seriesDirs.size());
+	for ( int i = 0; i < indices.size(); i++ )
+	{
+		indices[i] = i;
+	}
+
+	QtConcurrent::blockingMap(indices, [&] ( int &i ) {
+		QDir seriesDir(dir.filePath(seriesDirs.at(i)));
+		QStringList csvItems = seriesDir.entryList(QStringList() << "* Report.csv", QDir::Files | QDir::NoDotAndDotDot);
+
+		if ( csvItems.empty() )
+		{
+			qDebug() << "No report CSV in" << seriesDirs.at(i) << ", skipping...";
+			return;
+		}
+
+		QString csvFileName = csvItems.at(0);
+
+		qDebug() << "CSV file:" << csvFileName;
+
+		QFile csvFile(seriesDir.filePath(csvFileName));
+		csvFile.open(QIODevice::ReadOnly);
+		QTextStream csv(&csvFile);
+
+		out[i] = ExtractLabRadarSeries(csv);
+	});
+
+	/* Collect the valid series in directory order */
+
+	for ( int i = 0; i < parsed.size(); i++ )
+	{
+		ChronoSeries *series = parsed.at(i);
+
+		if ( series == NULL )
+		{
+			continue;
+		}
+
+		if ( ! series->isValid )
+		{
+			qDebug() << "Invalid series" << seriesDirs.at(i) << ", skipping...";
+			delete series;
+			continue;
+		}
+
+		seriesList.append(series);
+		names.append(seriesDirs.at(i));
+	}
+
+	return seriesList;
+}
+
+/*
+ * Replaces seriesData with parsed LabRadar series, named after their directories and all enabled
+ */
+void PowderTest::AddLabRadarSeries ( const QList<ChronoSeries *> &seriesList, const QStringList &names )
+{
+	clearSeries();
+
+	importDevice = DEVICE_LABRADAR;
+
+	for ( int i = 0; i < seriesList.size(); i++ )
+	{
+		ChronoSeries *series = seriesList.at(i);
+
+		series->enabled = true;
+
+		series->name = names.at(i);
+
+		series->chargeWeight = 0;
+
+		seriesData.append(arena.adopt(series));
+	}
+}
+
+/*
+ * Reads every series in a LabRadar directory into seriesData, replacing whatever was loaded before. Returns the directory the
+ * series were actually read from.
+ */
+QString PowderTest::LoadLabRadarDirectory ( QString path )
+{
+	QStringList names;
+	QList<ChronoSeries *> seriesList = ReadLabRadarDirectory(path, names);
+
+	AddLabRadarSeries(seriesList, names);
+
+	return path;
+}
+
+bool PowderTest::importLabRadar ( const QString &path )
+{
+	qDebug() << "importLabRadar path =" << path;
+
+	QString dataPath = LoadLabRadarDirectory(path);
+
+	if ( seriesData.empty() )
+	{
+		errors.append(QString("Unable to find LabRadar data in '%1'").arg(dataPath));
+		return false;
+	}
+
+	DisplaySeriesData();
+
+	return true;
+}
+
+bool PowderTest::importLabRadarSeries ( const QList<ChronoSeries *> &seriesList, const QStringList &names )
+{
+	AddLabRadarSeries(seriesList, names);
+
+	if ( seriesData.empty() )
+	{
+		return false;
+	}
+
+	DisplaySeriesData();
+
+	return true;
+}
+
+/*
+ * Matches this tab's graph options to another's, so a hidden renderer draws graphs the same way the user has them set up
+ */
+void PowderTest::copyGraphOptions ( PowderTest *other )
+{
+	rifle->setText(other->rifle->text());
+	projectile->setText(other->projectile->text());
+	propellant->setText(other->propellant->text());
+	brass->setText(other->brass->text());
+	primer->setText(other->primer->text());
+	weather->setText(other->weather->text());
+
+	graphType->setCurrentIndex(other->graphType->currentIndex());
+	weightUnits->setCurrentIndex(other->weightUnits->currentIndex());
+	velocityUnits->setCurrentIndex(other->velocityUnits->currentIndex());
+	xAxisSpacing->setCurrentIndex(other->xAxisSpacing->currentIndex());
+
+	esCheckBox->setChecked(other->esCheckBox->isChecked());
+	esLocation->setCurrentIndex(other->esLocation->currentIndex());
+	sdCheckBox->setChecked(other->sdCheckBox->isChecked());
+	sdLocation->setCurrentIndex(other->sdLocation->currentIndex());
+	avgCheckBox->setChecked(other->avgCheckBox->isChecked());
+	avgLocation->setCurrentIndex(other->avgLocation->currentIndex());
+	vdCheckBox->setChecked(other->vdCheckBox->isChecked());
+	vdLocation->setCurrentIndex(other->vdLocation->currentIndex());
+	trendCheckBox->setChecked(other->trendCheckBox->isChecked());
+	trendLineType->setCurrentIndex(other->trendLineType->currentIndex());
+}
+
+void PowderTest::setGraphTitle ( const QString &title )
+{
+	graphTitle->setText(title);
+}
+
+QList<QPair<QString, QWidget *> > PowderTest::optionWidgets ( void )
+{
+	QList<QPair<QString, QWidget *> > widgets;
+	widgets << qMakePair(QString("graphTitle"), (QWidget *)graphTitle);
+	widgets << qMakePair(QString("rifle"), (QWidget *)rifle);
+	widgets << qMakePair(QString("projectile"), (QWidget *)projectile);
+	widgets << qMakePair(QString("propellant"), (QWidget *)propellant);
+	widgets << qMakePair(QString("brass"), (QWidget *)brass);
+	widgets << qMakePair(QString("primer"), (QWidget *)primer);
+	widgets << qMakePair(QString("weather"), (QWidget *)weather);
+	widgets << qMakePair(QString("graphType"), (QWidget *)graphType);
+	widgets << qMakePair(QString("weightUnits"), (QWidget *)weightUnits);
+	widgets << qMakePair(QString("velocityUnits"), (QWidget *)velocityUnits);
+	widgets << qMakePair(QString("xAxisSpacing"), (QWidget *)xAxisSpacing);
+	widgets << qMakePair(QString("es"), (QWidget *)esCheckBox);
+	widgets << qMakePair(QString("esLocation"), (QWidget *)esLocation);
+	widgets << qMakePair(QString("sd"), (QWidget *)sdCheckBox);
+	widgets << qMakePair(QString("sdLocation"), (QWidget *)sdLocation);
+	widgets << qMakePair(QString("avg"), (QWidget *)avgCheckBox);
+	widgets << qMakePair(QString("avgLocation"), (QWidget *)avgLocation);
+	widgets << qMakePair(QString("vd"), (QWidget *)vdCheckBox);
+	widgets << qMakePair(QString("vdLocation"), (QWidget *)vdLocation);
+	widgets << qMakePair(QString("trend"), (QWidget *)trendCheckBox);
+	widgets << qMakePair(QString("trendLineType"), (QWidget *)trendLineType);
+
+	return widgets;
+}
+
+QVariantMap PowderTest::saveOptions ( void )
+{
+	return saveOptionWidgets(optionWidgets());
+}
+
+bool PowderTest::isManualEntry ( void )
+{
+	return seriesModel->isManual();
+}
+
+/*
+ * Replaces the tab's data and options with ones read from a project file. The series are adopted by the tab.
+ */
+void PowderTest::restoreProject ( const QVariantMap &options, const QList<ChronoSeries *> &seriesList, bool manual )
+{
+	unloadData();
+
+	restoreOptionWidgets(optionWidgets(), options);
+
+	optionCheckBoxChanged(esCheckBox, esLabel, esLocation);
+	optionCheckBoxChanged(sdCheckBox, sdLabel, sdLocation);
+	optionCheckBoxChanged(avgCheckBox, avgLabel, avgLocation);
+	optionCheckBoxChanged(vdCheckBox, vdLabel, vdLocation);
+	optionCheckBoxChanged(trendCheckBox, trendLabel, trendLineType);
+
+	if ( seriesList.isEmpty() )
+	{
+		return;
+	}
+
+	for ( int i = 0; i < seriesList.size(); i++ )
 	{
-		qDebug() << "User said yes";
+		seriesData.append(arena.adopt(seriesList.at(i)));
+	}
 
-		// Hide the chronograph data screen. This returns to the initial screen to choose a new chronograph file.
-		stackedWidget->removeWidget(scrollWidget);
+	if ( manual )
+	{
+		showManualEntry();
 
-		// Delete the loaded chronograph data
-		seriesData.clear();
+		for ( int i = 0; i < seriesData.size(); i++ )
+		{
+			addSeriesButtons(i);
+		}
 
-		// Disconnect the velocity units header signal (used in manual data entry), if necessary
-		disconnect(velocityUnits, SIGNAL(activated(int)), this, SLOT(velocityUnitsChanged(int)));
+		// Only the first row of a new table needs pointing out
+		addNewButton->setStyleSheet("");
 	}
 	else
 	{
-		qDebug() << "User said cancel";
+		DisplaySeriesData();
 	}
 }
 
-void PowderTest::selectLabRadarDirectory ( bool state )
+/*
+ * A hidden tab with copies of this one's series and options. Reports and workbooks populate their graphs in one, so whatever
+ * populatePlot() changes along the way (e.g. constant spacing on duplicate values) never reaches the tab the user is working in.
+ */
+PowderTest *PowderTest::scratchCopy ( void )
 {
-	qDebug() << "selectLabRadarDirectory state =" << state;
+	QList<ChronoSeries *> copies;
 
-	qDebug() << "Previous directory:" << prevLabRadarDir;
+	for ( int i = 0; i < seriesData.size(); i++ )
+	{
+		if ( ! seriesData.at(i)->deleted )
+		{
+			copies.append(new ChronoSeries(*seriesData.at(i)));
+		}
+	}
 
-	QString path = QFileDialog::getExistingDirectory(this, "Select directory", prevLabRadarDir);
-	prevLabRadarDir = path;
+	PowderTest *scratch = new PowderTest();
+	scratch->headless = true;
+	scratch->restoreProject(saveOptions(), copies, isManualEntry());
 
-	qDebug() << "Selected directory:" << path;
+	return scratch;
+}
 
-	if ( path.isEmpty() )
+/*
+ * Shows strings looked up in the load history the same way as a freshly loaded chronograph file
+ */
+void PowderTest::graphHistory ( const QVariantMap &options, const QList<ChronoSeries *> &seriesList )
+{
+	restoreProject(options, seriesList, false);
+
+	fromHistory = true;
+}
+
+/*
+ * Adds the enabled strings and their components to the load history, and their shots to the shot archive. Called on import and
+ * again on each graph. The fingerprint covers every loaded velocity, so recording the same data again with other charges or
+ * components replaces its earlier record.
+ */
+void PowderTest::recordHistory ( void )
+{
+	if ( headless || fromHistory )
 	{
-		qDebug() << "User didn't select a directory, bail";
 		return;
 	}
 
-	seriesData.clear();
-
-	/*
-	 * Look for LabRadar data. LabRadar has a LBR/ directory in the root of its drive filled with SR####/ directories.
-	 * We handle the case where the user selected the root of the SD card (and the series directories are actually in LBR/),
-	 * or if we're inside one of the actual series directories and we need to be one directory up to enumerate all of them.
-	 */
-
-	QDir lbrPath(path);
-	lbrPath.setPath(lbrPath.filePath("LBR"));
-	if ( lbrPath.exists() )
+	QList<ChronoSeries *> recordedSeries;
+	for ( int i = 0; i < seriesData.size(); i++ )
 	{
-		path = lbrPath.path();
-		qDebug() << "Detected LabRadar directory" << path << ". Using that directory instead.";
+		ChronoSeries *series = seriesData.at(i);
+		if ( series->enabled && (! series->deleted) && (! series->muzzleVelocities.isEmpty()) )
+		{
+			recordedSeries.append(series);
+		}
 	}
 
-	QDir trkPath(path);
-	trkPath.setPath(trkPath.filePath("TRK"));
-	if ( trkPath.exists() )
+	if ( recordedSeries.isEmpty() )
 	{
-		trkPath.setPath(trkPath.filePath("../.."));
-		path = trkPath.canonicalPath();
-		qDebug() << "Detected LabRadar directory" << path << ". Using one directory level up instead.";
+		return;
 	}
 
-	qDebug() << "path:" << path;
-
-	/* Enumerate the LabRadar directory */
-
-	QRegularExpression re;
-	re.setPattern("^SR\\d\\d\\d\\d.*");
-
-	QDir dir(path);
-	QStringList items = dir.entryList(QStringList(), QDir::AllDirs | QDir::NoDotAndDotDot);
-
-	foreach ( QString fileName, items )
+	// Sorted, so the fingerprint stays the same however the shots get split up later (excluded, round-robin converted)
+	QVector<double> loaded;
+	for ( int i = 0; i < seriesData.size(); i++ )
 	{
-		qDebug() << "Entry:" << fileName;
-		if ( re.match(fileName).hasMatch() )
+		ChronoSeries *series = seriesData.at(i);
+		loaded += series->muzzleVelocities.toVector();
+		for ( int j = 0; j < series->excludedShots.size(); j++ )
 		{
-			qDebug() << "Detected LabRadar series directory" << fileName;
-
-			QString seriesPath(dir.filePath(fileName));
-			QDir seriesDir(seriesPath);
-			QStringList csvItems = seriesDir.entryList(QStringList() << "* Report.csv", QDir::Files | QDir::NoDotAndDotDot);
-			QString csvFileName = csvItems.at(0);
-
-			qDebug() << "CSV file:" << csvFileName;
-
-			QFile csvFile(seriesDir.filePath(csvFileName));
-			csvFile.open(QIODevice::ReadOnly);
-			QTextStream csv(&csvFile);
-
-			ChronoSeries *series = ExtractLabRadarSeries(csv);
+			loaded.append(series->excludedShots.at(j).second);
+		}
+	}
+	std::sort(loaded.begin(), loaded.end());
+
+	History::Session session;
+	session.fingerprint = QCryptographicHash::hash(QByteArray((const char *)loaded.constData(), loaded.size() * sizeof(double)), QCryptographicHash::Sha1);
+	session.test = ARCHIVE_POWDER;
+	session.recorded = QDate::currentDate();
+	session.rifle = rifle->text();
+	session.projectile = projectile->text();
+	session.propellant = propellant->text();
+	session.brass = brass->text();
+	session.primer = primer->text();
+	session.weightUnits = (weightUnits->currentIndex() == GRAMS) ? "g" : "gr";
+
+	QVector<ShotArchive::Shot> shots;
+
+	for ( int i = 0; i < recordedSeries.size(); i++ )
+	{
+		ChronoSeries *chronoSeries = recordedSeries.at(i);
+		const QList<double> &velocities = chronoSeries->muzzleVelocities;
+
+		History::Series series;
+		series.name = chronoSeries->name;
+		series.firstDate = chronoSeries->firstDate;
+		series.charge = chronoSeries->chargeWeight;
+		series.velocityUnits = chronoSeries->velocityUnits;
+		series.velocities = velocities;
+		series.shots = velocities.size();
+		series.mean = std::accumulate(velocities.begin(), velocities.end(), 0.0) / static_cast<double>(velocities.size());
+		series.sd = (velocities.size() > 1) ? sampleStdev(velocities) : qQNaN();
+		series.es = (velocities.size() > 1) ? *std::max_element(velocities.begin(), velocities.end()) - *std::min_element(velocities.begin(), velocities.end()) : qQNaN();
+		series.groupSize = qQNaN();
+		session.series.append(series);
+
+		qint64 time = ShotArchive::timestamp(chronoSeries->firstDate, chronoSeries->firstTime);
+		for ( int j = 0; j < velocities.size(); j++ )
+		{
+			ShotArchive::Shot shot;
+			shot.velocity = velocities.at(j);
+			shot.x = shot.y = qQNaN();
+			shot.value = chronoSeries->chargeWeight;
+			shot.time = time;
+			shot.device = importDevice;
+			shot.sighter = false;
+			shots.append(shot);
+		}
+	}
 
-			if ( ! series->isValid )
-			{
-				qDebug() << "Invalid series, skipping...";
-				continue;
-			}
+	History::record(session);
+	ShotArchive::append(ARCHIVE_POWDER, ShotArchive::sessionKey(session.fingerprint), shots);
+}
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+void PowderTest::selectLabRadarDirectory ( bool state )
+{
+	qDebug() << "selectLabRadarDirectory state =" << state;
 
-			series->name = new QLabel(fileName);
+	qDebug() << "Previous directory:" << prevLabRadarDir;
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+	QString path = QFileDialog::getExistingDirectory(this, "Select directory", prevLabRadarDir);
+	prevLabRadarDir = path;
 
-			seriesData.append(series);
+	qDebug() << "Selected directory:" << path;
 
-			csvFile.close();
-		}
+	if ( path.isEmpty() )
+	{
+		qDebug() << "User didn't select a directory, bail";
+		return;
 	}
 
+	path = LoadLabRadarDirectory(path);
+
 	/* We're finished enumerating the directory */
 
 	if ( seriesData.empty() )
 	{
 		qDebug() << "Didn't find any chrono data in this directory, bail";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText(QString("Unable to find LabRadar data in '%1'").arg(path));
-		msg->setWindowTitle("Error");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Unable to find LabRadar data in '%1'").arg(path));
+		msg.setWindowTitle("Error");
+		msg.exec();
 	}
 	else
 	{
 		qDebug() << "Detected LabRadar directory" << path;
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Information);
-		msg->setText(QString("Detected LabRadar data\n\nUsing '%1'").arg(path));
-		msg->setWindowTitle("Success");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Information);
+		msg.setText(QString("Detected LabRadar data\n\nUsing '%1'").arg(path));
+		msg.setWindowTitle("Success");
+		msg.exec();
 
 		// Proceed to display the data
 		DisplaySeriesData();
+
+		recordHistory();
 	}
 }
 
@@ -1942,7 +2879,7 @@ void PowderTest::selectMagnetoSpeedFile ( bool state )
 		return;
 	}
 
-	seriesData.clear();
+	clearSeries();
 
 	/*
 	 * MagnetoSpeed records all of its series data in a single LOG.CSV file
@@ -1960,21 +2897,17 @@ void PowderTest::selectMagnetoSpeedFile ( bool state )
 	{
 		qDebug() << "Detected MagnetoSpeed file";
 
+		importDevice = DEVICE_MAGNETOSPEED;
+
 		for ( int i = 0; i < allSeries.size(); i++ )
 		{
 			ChronoSeries *series = allSeries.at(i);
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+			series->enabled = true;
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+			series->chargeWeight = 0;
 
-			seriesData.append(series);
+			seriesData.append(arena.adopt(series));
 		}
 	}
 
@@ -1986,24 +2919,26 @@ void PowderTest::selectMagnetoSpeedFile ( bool state )
 	{
 		qDebug() << "Didn't find any chrono data in this file, bail";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText(QString("Unable to find MagnetoSpeed data in '%1'").arg(path));
-		msg->setWindowTitle("Error");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Unable to find MagnetoSpeed data in '%1'").arg(path));
+		msg.setWindowTitle("Error");
+		msg.exec();
 	}
 	else
 	{
 		qDebug() << "Detected MagnetoSpeed file" << path;
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Information);
-		msg->setText(QString("Detected MagnetoSpeed data\n\nUsing '%1'").arg(path));
-		msg->setWindowTitle("Success");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Information);
+		msg.setText(QString("Detected MagnetoSpeed data\n\nUsing '%1'").arg(path));
+		msg.setWindowTitle("Success");
+		msg.exec();
 
 		// Proceed to display the data
 		DisplaySeriesData();
+
+		recordHistory();
 	}
 }
 
@@ -2064,6 +2999,10 @@ QList<ChronoSeries *> PowderTest::ExtractMagnetoSpeedSeries ( QTextStream &csv )
 
 					allSeries.append(curSeries);
 				}
+				else
+				{
+					delete curSeries;
+				}
 
 				curSeries = new ChronoSeries();
 				curSeries->isValid = false;
@@ -2096,7 +3035,7 @@ QList<ChronoSeries *> PowderTest::ExtractMagnetoSpeedSeries ( QTextStream &csv )
 				{
 					// MagnetoSpeed V3 files contain an integer in the 'Series' field. Use it as the series name.
 					curSeries->seriesNum = seriesNum;
-					curSeries->name = new QLabel(QString("Series %1").arg(seriesNum));
+					curSeries->name = QString("Series %1").arg(seriesNum);
 					qDebug() << "seriesNum =" << curSeries->seriesNum;
 				}
 				else
@@ -2110,11 +3049,11 @@ QList<ChronoSeries *> PowderTest::ExtractMagnetoSpeedSeries ( QTextStream &csv )
 				// Use the series name if the user entered one
 				if ( rows.at(1).compare("") == 0 )
 				{
-					curSeries->name = new QLabel("Unnamed");
+					curSeries->name = "Unnamed";
 				}
 				else
 				{
-					curSeries->name = new QLabel(rows.at(1));
+					curSeries->name = rows.at(1);
 				}
 
 				qDebug() << "Setting name to '" << curSeries->name << "' via Notes field";
@@ -2156,6 +3095,9 @@ QList<ChronoSeries *> PowderTest::ExtractMagnetoSpeedSeries ( QTextStream &csv )
 		i++;
 	}
 
+	// Every series ends in a '----' row, so whatever comes after the last one isn't a series
+	delete curSeries;
+
 	// XFR export files do not include series numbers, so iterate through and set the seriesNum's
 	for ( i = 0; i < allSeries.size(); i++ )
 	{
@@ -2184,7 +3126,7 @@ void PowderTest::selectProChronoFile ( bool state )
 		return;
 	}
 
-	seriesData.clear();
+	clearSeries();
 
 	/*
 	 * ProChrono records all of its series data in a single .CSV file
@@ -2217,21 +3159,17 @@ void PowderTest::selectProChronoFile ( bool state )
 	{
 		qDebug() << "Detected ProChrono file";
 
+		importDevice = DEVICE_PROCHRONO;
+
 		for ( int i = 0; i < allSeries.size(); i++ )
 		{
 			ChronoSeries *series = allSeries.at(i);
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+			series->enabled = true;
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+			series->chargeWeight = 0;
 
-			seriesData.append(series);
+			seriesData.append(arena.adopt(series));
 		}
 	}
 
@@ -2243,24 +3181,26 @@ void PowderTest::selectProChronoFile ( bool state )
 	{
 		qDebug() << "Didn't find any chrono data in this file, bail";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText(QString("Unable to find ProChrono data in '%1'").arg(path));
-		msg->setWindowTitle("Error");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Unable to find ProChrono data in '%1'").arg(path));
+		msg.setWindowTitle("Error");
+		msg.exec();
 	}
 	else
 	{
 		qDebug() << "Detected ProChrono file" << path;
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Information);
-		msg->setText(QString("Detected ProChrono data\n\nUsing '%1'").arg(path));
-		msg->setWindowTitle("Success");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Information);
+		msg.setText(QString("Detected ProChrono data\n\nUsing '%1'").arg(path));
+		msg.setWindowTitle("Success");
+		msg.exec();
 
 		// Proceed to display the data
 		DisplaySeriesData();
+
+		recordHistory();
 	}
 }
 
@@ -2334,6 +3274,10 @@ QList<ChronoSeries *> PowderTest::ExtractProChronoSeries ( QTextStream &csv )
 
 							allSeries.append(curSeries);
 						}
+						else
+						{
+							delete curSeries;
+						}
 
 						qDebug() << "Beginning new series";
 
@@ -2341,7 +3285,7 @@ QList<ChronoSeries *> PowderTest::ExtractProChronoSeries ( QTextStream &csv )
 						curSeries->isValid = true;
 						curSeries->deleted = false;
 						curSeries->seriesNum = -1;
-						curSeries->name = new QLabel(rows.at(0));
+						curSeries->name = rows.at(0);
 						curSeries->velocityUnits = "ft/s";
 					}
 
@@ -2379,6 +3323,10 @@ QList<ChronoSeries *> PowderTest::ExtractProChronoSeries ( QTextStream &csv )
 
 		allSeries.append(curSeries);
 	}
+	else
+	{
+		delete curSeries;
+	}
 
 	// ProChrono files list series in reverse order from newest to oldest. Iterate through and
 	// set the seriesNum's accordingly.
@@ -2450,6 +3398,10 @@ QList<ChronoSeries *> PowderTest::ExtractProChronoSeries_format2 ( QTextStream &
 
 					allSeries.append(curSeries);
 				}
+				else
+				{
+					delete curSeries;
+				}
 
 				qDebug() << "Beginning new series";
 
@@ -2507,6 +3459,10 @@ QList<ChronoSeries *> PowderTest::ExtractProChronoSeries_format2 ( QTextStream &
 
 		allSeries.append(curSeries);
 	}
+	else
+	{
+		delete curSeries;
+	}
 
 	// ProChrono files list series in reverse order from newest to oldest. Iterate through and
 	// set the seriesNum's and names accordingly.
@@ -2515,7 +3471,7 @@ QList<ChronoSeries *> PowderTest::ExtractProChronoSeries_format2 ( QTextStream &
 	{
 		ChronoSeries *series = allSeries.at(i);
 		series->seriesNum = seriesNum;
-		series->name = new QLabel(QString("Series %1").arg(seriesNum));
+		series->name = QString("Series %1").arg(seriesNum);
 		seriesNum++;
 	}
 
@@ -2539,7 +3495,7 @@ void PowderTest::selectShotMarkerFile ( bool state )
 		return;
 	}
 
-	seriesData.clear();
+	clearSeries();
 
 	/*
 	 * ShotMarker only records velocity data in .tar export files
@@ -2557,11 +3513,11 @@ void PowderTest::selectShotMarkerFile ( bool state )
 	{
 		qDebug() << "ShotMarker .csv export, bailing";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText(QString("Only ShotMarker .tar files are supported for velocity data.\n\nSelected: '%1'").arg(path));
-		msg->setWindowTitle("Error");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Only ShotMarker .tar files are supported for velocity data.\n\nSelected: '%1'").arg(path));
+		msg.setWindowTitle("Error");
+		msg.exec();
 
 		return;
 	}
@@ -2572,21 +3528,17 @@ void PowderTest::selectShotMarkerFile ( bool state )
 	{
 		qDebug() << "Detected ShotMarker file";
 
+		importDevice = DEVICE_SHOTMARKER;
+
 		for ( int i = 0; i < allSeries.size(); i++ )
 		{
 			ChronoSeries *series = allSeries.at(i);
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+			series->enabled = true;
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+			series->chargeWeight = 0;
 
-			seriesData.append(series);
+			seriesData.append(arena.adopt(series));
 		}
 	}
 
@@ -2596,31 +3548,32 @@ void PowderTest::selectShotMarkerFile ( bool state )
 	{
 		qDebug() << "Didn't find any shot data in this file, bail";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText(QString("Unable to find ShotMarker data in '%1'").arg(path));
-		msg->setWindowTitle("Error");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Unable to find ShotMarker data in '%1'").arg(path));
+		msg.setWindowTitle("Error");
+		msg.exec();
 	}
 	else
 	{
 		qDebug() << "Detected ShotMarker file" << path;
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Information);
-		msg->setText(QString("Detected ShotMarker data\n\nUsing '%1'").arg(path));
-		msg->setWindowTitle("Success");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Information);
+		msg.setText(QString("Detected ShotMarker data\n\nUsing '%1'").arg(path));
+		msg.setWindowTitle("Success");
+		msg.exec();
 
 		// Proceed to display the data
 		DisplaySeriesData();
+
+		recordHistory();
 	}
 }
 
 QList<ChronoSeries *> PowderTest::ExtractShotMarkerSeriesTar ( QString path )
 {
 	QList<ChronoSeries *> allSeries;
-	ChronoSeries *curSeries = new ChronoSeries();
 	QTemporaryDir tempDir;
 	int ret;
 
@@ -2716,11 +3669,11 @@ QList<ChronoSeries *> PowderTest::ExtractShotMarkerSeriesTar ( QString path )
 
 		qDebug() << "Beginning new series";
 
-		curSeries = new ChronoSeries();
+		ChronoSeries *curSeries = new ChronoSeries();
 		curSeries->isValid = false;
 		curSeries->seriesNum = seriesNum;
 		qDebug() << "name =" << jsonObj["name"].toString();
-		curSeries->name = new QLabel(jsonObj["name"].toString());
+		curSeries->name = jsonObj["name"].toString();
 		curSeries->velocityUnits = "ft/s";
 		curSeries->deleted = false;
 		QDateTime dateTime;
@@ -2766,6 +3719,10 @@ QList<ChronoSeries *> PowderTest::ExtractShotMarkerSeriesTar ( QString path )
 
 			allSeries.append(curSeries);
 		}
+		else
+		{
+			delete curSeries;
+		}
 
 		free(destBuf);
 
@@ -2792,7 +3749,7 @@ void PowderTest::selectGarminFile ( bool state )
 		return;
 	}
 
-	seriesData.clear();
+	clearSeries();
 
 	/*
 	 * Garmin Xero C1 records its series data as CSV, XLSX, or FIT files. Garmin, seriously why is this such a mess.
@@ -2807,7 +3764,8 @@ void PowderTest::selectGarminFile ( bool state )
 	{
 		qDebug() << "Garmin XLSX file";
 	
-		QXlsx::Document xlsx(path);
+		// Only the sheets we read get parsed
+		QXlsx::Document xlsx(path, QXlsx::Document::LoadOnDemand);
 		xlsx.load();
 		
 		qDebug() << "Loaded xlsx doc. sheets: " << xlsx.sheetNames();
@@ -2828,11 +3786,11 @@ void PowderTest::selectGarminFile ( bool state )
 	{
 		qDebug() << "Garmin unsupported file, bailing...";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText(QString("Only Garmin .XLSX and .CSV files are supported.\n\nSelected: '%1'").arg(path));
-		msg->setWindowTitle("Error");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Only Garmin .XLSX and .CSV files are supported.\n\nSelected: '%1'").arg(path));
+		msg.setWindowTitle("Error");
+		msg.exec();
 
 		return;
 	}
@@ -2843,21 +3801,17 @@ void PowderTest::selectGarminFile ( bool state )
 	{
 		qDebug() << "Detected Garmin file";
 
+		importDevice = DEVICE_GARMIN;
+
 		for ( int i = 0; i < allSeries.size(); i++ )
 		{
 			ChronoSeries *series = allSeries.at(i);
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+			series->enabled = true;
 
-			series->chargeWeight = new QDoubleSpinBox();
-			series->chargeWeight->setDecimals(2);
-			series->chargeWeight->setSingleStep(0.1);
-			series->chargeWeight->setMaximum(1000000);
-			series->chargeWeight->setMinimumWidth(100);
-			series->chargeWeight->setMaximumWidth(100);
+			series->chargeWeight = 0;
 
-			seriesData.append(series);
+			seriesData.append(arena.adopt(series));
 		}
 	}
 
@@ -2867,24 +3821,26 @@ void PowderTest::selectGarminFile ( bool state )
 	{
 		qDebug() << "Didn't find any chrono data in this file, bail";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText(QString("Unable to find Garmin data in '%1'").arg(path));
-		msg->setWindowTitle("Error");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Unable to find Garmin data in '%1'").arg(path));
+		msg.setWindowTitle("Error");
+		msg.exec();
 	}
 	else
 	{
 		qDebug() << "Detected Garmin file" << path;
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Information);
-		msg->setText(QString("Detected Garmin data\n\nUsing '%1'").arg(path));
-		msg->setWindowTitle("Success");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Information);
+		msg.setText(QString("Detected Garmin data\n\nUsing '%1'").arg(path));
+		msg.setWindowTitle("Success");
+		msg.exec();
 
 		// Proceed to display the data
 		DisplaySeriesData();
+
+		recordHistory();
 	}
 
 }
@@ -2929,7 +3885,7 @@ QList<ChronoSeries *> PowderTest::ExtractGarminSeries_xlsx ( QXlsx::Document &xl
 		curSeries->firstTime = QString("");
 		
 		qDebug() << "Series name:" << worksheet->read(1,1).toString();
-		curSeries->name = new QLabel(worksheet->read(1, 1).toString());
+		curSeries->name = worksheet->read(1, 1).toString();
 		
 		// Unit of measure
 		if ( worksheet->read(2, 2).toString().contains("FPS") )
@@ -2996,6 +3952,10 @@ QList<ChronoSeries *> PowderTest::ExtractGarminSeries_xlsx ( QXlsx::Document &xl
 
 			allSeries.append(curSeries);
 		}
+		else
+		{
+			delete curSeries;
+		}
 		
 		i += 1;
 	}
@@ -3090,7 +4050,7 @@ QList<ChronoSeries *> PowderTest::ExtractGarminSeries_csv ( QTextStream &csv )
 			if ( i == 0 )
 			{
 				qDebug() << "Series name:" << cols.at(0);
-				curSeries->name = new QLabel(cols.at(0));
+				curSeries->name = cols.at(0);
 			}
 			// Unit of measure in second row, second column
 			else if ( i == 1 )
@@ -3150,6 +4110,7 @@ QList<ChronoSeries *> PowderTest::ExtractGarminSeries_csv ( QTextStream &csv )
 	if ( curSeries->muzzleVelocities.empty() )
 	{
 		qDebug() << "Series has no velocities, returning invalid.";
+		delete curSeries;
 		return allSeries;
 	}
 
@@ -3167,7 +4128,7 @@ RoundRobinDialog::RoundRobinDialog ( PowderTest *main, QDialog *parent )
 
 	QLabel *label = new QLabel();
 	label->setTextFormat(Qt::RichText);
-	label->setText("<p>This feature handles chronograph data recorded using the \"round-robin\" method popular with <a href=\"http://www.ocwreloading.com/\">OCW testing</a>.<p>For example a shooter might record three chronograph series, where each series contains 10 shots with 10 different charge weights. Use this feature to \"convert\" the data back into 10 series of three-shot strings.<p>Data recorded using the <a href=\"http://www.65guys.com/10-round-load-development-ladder-test/\">Satterlee method</a> can be converted by using this feature with only a single series enabled (rather than multiple).<p>Note: This will <i>not</i> alter your CSV files, this only converts the data loaded in ChronoPlotter. If converting multiple series, it's assumed that charge weights are shot in the same order in each series.<br>");
+	label->setText("<p>This feature handles chronograph data recorded using the \"round-robin\" method popular with <a href=\"http://www.ocwreloading.com/\">OCW testing</a>.<p>For example a shooter might record three chronograph series, where each series contains 10 shots with 10 different charge weights. Use this feature to \"convert\" the data back into 10 series of three-shot strings.<p>Data recorded using the <a href=\"http://www.65guys.com/10-round-load-development-ladder-test/\">Satterlee method</a> can be converted by using this feature with only a single series enabled (rather than multiple).<p>Note: This will <i>not</i> alter your CSV files, this only converts the data loaded in ChronoPlotter. If converting multiple series, it's assumed that charge weights are shot in the same order in each series.<p>Series that repeat every charge weight over several rounds can be converted by lowering the number of charge weights per round. If charge weights weren't shot in order, enter the order they were shot in. Series don't need the same number of shots.<br>");
 	label->setOpenExternalLinks(true);
 	label->setWordWrap(true);
 
@@ -3175,64 +4136,193 @@ RoundRobinDialog::RoundRobinDialog ( PowderTest *main, QDialog *parent )
 	layout->addWidget(label);
 	layout->addWidget(new QHLine());
 
-	QList<QList<double> > seriesVelocs;
 	for ( int i = 0; i < main->seriesData.size(); i++ )
 	{
 		ChronoSeries *series = main->seriesData.at(i);
-		if ( series->enabled->isChecked() )
+		if ( series->enabled && (! series->deleted) )
 		{
-			seriesVelocs.append(series->muzzleVelocities);
+			numVelocs.append(series->muzzleVelocities.size());
 		}
 	}
 
-	qDebug() << "Number of enabled series:" << seriesVelocs.size();
-	qDebug() << "seriesVelocs:" << seriesVelocs;
-
-	QList<int> numVelocs;
-	for ( int i = 0; i < seriesVelocs.size(); i++ )
-	{
-		numVelocs.append(seriesVelocs.at(i).size());
-	}
-
 	qDebug() << "numVelocs:" << numVelocs;
 
-	bool equalLens = std::equal(numVelocs.begin() + 1, numVelocs.end(), numVelocs.begin());
-
-	qDebug() << "equalLens:" << equalLens;
+	int fewest = numVelocs.isEmpty() ? 0 : *std::min_element(numVelocs.begin(), numVelocs.end());
+	int most = numVelocs.isEmpty() ? 0 : *std::max_element(numVelocs.begin(), numVelocs.end());
 
 	QLabel *detected = new QLabel();
+	detected->setTextFormat(Qt::RichText);
+	detected->setWordWrap(true);
+
 	QDialogButtonBox *buttonBox;
 
-	if ( equalLens )
+	loadsPerRound = new QSpinBox();
+	order = new QLineEdit();
+	summary = new QLabel();
+	okButton = NULL;
+
+	if ( most > 0 )
 	{
-		detected->setText(QString("<center><br>Detected <b>%1</b> enabled series of <b>%2</b> shots each.<p>Click <b>OK</b> to convert this data into <b>%3</b> series of <b>%4</b> shots each.<br>").arg(seriesVelocs.size()).arg(numVelocs.at(0)).arg(numVelocs.at(0)).arg(seriesVelocs.size()));
+		if ( fewest == most )
+		{
+			detected->setText(QString("<center><br>Detected <b>%1</b> enabled series of <b>%2</b> shots each.").arg(numVelocs.size()).arg(most));
+		}
+		else
+		{
+			detected->setText(QString("<center><br>Detected <b>%1</b> enabled series of <b>%2</b> to <b>%3</b> shots.").arg(numVelocs.size()).arg(fewest).arg(most));
+		}
+
+		// One round per series by default. Fewer charge weights per round means each series holds several rounds.
+		loadsPerRound->setRange(1, most);
+		loadsPerRound->setValue(most);
+		loadsPerRound->setMinimumWidth(100);
+		loadsPerRound->setMaximumWidth(100);
+
+		order->setPlaceholderText("In order, e.g. 1, 2, 3");
+
+		QFormLayout *formLayout = new QFormLayout();
+		formLayout->addRow(new QLabel("Charge weights per round:"), loadsPerRound);
+		formLayout->addRow(new QLabel("Firing order:"), order);
+
+		summary->setTextFormat(Qt::RichText);
+		summary->setWordWrap(true);
 
 		buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+		okButton = buttonBox->button(QDialogButtonBox::Ok);
 		connect(buttonBox, &QDialogButtonBox::accepted, this, &RoundRobinDialog::accept);
 		connect(buttonBox, &QDialogButtonBox::rejected, this, &RoundRobinDialog::reject);
 
+		connect(loadsPerRound, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, [=] ( void ) { updateSummary(); });
+		connect(order, &QLineEdit::textChanged, this, [=] ( void ) { updateSummary(); });
+
+		layout->addWidget(detected);
+		layout->addLayout(formLayout);
+		layout->addWidget(summary);
+
+		updateSummary();
 	}
 	else
 	{
-		detected->setText(QString("<center><br>Detected <b>%1</b> enabled series of <b>different</b> lengths.<p>Series with the same number of shots are required to convert.<br>").arg(seriesVelocs.size()));
+		detected->setText("<center><br>No enabled series with shots to convert.<br>");
 
 		buttonBox = new QDialogButtonBox(QDialogButtonBox::Close);
 		connect(buttonBox, &QDialogButtonBox::rejected, this, &RoundRobinDialog::reject);
+
+		layout->addWidget(detected);
 	}
 
-	detected->setTextFormat(Qt::RichText);
-	detected->setWordWrap(true);
-	layout->addWidget(detected);
 	layout->addWidget(buttonBox);
 	setLayout(layout);
 
 	setFixedSize(sizeHint());
 }
 
+/*
+ * Describes the series the current settings would produce, counted without converting anything
+ */
+void RoundRobinDialog::updateSummary ( void )
+{
+	int loads = loadsPerRound->value();
+
+	bool ok;
+	RoundRobin::parseOrder(order->text(), loads, &ok);
+
+	if ( ! ok )
+	{
+		summary->setText(QString("<center><br>Firing order must list each charge weight from <b>1</b> to <b>%1</b> once.<br>").arg(loads));
+		okButton->setEnabled(false);
+		return;
+	}
+
+	// Charge weights early in the firing order get one more shot from series that end partway through a round
+	int fewest = -1;
+	int most = 0;
+	for ( int position = 0; position < loads; position++ )
+	{
+		int shots = 0;
+		for ( int i = 0; i < numVelocs.size(); i++ )
+		{
+			shots += (numVelocs.at(i) / loads) + ((position < numVelocs.at(i) % loads) ? 1 : 0);
+		}
+
+		fewest = (fewest == -1) ? shots : qMin(fewest, shots);
+		most = qMax(most, shots);
+	}
+
+	if ( fewest == most )
+	{
+		summary->setText(QString("<center><br>Click <b>OK</b> to convert this data into <b>%1</b> series of <b>%2</b> shots each.<br>").arg(loads).arg(most));
+	}
+	else
+	{
+		summary->setText(QString("<center><br>Click <b>OK</b> to convert this data into <b>%1</b> series of <b>%2</b> to <b>%3</b> shots.<br>").arg(loads).arg(fewest).arg(most));
+	}
+
+	okButton->setEnabled(true);
+}
+
+QVector<int> RoundRobinDialog::firingOrder ( void )
+{
+	bool ok;
+	return RoundRobin::parseOrder(order->text(), loadsPerRound->value(), &ok);
+}
+
+/*
+ * A series' shots with the excluded ones put back where they were taken out, flagging which those were
+ */
+static QList<double> withExcludedShots ( ChronoSeries *series, QVector<bool> *excluded )
+{
+	QList<double> shots = series->muzzleVelocities;
+	QList<bool> flags;
+	for ( int i = 0; i < shots.size(); i++ )
+	{
+		flags.append(false);
+	}
+
+	// Newest first, the same as restoreShotsClicked()
+	for ( int i = series->excludedShots.size() - 1; i >= 0; i-- )
+	{
+		int index = qMin(series->excludedShots.at(i).first, shots.size());
+		shots.insert(index, series->excludedShots.at(i).second);
+		flags.insert(index, true);
+	}
+
+	*excluded = flags.toVector();
+
+	return shots;
+}
+
+/*
+ * Sets a series' shots, taking the flagged ones out as excluded the same way excludeOutliersClicked() does
+ */
+static void setShotsExcluding ( ChronoSeries *series, const QList<double> &shots, const QVector<bool> &excluded )
+{
+	series->muzzleVelocities.clear();
+	series->excludedShots.clear();
+
+	for ( int i = 0; i < shots.size(); i++ )
+	{
+		if ( excluded.at(i) )
+		{
+			series->excludedShots.append(qMakePair(series->muzzleVelocities.size(), shots.at(i)));
+		}
+		else
+		{
+			series->muzzleVelocities.append(shots.at(i));
+		}
+	}
+}
+
 void PowderTest::rrClicked ( bool state )
 {
 	qDebug() << "rrClicked state =" << state;
 
+	if ( ! rrOriginalSeries.isEmpty() )
+	{
+		undoRoundRobin();
+		return;
+	}
+
 	RoundRobinDialog *dialog = new RoundRobinDialog(this);
 	int result = dialog->exec();
 
@@ -3242,46 +4332,69 @@ void PowderTest::rrClicked ( bool state )
 	{
 		qDebug() << "Performing series conversion";
 
-		QList<QList<double> > enabledSeriesVelocs;
+		// Excluded shots still hold their place in the firing order, so they're converted along with the rest and stay excluded
+		QVector<QList<double> > strings;
+		QVector<QVector<bool> > excluded;
+		ChronoSeries *first = NULL;
 		for ( int i = 0; i < seriesData.size(); i++ )
 		{
 			ChronoSeries *series = seriesData.at(i);
-			if ( series->enabled->isChecked() )
+			if ( series->enabled && (! series->deleted) )
 			{
-				enabledSeriesVelocs.append(series->muzzleVelocities);
+				QVector<bool> flags;
+				strings.append(withExcludedShots(series, &flags));
+				excluded.append(flags);
+				if ( first == NULL )
+				{
+					first = series;
+				}
 			}
 		}
 
-		// Iterate the number of velocities in the enabled series
+		rrConversion = RoundRobin::transpose(strings, dialog->numLoads(), dialog->firingOrder());
+
 		QList<ChronoSeries *> newSeriesData;
-		for ( int i = 0; i < enabledSeriesVelocs.at(0).size(); i++ )
+		for ( int i = 0; i < rrConversion.loads.size(); i++ )
 		{
-			// Grab the Xth velocity in each of the enabled series and create a new series with them
-			QList<double> newVelocs;
-			for ( int j = 0; j < enabledSeriesVelocs.size(); j++ )
+			ChronoSeries *newSeries = new ChronoSeries();
+
+			newSeries->isValid = true;
+
+			newSeries->seriesNum = i;
+
+			newSeries->name = QString("Series %1").arg(i + 1);
+
+			QVector<bool> flags;
+			for ( int j = 0; j < rrConversion.loads.at(i).size(); j++ )
 			{
-				newVelocs.append(enabledSeriesVelocs.at(j).at(i));
+				const RoundRobin::Source &source = rrConversion.sources.at(i).at(j);
+				flags.append(excluded.at(source.string).at(source.shot));
 			}
+			setShotsExcluding(newSeries, rrConversion.loads.at(i), flags);
 
-			ChronoSeries *newSeries = new ChronoSeries();
+			newSeries->velocityUnits = first->velocityUnits;
 
-			newSeries->seriesNum = i;
+			newSeries->firstDate = first->firstDate;
 
-			newSeries->name = new QLabel(QString("Series %1").arg(i + 1));
+			newSeries->firstTime = first->firstTime;
 
-			newSeries->muzzleVelocities = newVelocs;
+			newSeries->enabled = true;
 
-			newSeries->enabled = new QCheckBox();
-			newSeries->enabled->setChecked(true);
+			newSeries->chargeWeight = 0;
 
-			newSeries->chargeWeight = new QDoubleSpinBox();
-			newSeries->chargeWeight->setDecimals(2);
-			newSeries->chargeWeight->setSingleStep(0.1);
-			newSeries->chargeWeight->setMaximum(1000000);
-			newSeries->chargeWeight->setMinimumWidth(100);
-			newSeries->chargeWeight->setMaximumWidth(100);
+			newSeriesData.append(arena.adopt(newSeries));
+		}
 
-			newSeriesData.append(newSeries);
+		// Keep the series as loaded so the conversion can be undone. Their shots now live in the converted series.
+		rrOriginalSeries = seriesData;
+		for ( int i = 0; i < rrOriginalSeries.size(); i++ )
+		{
+			ChronoSeries *series = rrOriginalSeries.at(i);
+			if ( series->enabled && (! series->deleted) )
+			{
+				series->muzzleVelocities.clear();
+				series->excludedShots.clear();
+			}
 		}
 
 		// Replace the current series data with the new one
@@ -3294,6 +4407,79 @@ void PowderTest::rrClicked ( bool state )
 	{
 		qDebug() << "Not performing series conversion";
 	}
+
+	delete dialog;
+}
+
+/*
+ * Hands every converted shot back to the series it was loaded from and shows those series again. Excluded shots stay excluded
+ * in the series they go back to. The shots come from the conversion, so other changes to the converted series since (deleted
+ * rows) are lost, and the user is asked first.
+ */
+void PowderTest::undoRoundRobin ( void )
+{
+	qDebug() << "Undoing round-robin conversion";
+
+	QVector<QVector<bool> > excluded(rrConversion.stringSizes.size());
+	for ( int i = 0; i < excluded.size(); i++ )
+	{
+		excluded[i].fill(false, rrConversion.stringSizes.at(i));
+	}
+
+	bool modified = (seriesData.size() != rrConversion.loads.size());
+	for ( int i = 0; (! modified) && (i < seriesData.size()); i++ )
+	{
+		ChronoSeries *series = seriesData.at(i);
+
+		QVector<bool> flags;
+		QList<double> shots = withExcludedShots(series, &flags);
+
+		modified = series->deleted || (shots != rrConversion.loads.at(series->seriesNum));
+		for ( int j = 0; (! modified) && (j < flags.size()); j++ )
+		{
+			if ( flags.at(j) )
+			{
+				const RoundRobin::Source &source = rrConversion.sources.at(series->seriesNum).at(j);
+				excluded[source.string][source.shot] = true;
+			}
+		}
+	}
+
+	if ( modified )
+	{
+		QMessageBox::StandardButton reply;
+		reply = QMessageBox::question(this, "Undo round-robin conversion", "The converted series have been changed since the conversion.\n\nUndoing it will restore every shot as it was loaded and discard those changes.", QMessageBox::Yes | QMessageBox::Cancel);
+
+		if ( reply != QMessageBox::Yes )
+		{
+			qDebug() << "User cancelled undo";
+			return;
+		}
+
+		for ( int i = 0; i < excluded.size(); i++ )
+		{
+			excluded[i].fill(false);
+		}
+	}
+
+	QVector<QList<double> > strings = RoundRobin::restore(rrConversion);
+
+	int next = 0;
+	for ( int i = 0; i < rrOriginalSeries.size(); i++ )
+	{
+		ChronoSeries *series = rrOriginalSeries.at(i);
+		if ( series->enabled && (! series->deleted) )
+		{
+			setShotsExcluding(series, strings.at(next), excluded.at(next));
+			next++;
+		}
+	}
+
+	seriesData = rrOriginalSeries;
+	rrOriginalSeries.clear();
+	rrConversion = RoundRobin::Conversion();
+
+	DisplaySeriesData();
 }
 
 AutofillDialog::AutofillDialog ( PowderTest *main, QDialog *parent )
@@ -3396,10 +4582,10 @@ void PowderTest::autofillClicked ( bool state )
 		for ( int i = 0; i < seriesData.size(); i++ )
 		{
 			ChronoSeries *series = seriesData.at(i);
-			if ( (! series->deleted) && series->enabled->isChecked() )
+			if ( (! series->deleted) && series->enabled )
 			{
 				qDebug() << "Setting series" << i << "to" << currentCharge;
-				series->chargeWeight->setValue(currentCharge);
+				series->chargeWeight = currentCharge;
 				if ( values->increasing )
 				{
 					currentCharge += values->interval;
@@ -3410,9 +4596,15 @@ void PowderTest::autofillClicked ( bool state )
 				}
 			}
 		}
+
+		delete values;
+
+		seriesModel->refresh();
 	}
 	else
 	{
 		qDebug() << "User cancelled dialog";
 	}
+
+	delete dialog;
 }
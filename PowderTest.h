@@ -1,3 +1,6 @@
+#ifndef POWDERTEST_H
+#define POWDERTEST_H
+
 #include <QWidget>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -13,11 +16,14 @@
 #include <QPushButton>
 #include <QStackedWidget>
 #include <QDoubleSpinBox>
+#include <QSpinBox>
 #include <QScrollArea>
 #include <QGridLayout>
 #include <QDialog>
 #include <QMainWindow>
 #include <QTextEdit>
+#include <QAbstractTableModel>
+#include <QTableView>
 
 #include "xlsxdocument.h"
 #include "xlsxchartsheet.h"
@@ -27,6 +33,8 @@
 #include "xlsxworkbook.h"
 
 #include "ChronoPlotter.h"
+#include "RoundRobin.h"
+#include "SeriesArena.h"
 
 namespace Powder
 {
@@ -34,28 +42,50 @@ namespace Powder
 	{
 		bool isValid;
 		int seriesNum;
-		QLabel *name;
+		QString name;
 		QList<double> muzzleVelocities;
+		QVector<quint8> outlierFlags; // Outliers:: test bits for each shot in muzzleVelocities
+		QList<QPair<int, double> > excludedShots; // flagged shots taken out and the index each goes back to, most recent last
 		QString velocityUnits;
-		QLabel *result;
 		QString firstDate;
 		QString firstTime;
-		QDoubleSpinBox *chargeWeight;
-		QPushButton *enterDataButton;
-		QPushButton *deleteButton;
-		QCheckBox *enabled;
+		double chargeWeight;
+		bool enabled;
 		bool deleted;
 	};
 
+	class SeriesModel;
+
 	class PowderTest : public QWidget
 	{
 		Q_OBJECT
 
 		public:
 			PowderTest(QWidget *parent = 0);
-			~PowderTest() {};
+			~PowderTest() { delete graphPreview; };
 			QList<ChronoSeries *> seriesData;
 			QComboBox *weightUnits;
+			bool headless; // report problems through errors and warnings instead of dialogs
+			QStringList errors;
+			QStringList warnings;
+			bool importLabRadar ( const QString & );
+			bool importLabRadarSeries ( const QList<ChronoSeries *> &, const QStringList & );
+			void copyGraphOptions ( PowderTest * );
+			void setGraphTitle ( const QString & );
+			QVariantMap saveOptions ( void );
+			bool isManualEntry ( void );
+			PowderTest *scratchCopy ( void );
+			void restoreProject ( const QVariantMap &, const QList<ChronoSeries *> &, bool );
+			void graphHistory ( const QVariantMap &, const QList<ChronoSeries *> & );
+			bool populatePlot ( void );
+			bool exportGraph ( const QString & );
+			QByteArray renderKey ( void );
+			QImage renderImage ( void );
+			void paintGraph ( QCPPainter * );
+			QSize graphSize ( void ) { return canvasSize; };
+			QList<QStringList> seriesTable ( void );
+			QList<QPair<QString, QString> > reportDetails ( void );
+			static QList<ChronoSeries *> ReadLabRadarDirectory ( QString &, QStringList & );
 
 		public slots:
 			void esCheckBoxChanged(bool);
@@ -73,30 +103,75 @@ namespace Powder
 			void manualDataEntry(bool);
 			void rrClicked(bool);
 			void addNewClicked(bool);
-			void enterDataClicked(bool);
-			void deleteClicked(bool);
 			void autofillClicked(bool);
+			void excludeOutliersClicked(bool);
+			void restoreShotsClicked(bool);
 			void velocityUnitsChanged(int);
 			void headerCheckBoxChanged(int);
-			void seriesCheckBoxChanged(int);
-			void seriesManualCheckBoxChanged(int);
 			void showGraph(bool);
 			void saveGraph(bool);
+			void batchExportClicked(bool);
 
 		protected:
 			void optionCheckBoxChanged(QCheckBox *, QLabel *, QComboBox *);
-			ChronoSeries *ExtractLabRadarSeries ( QTextStream & );
+			QList<QPair<QString, QWidget *> > optionWidgets ( void );
+			void unloadData ( void );
+			void showManualEntry ( void );
+			void AddLabRadarSeries ( const QList<ChronoSeries *> &, const QStringList & );
+			QString LoadLabRadarDirectory ( QString );
+			static ChronoSeries *ExtractLabRadarSeries ( QTextStream & );
 			QList<ChronoSeries *> ExtractMagnetoSpeedSeries ( QTextStream & );
 			QList<ChronoSeries *> ExtractProChronoSeries ( QTextStream & );
 			QList<ChronoSeries *> ExtractProChronoSeries_format2 ( QTextStream & );
 			QList<ChronoSeries *> ExtractGarminSeries_xlsx ( QXlsx::Document & );
 			QList<ChronoSeries *> ExtractGarminSeries_csv ( QTextStream & );
 			QList<ChronoSeries *> ExtractShotMarkerSeriesTar ( QString );
+			void clearSeries ( void );
 			void DisplaySeriesData ( void );
+			void addSeriesButtons ( int );
+			void updateSeriesButtons ( int, int );
+			void enterDataClicked ( ChronoSeries * );
+			void deleteClicked ( ChronoSeries * );
+			void DetectOutliers ( void );
+			void undoRoundRobin ( void );
+			void setupPlot ( void );
+			QCPItemText *annotationItem ( QList<QCPItemText *> &, QList<QCPItemTracer *> &, int );
+			void updateTrendLine ( void );
+			void updateDensity ( void );
+			void updateAnnotations ( void );
+			void replotAnnotations ( void );
+			void replotTrendLine ( void );
+			void reportError ( const QString & );
 			void renderGraph ( bool );
+			void recordHistory ( void );
 
 		private:
 			GraphPreview *graphPreview;
+			QByteArray plottedKey; // renderKey() of what the plot currently shows
+			QSize canvasSize; // export size, worked out from the graph contents on each render
+			QCustomPlot *customPlot;
+			QCPTextElement *plotTitle;
+			QCPTextElement *plotSubtitle;
+			QCPGraph *averageLine;
+			QCPGraph *scatterPlot;
+			QCPErrorBars *errorBars;
+			QCPGraph *trendLine;
+			QList<QCPItemRect *> rangeRects;
+			QList<QCPCurve *> densityCurves;
+			bool densityMode; // scatter plot drawn as one violin per string, see DENSITY_THRESHOLD
+			QList<QCPItemText *> aboveAnnotations;
+			QList<QCPItemText *> belowAnnotations;
+			QList<QCPItemTracer *> aboveAnchors;
+			QList<QCPItemTracer *> belowAnchors;
+			SeriesArena<ChronoSeries> arena; // owns every series in seriesData, rrOriginalSeries and graphedSeries
+			QList<ChronoSeries *> graphedSeries;
+			QList<ChronoSeries *> rrOriginalSeries; // series as loaded, kept while round-robin converted series are shown
+			RoundRobin::Conversion rrConversion;
+			bool fromHistory; // seriesData came out of the load history, so there's nothing new to record
+			int importDevice; // DEVICE_ value for the chronograph seriesData was read from
+			QVector<double> graphedX;
+			QVector<double> trendXPoints;
+			QVector<double> trendYPoints;
 			QString prevLabRadarDir;
 			QString prevMagnetoSpeedDir;
 			QString prevProChronoDir;
@@ -105,9 +180,8 @@ namespace Powder
 			QString prevSaveDir;
 			QStackedWidget *stackedWidget;
 			QWidget *scrollWidget;
-			QScrollArea *scrollArea;
-			QGridLayout *seriesGrid;
-			QLabel *headerResult;
+			QTableView *seriesView;
+			SeriesModel *seriesModel;
 			QLineEdit *graphTitle;
 			QLineEdit *rifle;
 			QLineEdit *projectile;
@@ -116,6 +190,8 @@ namespace Powder
 			QLineEdit *primer;
 			QLineEdit *weather;
 			QPushButton *addNewButton;
+			QPushButton *excludeOutliersButton;
+			QPushButton *restoreShotsButton;
 			QComboBox *graphType;
 			QComboBox *velocityUnits;
 			QComboBox *xAxisSpacing;
@@ -136,6 +212,37 @@ namespace Powder
 			QLabel *trendLabel;
 	};
 
+	/*
+	 * The loaded series as a table. Rows are read straight out of the tab's seriesData, so the view only ever touches the rows
+	 * it has on screen. Manually entered series get two more columns, which the tab fills with buttons.
+	 */
+	class SeriesModel : public QAbstractTableModel
+	{
+		Q_OBJECT
+
+		public:
+			enum Column { ENABLED_COLUMN, NAME_COLUMN, WEIGHT_COLUMN, RESULT_COLUMN, DATE_COLUMN, ENTER_DATA_COLUMN = DATE_COLUMN, DELETE_COLUMN };
+
+			SeriesModel(QList<ChronoSeries *> *, QObject *parent = 0);
+			~SeriesModel() {};
+			void reload ( bool );
+			void appendSeries ( ChronoSeries * );
+			void refresh ( void );
+			void refreshSeries ( ChronoSeries * );
+			void setAllEnabled ( bool );
+			bool isManual ( void ) const { return manual; };
+			int rowCount ( const QModelIndex &parent = QModelIndex() ) const;
+			int columnCount ( const QModelIndex &parent = QModelIndex() ) const;
+			QVariant data ( const QModelIndex &, int role = Qt::DisplayRole ) const;
+			QVariant headerData ( int, Qt::Orientation, int role = Qt::DisplayRole ) const;
+			Qt::ItemFlags flags ( const QModelIndex & ) const;
+			bool setData ( const QModelIndex &, const QVariant &, int role = Qt::EditRole );
+
+		private:
+			QList<ChronoSeries *> *seriesData;
+			bool manual; // rows were entered by hand rather than loaded from a file
+	};
+
 	class RoundRobinDialog : public QDialog
 	{
 		Q_OBJECT
@@ -143,6 +250,16 @@ namespace Powder
 		public:
 			RoundRobinDialog(PowderTest *, QDialog *parent = 0);
 			~RoundRobinDialog() {};
+			int numLoads ( void ) { return loadsPerRound->value(); };
+			QVector<int> firingOrder ( void );
+
+		private:
+			void updateSummary ( void );
+			QList<int> numVelocs;
+			QSpinBox *loadsPerRound;
+			QLineEdit *order;
+			QLabel *summary;
+			QPushButton *okButton;
 	};
 
 	class EnterVelocitiesDialog : public QDialog
@@ -184,3 +301,5 @@ namespace Powder
 			QComboBox *direction;
 	};
 };
+
+#endif // POWDERTEST_H
@@ -0,0 +1,561 @@
+#include <cstring>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDataStream>
+#include <QElapsedTimer>
+
+#include "Project.h"
+#include "PowderTest.h"
+#include "SeatingDepthTest.h"
+#include "TunerTest.h"
+
+// Bump when the layout changes in a way older versions can't read. Adding keys to the series or option maps doesn't need it.
+#define PROJECT_VERSION 1
+
+static const char projectMagic[8] = { 'C', 'h', 'r', 'o', 'n', 'o', 'P', 'J' };
+
+// Magic, version, byte order mark and the size of the details block
+#define HEADER_SIZE 24
+
+// Written in native byte order, so a file from a machine of the other endianness reads back swapped
+#define BYTE_ORDER_MARK 0x01020304
+
+/*
+ * Shots of every series, back to back. Series record where theirs start and how many values they take up.
+ */
+struct ShotWriter
+{
+	QVector<double> values;
+
+	void append ( QVariantMap &series, const QString &key, const QList<double> &shots )
+	{
+		series.insert(key + "Offset", (qint64)values.size());
+		series.insert(key + "Count", shots.size());
+
+		for ( int i = 0; i < shots.size(); i++ )
+		{
+			values.append(shots.at(i));
+		}
+	};
+
+	// Coordinates are stored as x, y pairs
+	void append ( QVariantMap &series, const QString &key, const QList<QPair<double, double> > &shots )
+	{
+		series.insert(key + "Offset", (qint64)values.size());
+		series.insert(key + "Count", shots.size() * 2);
+
+		for ( int i = 0; i < shots.size(); i++ )
+		{
+			values.append(shots.at(i).first);
+			values.append(shots.at(i).second);
+		}
+	};
+};
+
+/*
+ * Reads shots out of the mapped file. Anything pointing past the end of the shot block marks the whole file as bad.
+ */
+struct ShotReader
+{
+	const double *values;
+	qint64 size;
+	bool ok;
+
+	const double *find ( const QVariantMap &series, const QString &key, qint64 &count )
+	{
+		qint64 offset = series.value(key + "Offset").toLongLong();
+		count = series.value(key + "Count").toLongLong();
+
+		if ( (offset < 0) || (count < 0) || (offset + count > size) )
+		{
+			ok = false;
+			count = 0;
+			return NULL;
+		}
+
+		return values + offset;
+	};
+
+	QList<double> velocities ( const QVariantMap &series, const QString &key )
+	{
+		qint64 count;
+		const double *shots = find(series, key, count);
+
+		QList<double> list;
+		list.reserve(count);
+		for ( qint64 i = 0; i < count; i++ )
+		{
+			list.append(shots[i]);
+		}
+
+		return list;
+	};
+
+	QList<QPair<double, double> > coordinates ( const QVariantMap &series, const QString &key )
+	{
+		qint64 count;
+		const double *shots = find(series, key, count);
+
+		QList<QPair<double, double> > list;
+		list.reserve(count / 2);
+		for ( qint64 i = 0; i + 1 < count; i += 2 )
+		{
+			list.append(QPair<double, double>(shots[i], shots[i + 1]));
+		}
+
+		return list;
+	};
+};
+
+/* Series to and from their saved details */
+
+static QVariantMap saveSeries ( Powder::ChronoSeries *series, ShotWriter &shots )
+{
+	QVariantMap map;
+	map.insert("seriesNum", series->seriesNum);
+	map.insert("name", series->name);
+	map.insert("velocityUnits", series->velocityUnits);
+	map.insert("firstDate", series->firstDate);
+	map.insert("firstTime", series->firstTime);
+	map.insert("chargeWeight", series->chargeWeight);
+	map.insert("enabled", series->enabled);
+	shots.append(map, "velocities", series->muzzleVelocities);
+
+	// Excluded shots, oldest first, so they can still be restored after the project is opened again
+	QVariantList excludedIndexes;
+	QList<double> excluded;
+	for ( int i = 0; i < series->excludedShots.size(); i++ )
+	{
+		excludedIndexes.append(series->excludedShots.at(i).first);
+		excluded.append(series->excludedShots.at(i).second);
+	}
+	map.insert("excludedIndexes", excludedIndexes);
+	shots.append(map, "excluded", excluded);
+
+	return map;
+}
+
+static Powder::ChronoSeries *loadPowderSeries ( const QVariantMap &map, ShotReader &shots )
+{
+	Powder::ChronoSeries *series = new Powder::ChronoSeries();
+	series->isValid = true;
+	series->seriesNum = map.value("seriesNum").toInt();
+	series->name = map.value("name").toString();
+	series->velocityUnits = map.value("velocityUnits").toString();
+	series->firstDate = map.value("firstDate").toString();
+	series->firstTime = map.value("firstTime").toString();
+	series->chargeWeight = map.value("chargeWeight").toDouble();
+	series->enabled = map.value("enabled").toBool();
+	series->muzzleVelocities = shots.velocities(map, "velocities");
+
+	QVariantList excludedIndexes = map.value("excludedIndexes").toList();
+	QList<double> excluded = shots.velocities(map, "excluded");
+	for ( int i = 0; i < qMin(excludedIndexes.size(), excluded.size()); i++ )
+	{
+		series->excludedShots.append(qMakePair(excludedIndexes.at(i).toInt(), excluded.at(i)));
+	}
+
+	return series;
+}
+
+/*
+ * Seating depth and tuner groups share everything but the value being tested
+ */
+template <typename T>
+static QVariantMap saveGroupSeries ( T *series, ShotWriter &shots )
+{
+	QVariantMap map;
+	map.insert("seriesNum", series->seriesNum);
+	map.insert("name", series->name);
+	map.insert("targetDistance", series->targetDistance);
+	map.insert("firstDate", series->firstDate);
+	map.insert("firstTime", series->firstTime);
+	map.insert("manual", series->manual);
+	map.insert("groupSize", series->groupSize);
+	map.insert("enabled", series->enabled);
+	shots.append(map, "coordinates", series->coordinates);
+	shots.append(map, "sighters", series->coordinates_sighters);
+
+	QVariantList excludedIndexes;
+	QVariantList excludedSighterIndexes;
+	QList<QPair<double, double> > excluded;
+	for ( int i = 0; i < series->excludedShots.size(); i++ )
+	{
+		excludedIndexes.append(series->excludedShots.at(i).index);
+		excludedSighterIndexes.append(series->excludedShots.at(i).sighterIndex);
+		excluded.append(series->excludedShots.at(i).coordinates);
+	}
+	map.insert("excludedIndexes", excludedIndexes);
+	map.insert("excludedSighterIndexes", excludedSighterIndexes);
+	shots.append(map, "excluded", excluded);
+
+	return map;
+}
+
+template <typename T>
+static T *loadGroupSeries ( const QVariantMap &map, ShotReader &shots )
+{
+	T *series = new T();
+	series->isValid = true;
+	series->seriesNum = map.value("seriesNum").toInt();
+	series->name = map.value("name").toString();
+	series->targetDistance = map.value("targetDistance").toInt();
+	series->firstDate = map.value("firstDate").toString();
+	series->firstTime = map.value("firstTime").toString();
+	series->manual = map.value("manual").toBool();
+	series->groupSize = map.value("groupSize").toDouble();
+	series->enabled = map.value("enabled").toBool();
+	series->coordinates = shots.coordinates(map, "coordinates");
+	series->coordinates_sighters = shots.coordinates(map, "sighters");
+
+	QVariantList excludedIndexes = map.value("excludedIndexes").toList();
+	QVariantList excludedSighterIndexes = map.value("excludedSighterIndexes").toList();
+	QList<QPair<double, double> > excluded = shots.coordinates(map, "excluded");
+	for ( int i = 0; i < qMin(qMin(excludedIndexes.size(), excludedSighterIndexes.size()), excluded.size()); i++ )
+	{
+		series->excludedShots.append({ excludedIndexes.at(i).toInt(), excludedSighterIndexes.at(i).toInt(), excluded.at(i) });
+	}
+
+	return series;
+}
+
+bool Project::save ( const QString &path, Powder::PowderTest *powderTest, SeatingDepth::SeatingDepthTest *seatingTest, Tuner::TunerTest *tunerTest, QString *error )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	ShotWriter shots;
+
+	/* Details of every tab */
+
+	QVariantList powderSeries;
+	for ( int i = 0; i < powderTest->seriesData.size(); i++ )
+	{
+		if ( ! powderTest->seriesData.at(i)->deleted )
+		{
+			powderSeries.append(saveSeries(powderTest->seriesData.at(i), shots));
+		}
+	}
+
+	QVariantList seatingSeries;
+	for ( int i = 0; i < seatingTest->seatingSeriesData.size(); i++ )
+	{
+		SeatingDepth::SeatingSeries *series = seatingTest->seatingSeriesData.at(i);
+		if ( ! series->deleted )
+		{
+			QVariantMap map = saveGroupSeries(series, shots);
+			map.insert("cartridgeLength", series->cartridgeLength);
+			seatingSeries.append(map);
+		}
+	}
+
+	QVariantList tunerSeries;
+	for ( int i = 0; i < tunerTest->tunerSeriesData.size(); i++ )
+	{
+		Tuner::TunerSeries *series = tunerTest->tunerSeriesData.at(i);
+		if ( ! series->deleted )
+		{
+			QVariantMap map = saveGroupSeries(series, shots);
+			map.insert("tunerSetting", series->tunerSetting);
+			tunerSeries.append(map);
+		}
+	}
+
+	int numSeries = powderSeries.size() + seatingSeries.size() + tunerSeries.size();
+
+	QVariantMap powder;
+	powder.insert("options", powderTest->saveOptions());
+	powder.insert("manual", powderTest->isManualEntry());
+	powder.insert("series", powderSeries);
+
+	QVariantMap seating;
+	seating.insert("options", seatingTest->saveOptions());
+	seating.insert("manual", seatingTest->isManualEntry());
+	seating.insert("series", seatingSeries);
+
+	QVariantMap tuner;
+	tuner.insert("options", tunerTest->saveOptions());
+	tuner.insert("manual", tunerTest->isManualEntry());
+	tuner.insert("series", tunerSeries);
+
+	QVariantMap root;
+	root.insert("version", CHRONOPLOTTER_VERSION);
+	root.insert("powder", powder);
+	root.insert("seating", seating);
+	root.insert("tuner", tuner);
+
+	QByteArray details;
+	QDataStream stream(&details, QIODevice::WriteOnly);
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream << root;
+
+	// The shot block starts on an 8-byte boundary so it can be read in place from the mapped file
+	details.append(QByteArray((8 - (HEADER_SIZE + details.size()) % 8) % 8, '\0'));
+
+	/* Write it all out */
+
+	QSaveFile file(path);
+	if ( ! file.open(QIODevice::WriteOnly) )
+	{
+		*error = file.errorString();
+		return false;
+	}
+
+	quint32 version = PROJECT_VERSION;
+	quint32 byteOrderMark = BYTE_ORDER_MARK;
+	quint64 detailsSize = details.size();
+
+	file.write(projectMagic, sizeof(projectMagic));
+	file.write((const char *)&version, sizeof(version));
+	file.write((const char *)&byteOrderMark, sizeof(byteOrderMark));
+	file.write((const char *)&detailsSize, sizeof(detailsSize));
+	file.write(details);
+	file.write((const char *)shots.values.constData(), shots.values.size() * sizeof(double));
+
+	if ( ! file.commit() )
+	{
+		*error = file.errorString();
+		return false;
+	}
+
+	qDebug() << "Saved project" << path << "with" << numSeries << "series and" << shots.values.size() << "shot values in" << timer.elapsed() << "ms";
+
+	return true;
+}
+
+/*
+ * Everything a project file holds. Reading one doesn't touch any widgets, so it can happen off the GUI thread.
+ */
+struct ProjectContents
+{
+	QVariantMap powder;
+	QVariantMap seating;
+	QVariantMap tuner;
+	QList<Powder::ChronoSeries *> powderSeries;
+	QList<SeatingDepth::SeatingSeries *> seatingSeries;
+	QList<Tuner::TunerSeries *> tunerSeries;
+};
+
+static bool readProject ( const QString &path, ProjectContents &contents, QString *error )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	QFile file(path);
+	if ( ! file.open(QIODevice::ReadOnly) )
+	{
+		*error = file.errorString();
+		return false;
+	}
+
+	qint64 fileSize = file.size();
+
+	// Fall back on reading the whole file where it can't be mapped
+	QByteArray contents;
+	const uchar *base = file.map(0, fileSize);
+	if ( base == NULL )
+	{
+		qDebug() << "Unable to map project file, reading it instead:" << file.errorString();
+		contents = file.readAll();
+		base = (const uchar *)contents.constData();
+	}
+
+	/* Header */
+
+	quint32 version;
+	quint32 byteOrderMark;
+	quint64 detailsSize;
+
+	if ( (fileSize < HEADER_SIZE) || (memcmp(base, projectMagic, sizeof(projectMagic)) != 0) )
+	{
+		*error = "Not a ChronoPlotter project file";
+		return false;
+	}
+
+	memcpy(&version, base + 8, sizeof(version));
+	memcpy(&byteOrderMark, base + 12, sizeof(byteOrderMark));
+	memcpy(&detailsSize, base + 16, sizeof(detailsSize));
+
+	if ( version > PROJECT_VERSION )
+	{
+		*error = "This project was saved by a newer version of ChronoPlotter";
+		return false;
+	}
+
+	if ( byteOrderMark != BYTE_ORDER_MARK )
+	{
+		*error = "This project was saved on a computer with a different byte order";
+		return false;
+	}
+
+	if ( (detailsSize > (quint64)(fileSize - HEADER_SIZE)) || ((HEADER_SIZE + detailsSize) % 8 != 0) )
+	{
+		*error = "Project file is damaged";
+		return false;
+	}
+
+	/* Details */
+
+	QByteArray details = QByteArray::fromRawData((const char *)base + HEADER_SIZE, detailsSize);
+	QDataStream stream(details);
+	stream.setVersion(QDataStream::Qt_5_0);
+
+	QVariantMap root;
+	stream >> root;
+
+	if ( stream.status() != QDataStream::Ok )
+	{
+		*error = "Project file is damaged";
+		return false;
+	}
+
+	qDebug() << "Project saved by ChronoPlotter" << root.value("version").toString();
+
+	/* Shots are read in place from the rest of the file */
+
+	ShotReader shots;
+	shots.values = (const double *)(base + HEADER_SIZE + detailsSize);
+	shots.size = (fileSize - HEADER_SIZE - detailsSize) / sizeof(double);
+	shots.ok = true;
+
+	contents.powder = root.value("powder").toMap();
+	contents.seating = root.value("seating").toMap();
+	contents.tuner = root.value("tuner").toMap();
+
+	QVariantList list = contents.powder.value("series").toList();
+	for ( int i = 0; i < list.size(); i++ )
+	{
+		contents.powderSeries.append(loadPowderSeries(list.at(i).toMap(), shots));
+	}
+
+	list = contents.seating.value("series").toList();
+	for ( int i = 0; i < list.size(); i++ )
+	{
+		SeatingDepth::SeatingSeries *series = loadGroupSeries<SeatingDepth::SeatingSeries>(list.at(i).toMap(), shots);
+		series->cartridgeLength = list.at(i).toMap().value("cartridgeLength").toDouble();
+		contents.seatingSeries.append(series);
+	}
+
+	list = contents.tuner.value("series").toList();
+	for ( int i = 0; i < list.size(); i++ )
+	{
+		Tuner::TunerSeries *series = loadGroupSeries<Tuner::TunerSeries>(list.at(i).toMap(), shots);
+		series->tunerSetting = list.at(i).toMap().value("tunerSetting").toInt();
+		contents.tunerSeries.append(series);
+	}
+
+	// Leave the current work alone unless the whole file could be read
+	if ( ! shots.ok )
+	{
+		qDeleteAll(contents.powderSeries);
+		qDeleteAll(contents.seatingSeries);
+		qDeleteAll(contents.tunerSeries);
+
+		*error = "Project file is damaged";
+		return false;
+	}
+
+	qDebug() << "Read project" << path << "with" << (contents.powderSeries.size() + contents.seatingSeries.size() + contents.tunerSeries.size()) << "series in" << timer.elapsed() << "ms";
+
+	return true;
+}
+
+bool Project::load ( const QString &path, Powder::PowderTest *powderTest, SeatingDepth::SeatingDepthTest *seatingTest, Tuner::TunerTest *tunerTest, QString *error )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	ProjectContents contents;
+	if ( ! readProject(path, contents, error) )
+	{
+		return false;
+	}
+
+	/* Hand everything to the tabs */
+
+	powderTest->restoreProject(contents.powder.value("options").toMap(), contents.powderSeries, contents.powder.value("manual").toBool());
+	seatingTest->restoreProject(contents.seating.value("options").toMap(), contents.seatingSeries, contents.seating.value("manual").toBool());
+	tunerTest->restoreProject(contents.tuner.value("options").toMap(), contents.tunerSeries, contents.tuner.value("manual").toBool());
+
+	qDebug() << "Opened project in" << timer.elapsed() << "ms";
+
+	return true;
+}
+
+QList<Powder::ChronoSeries *> Project::readPowderSeries ( const QString &path, QString *error )
+{
+	ProjectContents contents;
+	if ( ! readProject(path, contents, error) )
+	{
+		return QList<Powder::ChronoSeries *>();
+	}
+
+	qDeleteAll(contents.seatingSeries);
+	qDeleteAll(contents.tunerSeries);
+
+	return contents.powderSeries;
+}
+
+
+void Project::saveProject ( QWidget *parent, Powder::PowderTest *powderTest, SeatingDepth::SeatingDepthTest *seatingTest, Tuner::TunerTest *tunerTest )
+{
+	qDebug() << "saveProject";
+
+	QString path = QFileDialog::getSaveFileName(parent, "Save project", QDir::home().filePath("project.chrono"), "ChronoPlotter project (*.chrono)");
+
+	qDebug() << "Selected path:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qDebug() << "User didn't select a file, bail";
+		return;
+	}
+
+	QString error;
+	if ( ! save(path, powderTest, seatingTest, tunerTest, &error) )
+	{
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Unable to save project to '%1'\n\n%2").arg(path).arg(error));
+		msg.setWindowTitle("Error");
+		msg.exec();
+	}
+}
+
+void Project::openProject ( QWidget *parent, Powder::PowderTest *powderTest, SeatingDepth::SeatingDepthTest *seatingTest, Tuner::TunerTest *tunerTest )
+{
+	qDebug() << "openProject";
+
+	QMessageBox::StandardButton reply;
+	reply = QMessageBox::question(parent, "Open project", "Are you sure you want to open a project?\n\nThis will clear your current work in every tab.", QMessageBox::Yes | QMessageBox::Cancel);
+
+	if ( reply != QMessageBox::Yes )
+	{
+		qDebug() << "User said cancel";
+		return;
+	}
+
+	QString path = QFileDialog::getOpenFileName(parent, "Open project", QDir::homePath(), "ChronoPlotter project (*.chrono)");
+
+	qDebug() << "Selected path:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qDebug() << "User didn't select a file, bail";
+		return;
+	}
+
+	QString error;
+	if ( ! load(path, powderTest, seatingTest, tunerTest, &error) )
+	{
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Unable to open project '%1'\n\n%2").arg(path).arg(error));
+		msg.setWindowTitle("Error");
+		msg.exec();
+	}
+}
@@ -0,0 +1,27 @@
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include <QWidget>
+#include <QString>
+#include <QList>
+
+namespace Powder { class PowderTest; struct ChronoSeries; };
+namespace SeatingDepth { class SeatingDepthTest; };
+namespace Tuner { class TunerTest; };
+
+/*
+ * Project files hold every tab's series and graph options, so a session can be picked up again without re-importing and
+ * re-annotating the original files. Series details and options are a small QDataStream block at the start of the file. Shots
+ * follow as one packed array of doubles, which is memory-mapped on load and copied straight into each series.
+ */
+
+namespace Project
+{
+	bool save ( const QString &, Powder::PowderTest *, SeatingDepth::SeatingDepthTest *, Tuner::TunerTest *, QString * );
+	bool load ( const QString &, Powder::PowderTest *, SeatingDepth::SeatingDepthTest *, Tuner::TunerTest *, QString * );
+	QList<Powder::ChronoSeries *> readPowderSeries ( const QString &, QString * ); // safe to call off the GUI thread
+	void saveProject ( QWidget *, Powder::PowderTest *, SeatingDepth::SeatingDepthTest *, Tuner::TunerTest * );
+	void openProject ( QWidget *, Powder::PowderTest *, SeatingDepth::SeatingDepthTest *, Tuner::TunerTest * );
+};
+
+#endif // PROJECT_H
@@ -64,6 +64,7 @@ $${QXLSX_HEADERPATH}xlsxcellformula_p.h \
 $${QXLSX_HEADERPATH}xlsxcelllocation.h \
 $${QXLSX_HEADERPATH}xlsxcellrange.h \
 $${QXLSX_HEADERPATH}xlsxcellreference.h \
+$${QXLSX_HEADERPATH}xlsxcelltable_p.h \
 $${QXLSX_HEADERPATH}xlsxcell_p.h \
 $${QXLSX_HEADERPATH}xlsxchart.h \
 $${QXLSX_HEADERPATH}xlsxchartsheet.h \
@@ -110,6 +111,7 @@ $${QXLSX_SOURCEPATH}xlsxcellformula.cpp \
 $${QXLSX_SOURCEPATH}xlsxcelllocation.cpp \
 $${QXLSX_SOURCEPATH}xlsxcellrange.cpp \
 $${QXLSX_SOURCEPATH}xlsxcellreference.cpp \
+$${QXLSX_SOURCEPATH}xlsxcelltable.cpp \
 $${QXLSX_SOURCEPATH}xlsxchart.cpp \
 $${QXLSX_SOURCEPATH}xlsxchartsheet.cpp \
 $${QXLSX_SOURCEPATH}xlsxcolor.cpp \
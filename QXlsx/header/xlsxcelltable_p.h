@@ -0,0 +1,192 @@
+// xlsxcelltable_p.h
+
+#ifndef XLSXCELLTABLE_P_H
+#define XLSXCELLTABLE_P_H
+
+#include "xlsxcell.h"
+#include "xlsxglobal.h"
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <QVector>
+#include <QtGlobal>
+
+QT_BEGIN_NAMESPACE_XLSX
+
+/*
+  Bump allocator for cells created in bulk, such as while a sheet is
+  loaded. Cell and its shared_ptr control block come out of large slabs
+  instead of one heap allocation each. Memory is only given back when
+  the arena goes away, which happens once the table and every cell
+  allocated from it have let go of it.
+ */
+class CellArena
+{
+public:
+    CellArena();
+    void *allocate(std::size_t size);
+
+private:
+    Q_DISABLE_COPY(CellArena)
+    std::vector<std::unique_ptr<char[]>> m_slabs;
+    std::vector<std::unique_ptr<char[]>> m_large; // allocations too big for a slab
+    std::size_t m_used;
+};
+
+template <typename T>
+class CellArenaAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit CellArenaAllocator(const std::shared_ptr<CellArena> &arena)
+        : arena(arena)
+    {
+    }
+
+    template <typename U>
+    CellArenaAllocator(const CellArenaAllocator<U> &other)
+        : arena(other.arena)
+    {
+    }
+
+    T *allocate(std::size_t n) { return static_cast<T *>(arena->allocate(n * sizeof(T))); }
+    void deallocate(T *, std::size_t) {}
+
+    std::shared_ptr<CellArena> arena;
+};
+
+template <typename T, typename U>
+bool operator==(const CellArenaAllocator<T> &a, const CellArenaAllocator<U> &b)
+{
+    return a.arena == b.arena;
+}
+
+template <typename T, typename U>
+bool operator!=(const CellArenaAllocator<T> &a, const CellArenaAllocator<U> &b)
+{
+    return a.arena != b.arena;
+}
+
+/*
+  Cells of a worksheet, stored densely. Rows are grouped into blocks of
+  RowBlockSize that are allocated on first use, and each row keeps its
+  cells in a vector indexed by column, so a read is two array lookups.
+  Rows and columns are 1-based, as everywhere else in the worksheet.
+ */
+class CellTable
+{
+public:
+    CellTable();
+
+    bool isEmpty() const { return m_count == 0; }
+    int count() const { return m_count; }
+
+    Cell *cellAt(int row, int column) const
+    {
+        const Row *r = rowAt(row);
+        if (!r || column < 1 || column > r->cells.size())
+            return nullptr;
+        return r->cells.at(column - 1).get();
+    }
+
+    std::shared_ptr<Cell> cell(int row, int column) const
+    {
+        const Row *r = rowAt(row);
+        if (!r || column < 1 || column > r->cells.size())
+            return std::shared_ptr<Cell>();
+        return r->cells.at(column - 1);
+    }
+
+    bool contains(int row, int column) const { return cellAt(row, column) != nullptr; }
+
+    bool hasRow(int row) const
+    {
+        const Row *r = rowAt(row);
+        return r && r->count > 0;
+    }
+
+    void setCell(int row, int column, const std::shared_ptr<Cell> &cell);
+
+    // Extents of the cells present, only meaningful when the table or row isn't empty
+    int firstRow() const { return m_firstRow; }
+    int lastRow() const { return m_lastRow; }
+    int firstColumn(int row) const { return rowAt(row)->firstColumn; }
+    int lastColumn(int row) const { return rowAt(row)->cells.size(); }
+
+    // Calls function(row, column, cell) for every cell, in row then column order
+    template <typename Function>
+    void forEach(Function function) const
+    {
+        if (isEmpty())
+            return;
+        for (int row = m_firstRow; row <= m_lastRow; ++row) {
+            const Row *r = rowAt(row);
+            if (!r || r->count == 0)
+                continue;
+            for (int column = r->firstColumn; column <= r->cells.size(); ++column) {
+                const std::shared_ptr<Cell> &cell = r->cells.at(column - 1);
+                if (cell)
+                    function(row, column, cell);
+            }
+        }
+    }
+
+    // New cells come from the arena while it's enabled
+    void setArenaEnabled(bool enabled);
+
+    template <typename... Args>
+    std::shared_ptr<Cell> makeCell(Args &&...args)
+    {
+        if (m_arena)
+            return std::allocate_shared<Cell>(CellArenaAllocator<Cell>(m_arena),
+                                              std::forward<Args>(args)...);
+        return std::make_shared<Cell>(std::forward<Args>(args)...);
+    }
+
+private:
+    Q_DISABLE_COPY(CellTable)
+
+    enum { RowBlockShift = 8, RowBlockSize = 1 << RowBlockShift };
+
+    struct Row {
+        Row()
+            : count(0)
+            , firstColumn(0)
+        {
+        }
+        QVector<std::shared_ptr<Cell>> cells; // up to the last column with a cell
+        int count;
+        int firstColumn;
+    };
+
+    struct RowBlock {
+        Row rows[RowBlockSize];
+    };
+
+    const Row *rowAt(int row) const
+    {
+        if (row < 1)
+            return nullptr;
+        const std::size_t block = std::size_t(row - 1) >> RowBlockShift;
+        if (block >= m_blocks.size() || !m_blocks[block])
+            return nullptr;
+        return &m_blocks[block]->rows[(row - 1) & (RowBlockSize - 1)];
+    }
+
+    Row *rowFor(int row);
+    void updateRowExtents();
+
+    std::vector<std::unique_ptr<RowBlock>> m_blocks;
+    int m_count;
+    int m_firstRow;
+    int m_lastRow;
+    std::shared_ptr<CellArena> m_arena;
+};
+
+QT_END_NAMESPACE_XLSX
+
+#endif // XLSXCELLTABLE_P_H
@@ -30,8 +30,11 @@ class QXLSX_EXPORT Document : public QObject
     Q_DECLARE_PRIVATE(Document) // D-Pointer. Qt classes have a Q_DECLARE_PRIVATE
                                 // macro in the public class. The macro reads: qglobal.h
 public:
+    enum LoadMode { LoadAll, LoadOnDemand };
+
     explicit Document(QObject *parent = nullptr);
     Document(const QString &xlsxName, QObject *parent = nullptr);
+    Document(const QString &xlsxName, LoadMode mode, QObject *parent = nullptr);
     Document(QIODevice *device, QObject *parent = nullptr);
     ~Document();
 
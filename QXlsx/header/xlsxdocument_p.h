@@ -7,22 +7,32 @@
 #include "xlsxdocument.h"
 #include "xlsxglobal.h"
 #include "xlsxworkbook.h"
+#include "xlsxworkbook_p.h"
+#include "xlsxzipreader_p.h"
 
 #include <QMap>
 #include <QtGlobal>
 
+#include <memory>
+
 QT_BEGIN_NAMESPACE_XLSX
 
-class DocumentPrivate
+class DocumentPrivate : public WorkbookPartLoader
 {
     Q_DECLARE_PUBLIC(Document)
 public:
     DocumentPrivate(Document *p);
+    ~DocumentPrivate();
     void init();
 
-    bool loadPackage(QIODevice *device);
+    bool loadPackage(ZipReader *reader, Document::LoadMode mode);
     bool savePackage(QIODevice *device) const;
 
+    void loadStyles() override;
+    void loadSharedStrings() override;
+    void loadSheet(AbstractSheet *sheet) override;
+    void loadRemainingParts();
+
     // copy style from one xlsx file to other
     static bool copyStyle(const QString &from, const QString &to);
 
@@ -34,6 +44,13 @@ public:
     QSharedPointer<Workbook> workbook;
     std::shared_ptr<ContentTypes> contentTypes;
     bool isLoad;
+
+    // Parts of the package not parsed yet, see Document::LoadOnDemand
+    std::unique_ptr<ZipReader> zipReader;
+    QString workbookDir;
+    QList<QSharedPointer<AbstractSheet>> pendingSheets;
+    bool stylesPending;
+    bool sharedStringsPending;
 };
 
 QT_END_NAMESPACE_XLSX
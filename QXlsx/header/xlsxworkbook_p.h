@@ -37,6 +37,19 @@ struct XlsxDefineNameData {
     int sheetId;
 };
 
+/*
+  Parses the parts of a package opened with Document::LoadOnDemand the
+  first time they are needed.
+ */
+class WorkbookPartLoader
+{
+public:
+    virtual ~WorkbookPartLoader() {}
+    virtual void loadStyles()                    = 0;
+    virtual void loadSharedStrings()             = 0;
+    virtual void loadSheet(AbstractSheet *sheet) = 0;
+};
+
 class WorkbookPrivate : public AbstractOOXmlFilePrivate
 {
     Q_DECLARE_PUBLIC(Workbook)
@@ -52,6 +65,7 @@ public:
     QList<std::shared_ptr<MediaFile>> mediaFiles;
     QList<QSharedPointer<Chart>> chartFiles;
     QList<XlsxDefineNameData> definedNamesList;
+    WorkbookPartLoader *partLoader; // set while parts are still to be loaded on demand
 
     bool strings_to_numbers_enabled;
     bool strings_to_hyperlinks_enabled;
@@ -6,6 +6,7 @@
 #include "xlsxabstractsheet_p.h"
 #include "xlsxcell.h"
 #include "xlsxcellformula.h"
+#include "xlsxcelltable_p.h"
 #include "xlsxconditionalformatting.h"
 #include "xlsxdatavalidation.h"
 #include "xlsxworksheet.h"
@@ -182,7 +183,7 @@ public:
     SharedStrings *sharedStrings() const;
 
 public:
-    QMap<int, QMap<int, std::shared_ptr<Cell>>> cellTable;
+    CellTable cellTable;
 
     QMap<int, QMap<int, QString>> comments;
     QMap<int, QMap<int, QSharedPointer<XlsxHyperlinkData>>> urlTable;
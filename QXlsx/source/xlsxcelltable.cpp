@@ -0,0 +1,128 @@
+// xlsxcelltable.cpp
+
+#include "xlsxcelltable_p.h"
+
+#include <QtGlobal>
+
+QT_BEGIN_NAMESPACE_XLSX
+
+namespace {
+const std::size_t SlabSize = 64 * 1024;
+}
+
+CellArena::CellArena()
+    : m_used(SlabSize)
+{
+}
+
+void *CellArena::allocate(std::size_t size)
+{
+    // new[] hands out memory aligned for any fundamental type, keep every allocation that way
+    const std::size_t align = alignof(std::max_align_t);
+    size                    = (size + align - 1) & ~(align - 1);
+
+    if (size > SlabSize) {
+        m_large.push_back(std::unique_ptr<char[]>(new char[size]));
+        return m_large.back().get();
+    }
+
+    if (m_used + size > SlabSize) {
+        m_slabs.push_back(std::unique_ptr<char[]>(new char[SlabSize]));
+        m_used = 0;
+    }
+
+    void *p = m_slabs.back().get() + m_used;
+    m_used += size;
+    return p;
+}
+
+CellTable::CellTable()
+    : m_count(0)
+    , m_firstRow(0)
+    , m_lastRow(0)
+{
+}
+
+CellTable::Row *CellTable::rowFor(int row)
+{
+    const std::size_t block = std::size_t(row - 1) >> RowBlockShift;
+    if (block >= m_blocks.size())
+        m_blocks.resize(block + 1);
+    if (!m_blocks[block])
+        m_blocks[block].reset(new RowBlock);
+    return &m_blocks[block]->rows[(row - 1) & (RowBlockSize - 1)];
+}
+
+void CellTable::setCell(int row, int column, const std::shared_ptr<Cell> &cell)
+{
+    if (row < 1 || column < 1)
+        return;
+
+    if (!cell) {
+        // Clearing a cell
+        const Row *existing = rowAt(row);
+        if (!existing || column > existing->cells.size() || !existing->cells.at(column - 1))
+            return;
+
+        Row *r = rowFor(row);
+        r->cells[column - 1].reset();
+        r->count--;
+        m_count--;
+
+        if (r->count == 0) {
+            r->cells.clear();
+            r->firstColumn = 0;
+            updateRowExtents();
+        } else {
+            while (!r->cells.last())
+                r->cells.removeLast();
+            while (!r->cells.at(r->firstColumn - 1))
+                r->firstColumn++;
+        }
+        return;
+    }
+
+    Row *r = rowFor(row);
+
+    if (column > r->cells.size())
+        r->cells.resize(column);
+
+    std::shared_ptr<Cell> &slot = r->cells[column - 1];
+    if (!slot) {
+        if (r->count == 0 || column < r->firstColumn)
+            r->firstColumn = column;
+        r->count++;
+
+        if (m_count == 0) {
+            m_firstRow = m_lastRow = row;
+        } else {
+            m_firstRow = qMin(m_firstRow, row);
+            m_lastRow  = qMax(m_lastRow, row);
+        }
+        m_count++;
+    }
+    slot = cell;
+}
+
+void CellTable::updateRowExtents()
+{
+    if (m_count == 0) {
+        m_firstRow = m_lastRow = 0;
+        return;
+    }
+
+    while (!hasRow(m_firstRow))
+        m_firstRow++;
+    while (!hasRow(m_lastRow))
+        m_lastRow--;
+}
+
+void CellTable::setArenaEnabled(bool enabled)
+{
+    if (enabled && !m_arena)
+        m_arena = std::make_shared<CellArena>();
+    else if (!enabled)
+        m_arena.reset();
+}
+
+QT_END_NAMESPACE_XLSX
@@ -156,9 +156,17 @@ DocumentPrivate::DocumentPrivate(Document *p)
     : q_ptr(p)
     , defaultPackageName(QStringLiteral("Book1.xlsx"))
     , isLoad(false)
+    , stylesPending(false)
+    , sharedStringsPending(false)
 {
 }
 
+DocumentPrivate::~DocumentPrivate()
+{
+    if (workbook)
+        workbook->d_func()->partLoader = nullptr;
+}
+
 void DocumentPrivate::init()
 {
     if (!contentTypes)
@@ -168,23 +176,23 @@ void DocumentPrivate::init()
         workbook = QSharedPointer<Workbook>(new Workbook(Workbook::F_NewFromScratch));
 }
 
-bool DocumentPrivate::loadPackage(QIODevice *device)
+bool DocumentPrivate::loadPackage(ZipReader *reader, Document::LoadMode mode)
 {
     Q_Q(Document);
-    ZipReader zipReader(device);
-    QStringList filePaths = zipReader.filePaths();
+    std::unique_ptr<ZipReader> package(reader);
+    QStringList filePaths = package->filePaths();
 
     // Load the Content_Types file
     if (!filePaths.contains(QLatin1String("[Content_Types].xml")))
         return false;
     contentTypes = std::make_shared<ContentTypes>(ContentTypes::F_LoadFromExists);
-    contentTypes->loadFromXmlData(zipReader.fileData(QStringLiteral("[Content_Types].xml")));
+    contentTypes->loadFromXmlData(package->fileData(QStringLiteral("[Content_Types].xml")));
 
     // Load root rels file
     if (!filePaths.contains(QLatin1String("_rels/.rels")))
         return false;
     Relationships rootRels;
-    rootRels.loadFromXmlData(zipReader.fileData(QStringLiteral("_rels/.rels")));
+    rootRels.loadFromXmlData(package->fileData(QStringLiteral("_rels/.rels")));
 
     // load core property
     QList<XlsxRelationship> rels_core =
@@ -195,7 +203,7 @@ bool DocumentPrivate::loadPackage(QIODevice *device)
         QString docPropsCore_Name = rels_core[0].target;
 
         DocPropsCore props(DocPropsCore::F_LoadFromExists);
-        props.loadFromXmlData(zipReader.fileData(docPropsCore_Name));
+        props.loadFromXmlData(package->fileData(docPropsCore_Name));
         const auto propNames = props.propertyNames();
         for (const QString &name : propNames)
             q->setDocumentProperty(name, props.property(name));
@@ -210,7 +218,7 @@ bool DocumentPrivate::loadPackage(QIODevice *device)
         QString docPropsApp_Name = rels_app[0].target;
 
         DocPropsApp props(DocPropsApp::F_LoadFromExists);
-        props.loadFromXmlData(zipReader.fileData(docPropsApp_Name));
+        props.loadFromXmlData(package->fileData(docPropsApp_Name));
         const auto propNames = props.propertyNames();
         for (const QString &name : propNames)
             q->setDocumentProperty(name, props.property(name));
@@ -228,11 +236,32 @@ bool DocumentPrivate::loadPackage(QIODevice *device)
     const QString xlworkbook_Dir  = parts.first();
     const QString relFilePath     = getRelFilePath(xlworkbook_Path);
 
-    workbook->relationships()->loadFromXmlData(zipReader.fileData(relFilePath));
+    workbook->relationships()->loadFromXmlData(package->fileData(relFilePath));
     workbook->setFilePath(xlworkbook_Path);
-    workbook->loadFromXmlData(zipReader.fileData(xlworkbook_Path));
+    workbook->loadFromXmlData(package->fileData(xlworkbook_Path));
+
+    // Everything else is parsed when first needed, or right away when loading it all
+    zipReader            = std::move(package);
+    workbookDir          = xlworkbook_Dir;
+    pendingSheets        = workbook->d_func()->sheets;
+    stylesPending        = true;
+    sharedStringsPending = true;
+
+    workbook->d_func()->partLoader = this;
+
+    if (mode == Document::LoadAll)
+        loadRemainingParts();
+
+    isLoad = true;
+    return true;
+}
+
+void DocumentPrivate::loadStyles()
+{
+    if (!stylesPending)
+        return;
+    stylesPending = false;
 
-    // load styles
     QList<XlsxRelationship> rels_styles =
         workbook->relationships()->documentRelationships(QStringLiteral("/styles"));
     if (!rels_styles.isEmpty()) {
@@ -241,91 +270,134 @@ bool DocumentPrivate::loadPackage(QIODevice *device)
 
         // dev34
         QString path;
-        if (xlworkbook_Dir == QLatin1String(".")) // root
+        if (workbookDir == QLatin1String(".")) // root
         {
             path = name;
         } else {
-            path = xlworkbook_Dir + QLatin1String("/") + name;
+            path = workbookDir + QLatin1String("/") + name;
         }
 
         QSharedPointer<Styles> styles(new Styles(Styles::F_LoadFromExists));
-        styles->loadFromXmlData(zipReader.fileData(path));
+        styles->loadFromXmlData(zipReader->fileData(path));
         workbook->d_func()->styles = styles;
     }
+}
+
+void DocumentPrivate::loadSharedStrings()
+{
+    if (!sharedStringsPending)
+        return;
+    sharedStringsPending = false;
 
-    // load sharedStrings
     QList<XlsxRelationship> rels_sharedStrings =
         workbook->relationships()->documentRelationships(QStringLiteral("/sharedStrings"));
     if (!rels_sharedStrings.isEmpty()) {
         // In normal case this should be sharedStrings.xml which in xl
         QString name = rels_sharedStrings[0].target;
-        QString path = xlworkbook_Dir + QLatin1String("/") + name;
-        workbook->d_func()->sharedStrings->loadFromXmlData(zipReader.fileData(path));
+        QString path = workbookDir + QLatin1String("/") + name;
+        workbook->d_func()->sharedStrings->loadFromXmlData(zipReader->fileData(path));
+    }
+}
+
+/*!
+ * \internal
+ * Parses \a sheet if it hasn't been yet, along with its drawing and the
+ * charts and media files the drawing refers to. Styles and shared strings
+ * are pulled in through the workbook as the cells ask for them.
+ */
+void DocumentPrivate::loadSheet(AbstractSheet *sheet)
+{
+    int index = 0;
+    while (index < pendingSheets.size() && pendingSheets[index].data() != sheet)
+        ++index;
+    if (index == pendingSheets.size())
+        return;
+    pendingSheets.removeAt(index);
+
+    QString rel_path = getRelFilePath(sheet->filePath());
+    // If the .rel file exists, load it.
+    if (zipReader->filePaths().contains(rel_path))
+        sheet->relationships()->loadFromXmlData(zipReader->fileData(rel_path));
+    sheet->loadFromXmlData(zipReader->fileData(sheet->filePath()));
+
+    Drawing *drawing = sheet->drawing();
+    if (!drawing)
+        return;
+
+    // Charts and media files found in the drawing are appended to the workbook's lists
+    const int firstChart = workbook->chartFiles().size();
+    const int firstMedia = workbook->mediaFiles().size();
+
+    rel_path = getRelFilePath(drawing->filePath());
+    if (zipReader->filePaths().contains(rel_path))
+        drawing->relationships()->loadFromXmlData(zipReader->fileData(rel_path));
+    drawing->loadFromXmlData(zipReader->fileData(drawing->filePath()));
+
+    // load charts
+    QList<QSharedPointer<Chart>> chartFileToLoad = workbook->chartFiles();
+    for (int i = firstChart; i < chartFileToLoad.size(); ++i) {
+        QSharedPointer<Chart> cf = chartFileToLoad[i];
+        cf->loadFromXmlData(zipReader->fileData(cf->filePath()));
     }
 
+    // load media files
+    const auto mediaFileToLoad = workbook->mediaFiles();
+    for (int i = firstMedia; i < mediaFileToLoad.size(); ++i) {
+        const auto &mf       = mediaFileToLoad[i];
+        const QString path   = mf->fileName();
+        const QString suffix = path.mid(path.lastIndexOf(QLatin1Char('.')) + 1);
+        mf->set(zipReader->fileData(path), suffix);
+    }
+}
+
+/*!
+ * \internal
+ * Parses every part that hasn't been yet and closes the package.
+ */
+void DocumentPrivate::loadRemainingParts()
+{
+    if (!zipReader)
+        return;
+
+    loadStyles();
+    loadSharedStrings();
+
     // load theme
     QList<XlsxRelationship> rels_theme =
         workbook->relationships()->documentRelationships(QStringLiteral("/theme"));
     if (!rels_theme.isEmpty()) {
         // In normal case this should be theme/theme1.xml which in xl
         QString name = rels_theme[0].target;
-        QString path = xlworkbook_Dir + QLatin1String("/") + name;
-        workbook->theme()->loadFromXmlData(zipReader.fileData(path));
+        QString path = workbookDir + QLatin1String("/") + name;
+        workbook->theme()->loadFromXmlData(zipReader->fileData(path));
     }
 
-    // load sheets
-    for (int i = 0; i < workbook->sheetCount(); ++i) {
-        AbstractSheet *sheet = workbook->sheet(i);
-        QString strFilePath  = sheet->filePath();
-        QString rel_path     = getRelFilePath(strFilePath);
-        // If the .rel file exists, load it.
-        if (zipReader.filePaths().contains(rel_path))
-            sheet->relationships()->loadFromXmlData(zipReader.fileData(rel_path));
-        sheet->loadFromXmlData(zipReader.fileData(sheet->filePath()));
-    }
+    // load sheets, sheets since deleted from the workbook are skipped
+    for (int i = 0; i < workbook->sheetCount(); ++i)
+        loadSheet(workbook->d_func()->sheets[i].data());
+    pendingSheets.clear();
 
     // load external links
     for (int i = 0; i < workbook->d_func()->externalLinks.count(); ++i) {
         SimpleOOXmlFile *link = workbook->d_func()->externalLinks[i].data();
         QString rel_path      = getRelFilePath(link->filePath());
         // If the .rel file exists, load it.
-        if (zipReader.filePaths().contains(rel_path))
-            link->relationships()->loadFromXmlData(zipReader.fileData(rel_path));
-        link->loadFromXmlData(zipReader.fileData(link->filePath()));
-    }
-
-    // load drawings
-    for (int i = 0; i < workbook->drawings().size(); ++i) {
-        Drawing *drawing = workbook->drawings()[i];
-        QString rel_path = getRelFilePath(drawing->filePath());
-        if (zipReader.filePaths().contains(rel_path))
-            drawing->relationships()->loadFromXmlData(zipReader.fileData(rel_path));
-        drawing->loadFromXmlData(zipReader.fileData(drawing->filePath()));
-    }
-
-    // load charts
-    QList<QSharedPointer<Chart>> chartFileToLoad = workbook->chartFiles();
-    for (int i = 0; i < chartFileToLoad.size(); ++i) {
-        QSharedPointer<Chart> cf = chartFileToLoad[i];
-        cf->loadFromXmlData(zipReader.fileData(cf->filePath()));
+        if (zipReader->filePaths().contains(rel_path))
+            link->relationships()->loadFromXmlData(zipReader->fileData(rel_path));
+        link->loadFromXmlData(zipReader->fileData(link->filePath()));
     }
 
-    // load media files
-    const auto mediaFileToLoad = workbook->mediaFiles();
-    for (const auto &mf : mediaFileToLoad) {
-        const QString path   = mf->fileName();
-        const QString suffix = path.mid(path.lastIndexOf(QLatin1Char('.')) + 1);
-        mf->set(zipReader.fileData(path), suffix);
-    }
-
-    isLoad = true;
-    return true;
+    workbook->d_func()->partLoader = nullptr;
+    zipReader.reset();
 }
 
 bool DocumentPrivate::savePackage(QIODevice *device) const
 {
     Q_Q(const Document);
 
+    // Parts still in the package have to be parsed before they can be written back
+    const_cast<DocumentPrivate *>(this)->loadRemainingParts();
+
     ZipWriter zipWriter(device);
     if (zipWriter.error())
         return false;
@@ -580,7 +652,7 @@ Document::Document(const QString &name, QObject *parent)
     if (QFile::exists(name)) {
         QFile xlsx(name);
         if (xlsx.open(QFile::ReadOnly)) {
-            if (!d_ptr->loadPackage(&xlsx)) {
+            if (!d_ptr->loadPackage(new ZipReader(&xlsx), LoadAll)) {
                 // NOTICE: failed to load package
             }
         }
@@ -589,6 +661,31 @@ Document::Document(const QString &name, QObject *parent)
     d_ptr->init();
 }
 
+/*!
+ * \overload
+ * Try to open an existing xlsx document named \a name.
+ * With LoadOnDemand only the workbook and document properties are parsed
+ * up front. Each sheet is parsed the first time it is returned by the
+ * workbook, and styles and shared strings once a sheet needs them. The file
+ * stays open until every part has been loaded, which saving the document
+ * also does.
+ * The \a parent argument is passed to QObject's constructor.
+ */
+Document::Document(const QString &name, LoadMode mode, QObject *parent)
+    : QObject(parent)
+    , d_ptr(new DocumentPrivate(this))
+{
+    d_ptr->packageName = name;
+
+    if (QFile::exists(name)) {
+        if (!d_ptr->loadPackage(new ZipReader(name), mode)) {
+            // NOTICE: failed to load package
+        }
+    }
+
+    d_ptr->init();
+}
+
 /*!
  * \overload
  * Try to open an existing xlsx document from \a device.
@@ -599,7 +696,7 @@ Document::Document(QIODevice *device, QObject *parent)
     , d_ptr(new DocumentPrivate(this))
 {
     if (device && device->isReadable()) {
-        if (!d_ptr->loadPackage(device)) {
+        if (!d_ptr->loadPackage(new ZipReader(device), LoadAll)) {
             // NOTICE: failed to load package
         }
     }
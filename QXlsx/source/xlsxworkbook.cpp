@@ -30,6 +30,7 @@ WorkbookPrivate::WorkbookPrivate(Workbook *q, Workbook::CreateFlag flag)
     sharedStrings = QSharedPointer<SharedStrings>(new SharedStrings(flag));
     styles        = QSharedPointer<Styles>(new Styles(flag));
     theme         = QSharedPointer<Theme>(new Theme(flag));
+    partLoader    = nullptr;
 
     x_window      = 240;
     y_window      = 15;
@@ -269,7 +270,7 @@ AbstractSheet *Workbook::activeSheet() const
     Q_D(const Workbook);
     if (d->sheets.isEmpty())
         const_cast<Workbook *>(this)->addSheet();
-    return d->sheets[d->activesheetIndex].data();
+    return sheet(d->activesheetIndex);
 }
 
 bool Workbook::setActiveSheet(int index)
@@ -364,7 +365,7 @@ bool Workbook::copySheet(int index, const QString &newName)
     }
 
     ++d->last_sheet_id;
-    AbstractSheet *sheet = d->sheets[index]->copy(worksheetName, d->last_sheet_id);
+    AbstractSheet *sheet = this->sheet(index)->copy(worksheetName, d->last_sheet_id);
     d->sheets.append(QSharedPointer<AbstractSheet>(sheet));
     d->sheetNames.append(sheet->sheetName());
 
@@ -388,18 +389,25 @@ AbstractSheet *Workbook::sheet(int index) const
     Q_D(const Workbook);
     if (index < 0 || index >= d->sheets.size())
         return nullptr;
-    return d->sheets.at(index).data();
+    AbstractSheet *sheet = d->sheets.at(index).data();
+    if (d->partLoader)
+        d->partLoader->loadSheet(sheet);
+    return sheet;
 }
 
 SharedStrings *Workbook::sharedStrings() const
 {
     Q_D(const Workbook);
+    if (d->partLoader)
+        d->partLoader->loadSharedStrings();
     return d->sharedStrings.data();
 }
 
 Styles *Workbook::styles()
 {
     Q_D(Workbook);
+    if (d->partLoader)
+        d->partLoader->loadStyles();
     return d->styles.data();
 }
 
@@ -76,11 +76,12 @@ void WorksheetPrivate::calculateSpans() const
     int span_max = -1;
 
     for (int row_num = dimension.firstRow(); row_num <= dimension.lastRow(); row_num++) {
-        auto it = cellTable.constFind(row_num);
-        if (it != cellTable.constEnd()) {
-            for (int col_num = dimension.firstColumn(); col_num <= dimension.lastColumn();
+        if (cellTable.hasRow(row_num)) {
+            const int lastColumn = qMin(dimension.lastColumn(), cellTable.lastColumn(row_num));
+            for (int col_num = qMax(dimension.firstColumn(), cellTable.firstColumn(row_num));
+                 col_num <= lastColumn;
                  col_num++) {
-                if (it->contains(col_num)) {
+                if (cellTable.contains(row_num, col_num)) {
                     if (span_max == -1) {
                         span_min = col_num;
                         span_max = col_num;
@@ -190,24 +191,15 @@ Worksheet *Worksheet::copy(const QString &distName, int distId) const
 
     sheet_d->dimension = d->dimension;
 
-    QMapIterator<int, QMap<int, std::shared_ptr<Cell>>> it(d->cellTable);
-    while (it.hasNext()) {
-        it.next();
-        int row = it.key();
-        QMapIterator<int, std::shared_ptr<Cell>> it2(it.value());
-        while (it2.hasNext()) {
-            it2.next();
-            int col = it2.key();
+    d->cellTable.forEach([&](int row, int col, const std::shared_ptr<Cell> &source) {
+        auto cell           = std::make_shared<Cell>(source.get());
+        cell->d_ptr->parent = sheet;
 
-            auto cell           = std::make_shared<Cell>(it2.value().get());
-            cell->d_ptr->parent = sheet;
+        if (cell->cellType() == Cell::SharedStringType)
+            d->workbook->sharedStrings()->addSharedString(cell->d_ptr->richString);
 
-            if (cell->cellType() == Cell::SharedStringType)
-                d->workbook->sharedStrings()->addSharedString(cell->d_ptr->richString);
-
-            sheet_d->cellTable[row][col] = cell;
-        }
-    }
+        sheet_d->cellTable.setCell(row, col, cell);
+    });
 
     sheet_d->merges = d->merges;
     //    sheet_d->rowsInfo = d->rowsInfo;
@@ -557,23 +549,15 @@ Cell *Worksheet::cellAt(const CellReference &row_column) const
 Cell *Worksheet::cellAt(int row, int col) const
 {
     Q_D(const Worksheet);
-    auto it = d->cellTable.constFind(row);
-    if (it == d->cellTable.constEnd())
-        return nullptr;
-    if (!it->contains(col))
-        return nullptr;
-
-    return (*it)[col].get();
+    return d->cellTable.cellAt(row, col);
 }
 
 Format WorksheetPrivate::cellFormat(int row, int col) const
 {
-    auto it = cellTable.constFind(row);
-    if (it == cellTable.constEnd())
-        return Format();
-    if (!it->contains(col))
+    const Cell *cell = cellTable.cellAt(row, col);
+    if (!cell)
         return Format();
-    return (*it)[col]->format();
+    return cell->format();
 }
 
 /*!
@@ -615,7 +599,7 @@ bool Worksheet::writeString(int row, int column, const RichString &value, const
     d->workbook->styles()->addXfFormat(fmt);
     auto cell = std::make_shared<Cell>(value.toPlainString(), Cell::SharedStringType, fmt, this);
     cell->d_ptr->richString   = value;
-    d->cellTable[row][column] = cell;
+    d->cellTable.setCell(row, column, cell);
     return true;
 }
 
@@ -687,7 +671,8 @@ bool Worksheet::writeInlineString(int row, int column, const QString &value, con
 
     Format fmt = format.isValid() ? format : d->cellFormat(row, column);
     d->workbook->styles()->addXfFormat(fmt);
-    d->cellTable[row][column] = std::make_shared<Cell>(value, Cell::InlineStringType, fmt, this);
+    d->cellTable.setCell(
+        row, column, std::make_shared<Cell>(value, Cell::InlineStringType, fmt, this));
     return true;
 }
 
@@ -716,7 +701,8 @@ bool Worksheet::writeNumeric(int row, int column, double value, const Format &fo
 
     Format fmt = format.isValid() ? format : d->cellFormat(row, column);
     d->workbook->styles()->addXfFormat(fmt);
-    d->cellTable[row][column] = std::make_shared<Cell>(value, Cell::NumberType, fmt, this);
+    d->cellTable.setCell(
+        row, column, std::make_shared<Cell>(value, Cell::NumberType, fmt, this));
     return true;
 }
 
@@ -768,7 +754,7 @@ bool Worksheet::writeFormula(int row,
 
     auto data                 = std::make_shared<Cell>(result, Cell::NumberType, fmt, this);
     data->d_ptr->formula      = formula;
-    d->cellTable[row][column] = data;
+    d->cellTable.setCell(row, column, data);
 
     CellRange range = formula.reference();
     if (formula.formulaType() == CellFormula::SharedType) {
@@ -782,7 +768,7 @@ bool Worksheet::writeFormula(int row,
                     } else {
                         auto newCell = std::make_shared<Cell>(result, Cell::NumberType, fmt, this);
                         newCell->d_ptr->formula = sf;
-                        d->cellTable[r][c]      = newCell;
+                        d->cellTable.setCell(r, c, newCell);
                     }
                 }
             }
@@ -819,7 +805,8 @@ bool Worksheet::writeBlank(int row, int column, const Format &format)
     d->workbook->styles()->addXfFormat(fmt);
 
     // Note: NumberType with an invalid QVariant value means blank.
-    d->cellTable[row][column] = std::make_shared<Cell>(QVariant{}, Cell::NumberType, fmt, this);
+    d->cellTable.setCell(
+        row, column, std::make_shared<Cell>(QVariant{}, Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -848,7 +835,8 @@ bool Worksheet::writeBool(int row, int column, bool value, const Format &format)
 
     Format fmt = format.isValid() ? format : d->cellFormat(row, column);
     d->workbook->styles()->addXfFormat(fmt);
-    d->cellTable[row][column] = std::make_shared<Cell>(value, Cell::BooleanType, fmt, this);
+    d->cellTable.setCell(
+        row, column, std::make_shared<Cell>(value, Cell::BooleanType, fmt, this));
 
     return true;
 }
@@ -884,7 +872,8 @@ bool Worksheet::writeDateTime(int row, int column, const QDateTime &dt, const Fo
 
     double value = datetimeToNumber(dt, d->workbook->isDate1904());
 
-    d->cellTable[row][column] = std::make_shared<Cell>(value, Cell::NumberType, fmt, this);
+    d->cellTable.setCell(
+        row, column, std::make_shared<Cell>(value, Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -914,7 +903,8 @@ bool Worksheet::writeDate(int row, int column, const QDate &dt, const Format &fo
 
     double value = datetimeToNumber(QDateTime(dt, QTime(0, 0, 0)), d->workbook->isDate1904());
 
-    d->cellTable[row][column] = std::make_shared<Cell>(value, Cell::NumberType, fmt, this);
+    d->cellTable.setCell(
+        row, column, std::make_shared<Cell>(value, Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -947,8 +937,8 @@ bool Worksheet::writeTime(int row, int column, const QTime &t, const Format &for
         fmt.setNumberFormat(QStringLiteral("hh:mm:ss"));
     d->workbook->styles()->addXfFormat(fmt);
 
-    d->cellTable[row][column] =
-        std::make_shared<Cell>(timeToNumber(t), Cell::NumberType, fmt, this);
+    d->cellTable.setCell(
+        row, column, std::make_shared<Cell>(timeToNumber(t), Cell::NumberType, fmt, this));
 
     return true;
 }
@@ -1023,8 +1013,8 @@ bool Worksheet::writeHyperlink(int row,
 
     // Write the hyperlink string as normal string.
     d->sharedStrings()->addSharedString(displayString);
-    d->cellTable[row][column] =
-        std::make_shared<Cell>(displayString, Cell::SharedStringType, fmt, this);
+    d->cellTable.setCell(
+        row, column, std::make_shared<Cell>(displayString, Cell::SharedStringType, fmt, this));
 
     // Store the hyperlink data in a separate table
     d->urlTable[row][column] = QSharedPointer<XlsxHyperlinkData>(new XlsxHyperlinkData(
@@ -1478,9 +1468,9 @@ void WorksheetPrivate::saveXmlSheetData(QXmlStreamWriter &writer) const
 {
     calculateSpans();
     for (int row_num = dimension.firstRow(); row_num <= dimension.lastRow(); row_num++) {
-        auto ctIt = cellTable.constFind(row_num);
-        auto riIt = rowsInfo.constFind(row_num);
-        if (ctIt == cellTable.constEnd() && riIt == rowsInfo.constEnd() &&
+        const bool hasCells = cellTable.hasRow(row_num);
+        auto riIt           = rowsInfo.constFind(row_num);
+        if (!hasCells && riIt == rowsInfo.constEnd() &&
             !comments.contains(row_num)) {
             // Only process rows with cell data / comments / formatting
             continue;
@@ -1525,12 +1515,14 @@ void WorksheetPrivate::saveXmlSheetData(QXmlStreamWriter &writer) const
         }
 
         // Write cell data if row contains filled cells
-        if (ctIt != cellTable.constEnd()) {
-            for (int col_num = dimension.firstColumn(); col_num <= dimension.lastColumn();
+        if (hasCells) {
+            const int lastColumn = qMin(dimension.lastColumn(), cellTable.lastColumn(row_num));
+            for (int col_num = qMax(dimension.firstColumn(), cellTable.firstColumn(row_num));
+                 col_num <= lastColumn;
                  col_num++) {
-                if (ctIt->contains(col_num)) {
-                    saveXmlCellData(writer, row_num, col_num, (*ctIt)[col_num]);
-                }
+                std::shared_ptr<Cell> cell = cellTable.cell(row_num, col_num);
+                if (cell)
+                    saveXmlCellData(writer, row_num, col_num, cell);
             }
         }
         writer.writeEndElement(); // row
@@ -2261,6 +2253,9 @@ void WorksheetPrivate::loadXmlSheetData(QXmlStreamReader &reader)
 
     Q_ASSERT(reader.name() == QLatin1String("sheetData"));
 
+    // Every cell of the sheet is created here, take them from the arena in bulk
+    cellTable.setArenaEnabled(true);
+
     int row_num = 0;
     int col_num = 0;
 
@@ -2377,7 +2372,7 @@ void WorksheetPrivate::loadXmlSheetData(QXmlStreamReader &reader)
                 }
 
                 // create a heap of new cell
-                auto cell = std::make_shared<Cell>(QVariant{}, cellType, format, q, styleIndex);
+                auto cell = cellTable.makeCell(QVariant{}, cellType, format, q, styleIndex);
 
                 while (!reader.atEnd() && !(reader.name() == QLatin1String("c") &&
                                             reader.tokenType() == QXmlStreamReader::EndElement)) {
@@ -2443,11 +2438,13 @@ void WorksheetPrivate::loadXmlSheetData(QXmlStreamReader &reader)
                     }
                 }
 
-                cellTable[pos.row()][pos.column()] = cell;
+                cellTable.setCell(pos.row(), pos.column(), cell);
             }
         }
     }
 
+    cellTable.setArenaEnabled(false);
+
     if (dimension.lastRow() < row_num)
         dimension.setLastRow(row_num);
 
@@ -2820,21 +2817,22 @@ void WorksheetPrivate::validateDimension()
     if (dimension.isValid() || cellTable.isEmpty())
         return;
 
-    const auto firstRow = cellTable.constBegin().key();
+    const auto firstRow = cellTable.firstRow();
 
-    const auto lastRow = (--cellTable.constEnd()).key();
+    const auto lastRow = cellTable.lastRow();
 
     int firstColumn = -1;
     int lastColumn  = -1;
 
-    for (auto &&it = cellTable.constBegin(); it != cellTable.constEnd(); ++it) {
-        Q_ASSERT(!it.value().isEmpty());
+    for (int row = firstRow; row <= lastRow; ++row) {
+        if (!cellTable.hasRow(row))
+            continue;
 
-        if (firstColumn == -1 || it.value().constBegin().key() < firstColumn)
-            firstColumn = it.value().constBegin().key();
+        if (firstColumn == -1 || cellTable.firstColumn(row) < firstColumn)
+            firstColumn = cellTable.firstColumn(row);
 
-        if (lastColumn == -1 || (--it.value().constEnd()).key() > lastColumn) {
-            lastColumn = (--it.value().constEnd()).key();
+        if (lastColumn == -1 || cellTable.lastColumn(row) > lastColumn) {
+            lastColumn = cellTable.lastColumn(row);
         }
     }
 
@@ -2875,37 +2873,23 @@ QVector<CellLocation> Worksheet::getFullCells(int *maxRow, int *maxCol)
         return ret;
     }
 
-    QMapIterator<int, QMap<int, std::shared_ptr<Cell>>> _it(d->cellTable);
-
-    while (_it.hasNext()) {
-        _it.next();
-
-        int keyI = _it.key();                                       // key (cell row)
-        QMapIterator<int, std::shared_ptr<Cell>> _iit(_it.value()); // value
-
-        while (_iit.hasNext()) {
-            _iit.next();
-
-            int keyII                     = _iit.key();   // key (cell column)
-            std::shared_ptr<Cell> ptrCell = _iit.value(); // value
+    d->cellTable.forEach([&](int row, int col, const std::shared_ptr<Cell> &ptrCell) {
+        CellLocation cl;
 
-            CellLocation cl;
-
-            cl.row = keyI;
-            if (keyI > (*maxRow)) {
-                (*maxRow) = keyI;
-            }
+        cl.row = row;
+        if (row > (*maxRow)) {
+            (*maxRow) = row;
+        }
 
-            cl.col = keyII;
-            if (keyII > (*maxCol)) {
-                (*maxCol) = keyII;
-            }
+        cl.col = col;
+        if (col > (*maxCol)) {
+            (*maxCol) = col;
+        }
 
-            cl.cell = ptrCell;
+        cl.cell = ptrCell;
 
-            ret.push_back(cl);
-        }
-    }
+        ret.push_back(cl);
+    });
 
     return ret;
 }
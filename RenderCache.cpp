@@ -0,0 +1,38 @@
+#include <QDebug>
+#include <QCache>
+
+#include "RenderCache.h"
+
+// Memory budget in KiB. One 2880x1250 export is about 14 MiB.
+#define CACHE_BUDGET (96 * 1024)
+
+static QCache<QByteArray, QImage> &cache ( void )
+{
+	static QCache<QByteArray, QImage> images(CACHE_BUDGET);
+	return images;
+}
+
+QImage RenderCache::find ( const QByteArray &key )
+{
+	// QCache::object() also marks the entry as most recently used
+	QImage *image = cache().object(key);
+
+	if ( image )
+	{
+		qDebug() << "Render cache hit" << key.toHex();
+		return *image;
+	}
+
+	return QImage();
+}
+
+void RenderCache::insert ( const QByteArray &key, const QImage &image )
+{
+	int cost = (image.bytesPerLine() * image.height()) / 1024;
+
+	// QCache takes ownership, and the copy shares its pixels with the caller's image
+	if ( ! cache().insert(key, new QImage(image), qMax(cost, 1)) )
+	{
+		qDebug() << "Image too large for render cache," << cost << "KiB";
+	}
+}
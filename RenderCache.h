@@ -0,0 +1,21 @@
+#ifndef RENDERCACHE_H
+#define RENDERCACHE_H
+
+#include <QByteArray>
+#include <QImage>
+
+/*
+ * Exported graph images, keyed by a hash of everything that goes into drawing them (see each tab's renderKey()). Previewing and
+ * then saving, or saving the same graph again, reuses the image instead of painting it again. Least recently used images are
+ * dropped first once the cache goes over its memory budget.
+ *
+ * Only used from the GUI thread.
+ */
+
+namespace RenderCache
+{
+	QImage find ( const QByteArray & );
+	void insert ( const QByteArray &, const QImage & );
+};
+
+#endif // RENDERCACHE_H
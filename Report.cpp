@@ -0,0 +1,352 @@
+#include <functional>
+#include <QDebug>
+#include <QDir>
+#include <QDate>
+#include <QLocale>
+#include <QFileInfo>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QPdfWriter>
+#include <QScopedPointer>
+#include <QPageSize>
+#include <QPageLayout>
+#include <QtMath>
+
+#include "Report.h"
+#include "PowderTest.h"
+#include "SeatingDepthTest.h"
+#include "TunerTest.h"
+
+// Page coordinates are in pixels at this resolution, which keeps font sizes and the exported graph size on the same scale
+#define REPORT_DPI 96
+
+// Vertical space between blocks on a page
+#define BLOCK_SPACING 24
+
+struct Section
+{
+	QString title;
+	QList<QStringList> table;
+	QSize graphSize;
+	std::function<void ( QCPPainter * )> paintGraph;
+};
+
+/*
+ * Tracks where the next block goes, starting a new page whenever one doesn't fit
+ */
+struct PageCursor
+{
+	QPdfWriter *writer;
+	QCPPainter *painter;
+	QRect page;
+	int y;
+	int numPages;
+
+	void newPage ( void )
+	{
+		writer->newPage();
+		y = 0;
+		numPages++;
+	}
+
+	bool fits ( int height )
+	{
+		return (y + height <= page.height());
+	}
+};
+
+/*
+ * Each tab's graph is built in a headless scratchCopy(), so a tab that can't be graphed is left out of the report instead of
+ * interrupting it, and the tab itself is left as the user had it
+ */
+template <typename T>
+static void prepareSection ( T *tab, const QString &title, QList<Section> &sections, QStringList &skipped )
+{
+	tab->errors.clear();
+	tab->warnings.clear();
+
+	bool res = tab->populatePlot();
+
+	if ( ! res )
+	{
+		qDebug() << "Skipping" << title << "section:" << tab->errors;
+		skipped.append(QString("%1: %2").arg(title).arg(tab->errors.join(" ")));
+		return;
+	}
+
+	Section section;
+	section.title = title;
+	section.table = tab->seriesTable();
+	section.graphSize = tab->graphSize();
+	section.paintGraph = [tab] ( QCPPainter *painter ) { tab->paintGraph(painter); };
+	sections.append(section);
+
+	foreach ( QString warning, tab->warnings )
+	{
+		skipped.append(QString("%1: %2").arg(title).arg(warning));
+	}
+}
+
+static QFont sizedFont ( const QFont &base, double pointSize, bool bold )
+{
+	QFont font(base);
+	font.setPointSizeF(pointSize);
+	font.setBold(bold);
+	return font;
+}
+
+static void drawHeading ( PageCursor &cursor, const QString &text, double pointSize )
+{
+	QCPPainter *painter = cursor.painter;
+
+	painter->setFont(sizedFont(painter->font(), pointSize, true));
+	int height = painter->fontMetrics().height();
+
+	painter->drawText(QRect(0, cursor.y, cursor.page.width(), height), Qt::AlignLeft | Qt::AlignVCenter, text);
+	cursor.y += height + BLOCK_SPACING / 2;
+}
+
+static void drawCover ( PageCursor &cursor, const QList<QPair<QString, QString> > &details, const QList<Section> &sections, const QStringList &notes )
+{
+	QCPPainter *painter = cursor.painter;
+	QFont base = painter->font();
+
+	drawHeading(cursor, "Load development report", 24);
+
+	painter->setFont(sizedFont(base, 11, false));
+	int lineHeight = painter->fontMetrics().height() * 1.4;
+
+	painter->drawText(QRect(0, cursor.y, cursor.page.width(), lineHeight), Qt::AlignLeft | Qt::AlignVCenter, QLocale().toString(QDate::currentDate(), QLocale::LongFormat));
+	cursor.y += lineHeight + BLOCK_SPACING;
+
+	/* Load details, two columns of label and value */
+
+	int labelWidth = cursor.page.width() / 5;
+
+	for ( int i = 0; i < details.size(); i++ )
+	{
+		painter->setFont(sizedFont(base, 11, true));
+		painter->drawText(QRect(0, cursor.y, labelWidth, lineHeight), Qt::AlignLeft | Qt::AlignVCenter, details.at(i).first + ":");
+
+		painter->setFont(sizedFont(base, 11, false));
+		painter->drawText(QRect(labelWidth, cursor.y, cursor.page.width() - labelWidth, lineHeight), Qt::AlignLeft | Qt::AlignVCenter, details.at(i).second);
+
+		cursor.y += lineHeight;
+	}
+
+	cursor.y += BLOCK_SPACING;
+
+	/* What's in the rest of the report */
+
+	drawHeading(cursor, "Contents", 14);
+
+	painter->setFont(sizedFont(base, 11, false));
+	for ( int i = 0; i < sections.size(); i++ )
+	{
+		painter->drawText(QRect(0, cursor.y, cursor.page.width(), lineHeight), Qt::AlignLeft | Qt::AlignVCenter, sections.at(i).title);
+		cursor.y += lineHeight;
+	}
+
+	if ( ! notes.empty() )
+	{
+		cursor.y += BLOCK_SPACING;
+
+		drawHeading(cursor, "Notes", 14);
+
+		painter->setFont(sizedFont(base, 11, false));
+		foreach ( QString note, notes )
+		{
+			QRect bounds = painter->boundingRect(QRect(0, 0, cursor.page.width(), cursor.page.height()), Qt::TextWordWrap, note);
+			if ( ! cursor.fits(bounds.height()) )
+			{
+				break;
+			}
+
+			painter->drawText(QRect(0, cursor.y, cursor.page.width(), bounds.height()), Qt::AlignLeft | Qt::TextWordWrap, note);
+			cursor.y += bounds.height() + lineHeight / 4;
+		}
+	}
+
+	painter->setFont(base);
+}
+
+static void drawTableRow ( PageCursor &cursor, const QStringList &row, int rowHeight, bool header )
+{
+	QCPPainter *painter = cursor.painter;
+
+	int columnWidth = cursor.page.width() / row.size();
+
+	for ( int i = 0; i < row.size(); i++ )
+	{
+		// Series names read best left aligned, numbers centered under their heading
+		int flags = Qt::AlignVCenter | ((i == 0) ? Qt::AlignLeft : Qt::AlignHCenter);
+		painter->drawText(QRect(i * columnWidth, cursor.y, columnWidth, rowHeight), flags, row.at(i));
+	}
+
+	cursor.y += rowHeight;
+
+	if ( header )
+	{
+		painter->drawLine(0, cursor.y, cursor.page.width(), cursor.y);
+	}
+}
+
+/*
+ * Statistics table under the graph. Rows that don't fit carry over onto as many pages as needed, repeating the header row.
+ */
+static void drawTable ( PageCursor &cursor, const QString &title, const QList<QStringList> &table )
+{
+	QCPPainter *painter = cursor.painter;
+	QFont base = painter->font();
+
+	painter->setFont(sizedFont(base, 10, false));
+	int rowHeight = painter->fontMetrics().height() * 1.5;
+
+	bool needHeader = true;
+	for ( int i = 1; i < table.size(); i++ )
+	{
+		if ( ! cursor.fits(rowHeight * (needHeader ? 2 : 1)) )
+		{
+			cursor.newPage();
+			drawHeading(cursor, QString("%1 (continued)").arg(title), 14);
+			needHeader = true;
+		}
+
+		if ( needHeader )
+		{
+			painter->setFont(sizedFont(base, 10, true));
+			drawTableRow(cursor, table.at(0), rowHeight, true);
+			needHeader = false;
+		}
+
+		painter->setFont(sizedFont(base, 10, false));
+		drawTableRow(cursor, table.at(i), rowHeight, false);
+	}
+
+	painter->setFont(base);
+}
+
+static void drawSection ( PageCursor &cursor, const Section &section )
+{
+	QCPPainter *painter = cursor.painter;
+
+	drawHeading(cursor, section.title, 16);
+
+	/* Graph, scaled down to the width of the page or whatever's left of its height */
+
+	double scale = qMin((double)cursor.page.width() / section.graphSize.width(), (double)(cursor.page.height() - cursor.y) / section.graphSize.height());
+
+	painter->save();
+	painter->translate(0, cursor.y);
+	painter->scale(scale, scale);
+	section.paintGraph(painter);
+	painter->restore();
+
+	cursor.y += qCeil(section.graphSize.height() * scale) + BLOCK_SPACING;
+
+	drawTable(cursor, section.title, section.table);
+}
+
+void Report::saveReport ( QWidget *parent, Powder::PowderTest *powderTest, SeatingDepth::SeatingDepthTest *seatingTest, Tuner::TunerTest *tunerTest )
+{
+	qDebug() << "saveReport";
+
+	/* Build each tab's graph, leaving out any that can't be graphed */
+
+	QList<Section> sections;
+	QStringList notes;
+
+	QScopedPointer<Powder::PowderTest> powderScratch(powderTest->scratchCopy());
+	QScopedPointer<SeatingDepth::SeatingDepthTest> seatingScratch(seatingTest->scratchCopy());
+	QScopedPointer<Tuner::TunerTest> tunerScratch(tunerTest->scratchCopy());
+
+	prepareSection(powderScratch.data(), "Powder charge", sections, notes);
+	prepareSection(seatingScratch.data(), "Seating depth", sections, notes);
+	prepareSection(tunerScratch.data(), "Tuner", sections, notes);
+
+	if ( sections.empty() )
+	{
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText("At least one tab needs data to graph before a report can be created!");
+		msg.setWindowTitle("Error");
+		msg.exec();
+		return;
+	}
+
+	/* Details are usually only filled in on one tab, take the first value entered for each */
+
+	QList<QPair<QString, QString> > allDetails;
+	allDetails << powderTest->reportDetails() << seatingTest->reportDetails() << tunerTest->reportDetails();
+
+	QList<QPair<QString, QString> > details;
+	QStringList seen;
+	for ( int i = 0; i < allDetails.size(); i++ )
+	{
+		if ( allDetails.at(i).second.isEmpty() || seen.contains(allDetails.at(i).first) )
+		{
+			continue;
+		}
+
+		seen.append(allDetails.at(i).first);
+		details.append(allDetails.at(i));
+	}
+
+	/* Pick where to save it */
+
+	QString path = QFileDialog::getSaveFileName(parent, "Save report", QDir::home().filePath("report.pdf"), "PDF file (*.pdf)");
+	qDebug() << "User selected save path:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qDebug() << "No path selected, bailing";
+		return;
+	}
+
+	if ( QFileInfo(path).suffix().toLower() != "pdf" )
+	{
+		path.append(".pdf");
+	}
+
+	/* Write the pages */
+
+	QPdfWriter writer(path);
+	writer.setTitle("Load development report");
+	writer.setCreator("ChronoPlotter");
+	writer.setResolution(REPORT_DPI);
+	writer.setPageSize(QPageSize(QPageSize::Letter));
+	writer.setPageOrientation(QPageLayout::Landscape);
+	writer.setPageMargins(QMarginsF(15, 15, 15, 15), QPageLayout::Millimeter);
+
+	QCPPainter painter;
+	if ( ! painter.begin(&writer) )
+	{
+		qDebug() << "Unable to start painting" << path;
+		showSaveResult(parent, path, false);
+		return;
+	}
+
+	painter.setMode(QCPPainter::pmVectorized);
+	painter.setMode(QCPPainter::pmNoCaching);
+
+	PageCursor cursor;
+	cursor.writer = &writer;
+	cursor.painter = &painter;
+	cursor.page = QRect(QPoint(0, 0), writer.pageLayout().paintRectPixels(writer.resolution()).size());
+	cursor.y = 0;
+	cursor.numPages = 1;
+
+	drawCover(cursor, details, sections, notes);
+
+	for ( int i = 0; i < sections.size(); i++ )
+	{
+		cursor.newPage();
+		drawSection(cursor, sections.at(i));
+	}
+
+	bool res = painter.end();
+
+	qDebug() << "Wrote" << cursor.numPages << "pages, res =" << res;
+
+	showSaveResult(parent, path, res);
+}
@@ -0,0 +1,20 @@
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <QWidget>
+
+namespace Powder { class PowderTest; };
+namespace SeatingDepth { class SeatingDepthTest; };
+namespace Tuner { class TunerTest; };
+
+/*
+ * Load development report: a single PDF with a cover sheet followed by the graph and per-series statistics of every tab that
+ * has enough data to graph. Pages are painted one at a time into one QPdfWriter, so nothing is held onto between pages.
+ */
+
+namespace Report
+{
+	void saveReport ( QWidget *, Powder::PowderTest *, SeatingDepth::SeatingDepthTest *, Tuner::TunerTest * );
+};
+
+#endif // REPORT_H
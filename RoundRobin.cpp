@@ -0,0 +1,121 @@
+#include <QDebug>
+#include <QString>
+#include <QStringList>
+#include <QRegularExpression>
+
+#include "RoundRobin.h"
+
+/*
+ * Shot k of every string is charge weight order[k % numLoads]. An empty order means the charge weights were fired in list
+ * order. Strings that end partway through a round just contribute fewer shots to the charge weights they didn't reach.
+ */
+RoundRobin::Conversion RoundRobin::transpose ( const QVector<QList<double> > &strings, int numLoads, const QVector<int> &order )
+{
+	Conversion conversion;
+
+	if ( numLoads <= 0 )
+	{
+		return conversion;
+	}
+
+	conversion.loads.resize(numLoads);
+	conversion.sources.resize(numLoads);
+	conversion.stringSizes.resize(strings.size());
+
+	for ( int i = 0; i < strings.size(); i++ )
+	{
+		const QList<double> &string = strings.at(i);
+		conversion.stringSizes[i] = string.size();
+
+		for ( int k = 0; k < string.size(); k++ )
+		{
+			int position = k % numLoads;
+			int load = order.isEmpty() ? position : order.at(position);
+
+			Source source;
+			source.string = i;
+			source.shot = k;
+
+			conversion.loads[load].append(string.at(k));
+			conversion.sources[load].append(source);
+		}
+	}
+
+	qDebug() << "Round-robin:" << strings.size() << "strings into" << numLoads << "charge weights";
+
+	return conversion;
+}
+
+/*
+ * Puts every converted shot back where it came from
+ */
+QVector<QList<double> > RoundRobin::restore ( const Conversion &conversion )
+{
+	QVector<QVector<double> > buffers(conversion.stringSizes.size());
+	for ( int i = 0; i < buffers.size(); i++ )
+	{
+		buffers[i].resize(conversion.stringSizes.at(i));
+	}
+
+	for ( int i = 0; i < conversion.loads.size(); i++ )
+	{
+		const QList<double> &load = conversion.loads.at(i);
+		const QVector<Source> &sources = conversion.sources.at(i);
+
+		for ( int j = 0; j < load.size(); j++ )
+		{
+			buffers[sources.at(j).string][sources.at(j).shot] = load.at(j);
+		}
+	}
+
+	QVector<QList<double> > strings(buffers.size());
+	for ( int i = 0; i < buffers.size(); i++ )
+	{
+		strings[i] = buffers.at(i).toList();
+	}
+
+	return strings;
+}
+
+/*
+ * Reads a firing order typed as 1-based charge weight numbers, such as "3, 1, 4, 2". Every charge weight must appear exactly
+ * once. Returns 0-based indices, or an empty order for blank text meaning list order.
+ */
+QVector<int> RoundRobin::parseOrder ( const QString &text, int numLoads, bool *ok )
+{
+	QVector<int> order;
+	*ok = true;
+
+	// Leading or trailing separators leave empty fields. They're dropped here rather than with a split flag, which moved between Qt versions.
+	QStringList fields = text.split(QRegularExpression("[\\s,]+"));
+	fields.removeAll(QString(""));
+	if ( fields.isEmpty() )
+	{
+		return order;
+	}
+
+	QVector<bool> seen(numLoads, false);
+
+	for ( int i = 0; i < fields.size(); i++ )
+	{
+		bool isNumber;
+		int load = fields.at(i).toInt(&isNumber) - 1;
+
+		if ( (! isNumber) || (load < 0) || (load >= numLoads) || seen.at(load) )
+		{
+			*ok = false;
+			return QVector<int>();
+		}
+
+		seen[load] = true;
+		order.append(load);
+	}
+
+	if ( order.size() != numLoads )
+	{
+		*ok = false;
+		return QVector<int>();
+	}
+
+	return order;
+}
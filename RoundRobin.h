@@ -0,0 +1,35 @@
+#ifndef ROUNDROBIN_H
+#define ROUNDROBIN_H
+
+#include <QVector>
+#include <QList>
+#include <QString>
+
+/*
+ * Converts strings shot round-robin (every charge weight once per round, over one or more rounds) into one string per charge
+ * weight. Strings may be different lengths and a round may be fired in any order. Where every converted shot came from is
+ * kept alongside it, so the conversion can be undone without holding on to a second copy of the original strings.
+ */
+
+namespace RoundRobin
+{
+	// Position of a converted shot in the original strings
+	struct Source
+	{
+		int string;
+		int shot;
+	};
+
+	struct Conversion
+	{
+		QVector<QList<double> > loads; // shots for each charge weight, in the order they were fired
+		QVector<QVector<Source> > sources; // parallel to loads
+		QVector<int> stringSizes;
+	};
+
+	Conversion transpose ( const QVector<QList<double> > &, int, const QVector<int> & );
+	QVector<QList<double> > restore ( const Conversion & );
+	QVector<int> parseOrder ( const QString &, int, bool * );
+};
+
+#endif // ROUNDROBIN_H
@@ -1,7 +1,16 @@
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QHeaderView>
+
 #include "untar.h"
 #include "miniz.h"
 #include "ChronoPlotter.h"
 #include "SeatingDepthTest.h"
+#include "Outliers.h"
+#include "LabelLayout.h"
+#include "RenderCache.h"
+#include "ShotArchive.h"
+#include "History.h"
 
 using namespace SeatingDepth;
 
@@ -131,6 +140,295 @@ double SeatingDepthTest::calculateMR ( QList<QPair<double, double> > coordinates
 	return meanRadius;
 }
 
+/*
+ * Linear group measurements (like CEP) don't need to be recalculated from converted coordinates, so derive every unit directly
+ * from the inch value. The results are appended in the order of the index constants used in groupUnits.
+ */
+static void AppendGroupUnits ( QList<double> &list, double inches, int targetDistance )
+{
+	list.append(inches);
+	list.append(inches / (1.047 * ((double)targetDistance / (double)100)));
+	list.append(inches * 2.54);
+	list.append(inches / (((double)targetDistance * 3 * 12) / (double)1000));
+}
+
+void SeatingDepthTest::calculateGroupSizes ( SeatingSeries *series )
+{
+	// Start over in case the series' shots have changed since the last calculation
+	series->extremeSpread.clear();
+	series->extremeSpread_sighters.clear();
+	series->yStdev.clear();
+	series->yStdev_sighters.clear();
+	series->xStdev.clear();
+	series->xStdev_sighters.clear();
+	series->radialStdev.clear();
+	series->radialStdev_sighters.clear();
+	series->meanRadius.clear();
+	series->meanRadius_sighters.clear();
+	series->cep50.clear();
+	series->cep50_sighters.clear();
+	series->cep90.clear();
+	series->cep90_sighters.clear();
+
+	/* Source coordinates are already in inches, perform calculations directly */
+
+	series->extremeSpread.append(calculateES(series->coordinates));
+	series->extremeSpread_sighters.append(calculateES(series->coordinates_sighters));
+	series->yStdev.append(calculateYStdev(series->coordinates));
+	series->yStdev_sighters.append(calculateYStdev(series->coordinates_sighters));
+	series->xStdev.append(calculateXStdev(series->coordinates));
+	series->xStdev_sighters.append(calculateXStdev(series->coordinates_sighters));
+	series->radialStdev.append(calculateRSD(series->coordinates));
+	series->radialStdev_sighters.append(calculateRSD(series->coordinates_sighters));
+	series->meanRadius.append(calculateMR(series->coordinates));
+	series->meanRadius_sighters.append(calculateMR(series->coordinates_sighters));
+
+	/* Convert inches to MOA */
+
+	// C++ is tricky here. If we don't cast targetDistance or 100 to a double, then calculations like 650 / 100 will return 6 instead of 6.5!
+	series->extremeSpread.append( series->extremeSpread.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->extremeSpread_sighters.append( series->extremeSpread_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->yStdev.append( series->yStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->yStdev_sighters.append( series->yStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->xStdev.append( series->xStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->xStdev_sighters.append( series->xStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->radialStdev.append( series->radialStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->radialStdev_sighters.append( series->radialStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->meanRadius.append( series->meanRadius.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+	series->meanRadius_sighters.append( series->meanRadius_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
+
+	/* Convert inches to centimeters, then perform calculations */
+
+	QList<QPair<double, double> > coordinatesCm;
+	for ( int i = 0; i < series->coordinates.size(); i++ )
+	{
+		// convert inches to cm
+		coordinatesCm.append( QPair<double, double>(series->coordinates.at(i).first * 2.54, series->coordinates.at(i).second * 2.54) );
+	}
+
+	QList<QPair<double, double> > coordinatesCm_sighters;
+	for ( int i = 0; i < series->coordinates_sighters.size(); i++ )
+	{
+		// convert inches to cm
+		coordinatesCm_sighters.append( QPair<double, double>(series->coordinates_sighters.at(i).first * 2.54, series->coordinates_sighters.at(i).second * 2.54) );
+	}
+
+	series->extremeSpread.append(calculateES(coordinatesCm));
+	series->extremeSpread_sighters.append(calculateES(coordinatesCm_sighters));
+	series->yStdev.append(calculateYStdev(coordinatesCm));
+	series->yStdev_sighters.append(calculateYStdev(coordinatesCm_sighters));
+	series->xStdev.append(calculateXStdev(coordinatesCm));
+	series->xStdev_sighters.append(calculateXStdev(coordinatesCm_sighters));
+	series->radialStdev.append(calculateRSD(coordinatesCm));
+	series->radialStdev_sighters.append(calculateRSD(coordinatesCm_sighters));
+	series->meanRadius.append(calculateMR(coordinatesCm));
+	series->meanRadius_sighters.append(calculateMR(coordinatesCm_sighters));
+
+	/* Convert inches to mils */
+
+	// mils = target distance (converted from yards to inches), divided by 1000. What elegance!
+	series->extremeSpread.append( series->extremeSpread.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->extremeSpread_sighters.append( series->extremeSpread_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->yStdev.append( series->yStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->yStdev_sighters.append( series->yStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->xStdev.append( series->xStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->xStdev_sighters.append( series->xStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->radialStdev.append( series->radialStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->radialStdev_sighters.append( series->radialStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->meanRadius.append( series->meanRadius.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+	series->meanRadius_sighters.append( series->meanRadius_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
+
+	/* Group shape and closed-form CEP, refined later by refineGroupShapes() once every series is loaded */
+
+	series->dispersion = Dispersion::calculate(series->coordinates);
+	series->dispersion_sighters = Dispersion::calculate(series->coordinates_sighters);
+
+	AppendGroupUnits(series->cep50, series->dispersion.cep50, series->targetDistance);
+	AppendGroupUnits(series->cep50_sighters, series->dispersion_sighters.cep50, series->targetDistance);
+	AppendGroupUnits(series->cep90, series->dispersion.cep90, series->targetDistance);
+	AppendGroupUnits(series->cep90_sighters, series->dispersion_sighters.cep90, series->targetDistance);
+}
+
+void SeatingDepthTest::refineGroupShapes ( void )
+{
+	/* Refine every group's CEP with a Monte Carlo pass, all series at once */
+
+	QVector<Dispersion::Ellipse *> ellipses;
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		ellipses.append(&seatingSeriesData.at(i)->dispersion);
+		ellipses.append(&seatingSeriesData.at(i)->dispersion_sighters);
+	}
+
+	Dispersion::refine(ellipses);
+
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		SeatingSeries *series = seatingSeriesData.at(i);
+
+		series->cep50.clear();
+		series->cep50_sighters.clear();
+		series->cep90.clear();
+		series->cep90_sighters.clear();
+
+		AppendGroupUnits(series->cep50, series->dispersion.cep50, series->targetDistance);
+		AppendGroupUnits(series->cep50_sighters, series->dispersion_sighters.cep50, series->targetDistance);
+		AppendGroupUnits(series->cep90, series->dispersion.cep90, series->targetDistance);
+		AppendGroupUnits(series->cep90_sighters, series->dispersion_sighters.cep90, series->targetDistance);
+
+		qDebug() << "Series '" << series->name << "' has CEP50" << series->cep50 << "and CEP90" << series->cep90 << ", principal axes" << series->dispersion.majorStdev << series->dispersion.minorStdev << "at" << qRadiansToDegrees(series->dispersion.angle) << "degrees";
+	}
+
+}
+
+QList<QPair<QString, QWidget *> > SeatingDepthTest::optionWidgets ( void )
+{
+	QList<QPair<QString, QWidget *> > widgets;
+	widgets << qMakePair(QString("graphTitle"), (QWidget *)graphTitle);
+	widgets << qMakePair(QString("rifle"), (QWidget *)rifle);
+	widgets << qMakePair(QString("projectile"), (QWidget *)projectile);
+	widgets << qMakePair(QString("propellant"), (QWidget *)propellant);
+	widgets << qMakePair(QString("brass"), (QWidget *)brass);
+	widgets << qMakePair(QString("primer"), (QWidget *)primer);
+	widgets << qMakePair(QString("weather"), (QWidget *)weather);
+	widgets << qMakePair(QString("distance"), (QWidget *)distance);
+	widgets << qMakePair(QString("cartridgeUnits"), (QWidget *)cartridgeUnits);
+	widgets << qMakePair(QString("cartridgeMeasurementType"), (QWidget *)cartridgeMeasurementType);
+	widgets << qMakePair(QString("groupMeasurementType"), (QWidget *)groupMeasurementType);
+	widgets << qMakePair(QString("groupUnits"), (QWidget *)groupUnits);
+	widgets << qMakePair(QString("xAxisSpacing"), (QWidget *)xAxisSpacing);
+	widgets << qMakePair(QString("groupSize"), (QWidget *)groupSizeCheckBox);
+	widgets << qMakePair(QString("groupSizeLocation"), (QWidget *)groupSizeLocation);
+	widgets << qMakePair(QString("gsd"), (QWidget *)gsdCheckBox);
+	widgets << qMakePair(QString("gsdLocation"), (QWidget *)gsdLocation);
+	widgets << qMakePair(QString("trend"), (QWidget *)trendCheckBox);
+	widgets << qMakePair(QString("trendLineType"), (QWidget *)trendLineType);
+	widgets << qMakePair(QString("ellipse"), (QWidget *)ellipseCheckBox);
+	widgets << qMakePair(QString("includeSighters"), (QWidget *)includeSightersCheckBox);
+	widgets << qMakePair(QString("pattern"), (QWidget *)patternCheckBox);
+
+	return widgets;
+}
+
+QVariantMap SeatingDepthTest::saveOptions ( void )
+{
+	return saveOptionWidgets(optionWidgets());
+}
+
+bool SeatingDepthTest::isManualEntry ( void )
+{
+	return seriesModel->isManual();
+}
+
+/*
+ * Replaces the tab's data and options with ones read from a project file. The series are adopted by the tab. Group sizes of
+ * imported series are measured again from their shots, the same way they are on import.
+ */
+void SeatingDepthTest::restoreProject ( const QVariantMap &options, const QList<SeatingSeries *> &seriesList, bool manual )
+{
+	unloadData();
+
+	restoreOptionWidgets(optionWidgets(), options);
+
+	optionCheckBoxChanged(groupSizeCheckBox, groupSizeLabel, groupSizeLocation);
+	optionCheckBoxChanged(gsdCheckBox, gsdLabel, gsdLocation);
+	optionCheckBoxChanged(trendCheckBox, trendLabel, trendLineType);
+	seriesModel->setLengthType(cartridgeMeasurementType->currentText());
+
+	// Sighters only exist in imported shot data
+	if ( manual || seriesList.isEmpty() )
+	{
+		includeSightersCheckBox->setChecked(false);
+	}
+
+	seriesModel->setGroupDisplay(groupMeasurementType->currentIndex(), groupUnits->currentIndex(), includeSightersCheckBox->isChecked());
+
+	if ( seriesList.isEmpty() )
+	{
+		return;
+	}
+
+	for ( int i = 0; i < seriesList.size(); i++ )
+	{
+		SeatingSeries *series = seriesList.at(i);
+
+		if ( ! manual )
+		{
+			calculateGroupSizes(series);
+		}
+
+		seatingSeriesData.append(arena.adopt(series));
+	}
+
+	if ( manual )
+	{
+		showManualEntry();
+
+		for ( int i = 0; i < seatingSeriesData.size(); i++ )
+		{
+			addSeriesButtons(i);
+		}
+
+		// Only the first row of a new table needs pointing out
+		addNewButton->setStyleSheet("");
+
+		return;
+	}
+
+	refineGroupShapes();
+
+	connect(includeSightersCheckBox, SIGNAL(clicked(bool)), this, SLOT(importedGroupIncludeSightersCheckBoxChanged(bool)));
+
+	includeSightersCheckBox->setEnabled(true);
+	includeSightersLabel->setStyleSheet("");
+
+	DisplaySeriesData();
+
+	DetectOutliers();
+
+	// updateDisplayedData() re-enables any series it can measure, so put back the ones that were saved disabled
+	QList<bool> enabled;
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		enabled.append(seatingSeriesData.at(i)->enabled);
+	}
+
+	updateDisplayedData();
+
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		if ( ! enabled.at(i) )
+		{
+			seatingSeriesData.at(i)->enabled = false;
+		}
+	}
+
+	seriesModel->refresh();
+}
+
+/*
+ * A hidden tab with copies of this one's series and options. Reports and workbooks populate their graphs in one, so whatever
+ * populatePlot() changes along the way (e.g. constant spacing on duplicate values) never reaches the tab the user is working in.
+ */
+SeatingDepthTest *SeatingDepthTest::scratchCopy ( void )
+{
+	QList<SeatingSeries *> copies;
+
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		if ( ! seatingSeriesData.at(i)->deleted )
+		{
+			copies.append(new SeatingSeries(*seatingSeriesData.at(i)));
+		}
+	}
+
+	SeatingDepthTest *scratch = new SeatingDepthTest();
+	scratch->headless = true;
+	scratch->restoreProject(saveOptions(), copies, isManualEntry());
+
+	return scratch;
+}
+
 void SeatingDepthTest::selectShotMarkerFile ( bool state )
 {
 	qDebug() << "selectShotMarkerFile state =" << state;
@@ -148,7 +446,7 @@ void SeatingDepthTest::selectShotMarkerFile ( bool state )
 		return;
 	}
 
-	seatingSeriesData.clear();
+	clearSeries();
 
 	/*
 	 * ShotMarker records all of its series data in a single .CSV file
@@ -185,14 +483,9 @@ void SeatingDepthTest::selectShotMarkerFile ( bool state )
 		{
 			SeatingSeries *series = allSeries.at(i);
 
-			series->enabled = new QCheckBox();
-			series->enabled->setChecked(true);
+			series->enabled = true;
 
-			series->cartridgeLength = new QDoubleSpinBox();
-			series->cartridgeLength->setDecimals(3);
-			series->cartridgeLength->setSingleStep(0.001);
-			series->cartridgeLength->setMinimumWidth(100);
-			series->cartridgeLength->setMaximumWidth(100);
+			series->cartridgeLength = 0;
 
 			/*
 			 * ShotMarker internally records shot coordinates in millimeters (at least it appears to, from studying its file formats). String
@@ -209,168 +502,44 @@ void SeatingDepthTest::selectShotMarkerFile ( bool state )
 			 * where each index correlates to the index constants used in groupUnits.
 			 */
 
-			/* Source coordinates are already in inches, perform calculations directly */
-
-			series->extremeSpread.append(calculateES(series->coordinates));
-			series->extremeSpread_sighters.append(calculateES(series->coordinates_sighters));
-			series->yStdev.append(calculateYStdev(series->coordinates));
-			series->yStdev_sighters.append(calculateYStdev(series->coordinates_sighters));
-			series->xStdev.append(calculateXStdev(series->coordinates));
-			series->xStdev_sighters.append(calculateXStdev(series->coordinates_sighters));
-			series->radialStdev.append(calculateRSD(series->coordinates));
-			series->radialStdev_sighters.append(calculateRSD(series->coordinates_sighters));
-			series->meanRadius.append(calculateMR(series->coordinates));
-			series->meanRadius_sighters.append(calculateMR(series->coordinates_sighters));
-
-			/* Convert inches to MOA */
-
-			// C++ is tricky here. If we don't cast targetDistance or 100 to a double, then calculations like 650 / 100 will return 6 instead of 6.5!
-			series->extremeSpread.append( series->extremeSpread.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->extremeSpread_sighters.append( series->extremeSpread_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->yStdev.append( series->yStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->yStdev_sighters.append( series->yStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->xStdev.append( series->xStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->xStdev_sighters.append( series->xStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->radialStdev.append( series->radialStdev.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->radialStdev_sighters.append( series->radialStdev_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->meanRadius.append( series->meanRadius.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-			series->meanRadius_sighters.append( series->meanRadius_sighters.at(INCH) / (1.047 * ((double)series->targetDistance / (double)100)) );
-
-			/* Convert inches to centimeters, then perform calculations */
-
-			QList<QPair<double, double> > coordinatesCm;
-			for ( int i = 0; i < series->coordinates.size(); i++ )
-			{
-				// convert inches to cm
-				coordinatesCm.append( QPair<double, double>(series->coordinates.at(i).first * 2.54, series->coordinates.at(i).second * 2.54) );
-			}
-
-			QList<QPair<double, double> > coordinatesCm_sighters;
-			for ( int i = 0; i < series->coordinates_sighters.size(); i++ )
-			{
-				// convert inches to cm
-				coordinatesCm_sighters.append( QPair<double, double>(series->coordinates_sighters.at(i).first * 2.54, series->coordinates_sighters.at(i).second * 2.54) );
-			}
-
-			series->extremeSpread.append(calculateES(coordinatesCm));
-			series->extremeSpread_sighters.append(calculateES(coordinatesCm_sighters));
-			series->yStdev.append(calculateYStdev(coordinatesCm));
-			series->yStdev_sighters.append(calculateYStdev(coordinatesCm_sighters));
-			series->xStdev.append(calculateXStdev(coordinatesCm));
-			series->xStdev_sighters.append(calculateXStdev(coordinatesCm_sighters));
-			series->radialStdev.append(calculateRSD(coordinatesCm));
-			series->radialStdev_sighters.append(calculateRSD(coordinatesCm_sighters));
-			series->meanRadius.append(calculateMR(coordinatesCm));
-			series->meanRadius_sighters.append(calculateMR(coordinatesCm_sighters));
-
-			/* Convert inches to mils */
-
-			// mils = target distance (converted from yards to inches), divided by 1000. What elegance!
-			series->extremeSpread.append( series->extremeSpread.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->extremeSpread_sighters.append( series->extremeSpread_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->yStdev.append( series->yStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->yStdev_sighters.append( series->yStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->xStdev.append( series->xStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->xStdev_sighters.append( series->xStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->radialStdev.append( series->radialStdev.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->radialStdev_sighters.append( series->radialStdev_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->meanRadius.append( series->meanRadius.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-			series->meanRadius_sighters.append( series->meanRadius_sighters.at(INCH) / (((double)series->targetDistance * 3 * 12) / (double)1000) );
-
-			const char *groupUnits2;
-			if ( groupUnits->currentIndex() == INCH )
-			{
-				groupUnits2 = "in";
-			}
-			else if ( groupUnits->currentIndex() == MOA )
-			{
-				groupUnits2 = "MOA";
-			}
-			else if ( groupUnits->currentIndex() == CENTIMETER )
-			{
-				groupUnits2 = "cm";
-			}
-			else
-			{
-				groupUnits2 = "mil";
-			}
+			calculateGroupSizes(series);
 
 			if ( includeSightersCheckBox->isChecked() )
 			{
-				if ( groupMeasurementType->currentIndex() == ES )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->extremeSpread_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == YSTDEV )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->yStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == XSTDEV )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->xStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == RSD )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->radialStdev_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->meanRadius_sighters.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-
-				qDebug() << "Series '" << series->name->text() << "' has ES" << series->extremeSpread_sighters << ", RSD" << series->radialStdev_sighters << ", and MR" << series->meanRadius_sighters << "(with sighters) at target distance" << series->targetDistance;
+				qDebug() << "Series '" << series->name << "' has ES" << series->extremeSpread_sighters << ", RSD" << series->radialStdev_sighters << ", and MR" << series->meanRadius_sighters << "(with sighters) at target distance" << series->targetDistance;
 			}
 			else
 			{
-				if ( groupMeasurementType->currentIndex() == ES )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->extremeSpread.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == YSTDEV )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->yStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == XSTDEV )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->xStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else if ( groupMeasurementType->currentIndex() == RSD )
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->radialStdev.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-				else
-				{
-					series->groupSizeLabel = new QLabel(QString("%1 %2").arg(series->meanRadius.at(groupUnits->currentIndex()), 0, 'f', 3).arg(groupUnits2));
-				}
-
-				qDebug() << "Series '" << series->name->text() << "' has ES" << series->extremeSpread << ", RSD" << series->radialStdev << ", and MR" << series->meanRadius << "at target distance" << series->targetDistance;
+				qDebug() << "Series '" << series->name << "' has ES" << series->extremeSpread << ", RSD" << series->radialStdev << ", and MR" << series->meanRadius << "at target distance" << series->targetDistance;
 			}
 
-			seatingSeriesData.append(series);
+			seatingSeriesData.append(arena.adopt(series));
 		}
 	}
 
+	refineGroupShapes();
+
 	/* We're finished parsing the file */
 
 	if ( seatingSeriesData.empty() )
 	{
 		qDebug() << "Didn't find any shot data in this file, bail";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText(QString("Unable to find ShotMarker data in '%1'").arg(path));
-		msg->setWindowTitle("Error");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText(QString("Unable to find ShotMarker data in '%1'").arg(path));
+		msg.setWindowTitle("Error");
+		msg.exec();
 	}
 	else
 	{
 		qDebug() << "Detected ShotMarker file" << path;
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Information);
-		msg->setText(QString("Detected ShotMarker data\n\nUsing '%1'").arg(path));
-		msg->setWindowTitle("Success");
-		msg->exec();
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Information);
+		msg.setText(QString("Detected ShotMarker data\n\nUsing '%1'").arg(path));
+		msg.setWindowTitle("Success");
+		msg.exec();
 
 		// Connect and enable 'Include sighters' checkbox
 		connect(includeSightersCheckBox, SIGNAL(clicked(bool)), this, SLOT(importedGroupIncludeSightersCheckBoxChanged(bool)));
@@ -381,6 +550,11 @@ void SeatingDepthTest::selectShotMarkerFile ( bool state )
 		// Proceed to display the data
 		DisplaySeriesData();
 
+		recordHistory();
+
+		// Flag any flyers in the newly displayed data
+		DetectOutliers();
+
 		// Convenience function to disable any series with too few shots to calculate
 		updateDisplayedData();
 	}
@@ -389,7 +563,6 @@ void SeatingDepthTest::selectShotMarkerFile ( bool state )
 QList<SeatingSeries *> SeatingDepthTest::ExtractShotMarkerSeriesTar ( QString path )
 {
 	QList<SeatingSeries *> allSeries;
-	SeatingSeries *curSeries = new SeatingSeries();
 	QTemporaryDir tempDir;
 	int ret;
 
@@ -485,11 +658,11 @@ QList<SeatingSeries *> SeatingDepthTest::ExtractShotMarkerSeriesTar ( QString pa
 
 		qDebug() << "Beginning new series";
 
-		curSeries = new SeatingSeries();
+		SeatingSeries *curSeries = new SeatingSeries();
 		curSeries->isValid = false;
 		curSeries->seriesNum = seriesNum;
 		qDebug() << "name =" << jsonObj["name"].toString();
-		curSeries->name = new QLabel(jsonObj["name"].toString() + QString(" (%1%2)").arg(jsonObj["dist"].toInt()).arg(jsonObj["dist_unit"].toString()));
+		curSeries->name = jsonObj["name"].toString() + QString(" (%1%2)").arg(jsonObj["dist"].toInt()).arg(jsonObj["dist_unit"].toString());
 		curSeries->deleted = false;
 		QDateTime dateTime;
 		dateTime.setMSecsSinceEpoch(jsonObj["ts"].toVariant().toULongLong());
@@ -548,6 +721,10 @@ QList<SeatingSeries *> SeatingDepthTest::ExtractShotMarkerSeriesTar ( QString pa
 
 			allSeries.append(curSeries);
 		}
+		else
+		{
+			delete curSeries;
+		}
 
 		free(destBuf);
 
@@ -594,6 +771,7 @@ QList<SeatingSeries *> SeatingDepthTest::ExtractShotMarkerSeriesCsv ( QTextStrea
 			else
 			{
 				qDebug() << "File doesn't have the ShotMarker header, bailing";
+				delete curSeries;
 				return allSeries;
 			}
 		}
@@ -613,13 +791,17 @@ QList<SeatingSeries *> SeatingDepthTest::ExtractShotMarkerSeriesCsv ( QTextStrea
 
 					allSeries.append(curSeries);
 				}
+				else
+				{
+					delete curSeries;
+				}
 
 				qDebug() << "Beginning new series";
 
 				curSeries = new SeatingSeries();
 				curSeries->isValid = false;
 				curSeries->seriesNum = seriesNum;
-				curSeries->name = new QLabel(rows.at(1) + QString(" (%1)").arg(rows.at(3)));
+				curSeries->name = rows.at(1) + QString(" (%1)").arg(rows.at(3));
 				curSeries->deleted = false;
 				curSeries->firstDate = rows.at(0);
 
@@ -699,6 +881,10 @@ QList<SeatingSeries *> SeatingDepthTest::ExtractShotMarkerSeriesCsv ( QTextStrea
 
 		allSeries.append(curSeries);
 	}
+	else
+	{
+		delete curSeries;
+	}
 
 	return allSeries;
 }
@@ -801,10 +987,10 @@ void SeatingDepthTest::autofillClicked ( bool state )
 		for ( int i = 0; i < seatingSeriesData.size(); i++ )
 		{
 			SeatingSeries *series = seatingSeriesData.at(i);
-			if ( (! series->deleted) && series->enabled->isChecked() )
+			if ( (! series->deleted) && series->enabled )
 			{
 				qDebug() << "Setting series" << i << "to" << currentLength;
-				series->cartridgeLength->setValue(currentLength);
+				series->cartridgeLength = currentLength;
 				if ( values->increasing )
 				{
 					currentLength += values->interval;
@@ -815,11 +1001,17 @@ void SeatingDepthTest::autofillClicked ( bool state )
 				}
 			}
 		}
+
+		delete values;
+
+		seriesModel->refresh();
 	}
 	else
 	{
 		qDebug() << "User cancelled dialog";
 	}
+
+	delete dialog;
 }
 
 void SeatingDepthTest::addNewClicked ( bool state )
@@ -829,22 +1021,11 @@ void SeatingDepthTest::addNewClicked ( bool state )
 	// un-bold the button after the first click
 	addNewButton->setStyleSheet("");
 
-	int numRows = seatingSeriesGrid->rowCount();
-
-	// Remove the stretch from the last row, we'll be using the row for our new series
-	seatingSeriesGrid->setRowStretch(numRows - 1, 0);
-
-	qDebug() << "numRows =" << numRows;
-
 	SeatingSeries *series = new SeatingSeries();
 
 	series->deleted = false;
-
-	series->enabled = new QCheckBox();
-	series->enabled->setChecked(true);
-
-	connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesManualCheckBoxChanged(int)));
-	seatingSeriesGrid->addWidget(series->enabled, numRows - 1, 0);
+	series->enabled = true;
+	series->manual = true;
 
 	int newSeriesNum = 1;
 	for ( int i = seatingSeriesData.size() - 1; i >= 0; i-- )
@@ -853,86 +1034,82 @@ void SeatingDepthTest::addNewClicked ( bool state )
 		if ( ! series->deleted )
 		{
 			newSeriesNum = series->seriesNum + 1;
-			qDebug() << "Found last un-deleted series" << series->seriesNum << "(" << series->name->text() << ") at index" << i;
+			qDebug() << "Found last un-deleted series" << series->seriesNum << "(" << series->name << ") at index" << i;
 			break;
 		}
 	}
 
 	series->seriesNum = newSeriesNum;
+	series->name = QString("Series %1").arg(newSeriesNum);
+	series->cartridgeLength = 0;
+	series->groupSize = 0;
 
-	series->name = new QLabel(QString("Series %1").arg(newSeriesNum));
-	seatingSeriesGrid->addWidget(series->name, numRows - 1, 1);
-
-	series->cartridgeLength = new QDoubleSpinBox();
-	series->cartridgeLength->setDecimals(3);
-	series->cartridgeLength->setSingleStep(0.001);
-	series->cartridgeLength->setMinimumWidth(100);
-	series->cartridgeLength->setMaximumWidth(100);
-
-	QHBoxLayout *cartridgeLengthLayout = new QHBoxLayout();
-	cartridgeLengthLayout->addWidget(series->cartridgeLength);
-	cartridgeLengthLayout->addStretch(0);
-	seatingSeriesGrid->addLayout(cartridgeLengthLayout, numRows - 1, 2);
+	seriesModel->appendSeries(arena.adopt(series));
+	addSeriesButtons(seatingSeriesData.size() - 1);
+}
 
-	series->groupSize = new QDoubleSpinBox();
-	series->groupSize->setDecimals(3);
-	series->groupSize->setSingleStep(0.001);
-	series->groupSize->setMinimumWidth(100);
-	series->groupSize->setMaximumWidth(100);
+/*
+ * Manually entered groups have a button to delete them at the end of their row
+ */
+void SeatingDepthTest::addSeriesButtons ( int row )
+{
+	SeatingSeries *series = seatingSeriesData.at(row);
 
-	QHBoxLayout *groupSizeLayout = new QHBoxLayout();
-	groupSizeLayout->addWidget(series->groupSize);
-	groupSizeLayout->addStretch(0);
-	seatingSeriesGrid->addLayout(groupSizeLayout, numRows - 1, 3);
+	QPushButton *deleteButton = new QPushButton();
+	connect(deleteButton, &QPushButton::clicked, this, [=] ( void ) { deleteClicked(series); });
+	deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
+	deleteButton->setFixedSize(deleteButton->minimumSizeHint());
+	seriesView->setIndexWidget(seriesModel->index(row, SeriesModel::DELETE_COLUMN), deleteButton);
 
-	series->deleteButton = new QPushButton();
-	connect(series->deleteButton, SIGNAL(clicked(bool)), this, SLOT(deleteClicked(bool)));
-	series->deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
-	series->deleteButton->setFixedSize(series->deleteButton->minimumSizeHint());
-	seatingSeriesGrid->addWidget(series->deleteButton, numRows - 1, 4, Qt::AlignLeft);
+	// Every row is the same height, so make it tall enough for the button
+	QHeaderView *rows = seriesView->verticalHeader();
+	rows->setDefaultSectionSize(qMax(rows->defaultSectionSize(), deleteButton->height()));
+}
 
-	seatingSeriesData.append(series);
+void SeatingDepthTest::updateSeriesButtons ( int first, int last )
+{
+	if ( seriesView == NULL )
+	{
+		return;
+	}
 
-	// Add an empty stretch row at the end for proper spacing
-	seatingSeriesGrid->setRowStretch(numRows, 1);
+	for ( int i = first; i <= last; i++ )
+	{
+		// Only manually entered groups have buttons
+		QWidget *button = seriesView->indexWidget(seriesModel->index(i, SeriesModel::DELETE_COLUMN));
+		if ( button && seatingSeriesData.at(i)->manual )
+		{
+			button->setEnabled(seatingSeriesData.at(i)->enabled);
+		}
+	}
 }
 
-void SeatingDepthTest::deleteClicked ( bool state )
+void SeatingDepthTest::deleteClicked ( SeatingSeries *series )
 {
-	QPushButton *deleteButton = qobject_cast<QPushButton *>(sender());
+	int row = seatingSeriesData.indexOf(series);
 
-	qDebug() << "deleteClicked state =" << state;
+	qDebug() << "Series" << series->seriesNum << "(" << series->name << ") was deleted";
 
-	int newSeriesNum = -1;
+	series->deleted = true;
+	seriesView->setRowHidden(row, true);
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	// Renumber the groups after it
+	int newSeriesNum = series->seriesNum;
+	for ( int i = row + 1; i < seatingSeriesData.size(); i++ )
 	{
 		SeatingSeries *series = seatingSeriesData.at(i);
-		if ( deleteButton == series->deleteButton )
-		{
-			qDebug() << "Series" << series->seriesNum << "(" << series->name->text() << ") was deleted";
-
-			series->deleted = true;
-
-			series->enabled->hide();
-			series->name->hide();
-			series->cartridgeLength->hide();
-			series->groupSize->hide();
-			series->deleteButton->hide();
-
-			newSeriesNum = series->seriesNum;
-		}
-		else if ( (! series->deleted) && newSeriesNum > 0 )
+		if ( ! series->deleted )
 		{
 			qDebug() << "Updating Series" << series->seriesNum << "to Series" << newSeriesNum;
 
 			series->seriesNum = newSeriesNum;
-			series->name->setText(QString("Series %1").arg(newSeriesNum));
+			series->name = QString("Series %1").arg(newSeriesNum);
 
 			newSeriesNum++;
 		}
 	}
+
+	seriesModel->refresh();
 }
 
 SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
@@ -941,6 +1118,10 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	qDebug() << "Seating depth test";
 
 	graphPreview = NULL;
+	headless = false;
+	scrollWidget = NULL;
+	seriesView = NULL;
+	seriesModel = new SeriesModel(&seatingSeriesData, this);
 	prevShotMarkerDir = QDir::homePath();
 	prevSaveDir = QDir::homePath();
 
@@ -1027,8 +1208,7 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	connect(cartridgeMeasurementType, SIGNAL(activated(int)), this, SLOT(cartridgeMeasurementTypeChanged(int)));
 	optionsFormLayout->addRow(new QLabel("Cartridge measurement:"), cartridgeMeasurementType);
 
-	// create the header object that cartridgeMeasurementType controls
-	headerLengthType = new QLabel(cartridgeMeasurementType->currentText());
+	seriesModel->setLengthType(cartridgeMeasurementType->currentText());
 
 	cartridgeUnits = new QComboBox();
 	cartridgeUnits->addItem("inches (in)");
@@ -1041,33 +1221,11 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	groupMeasurementType->addItem("X Stdev");
 	groupMeasurementType->addItem("Radial Stdev (RSD)");
 	groupMeasurementType->addItem("Mean Radius (MR)");
+	groupMeasurementType->addItem("CEP (50%)");
+	groupMeasurementType->addItem("CEP (90%)");
 	connect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(groupMeasurementTypeChanged(int)));
 	optionsFormLayout->addRow(new QLabel("Group size measurement:"), groupMeasurementType);
 
-	// create the header object that groupMeasurementType controls
-	const char *headerGroupType2;
-	if ( groupMeasurementType->currentIndex() == ES )
-	{
-		headerGroupType2 = "Group Size (ES)";
-	}
-	else if ( groupMeasurementType->currentIndex() == YSTDEV )
-	{
-		headerGroupType2 = "Group Size (Y Stdev)";
-	}
-	else if ( groupMeasurementType->currentIndex() == XSTDEV )
-	{
-		headerGroupType2 = "Group Size (X Stdev)";
-	}
-	else if ( groupMeasurementType->currentIndex() == RSD )
-	{
-		headerGroupType2 = "Group Size (RSD)";
-	}
-	else
-	{
-		headerGroupType2 = "Group Size (MR)";
-	}
-	headerGroupType = new QLabel(headerGroupType2);
-
 	groupUnits = new QComboBox();
 	groupUnits->addItem("inches (in)");
 	groupUnits->addItem("minutes (MOA)");
@@ -1075,6 +1233,8 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	groupUnits->addItem("milliradians (mil)");
 	optionsFormLayout->addRow(new QLabel("Group size units:"), groupUnits);
 
+	seriesModel->setGroupDisplay(groupMeasurementType->currentIndex(), groupUnits->currentIndex(), false);
+
 	xAxisSpacing = new QComboBox();
 	xAxisSpacing->addItem("Proportional");
 	xAxisSpacing->addItem("Constant");
@@ -1127,6 +1287,16 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	trendLayout->addWidget(trendLineType);
 	optionsLayout->addLayout(trendLayout);
 
+	QHBoxLayout *ellipseLayout = new QHBoxLayout();
+	ellipseCheckBox = new QCheckBox();
+	ellipseCheckBox->setChecked(false);
+	connect(ellipseCheckBox, SIGNAL(clicked(bool)), this, SLOT(ellipseCheckBoxChanged(bool)));
+	ellipseLayout->addWidget(ellipseCheckBox, 0);
+	ellipseLabel = new QLabel("Show dispersion ellipses");
+	ellipseLabel->setFixedHeight(trendLineType->sizeHint().height());
+	ellipseLayout->addWidget(ellipseLabel, 1);
+	optionsLayout->addLayout(ellipseLayout);
+
 	QHBoxLayout *includeSightersLayout = new QHBoxLayout();
 	includeSightersCheckBox = new QCheckBox();
 	includeSightersCheckBox->setChecked(false);
@@ -1138,6 +1308,15 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	includeSightersLayout->addWidget(includeSightersLabel, 1);
 	optionsLayout->addLayout(includeSightersLayout);
 
+	QHBoxLayout *patternLayout = new QHBoxLayout();
+	patternCheckBox = new QCheckBox();
+	patternCheckBox->setChecked(false);
+	patternLayout->addWidget(patternCheckBox, 0);
+	patternLabel = new QLabel("Show shot patterns");
+	patternLabel->setFixedHeight(trendLineType->sizeHint().height());
+	patternLayout->addWidget(patternLabel, 1);
+	optionsLayout->addLayout(patternLayout);
+
 	// Don't resize row heights if window height changes
 	optionsLayout->addStretch(0);
 
@@ -1167,6 +1346,55 @@ SeatingDepthTest::SeatingDepthTest ( QWidget *parent )
 	pageLayout->addLayout(rightLayout, 0);
 
 	this->setLayout(pageLayout);
+
+	// Delete buttons in manually entered rows are greyed out along with the rest of their row
+	connect(seriesModel, &QAbstractItemModel::dataChanged, this, [=] ( const QModelIndex &topLeft, const QModelIndex &bottomRight ) {
+		updateSeriesButtons(topLeft.row(), bottomRight.row());
+	});
+
+	setupPlot();
+}
+
+/*
+ * Frees every series loaded since the last call, ahead of loading new data. The graph preview is closed since it was drawn
+ * from series that no longer exist.
+ */
+void SeatingDepthTest::clearSeries ( void )
+{
+	if ( graphPreview != NULL )
+	{
+		graphPreview->hide();
+	}
+
+	graphedSeries.clear();
+	seatingSeriesData.clear();
+	plottedKey.clear(); // the plot no longer matches anything, even if the same data is loaded again
+	seriesModel->reload(false);
+
+	arena.clear();
+}
+
+/*
+ * Returns to the initial screen to choose a new shot data file, freeing the loaded data
+ */
+void SeatingDepthTest::unloadData ( void )
+{
+	// Hide the shot data screen
+	stackedWidget->removeWidget(scrollWidget);
+
+	// Delete the loaded shot data
+	clearSeries();
+
+	// Disconnect the group measurement type signal (used in imported data entry), if necessary
+	disconnect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(importedGroupMeasurementTypeChanged(int)));
+	disconnect(groupUnits, SIGNAL(activated(int)), this, SLOT(importedGroupUnitsChanged(int)));
+
+	// Disconnect and disable 'Include sighters' checkbox
+	disconnect(includeSightersCheckBox, SIGNAL(clicked(bool)), this, SLOT(importedGroupIncludeSightersCheckBoxChanged(bool)));
+
+	includeSightersCheckBox->setChecked(false);
+	includeSightersCheckBox->setEnabled(false);
+	includeSightersLabel->setStyleSheet("color: #878787");
 }
 
 void SeatingDepthTest::loadNewShotData ( bool state )
@@ -1180,173 +1408,403 @@ void SeatingDepthTest::loadNewShotData ( bool state )
 	{
 		qDebug() << "User said yes";
 
-		// Hide the shot data screen. This returns to the initial screen to choose a new shot data file.
-		stackedWidget->removeWidget(scrollWidget);
-
-		// Delete the loaded shot data
-		seatingSeriesData.clear();
-
-		// Disconnect the group measurement type signal (used in imported data entry), if necessary
-		disconnect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(importedGroupMeasurementTypeChanged(int)));
-		disconnect(groupUnits, SIGNAL(activated(int)), this, SLOT(importedGroupUnitsChanged(int)));
+		unloadData();
+	}
+	else
+	{
+		qDebug() << "User said cancel";
+	}
+}
 
-		// Disconnect and disable 'Include sighters' checkbox
-		disconnect(includeSightersCheckBox, SIGNAL(clicked(bool)), this, SLOT(importedGroupIncludeSightersCheckBoxChanged(bool)));
+/*
+ * Series table
+ */
 
-		includeSightersCheckBox->setChecked(false);
-		includeSightersCheckBox->setEnabled(false);
-		includeSightersLabel->setStyleSheet("color: #878787");
+/*
+ * A group's measured size of the given type (ES, RSD, MR, etc.) in the given units. NaN if it has too few shots to measure.
+ */
+static double measuredGroupSize ( SeatingSeries *series, int type, int units, bool sighters )
+{
+	if ( type == ES )
+	{
+		return sighters ? series->extremeSpread_sighters.at(units) : series->extremeSpread.at(units);
+	}
+	else if ( type == YSTDEV )
+	{
+		return sighters ? series->yStdev_sighters.at(units) : series->yStdev.at(units);
+	}
+	else if ( type == XSTDEV )
+	{
+		return sighters ? series->xStdev_sighters.at(units) : series->xStdev.at(units);
+	}
+	else if ( type == RSD )
+	{
+		return sighters ? series->radialStdev_sighters.at(units) : series->radialStdev.at(units);
+	}
+	else if ( type == CEP50 )
+	{
+		return sighters ? series->cep50_sighters.at(units) : series->cep50.at(units);
+	}
+	else if ( type == CEP90 )
+	{
+		return sighters ? series->cep90_sighters.at(units) : series->cep90.at(units);
 	}
 	else
 	{
-		qDebug() << "User said cancel";
+		return sighters ? series->meanRadius_sighters.at(units) : series->meanRadius.at(units);
 	}
 }
 
-static bool SeatingSeriesComparator ( SeatingSeries *one, SeatingSeries *two )
+SeriesModel::SeriesModel ( QList<SeatingSeries *> *seriesData, QObject *parent )
+	: QAbstractTableModel(parent), seriesData(seriesData), manual(false), groupType(ES), groupUnits(INCH), includeSighters(false)
 {
-	return (one->seriesNum < two->seriesNum);
 }
 
-void SeatingDepthTest::DisplaySeriesData ( void )
+/*
+ * Call after seatingSeriesData has been replaced or reordered
+ */
+void SeriesModel::reload ( bool manualEntry )
 {
-	// Sort the list by series number
-	std::sort(seatingSeriesData.begin(), seatingSeriesData.end(), SeatingSeriesComparator);
+	beginResetModel();
+	manual = manualEntry;
+	endResetModel();
+}
 
-	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
-	stackedWidget->removeWidget(scrollWidget);
+void SeriesModel::appendSeries ( SeatingSeries *series )
+{
+	beginInsertRows(QModelIndex(), seriesData->size(), seriesData->size());
+	seriesData->append(series);
+	endInsertRows();
+}
 
-	QVBoxLayout *scrollLayout = new QVBoxLayout();
+/*
+ * Call after groups have been changed in place
+ */
+void SeriesModel::refresh ( void )
+{
+	if ( ! seriesData->isEmpty() )
+	{
+		emit dataChanged(index(0, 0), index(seriesData->size() - 1, columnCount() - 1));
+	}
+}
 
-	// Wrap grid in a widget to make the grid scrollable
-	QWidget *scrollAreaWidget = new QWidget();
+void SeriesModel::setAllEnabled ( bool enabled )
+{
+	for ( int i = 0; i < seriesData->size(); i++ )
+	{
+		SeatingSeries *series = seriesData->at(i);
+		if ( isCheckable(series) )
+		{
+			series->enabled = enabled;
+		}
+	}
 
-	seatingSeriesGrid = new QGridLayout(scrollAreaWidget);
-	seatingSeriesGrid->setColumnStretch(0, 0);
-	seatingSeriesGrid->setColumnStretch(1, 1);
-	seatingSeriesGrid->setColumnStretch(2, 2);
-	seatingSeriesGrid->setColumnStretch(3, 3);
-	seatingSeriesGrid->setColumnStretch(4, 3);
-	seatingSeriesGrid->setHorizontalSpacing(25);
+	refresh();
+}
 
-	scrollArea = new QScrollArea();
-	scrollArea->setWidget(scrollAreaWidget);
-	scrollArea->setWidgetResizable(true);
+void SeriesModel::setLengthType ( const QString &type )
+{
+	lengthType = type;
 
-	scrollLayout->addWidget(scrollArea);
+	emit headerDataChanged(Qt::Horizontal, LENGTH_COLUMN, LENGTH_COLUMN);
+}
 
-	/* Create utilities toolbar under scroll area */
+/*
+ * Measured group sizes are shown as the given type, in the given units, with or without sighters
+ */
+void SeriesModel::setGroupDisplay ( int type, int units, bool sighters )
+{
+	groupType = type;
+	groupUnits = units;
+	includeSighters = sighters;
 
-	QPushButton *loadNewButton = new QPushButton("Load new shot data file");
-	connect(loadNewButton, SIGNAL(clicked(bool)), this, SLOT(loadNewShotData(bool)));
-	loadNewButton->setMinimumWidth(225);
-	loadNewButton->setMaximumWidth(225);
+	emit headerDataChanged(Qt::Horizontal, GROUP_COLUMN, GROUP_COLUMN);
+	refresh();
+}
 
-	QPushButton *autofillButton = new QPushButton("Auto-fill cartridge lengths");
-	connect(autofillButton, SIGNAL(clicked(bool)), this, SLOT(autofillClicked(bool)));
-	autofillButton->setMinimumWidth(225);
-	autofillButton->setMaximumWidth(225);
+/*
+ * Groups with too few shots to measure can't be graphed, so they stay unchecked
+ */
+bool SeriesModel::isCheckable ( SeatingSeries *series ) const
+{
+	return series->manual || (! qIsNaN(measuredGroupSize(series, groupType, groupUnits, includeSighters)));
+}
 
-	QHBoxLayout *utilitiesLayout = new QHBoxLayout();
-	utilitiesLayout->addWidget(loadNewButton);
-	utilitiesLayout->addWidget(autofillButton);
+int SeriesModel::rowCount ( const QModelIndex &parent ) const
+{
+	return parent.isValid() ? 0 : seriesData->size();
+}
 
-	scrollLayout->addLayout(utilitiesLayout);
+int SeriesModel::columnCount ( const QModelIndex &parent ) const
+{
+	if ( parent.isValid() )
+	{
+		return 0;
+	}
 
-	scrollWidget = new QWidget();
-	scrollWidget->setLayout(scrollLayout);
+	// Manual entry has the delete buttons where the date would be
+	return DATE_COLUMN + 1;
+}
 
-	stackedWidget->addWidget(scrollWidget);
-	stackedWidget->setCurrentWidget(scrollWidget);
+QVariant SeriesModel::data ( const QModelIndex &index, int role ) const
+{
+	if ( ! index.isValid() )
+	{
+		return QVariant();
+	}
 
-	QCheckBox *headerCheckBox = new QCheckBox();
-	headerCheckBox->setChecked(true);
-	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
-	seatingSeriesGrid->addWidget(headerCheckBox, 0, 0);
+	SeatingSeries *series = seriesData->at(index.row());
 
-	/*
-	 * Connect signals to update all calculations in the Group Size column when the user selects a new group measurement type (ES, RSD, MR, etc.) or
-	 * measurement unit (in, MOA, cm, mil, etc.). This is only done for imported shot data, where the group sizes are QLabels and not user-controllable.
-	 */
+	if ( index.column() == ENABLED_COLUMN )
+	{
+		if ( role == Qt::CheckStateRole )
+		{
+			return series->enabled ? Qt::Checked : Qt::Unchecked;
+		}
 
-	connect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(importedGroupMeasurementTypeChanged(int)));
-	connect(groupUnits, SIGNAL(activated(int)), this, SLOT(importedGroupUnitsChanged(int)));
+		return QVariant();
+	}
+
+	int flagged = series->outlierFlags.size() - series->outlierFlags.count(0);
 
-	/* Headers for series data */
+	if ( (role == Qt::DisplayRole) || (role == Qt::EditRole) )
+	{
+		switch ( index.column() )
+		{
+			case NAME_COLUMN:
+				return series->name;
+			case LENGTH_COLUMN:
+				return series->cartridgeLength;
+			case GROUP_COLUMN:
+			{
+				if ( series->manual )
+				{
+					return series->groupSize;
+				}
 
-	QLabel *headerNumber = new QLabel("Series Name");
-	seatingSeriesGrid->addWidget(headerNumber, 0, 1, Qt::AlignVCenter);
+				double groupSize = measuredGroupSize(series, groupType, groupUnits, includeSighters);
+				if ( qIsNaN(groupSize) )
+				{
+					return QString("2+ shots required");
+				}
 
-	// these two objects were previously created
-	seatingSeriesGrid->addWidget(headerLengthType, 0, 2, Qt::AlignVCenter);
-	seatingSeriesGrid->addWidget(headerGroupType, 0, 3, Qt::AlignVCenter);
+				const char *groupUnits2;
+				if ( groupUnits == INCH )
+				{
+					groupUnits2 = "in";
+				}
+				else if ( groupUnits == MOA )
+				{
+					groupUnits2 = "MOA";
+				}
+				else if ( groupUnits == CENTIMETER )
+				{
+					groupUnits2 = "cm";
+				}
+				else
+				{
+					groupUnits2 = "mil";
+				}
 
-	QLabel *headerDate = new QLabel("Series Date");
-	seatingSeriesGrid->addWidget(headerDate, 0, 4, Qt::AlignVCenter);
+				QString text = QString("%1 %2").arg(groupSize, 0, 'f', 3).arg(groupUnits2);
+				if ( flagged > 0 )
+				{
+					text = QString("%1 (%2 flagged)").arg(text).arg(flagged);
+				}
 
-	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+				return text;
+			}
+			case DATE_COLUMN:
+				if ( ! manual )
+				{
+					return QString("%1 %2").arg(series->firstDate).arg(series->firstTime);
+				}
+		}
+	}
+	else if ( (index.column() == GROUP_COLUMN) && (flagged > 0) && isCheckable(series) )
 	{
-		SeatingSeries *series = seatingSeriesData.at(i);
+		if ( role == Qt::ForegroundRole )
+		{
+			return QColor("#c00000");
+		}
+		else if ( role == Qt::ToolTipRole )
+		{
+			QList<double> distances = Outliers::radialDistances(series->coordinates);
+
+			QStringList shots;
+			for ( int j = 0; j < qMin(distances.size(), series->outlierFlags.size()); j++ )
+			{
+				if ( series->outlierFlags.at(j) )
+				{
+					shots.append(QString("Shot %1: %2 in from center (%3)").arg(j + 1).arg(distances.at(j), 0, 'f', 3).arg(Outliers::describe(series->outlierFlags.at(j))));
+				}
+			}
+
+			return QString("Possible flyers:\n%1").arg(shots.join("\n"));
+		}
+	}
 
-		connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesCheckBoxChanged(int)));
+	return QVariant();
+}
+
+QVariant SeriesModel::headerData ( int section, Qt::Orientation orientation, int role ) const
+{
+	if ( (orientation != Qt::Horizontal) || (role != Qt::DisplayRole) )
+	{
+		return QVariant();
+	}
+
+	if ( section == NAME_COLUMN )
+	{
+		return QString("Series Name");
+	}
+	else if ( section == LENGTH_COLUMN )
+	{
+		return lengthType;
+	}
+	else if ( section == DATE_COLUMN )
+	{
+		return manual ? QString() : QString("Series Date");
+	}
+	else if ( section != GROUP_COLUMN )
+	{
+		return QVariant();
+	}
+
+	if ( groupType == ES )
+	{
+		return QString("Group Size (ES)");
+	}
+	else if ( groupType == YSTDEV )
+	{
+		return QString("Group Size (Y Stdev)");
+	}
+	else if ( groupType == XSTDEV )
+	{
+		return QString("Group Size (X Stdev)");
+	}
+	else if ( groupType == RSD )
+	{
+		return QString("Group Size (RSD)");
+	}
+	else if ( groupType == CEP50 )
+	{
+		return QString("Group Size (CEP50)");
+	}
+	else if ( groupType == CEP90 )
+	{
+		return QString("Group Size (CEP90)");
+	}
+	else
+	{
+		return QString("Group Size (MR)");
+	}
+}
 
-		seatingSeriesGrid->addWidget(series->enabled, i + 1, 0);
-		seatingSeriesGrid->addWidget(series->name, i + 1, 1, Qt::AlignVCenter);
+Qt::ItemFlags SeriesModel::flags ( const QModelIndex &index ) const
+{
+	if ( ! index.isValid() )
+	{
+		return Qt::NoItemFlags;
+	}
 
-		QHBoxLayout *cartridgeLengthLayout = new QHBoxLayout();
-		cartridgeLengthLayout->addWidget(series->cartridgeLength);
-		cartridgeLengthLayout->addStretch(0);
-		seatingSeriesGrid->addLayout(cartridgeLengthLayout, i + 1, 2);
+	SeatingSeries *series = seriesData->at(index.row());
 
-		seatingSeriesGrid->addWidget(series->groupSizeLabel, i + 1, 3, Qt::AlignVCenter);
+	if ( index.column() == ENABLED_COLUMN )
+	{
+		if ( ! isCheckable(series) )
+		{
+			return Qt::ItemIsUserCheckable;
+		}
 
-		QLabel *datetimeLabel = new QLabel(QString("%1 %2").arg(series->firstDate).arg(series->firstTime));
-		seatingSeriesGrid->addWidget(datetimeLabel, i + 1, 4, Qt::AlignVCenter);
+		return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+	}
 
-		seatingSeriesGrid->setRowMinimumHeight(0, series->cartridgeLength->sizeHint().height());
+	// The rest of an unchecked group's row is greyed out
+	if ( ! series->enabled )
+	{
+		return Qt::NoItemFlags;
 	}
 
-	// Add an empty stretch row at the end for proper spacing
-	seatingSeriesGrid->setRowStretch(seatingSeriesData.size() + 1, 1);
+	if ( (index.column() == LENGTH_COLUMN) || ((index.column() == GROUP_COLUMN) && series->manual) )
+	{
+		return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+	}
 
-	scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
-	scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
-	scrollArea->setWidgetResizable(true);
+	return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
 }
 
-void SeatingDepthTest::manualDataEntry ( bool state )
+bool SeriesModel::setData ( const QModelIndex &index, const QVariant &value, int role )
 {
-	qDebug() << "manualDataEntry state =" << state;
+	if ( ! index.isValid() )
+	{
+		return false;
+	}
+
+	SeatingSeries *series = seriesData->at(index.row());
+
+	if ( (index.column() == ENABLED_COLUMN) && (role == Qt::CheckStateRole) )
+	{
+		series->enabled = (value.toInt() == Qt::Checked);
+
+		qDebug() << "Series" << series->seriesNum << "enabled =" << series->enabled;
+
+		// Grey out or restore the whole row
+		emit dataChanged(index, index.sibling(index.row(), columnCount() - 1));
+		return true;
+	}
+
+	if ( role != Qt::EditRole )
+	{
+		return false;
+	}
+
+	if ( index.column() == LENGTH_COLUMN )
+	{
+		series->cartridgeLength = value.toDouble();
+	}
+	else if ( (index.column() == GROUP_COLUMN) && series->manual )
+	{
+		series->groupSize = value.toDouble();
+	}
+	else
+	{
+		return false;
+	}
+
+	emit dataChanged(index, index);
+	return true;
+}
+
+static bool SeatingSeriesComparator ( SeatingSeries *one, SeatingSeries *two )
+{
+	return (one->seriesNum < two->seriesNum);
+}
+
+void SeatingDepthTest::DisplaySeriesData ( void )
+{
+	// Sort the list by series number
+	std::sort(seatingSeriesData.begin(), seatingSeriesData.end(), SeatingSeriesComparator);
 
 	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
 	stackedWidget->removeWidget(scrollWidget);
 
-	QVBoxLayout *scrollLayout = new QVBoxLayout();
+	seriesModel->reload(false);
 
-	// Wrap grid in a widget to make the grid scrollable
-	QWidget *scrollAreaWidget = new QWidget();
+	qDebug() << "Displaying" << seatingSeriesData.size() << "series," << SeriesArena<SeatingSeries>::live() << "live";
 
-	seatingSeriesGrid = new QGridLayout(scrollAreaWidget);
-	seatingSeriesGrid->setColumnStretch(0, 0);
-	seatingSeriesGrid->setColumnStretch(1, 1);
-	seatingSeriesGrid->setColumnStretch(2, 2);
-	seatingSeriesGrid->setColumnStretch(3, 2);
-	seatingSeriesGrid->setColumnStretch(4, 3);
-	seatingSeriesGrid->setHorizontalSpacing(25);
+	QVBoxLayout *scrollLayout = new QVBoxLayout();
 
-	scrollArea = new QScrollArea();
-	scrollArea->setWidget(scrollAreaWidget);
-	scrollArea->setWidgetResizable(true);
+	QCheckBox *headerCheckBox = new QCheckBox();
+	headerCheckBox->setChecked(true);
+	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
 
-	scrollLayout->addWidget(scrollArea);
+	seriesView = createSeriesView(seriesModel, headerCheckBox);
+	seriesView->setItemDelegateForColumn(SeriesModel::LENGTH_COLUMN, new SpinBoxDelegate(3, 0.001, 99.99, seriesView));
 
-	/* Create utilities toolbar under scroll area */
+	scrollLayout->addWidget(seriesView);
 
-	addNewButton = new QPushButton("Add new group");
-	addNewButton->setStyleSheet("font-weight: bold");
-	connect(addNewButton, SIGNAL(clicked(bool)), this, SLOT(addNewClicked(bool)));
-	addNewButton->setMinimumWidth(225);
-	addNewButton->setMaximumWidth(225);
+	/* Create utilities toolbar under scroll area */
 
 	QPushButton *loadNewButton = new QPushButton("Load new shot data file");
 	connect(loadNewButton, SIGNAL(clicked(bool)), this, SLOT(loadNewShotData(bool)));
@@ -1358,10 +1816,21 @@ void SeatingDepthTest::manualDataEntry ( bool state )
 	autofillButton->setMinimumWidth(225);
 	autofillButton->setMaximumWidth(225);
 
+	excludeOutliersButton = new QPushButton("Exclude flagged shots");
+	connect(excludeOutliersButton, SIGNAL(clicked(bool)), this, SLOT(excludeOutliersClicked(bool)));
+	excludeOutliersButton->setMinimumWidth(225);
+	excludeOutliersButton->setMaximumWidth(225);
+
+	restoreShotsButton = new QPushButton("Restore excluded shots");
+	connect(restoreShotsButton, SIGNAL(clicked(bool)), this, SLOT(restoreShotsClicked(bool)));
+	restoreShotsButton->setMinimumWidth(225);
+	restoreShotsButton->setMaximumWidth(225);
+
 	QHBoxLayout *utilitiesLayout = new QHBoxLayout();
-	utilitiesLayout->addWidget(addNewButton);
 	utilitiesLayout->addWidget(loadNewButton);
 	utilitiesLayout->addWidget(autofillButton);
+	utilitiesLayout->addWidget(excludeOutliersButton);
+	utilitiesLayout->addWidget(restoreShotsButton);
 
 	scrollLayout->addLayout(utilitiesLayout);
 
@@ -1371,211 +1840,227 @@ void SeatingDepthTest::manualDataEntry ( bool state )
 	stackedWidget->addWidget(scrollWidget);
 	stackedWidget->setCurrentWidget(scrollWidget);
 
-	QCheckBox *headerCheckBox = new QCheckBox();
-	headerCheckBox->setChecked(true);
-	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
-	seatingSeriesGrid->addWidget(headerCheckBox, 0, 0);
-
-	/* Headers for series data */
+	/*
+	 * Connect signals to update all calculations in the Group Size column when the user selects a new group measurement type (ES, RSD, MR, etc.) or
+	 * measurement unit (in, MOA, cm, mil, etc.). This is only done for imported shot data, where the group sizes are measured and not user-controllable.
+	 */
 
-	QLabel *headerNumber = new QLabel("Series Name");
-	seatingSeriesGrid->addWidget(headerNumber, 0, 1, Qt::AlignVCenter);
+	connect(groupMeasurementType, SIGNAL(activated(int)), this, SLOT(importedGroupMeasurementTypeChanged(int)));
+	connect(groupUnits, SIGNAL(activated(int)), this, SLOT(importedGroupUnitsChanged(int)));
+}
 
-	// this object was previously created
-	seatingSeriesGrid->addWidget(headerLengthType, 0, 2, Qt::AlignVCenter);
+void SeatingDepthTest::DetectOutliers ( void )
+{
+	/* Pack every group's radial distances into one buffer so all groups are tested in a single pass */
 
-	const char *headerGroupType2;
-	if ( groupMeasurementType->currentIndex() == ES )
-	{
-		headerGroupType2 = "Group Size (ES)";
-	}
-	else if ( groupMeasurementType->currentIndex() == YSTDEV )
-	{
-		headerGroupType2 = "Group Size (Y Stdev)";
-	}
-	else if ( groupMeasurementType->currentIndex() == XSTDEV )
-	{
-		headerGroupType2 = "Group Size (X Stdev)";
-	}
-	else if ( groupMeasurementType->currentIndex() == RSD )
+	Outliers::Batch batch;
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
 	{
-		headerGroupType2 = "Group Size (RSD)";
+		batch.appendSeries(Outliers::radialDistances(seatingSeriesData.at(i)->coordinates));
 	}
-	else
+
+	// Shots can only be too far from the center of the group, not too close
+	QVector<quint8> flags = Outliers::detect(batch, true);
+
+	int totalFlagged = 0;
+	int totalExcluded = 0;
+
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
 	{
-		headerGroupType2 = "Group Size (MR)";
-	}
+		SeatingSeries *series = seatingSeriesData.at(i);
 
-	headerGroupType = new QLabel(headerGroupType2);
-	seatingSeriesGrid->addWidget(headerGroupType, 0, 3, Qt::AlignVCenter);
-	QLabel *headerDelete = new QLabel("");
-	seatingSeriesGrid->addWidget(headerDelete, 0, 4, Qt::AlignVCenter);
+		int offset = batch.offsets.at(i);
+		series->outlierFlags = flags.mid(offset, batch.offsets.at(i + 1) - offset);
 
-	/* Create initial row */
+		totalExcluded += series->excludedShots.size();
 
-	SeatingSeries *series = new SeatingSeries();
+		int seriesFlagged = series->outlierFlags.size() - series->outlierFlags.count(0);
+		if ( seriesFlagged > 0 )
+		{
+			qDebug() << "Series" << series->seriesNum << "has" << seriesFlagged << "flagged shots";
 
-	series->deleted = false;
+			totalFlagged += seriesFlagged;
+		}
+	}
 
-	series->enabled = new QCheckBox();
-	series->enabled->setChecked(true);
+	// Flagged shots are listed in each group's size
+	seriesModel->refresh();
 
-	connect(series->enabled, SIGNAL(stateChanged(int)), this, SLOT(seriesManualCheckBoxChanged(int)));
-	seatingSeriesGrid->addWidget(series->enabled, 1, 0);
+	qDebug() << "Flagged" << totalFlagged << "shots across" << seatingSeriesData.size() << "series";
 
-	series->seriesNum = 1;
+	excludeOutliersButton->setEnabled(totalFlagged > 0);
+	restoreShotsButton->setEnabled(totalExcluded > 0);
+}
+
+void SeatingDepthTest::excludeOutliersClicked ( bool state )
+{
+	qDebug() << "excludeOutliersClicked state =" << state;
+
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		SeatingSeries *series = seatingSeriesData.at(i);
 
-	series->name = new QLabel("Series 1");
-	seatingSeriesGrid->addWidget(series->name, 1, 1);
+		// Leave series the user has unchecked as they are
+		if ( series->outlierFlags.empty() || series->deleted || !series->enabled )
+		{
+			continue;
+		}
 
-	series->cartridgeLength = new QDoubleSpinBox();
-	series->cartridgeLength->setDecimals(3);
-	series->cartridgeLength->setSingleStep(0.001);
-	series->cartridgeLength->setMinimumWidth(100);
-	series->cartridgeLength->setMaximumWidth(100);
+		QList<QPair<double, double> > kept;
+		for ( int j = 0; j < series->coordinates.size(); j++ )
+		{
+			if ( (j < series->outlierFlags.size()) && series->outlierFlags.at(j) )
+			{
+				qDebug() << "Excluding" << series->coordinates.at(j) << "from Series" << series->seriesNum;
 
-	QHBoxLayout *cartridgeLengthLayout = new QHBoxLayout();
-	cartridgeLengthLayout->addWidget(series->cartridgeLength);
-	cartridgeLengthLayout->addStretch(0);
-	seatingSeriesGrid->addLayout(cartridgeLengthLayout, 1, 2);
+				ExcludedShot shot;
+				shot.index = kept.size();
+				shot.coordinates = series->coordinates.at(j);
 
-	series->groupSize = new QDoubleSpinBox();
-	series->groupSize->setDecimals(3);
-	series->groupSize->setSingleStep(0.001);
-	series->groupSize->setMinimumWidth(100);
-	series->groupSize->setMaximumWidth(100);
+				// Record shots are also part of the sighter-inclusive list
+				shot.sighterIndex = series->coordinates_sighters.indexOf(shot.coordinates);
+				if ( shot.sighterIndex >= 0 )
+				{
+					series->coordinates_sighters.removeAt(shot.sighterIndex);
+				}
 
-	QHBoxLayout *groupSizeLayout = new QHBoxLayout();
-	groupSizeLayout->addWidget(series->groupSize);
-	groupSizeLayout->addStretch(0);
-	seatingSeriesGrid->addLayout(groupSizeLayout, 1, 3);
+				series->excludedShots.append(shot);
+			}
+			else
+			{
+				kept.append(series->coordinates.at(j));
+			}
+		}
 
-	series->deleteButton = new QPushButton();
-	connect(series->deleteButton, SIGNAL(clicked(bool)), this, SLOT(deleteClicked(bool)));
-	series->deleteButton->setIcon(style()->standardIcon(QStyle::SP_DialogCancelButton));
-	series->deleteButton->setFixedSize(series->deleteButton->minimumSizeHint());
-	seatingSeriesGrid->addWidget(series->deleteButton, 1, 4, Qt::AlignLeft);
+		series->coordinates = kept;
 
-	seatingSeriesGrid->setRowMinimumHeight(0, series->cartridgeLength->sizeHint().height());
+		calculateGroupSizes(series);
+	}
 
-	seatingSeriesData.append(series);
+	refineGroupShapes();
 
-	// Add an empty stretch row at the end for proper spacing
-	seatingSeriesGrid->setRowStretch(seatingSeriesGrid->rowCount(), 1);
+	// Flag the remaining shots and update the group sizes
+	DetectOutliers();
+	updateDisplayedData();
 }
 
-void SeatingDepthTest::seriesCheckBoxChanged ( int state )
+void SeatingDepthTest::restoreShotsClicked ( bool state )
 {
-	QCheckBox *checkBox = qobject_cast<QCheckBox *>(sender());
+	qDebug() << "restoreShotsClicked state =" << state;
 
-	qDebug() << "seriesCheckBoxChanged state =" << state;
-
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seatingSeriesGrid->rowCount() - 1; i++ )
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
 	{
-		QWidget *rowCheckBox = seatingSeriesGrid->itemAtPosition(i, 0)->widget();
-		if ( checkBox == rowCheckBox )
+		SeatingSeries *series = seatingSeriesData.at(i);
+
+		if ( series->excludedShots.isEmpty() )
 		{
-			QWidget *seriesName = seatingSeriesGrid->itemAtPosition(i, 1)->widget();
-			QWidget *cartridgeLength = seatingSeriesGrid->itemAtPosition(i, 2)->layout()->itemAt(0)->widget();
-			QWidget *groupSizeLabel = seatingSeriesGrid->itemAtPosition(i, 3)->widget();
-			QWidget *seriesDate = seatingSeriesGrid->itemAtPosition(i, 4)->widget();
+			continue;
+		}
 
-			if ( checkBox->isChecked() )
-			{
-				qDebug() << "Grid row" << i << "was checked";
+		// Put shots back newest first so each one lands where it was taken out
+		while ( !series->excludedShots.isEmpty() )
+		{
+			ExcludedShot shot = series->excludedShots.takeLast();
 
-				seriesName->setEnabled(true);
-				cartridgeLength->setEnabled(true);
-				groupSizeLabel->setEnabled(true);
-				seriesDate->setEnabled(true);
-			}
-			else
-			{
-				qDebug() << "Grid row" << i << "was unchecked";
+			qDebug() << "Restoring" << shot.coordinates << "to Series" << series->seriesNum;
 
-				seriesName->setEnabled(false);
-				cartridgeLength->setEnabled(false);
-				groupSizeLabel->setEnabled(false);
-				seriesDate->setEnabled(false);
+			series->coordinates.insert(qMin(shot.index, series->coordinates.size()), shot.coordinates);
+			if ( shot.sighterIndex >= 0 )
+			{
+				series->coordinates_sighters.insert(qMin(shot.sighterIndex, series->coordinates_sighters.size()), shot.coordinates);
 			}
-
-			return;
 		}
+
+		calculateGroupSizes(series);
 	}
+
+	refineGroupShapes();
+
+	DetectOutliers();
+	updateDisplayedData();
 }
 
-void SeatingDepthTest::seriesManualCheckBoxChanged ( int state )
+void SeatingDepthTest::manualDataEntry ( bool state )
 {
-	QCheckBox *checkBox = qobject_cast<QCheckBox *>(sender());
+	qDebug() << "manualDataEntry state =" << state;
 
-	qDebug() << "seriesManualCheckBoxChanged state =" << state;
+	showManualEntry();
 
-	// We have the checkbox object, now locate its row in the grid
-	for ( int i = 0; i < seatingSeriesGrid->rowCount() - 1; i++ )
-	{
-		QWidget *rowCheckBox = seatingSeriesGrid->itemAtPosition(i, 0)->widget();
-		if ( checkBox == rowCheckBox )
-		{
-			QWidget *seriesName = seatingSeriesGrid->itemAtPosition(i, 1)->widget();
-			QWidget *cartridgeLength = seatingSeriesGrid->itemAtPosition(i, 2)->layout()->itemAt(0)->widget();
-			QWidget *groupSize = seatingSeriesGrid->itemAtPosition(i, 3)->layout()->itemAt(0)->widget();
-			QWidget *deleteButton = seatingSeriesGrid->itemAtPosition(i, 4)->widget();
+	/* Create initial row */
 
-			if ( checkBox->isChecked() )
-			{
-				qDebug() << "Grid row" << i << "was checked";
+	SeatingSeries *series = new SeatingSeries();
 
-				seriesName->setEnabled(true);
-				cartridgeLength->setEnabled(true);
-				groupSize->setEnabled(true);
-				deleteButton->setEnabled(true);;
-			}
-			else
-			{
-				qDebug() << "Grid row" << i << "was unchecked";
+	series->deleted = false;
+	series->enabled = true;
+	series->manual = true;
+	series->seriesNum = 1;
+	series->name = "Series 1";
+	series->cartridgeLength = 0;
+	series->groupSize = 0;
 
-				seriesName->setEnabled(false);
-				cartridgeLength->setEnabled(false);
-				groupSize->setEnabled(false);
-				deleteButton->setEnabled(false);
-			}
+	seriesModel->appendSeries(arena.adopt(series));
+	addSeriesButtons(seatingSeriesData.size() - 1);
+}
 
-			return;
-		}
-	}
+/*
+ * Shows the manual data entry table for whatever is in seatingSeriesData, without any rows' buttons
+ */
+void SeatingDepthTest::showManualEntry ( void )
+{
+	// If we already have series data displayed, clear it out first. This call is a no-op if scrollWidget is not already added to stackedWidget.
+	stackedWidget->removeWidget(scrollWidget);
+
+	seriesModel->reload(true);
+
+	QVBoxLayout *scrollLayout = new QVBoxLayout();
+
+	QCheckBox *headerCheckBox = new QCheckBox();
+	headerCheckBox->setChecked(true);
+	connect(headerCheckBox, SIGNAL(stateChanged(int)), this, SLOT(headerCheckBoxChanged(int)));
+
+	seriesView = createSeriesView(seriesModel, headerCheckBox);
+	seriesView->setItemDelegateForColumn(SeriesModel::LENGTH_COLUMN, new SpinBoxDelegate(3, 0.001, 99.99, seriesView));
+	seriesView->setItemDelegateForColumn(SeriesModel::GROUP_COLUMN, new SpinBoxDelegate(3, 0.001, 99.99, seriesView));
+
+	scrollLayout->addWidget(seriesView);
+
+	/* Create utilities toolbar under scroll area */
+
+	addNewButton = new QPushButton("Add new group");
+	addNewButton->setStyleSheet("font-weight: bold");
+	connect(addNewButton, SIGNAL(clicked(bool)), this, SLOT(addNewClicked(bool)));
+	addNewButton->setMinimumWidth(225);
+	addNewButton->setMaximumWidth(225);
+
+	QPushButton *loadNewButton = new QPushButton("Load new shot data file");
+	connect(loadNewButton, SIGNAL(clicked(bool)), this, SLOT(loadNewShotData(bool)));
+	loadNewButton->setMinimumWidth(225);
+	loadNewButton->setMaximumWidth(225);
+
+	QPushButton *autofillButton = new QPushButton("Auto-fill cartridge lengths");
+	connect(autofillButton, SIGNAL(clicked(bool)), this, SLOT(autofillClicked(bool)));
+	autofillButton->setMinimumWidth(225);
+	autofillButton->setMaximumWidth(225);
+
+	QHBoxLayout *utilitiesLayout = new QHBoxLayout();
+	utilitiesLayout->addWidget(addNewButton);
+	utilitiesLayout->addWidget(loadNewButton);
+	utilitiesLayout->addWidget(autofillButton);
+
+	scrollLayout->addLayout(utilitiesLayout);
+
+	scrollWidget = new QWidget();
+	scrollWidget->setLayout(scrollLayout);
+
+	stackedWidget->addWidget(scrollWidget);
+	stackedWidget->setCurrentWidget(scrollWidget);
 }
 
 void SeatingDepthTest::headerCheckBoxChanged ( int state )
 {
 	qDebug() << "headerCheckBoxChanged state =" << state;
 
-	if ( state == Qt::Checked )
-	{
-		qDebug() << "Header checkbox was checked";
-
-		for ( int i = 0; i < seatingSeriesGrid->rowCount() - 1; i++ )
-		{
-			QCheckBox *checkBox = qobject_cast<QCheckBox *>(seatingSeriesGrid->itemAtPosition(i, 0)->widget());
-			if ( checkBox->isEnabled() )
-			{
-				checkBox->setChecked(true);
-			}
-		}
-	}
-	else
-	{
-		qDebug() << "Header checkbox was unchecked";
-
-		for ( int i = 0; i < seatingSeriesGrid->rowCount() - 1; i++ )
-		{
-			QCheckBox *checkBox = qobject_cast<QCheckBox *>(seatingSeriesGrid->itemAtPosition(i, 0)->widget());
-			if ( checkBox->isEnabled() )
-			{
-				checkBox->setChecked(false);
-			}
-		}
-	}
+	seriesModel->setAllEnabled(state == Qt::Checked);
 }
 
 void SeatingDepthTest::groupSizeCheckBoxChanged ( bool state )
@@ -1583,6 +2068,7 @@ void SeatingDepthTest::groupSizeCheckBoxChanged ( bool state )
 	qDebug() << "groupSizeCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(groupSizeCheckBox, groupSizeLabel, groupSizeLocation);
+	replotAnnotations();
 }
 
 void SeatingDepthTest::gsdCheckBoxChanged ( bool state )
@@ -1590,6 +2076,7 @@ void SeatingDepthTest::gsdCheckBoxChanged ( bool state )
 	qDebug() << "gsdCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(gsdCheckBox, gsdLabel, gsdLocation);
+	replotAnnotations();
 }
 
 void SeatingDepthTest::trendCheckBoxChanged ( bool state )
@@ -1597,6 +2084,14 @@ void SeatingDepthTest::trendCheckBoxChanged ( bool state )
 	qDebug() << "trendCheckBoxChanged state =" << state;
 
 	optionCheckBoxChanged(trendCheckBox, trendLabel, trendLineType);
+	replotTrendLine();
+}
+
+void SeatingDepthTest::ellipseCheckBoxChanged ( bool state )
+{
+	qDebug() << "ellipseCheckBoxChanged state =" << state;
+
+	replotAnnotations();
 }
 
 void SeatingDepthTest::updateDisplayedData ( void )
@@ -1606,127 +2101,46 @@ void SeatingDepthTest::updateDisplayedData ( void )
 
 	int index = groupMeasurementType->currentIndex();
 
-	const char *groupMeasurementType2;
-	if ( index == ES )
-	{
-		groupMeasurementType2 = "ES";
-	}
-	else if ( index == YSTDEV )
-	{
-		groupMeasurementType2 = "Y Stdev";
-	}
-	else if ( index == XSTDEV )
-	{
-		groupMeasurementType2 = "X Stdev";
-	}
-	else if ( index == RSD )
-	{
-		groupMeasurementType2 = "RSD";
-	}
-	else
-	{
-		groupMeasurementType2 = "MR";
-	}
-
-	const char *groupUnits2;
-	if ( groupUnits->currentIndex() == INCH )
-	{
-		groupUnits2 = "in";
-	}
-	else if ( groupUnits->currentIndex() == MOA )
-	{
-		groupUnits2 = "MOA";
-	}
-	else if ( groupUnits->currentIndex() == CENTIMETER )
-	{
-		groupUnits2 = "cm";
-	}
-	else
-	{
-		groupUnits2 = "mil";
-	}
-
 	for ( int i = 0; i < seatingSeriesData.size(); i++ )
 	{
 		SeatingSeries *series = seatingSeriesData.at(i);
 
-		double groupSize;
-		double groupSize_sighters;
-		if ( index == ES )
-		{
-			groupSize = series->extremeSpread.at(groupUnits->currentIndex());
-			groupSize_sighters = series->extremeSpread_sighters.at(groupUnits->currentIndex());
-		}
-		else if ( index == YSTDEV )
-		{
-			groupSize = series->yStdev.at(groupUnits->currentIndex());
-			groupSize_sighters = series->yStdev_sighters.at(groupUnits->currentIndex());
-		}
-		else if ( index == XSTDEV )
-		{
-			groupSize = series->xStdev.at(groupUnits->currentIndex());
-			groupSize_sighters = series->xStdev_sighters.at(groupUnits->currentIndex());
-		}
-		else if ( index == RSD )
-		{
-			groupSize = series->radialStdev.at(groupUnits->currentIndex());
-			groupSize_sighters = series->radialStdev_sighters.at(groupUnits->currentIndex());
-		}
-		else
-		{
-			groupSize = series->meanRadius.at(groupUnits->currentIndex());
-			groupSize_sighters = series->meanRadius_sighters.at(groupUnits->currentIndex());
-		}
-
+		double groupSize = measuredGroupSize(series, index, groupUnits->currentIndex(), false);
+		double groupSize_sighters = measuredGroupSize(series, index, groupUnits->currentIndex(), true);
 
 		if ( includeSightersCheckBox->isChecked() )
 		{
-
-			qDebug() << "Setting series (sighters)" << i << "to" << groupMeasurementType2 << groupSize_sighters;
+			qDebug() << "Setting series (sighters)" << i << "to" << groupSize_sighters;
 
 			if ( qIsNaN(groupSize_sighters) )
 			{
-				// series doesn't have enough shots to calculate, so disable it altogether. unchecking the box triggers seriesCheckBoxChanged() to run
-				series->groupSizeLabel->setText("2+ shots required");
-				series->enabled->setChecked(false);
-				series->enabled->setEnabled(false);
+				// series doesn't have enough shots to calculate, so disable it altogether. the model greys out its checkbox
+				series->enabled = false;
 			}
-			else
+			else if ( qIsNaN(groupSize) )
 			{
-				series->groupSizeLabel->setText(QString("%1 %2").arg(groupSize_sighters, 0, 'f', 3).arg(groupUnits2));
-
-				if ( qIsNaN(groupSize) )
-				{
-					// transition from disabled series (no sighters) to enabled series (with sighters)
-					series->enabled->setChecked(true);
-					series->enabled->setEnabled(true);
-				}
+				// transition from disabled series (no sighters) to enabled series (with sighters)
+				series->enabled = true;
 			}
 		}
 		else
 		{
-			qDebug() << "Setting series" << i << "to" << groupMeasurementType2 << groupSize;
+			qDebug() << "Setting series" << i << "to" << groupSize;
 
 			if ( qIsNaN(groupSize) )
 			{
-				// series doesn't have enough shots to calculate, so disable it altogether. unchecking the box triggers seriesCheckBoxChanged() to run
-				series->groupSizeLabel->setText("2+ shots required");
-				series->enabled->setChecked(false);
-				series->enabled->setEnabled(false);
+				// series doesn't have enough shots to calculate, so disable it altogether. the model greys out its checkbox
+				series->enabled = false;
 			}
-			else
+			else if ( qIsNaN(groupSize_sighters) )
 			{
-				series->groupSizeLabel->setText(QString("%1 %2").arg(groupSize, 0, 'f', 3).arg(groupUnits2));
-
-				if ( qIsNaN(groupSize_sighters) )
-				{
-					// transition from disabled series (with sighters) to enabled series (no sighters)
-					series->enabled->setChecked(true);
-					series->enabled->setEnabled(true);
-				}
+				// transition from disabled series (with sighters) to enabled series (no sighters)
+				series->enabled = true;
 			}
 		}
 	}
+
+	seriesModel->setGroupDisplay(index, groupUnits->currentIndex(), includeSightersCheckBox->isChecked());
 }
 
 void SeatingDepthTest::importedGroupIncludeSightersCheckBoxChanged ( bool state )
@@ -1774,33 +2188,14 @@ void SeatingDepthTest::cartridgeMeasurementTypeChanged ( int index )
 {
 	qDebug() << "cartridgeMeasurementTypeChanged index =" << index;
 
-	headerLengthType->setText(cartridgeMeasurementType->currentText());
+	seriesModel->setLengthType(cartridgeMeasurementType->currentText());
 }
 
 void SeatingDepthTest::groupMeasurementTypeChanged ( int index )
 {
 	qDebug() << "groupMeasurementTypeChanged index =" << index;
 
-	if ( index == ES )
-	{
-		headerGroupType->setText("Group Size (ES)");
-	}
-	else if ( index == YSTDEV )
-	{
-		headerGroupType->setText("Group Size (Y Stdev)");
-	}
-	else if ( index == XSTDEV )
-	{
-		headerGroupType->setText("Group Size (X Stdev)");
-	}
-	else if ( index == RSD )
-	{
-		headerGroupType->setText("Group Size (RSD)");
-	}
-	else
-	{
-		headerGroupType->setText("Group Size (MR)");
-	}
+	seriesModel->setGroupDisplay(index, groupUnits->currentIndex(), includeSightersCheckBox->isChecked());
 }
 
 void SeatingDepthTest::importedGroupMeasurementTypeChanged ( int index )
@@ -1842,218 +2237,481 @@ void SeatingDepthTest::saveGraph ( bool state )
 	renderGraph(false);
 }
 
-class SmoothCurveGenerator
-{
-protected:
-    static QPainterPath generateSmoothCurveImp(const QVector<QPointF> &points) {
-        QPainterPath path;
-        int len = points.size();
-
-        if (len < 2) {
-            return path;
-        }
-
-        QVector<QPointF> firstControlPoints;
-        QVector<QPointF> secondControlPoints;
-        calculateControlPoints(points, &firstControlPoints, &secondControlPoints);
-
-        path.moveTo(points[0].x(), points[0].y());
-
-        // Using bezier curve to generate a smooth curve.
-        for (int i = 0; i < len - 1; ++i) {
-            path.cubicTo(firstControlPoints[i], secondControlPoints[i], points[i+1]);
-        }
-
-        return path;
-    }
-public:
-    static QPainterPath generateSmoothCurve(const QVector<QPointF> &points) {
-        QPainterPath result;
-
-        int segmentStart = 0;
-        int i = 0;
-        int pointSize = points.size();
-        while (i < pointSize) {
-            if (qIsNaN(points.at(i).y()) || qIsNaN(points.at(i).x()) || qIsInf(points.at(i).y())) {
-                //QVector<QPointF> lineData(QVector<QPointF>(points.constBegin() + segmentStart, points.constBegin() + i - segmentStart));
-                QVector<QPointF> lineData(QVector<QPointF>(points.mid(segmentStart, i - segmentStart)));
-                result.addPath(generateSmoothCurveImp(lineData));
-                segmentStart = i + 1;
-            }
-            ++i;
-        }
-        //QVector<QPointF> lineData(QVector<QPointF>(points.constBegin() + segmentStart, points.constEnd()));
-        QVector<QPointF> lineData(QVector<QPointF>(points.mid(segmentStart)));
-        result.addPath(generateSmoothCurveImp(lineData));
-        return result;
-    }
-
-    static QPainterPath generateSmoothCurve(const QPainterPath &basePath, const QVector<QPointF> &points) {
-        if (points.isEmpty()) return basePath;
-
-        QPainterPath path = basePath;
-        int len = points.size();
-        if (len == 1) {
-            path.lineTo(points.at(0));
-            return path;
-        }
-
-        QVector<QPointF> firstControlPoints;
-        QVector<QPointF> secondControlPoints;
-        calculateControlPoints(points, &firstControlPoints, &secondControlPoints);
-
-        path.lineTo(points.at(0));
-        for (int i = 0; i < len - 1; ++i)
-            path.cubicTo(firstControlPoints[i], secondControlPoints[i], points[i+1]);
-
-        return path;
-    }
-
-    static void calculateFirstControlPoints(double *&result, const double *rhs, int n) {
-        result = new double[n];
-        double *tmp = new double[n];
-        double b = 2.0;
-        result[0] = rhs[0] / b;
-
-        // Decomposition and forward substitution.
-        for (int i = 1; i < n; i++) {
-            tmp[i] = 1 / b;
-            b = (i < n - 1 ? 4.0 : 3.5) - tmp[i];
-            result[i] = (rhs[i] - result[i - 1]) / b;
-        }
-
-        for (int i = 1; i < n; i++) {
-            result[n - i - 1] -= tmp[n - i] * result[n - i]; // Backsubstitution.
-        }
-
-        delete[] tmp;
-    }
-
-    static void calculateControlPoints(const QVector<QPointF> &knots,
-                                                       QVector<QPointF> *firstControlPoints,
-                                                       QVector<QPointF> *secondControlPoints) {
-        int n = knots.size() - 1;
-
-        firstControlPoints->reserve(n);
-        secondControlPoints->reserve(n);
-
-        for (int i = 0; i < n; ++i) {
-            firstControlPoints->append(QPointF());
-            secondControlPoints->append(QPointF());
-        }
-
-        if (n == 1) {
-            // Special case: Bezier curve should be a straight line.
-            // P1 = (2P0 + P3) / 3
-            (*firstControlPoints)[0].rx() = (2 * knots[0].x() + knots[1].x()) / 3;
-            (*firstControlPoints)[0].ry() = (2 * knots[0].y() + knots[1].y()) / 3;
-
-            // P2 = 2P1 – P0
-            (*secondControlPoints)[0].rx() = 2 * (*firstControlPoints)[0].x() - knots[0].x();
-            (*secondControlPoints)[0].ry() = 2 * (*firstControlPoints)[0].y() - knots[0].y();
-
-            return;
-        }
-
-        // Calculate first Bezier control points
-        double *xs = NULL;
-        double *ys = NULL;
-        double *rhsx = new double[n]; // Right hand side vector
-        double *rhsy = new double[n]; // Right hand side vector
-
-        // Set right hand side values
-        for (int i = 1; i < n - 1; ++i) {
-            rhsx[i] = 4 * knots[i].x() + 2 * knots[i + 1].x();
-            rhsy[i] = 4 * knots[i].y() + 2 * knots[i + 1].y();
-        }
-        rhsx[0] = knots[0].x() + 2 * knots[1].x();
-        rhsx[n - 1] = (8 * knots[n - 1].x() + knots[n].x()) / 2.0;
-        rhsy[0] = knots[0].y() + 2 * knots[1].y();
-        rhsy[n - 1] = (8 * knots[n - 1].y() + knots[n].y()) / 2.0;
-
-        // Calculate first control points coordinates
-        calculateFirstControlPoints(xs, rhsx, n);
-        calculateFirstControlPoints(ys, rhsy, n);
-
-        // Fill output control points.
-        for (int i = 0; i < n; ++i) {
-            (*firstControlPoints)[i].rx() = xs[i];
-            (*firstControlPoints)[i].ry() = ys[i];
-
-            if (i < n - 1) {
-                (*secondControlPoints)[i].rx() = 2 * knots[i + 1].x() - xs[i + 1];
-                (*secondControlPoints)[i].ry() = 2 * knots[i + 1].y() - ys[i + 1];
-            } else {
-                (*secondControlPoints)[i].rx() = (knots[n].x() + xs[n - 1]) / 2;
-                (*secondControlPoints)[i].ry() = (knots[n].y() + ys[n - 1]) / 2;
-            }
-        }
-
-        delete xs;
-        delete ys;
-        delete[] rhsx;
-        delete[] rhsy;
-    }
-};
-
-void QCPSmoothGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines) const
-{
-  qDebug() << "QCPSmoothGraph::drawLinePlot lines =" << lines;
-  if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
-  {
-    applyDefaultAntialiasingHint(painter);
-	if ( mSmooth && mLineStyle == lsLine )
-	{
-		painter->drawPath(SmoothCurveGenerator::generateSmoothCurve(lines));
-	}
-	else
+static bool CartridgeLengthComparator ( SeatingSeries *one, SeatingSeries *two )
+{
+	return (one->cartridgeLength < two->cartridgeLength);
+}
+
+/*
+ * The graph is built once and reused for every preview and save. renderGraph() only updates the data, text, and visibility of what's created here.
+ */
+void SeatingDepthTest::setupPlot ( void )
+{
+	customPlot = new QCustomPlot();
+	// Export size until the first render works it out from the graph's contents, see LabelLayout::canvasSize()
+	canvasSize = QSize(1440, 625);
+	customPlot->setGeometry(40, 40, canvasSize.width(), canvasSize.height());
+	customPlot->setAntialiasedElements(QCP::aeAll);
+	customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+
+	/*
+	 * The data, trend line, and annotations each get their own paint buffer, so toggling the trend line or an annotation only
+	 * repaints that layer instead of the whole plot.
+	 */
+	customPlot->addLayer("scatter", customPlot->layer("main"), QCustomPlot::limAbove);
+	customPlot->addLayer("trend", customPlot->layer("scatter"), QCustomPlot::limAbove);
+	customPlot->addLayer("annotations", customPlot->layer("overlay"), QCustomPlot::limAbove);
+	customPlot->layer("scatter")->setMode(QCPLayer::lmBuffered);
+	customPlot->layer("trend")->setMode(QCPLayer::lmBuffered);
+	customPlot->layer("annotations")->setMode(QCPLayer::lmBuffered);
+
+	/* Scatter plot */
+
+	QPen seatingLinePen(Qt::SolidLine);
+	QColor seatingLineColor("#1c57eb");
+	seatingLineColor.setAlphaF(0.65);
+	seatingLinePen.setColor(seatingLineColor);
+	seatingLinePen.setWidthF(1.5);
+
+	scatterPlot = new QCPSmoothGraph(customPlot->xAxis, customPlot->yAxis);
+	scatterPlot->setName(QLatin1String("Graph ")+QString::number(customPlot->graphCount()));
+	scatterPlot->setSmooth(true);
+	scatterPlot->setLayer("scatter");
+	scatterPlot->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, QColor("#0536b0"), 6.0));
+	scatterPlot->setPen(seatingLinePen);
+
+	/* Trend line */
+
+	trendLine = customPlot->addGraph();
+	trendLine->setScatterStyle(QCPScatterStyle::ssNone);
+	trendLine->setVisible(false);
+	trendLine->setLayer("trend");
+
+	/* Title and subtitle */
+
+	plotTitle = new QCPTextElement(customPlot);
+	plotTitle->setFont(QFont("DejaVu Sans", scaleFontSize(24)));
+	plotTitle->setTextColor(QColor("#4d4d4d"));
+	customPlot->plotLayout()->insertRow(0);
+	customPlot->plotLayout()->addElement(0, 0, plotTitle);
+
+	plotSubtitle = new QCPTextElement(customPlot);
+	plotSubtitle->setFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	plotSubtitle->setTextColor(QColor("#4d4d4d"));
+	customPlot->plotLayout()->insertRow(1);
+	customPlot->plotLayout()->addElement(1, 0, plotSubtitle);
+
+	/* Axes */
+
+	QPen gridPen(Qt::SolidLine);
+	gridPen.setColor("#d9d9d9");
+
+	QPen axisBasePen(Qt::SolidLine);
+	axisBasePen.setColor("#d9d9d9");
+	axisBasePen.setWidth(2);
+
+	customPlot->xAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	customPlot->xAxis->setTickLabelColor(QColor("#4d4d4d"));
+	customPlot->xAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	customPlot->xAxis->setLabelColor(QColor("#4d4d4d"));
+	customPlot->xAxis->grid()->setZeroLinePen(Qt::NoPen);
+	customPlot->xAxis->grid()->setPen(gridPen);
+	customPlot->xAxis->setBasePen(axisBasePen);
+	customPlot->xAxis->setTickPen(Qt::NoPen);
+	customPlot->xAxis->setSubTickPen(Qt::NoPen);
+	customPlot->xAxis->setLabelPadding(13);
+	customPlot->xAxis->setPadding(20);
+
+	customPlot->xAxis2->setBasePen(axisBasePen);
+	customPlot->xAxis2->setTickPen(Qt::NoPen);
+	customPlot->xAxis2->setSubTickPen(Qt::NoPen);
+	customPlot->xAxis2->setPadding(20);
+
+	customPlot->yAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	customPlot->yAxis->setTickLabelColor(QColor("#4d4d4d"));
+	customPlot->yAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
+	customPlot->yAxis->setLabelColor(QColor("#4d4d4d"));
+	customPlot->yAxis->grid()->setZeroLinePen(Qt::NoPen);
+	customPlot->yAxis->grid()->setPen(gridPen);
+	customPlot->yAxis->setBasePen(axisBasePen);
+	customPlot->yAxis->setTickPen(Qt::NoPen);
+	customPlot->yAxis->setSubTickPen(Qt::NoPen);
+	customPlot->yAxis->setLabelPadding(20);
+	customPlot->yAxis->setPadding(20);
+
+	customPlot->yAxis2->setBasePen(axisBasePen);
+	customPlot->yAxis2->setTickPen(Qt::NoPen);
+	customPlot->yAxis2->setSubTickPen(Qt::NoPen);
+	customPlot->yAxis2->setPadding(20);
+
+	// seems to strike a good balance of tick frequency and readability
+	customPlot->yAxis->ticker()->setTickCount(6);
+
+	/* Shot pattern overlay, beside the graph while shown */
+
+	patterns = new ShotPattern::Overlay(customPlot);
+
+	// The preview window takes ownership of the plot and is only hidden when closed
+	graphPreview = new GraphPreview(customPlot);
+}
+
+/*
+ * Annotations are pooled across renders. Returns the pool's item at index, creating it if the pool isn't that large yet.
+ */
+QCPItemText *SeatingDepthTest::annotationItem ( QList<QCPItemText *> &pool, QList<QCPItemTracer *> &anchors, int index )
+{
+	if ( index < pool.size() )
+	{
+		pool.at(index)->setVisible(true);
+		return pool.at(index);
+	}
+
+	// Annotations sit a fixed number of pixels away from an invisible anchor in plot coordinates, so they follow the plot when it's resized
+	QCPItemTracer *anchor = new QCPItemTracer(customPlot);
+	anchor->setStyle(QCPItemTracer::tsNone);
+	anchor->setLayer("annotations");
+	anchors.append(anchor);
+
+	QCPItemText *annotation = new QCPItemText(customPlot);
+	annotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
+	annotation->setColor(QColor("#4d4d4d"));
+	annotation->position->setType(QCPItemPosition::ptAbsolute);
+	annotation->position->setParentAnchor(anchor->position);
+	annotation->setTextAlignment(Qt::AlignCenter);
+	annotation->setBrush(QBrush(Qt::white));
+	annotation->setClipToAxisRect(false);
+	annotation->setLayer("annotations");
+
+	pool.append(annotation);
+	return annotation;
+}
+
+/*
+ * Trend line over the groups being graphed. Called on each render, and on its own when the trend line is toggled.
+ */
+void SeatingDepthTest::updateTrendLine ( void )
+{
+	if ( trendCheckBox->isChecked() && (! graphedX.empty()) )
+	{
+		std::vector<double> res = GetLinearFit(graphedX, graphedY);
+		qDebug() << "linear fit:" << res[0] << res[1];
+
+		std::vector<SplineSet> res2a = spline(graphedX, graphedY);
+		SplineSet res2;
+		foreach ( res2, res2a )
+		{
+			qDebug() << "spline:" << res2.a << res2.b << res2.c << res2.d << res2.x;
+		}
+
+		QVector<double> xTrendPoints;
+		QVector<double> yTrendPoints;
+		xTrendPoints.push_back(graphedX.first());
+		yTrendPoints.push_back(res[1] + (graphedX.first() * res[0]));
+		xTrendPoints.push_back(graphedX.last());
+		yTrendPoints.push_back(res[1] + (graphedX.last() * res[0]));
+
+		qDebug() << "xTrendPoints:" << xTrendPoints;
+		qDebug() << "yTrendPoints:" << yTrendPoints;
+
+		Qt::PenStyle lineType;
+		if ( trendLineType->currentIndex() == SOLID_LINE )
+		{
+			lineType = Qt::SolidLine;
+		}
+		else
+		{
+			lineType = Qt::DashLine;
+		}
+
+		QPen trendLinePen(lineType);
+		QColor trendLineColor(Qt::red);
+		trendLineColor.setAlphaF(0.65);
+		trendLinePen.setColor(trendLineColor);
+		trendLinePen.setWidthF(1.5);
+
+		trendLine->setData(xTrendPoints, yTrendPoints);
+		trendLine->setPen(trendLinePen);
+		trendLine->setVisible(true);
+	}
+	else
+	{
+		trendLine->data()->clear();
+		trendLine->setVisible(false);
+	}
+}
+
+/*
+ * Per-group text annotations, anchored to the groups' points in plot coordinates. Called on each render, and on its own when
+ * an annotation is toggled.
+ */
+void SeatingDepthTest::updateAnnotations ( void )
+{
+	bool prevSizeSet = false;
+	double prevSize = 0;
+
+	for ( int i = 0; i < graphedY.size(); i++ )
+	{
+		// Collect annotation contents
+		QStringList aboveAnnotationText;
+		QStringList belowAnnotationText;
+
+		if ( groupSizeCheckBox->isChecked() )
+		{
+			QString annotation = QString::number(graphedY.at(i), 'f', 3);
+			if ( groupSizeLocation->currentIndex() == ABOVE_STRING )
+			{
+				aboveAnnotationText.append(annotation);
+			}
+			else
+			{
+				belowAnnotationText.append(annotation);
+			}
+		}
+
+		if ( gsdCheckBox->isChecked() )
+		{
+			if ( prevSizeSet )
+			{
+				QString sign;
+				double delta = graphedY.at(i) - prevSize;
+				if ( delta < 0 )
+				{
+					sign = QString("-");
+				}
+				else
+				{
+					sign = QString("+");
+				}
+
+				QString annotation = QString("%1%2").arg(sign).arg(fabs(delta), 0, 'f', 3);
+				if ( gsdLocation->currentIndex() == ABOVE_STRING )
+				{
+					aboveAnnotationText.append(annotation);
+				}
+				else
+				{
+					belowAnnotationText.append(annotation);
+				}
+			}
+		}
+
+		double yCoord = graphedY.at(i);
+
+		QCPItemText *belowAnnotation = annotationItem(belowAnnotations, belowAnchors, i);
+		belowAnnotation->setText(belowAnnotationText.join('\n'));
+		belowAnchors.at(i)->position->setCoords(graphedX.at(i), yCoord);
+
+		QCPItemText *aboveAnnotation = annotationItem(aboveAnnotations, aboveAnchors, i);
+		aboveAnnotation->setText(aboveAnnotationText.join('\n'));
+		aboveAnchors.at(i)->position->setCoords(graphedX.at(i), yCoord);
+
+		prevSize = yCoord;
+		prevSizeSet = true;
+	}
+
+	// Hide pooled annotations left over from a previous render with more series
+	for ( int i = graphedY.size(); i < belowAnnotations.size(); i++ )
+	{
+		belowAnnotations.at(i)->setVisible(false);
+	}
+	for ( int i = graphedY.size(); i < aboveAnnotations.size(); i++ )
+	{
+		aboveAnnotations.at(i)->setVisible(false);
+	}
+
+	/* Resolve overlaps between every label on the graph */
+
+	QList<QCPItemText *> labels;
+	QVector<int> sides;
+	for ( int i = 0; i < graphedY.size(); i++ )
+	{
+		labels.append(aboveAnnotations.at(i));
+		sides.append(LabelLayout::ABOVE);
+		labels.append(belowAnnotations.at(i));
+		sides.append(LabelLayout::BELOW);
+	}
+
+	// Size the canvas to fit, then lay the graph out at that size since labels are placed in pixels. Ellipse glyphs reach 30
+	// pixels out from their point.
+	canvasSize = LabelLayout::canvasSize(customPlot, labels, sides, 10, ellipseCheckBox->isChecked() ? 60 : 10);
+	QRect viewport = LabelLayout::layoutAt(customPlot, canvasSize);
+
+	// Keep labels off each group's point marker
+	QVector<QRectF> markers;
+	for ( int i = 0; i < graphedY.size(); i++ )
+	{
+		QPointF pointPixel = aboveAnchors.at(i)->position->pixelPosition();
+		markers.append(QRectF(pointPixel.x() - 5, pointPixel.y() - 5, 10, 10));
+	}
+
+	LabelLayout::arrange(labels, sides, markers, 10);
+
+	// Lay the graph back out for the on-screen preview
+	LabelLayout::layoutAt(customPlot, viewport.size());
+}
+
+/*
+ * Draw each group's 90% dispersion ellipse as a glyph centered on its point. Shot coordinates and graph axes are unrelated,
+ * so the glyphs are laid out in pixels, scaled together so the largest group reaches 30 pixels out. Only imported data has shot
+ * coordinates to work with.
+ */
+void SeatingDepthTest::updateEllipses ( void )
+{
+	// Lay the graph out at its export size so that coordToPixel() matches what's saved
+	QRect viewport = LabelLayout::layoutAt(customPlot, canvasSize);
+
+	int numEllipses = 0;
+
+	if ( ellipseCheckBox->isChecked() )
+	{
+		QList<QVector<QPair<double, double> > > outlines;
+		double largest = 0;
+
+		for ( int i = 0; i < graphedSeries.size(); i++ )
+		{
+			SeatingSeries *series = graphedSeries.at(i);
+
+			QVector<QPair<double, double> > outline;
+			if ( ! series->manual )
+			{
+				outline = Dispersion::outline(includeSightersCheckBox->isChecked() ? series->dispersion_sighters : series->dispersion, 0.9, 48);
+			}
+
+			for ( int j = 0; j < outline.size(); j++ )
+			{
+				largest = qMax(largest, sqrt( pow(outline.at(j).first, 2) + pow(outline.at(j).second, 2) ));
+			}
+
+			outlines.append(outline);
+		}
+
+		QPen ellipsePen(Qt::SolidLine);
+		QColor ellipseColor("#0536b0");
+		ellipseColor.setAlphaF(0.5);
+		ellipsePen.setColor(ellipseColor);
+		ellipsePen.setWidthF(1.0);
+
+		for ( int i = 0; i < outlines.size() && largest > 0; i++ )
+		{
+			const QVector<QPair<double, double> > &outline = outlines.at(i);
+			if ( outline.empty() )
+			{
+				continue;
+			}
+
+			double xPixel = customPlot->xAxis->coordToPixel(graphedX.at(i));
+			double yPixel = customPlot->yAxis->coordToPixel(graphedY.at(i));
+			double scale = 30 / largest;
+
+			QVector<double> t(outline.size());
+			QVector<double> x(outline.size());
+			QVector<double> y(outline.size());
+			for ( int j = 0; j < outline.size(); j++ )
+			{
+				// screen y grows downward, target y grows upward
+				t[j] = j;
+				x[j] = customPlot->xAxis->pixelToCoord(xPixel + outline.at(j).first * scale);
+				y[j] = customPlot->yAxis->pixelToCoord(yPixel - outline.at(j).second * scale);
+			}
+
+			QCPCurve *ellipse;
+			if ( numEllipses < ellipseCurves.size() )
+			{
+				ellipse = ellipseCurves.at(numEllipses);
+				ellipse->setVisible(true);
+			}
+			else
+			{
+				ellipse = new QCPCurve(customPlot->xAxis, customPlot->yAxis);
+				ellipse->setLayer("annotations");
+				ellipse->setPen(ellipsePen);
+				ellipse->setBrush(Qt::NoBrush);
+				ellipseCurves.append(ellipse);
+			}
+			ellipse->setData(t, x, y, true);
+			numEllipses++;
+		}
+	}
+
+	for ( int i = numEllipses; i < ellipseCurves.size(); i++ )
+	{
+		ellipseCurves.at(i)->data()->clear();
+		ellipseCurves.at(i)->setVisible(false);
+	}
+
+	// Lay the graph back out for the on-screen preview
+	LabelLayout::layoutAt(customPlot, viewport.size());
+}
+
+/*
+ * Repaint only the annotation or trend line layer of an open preview after its option was toggled
+ */
+void SeatingDepthTest::replotAnnotations ( void )
+{
+	if ( graphPreview->isVisible() )
+	{
+		updateAnnotations();
+		updateEllipses();
+		customPlot->layer("annotations")->replot();
+	}
+}
+
+void SeatingDepthTest::replotTrendLine ( void )
+{
+	if ( graphPreview->isVisible() )
 	{
-    	drawPolyline(painter, lines);
+		updateTrendLine();
+		customPlot->layer("trend")->replot();
 	}
-  }
 }
 
-static bool CartridgeLengthComparator ( SeatingSeries *one, SeatingSeries *two )
+/*
+ * Errors found while building the graph. Interactive sessions get a dialog, headless runs collect them for the caller to report.
+ */
+void SeatingDepthTest::reportError ( const QString &text )
 {
-	return (one->cartridgeLength->value() < two->cartridgeLength->value());
+	if ( headless )
+	{
+		errors.append(text);
+		return;
+	}
+
+	QMessageBox msg;
+	msg.setIcon(QMessageBox::Critical);
+	msg.setText(text);
+	msg.setWindowTitle("Error");
+	msg.exec();
 }
 
-void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
+/*
+ * Validates the series and updates the persistent plot in place. Returns false if there's nothing to graph.
+ */
+bool SeatingDepthTest::populatePlot ( void )
 {
-	qDebug() << "renderGraph displayGraphPreview =" << displayGraphPreview;
-
 	/* Validate series before continuing */
 
 	int numEnabled = 0;
 	for ( int i = 0; i < seatingSeriesData.size(); i++ )
 	{
 		SeatingSeries *series = seatingSeriesData.at(i);
-		if ( (! series->deleted) && series->enabled->isChecked() )
+		if ( (! series->deleted) && series->enabled )
 		{
 			numEnabled += 1;
 
-			if ( series->cartridgeLength->value() == 0 )
+			if ( series->cartridgeLength == 0 )
 			{
-				qDebug() << series->name->text() << "is missing cartridge length, bailing";
-
-				QMessageBox *msg = new QMessageBox();
-				msg->setIcon(QMessageBox::Critical);
-				msg->setText(QString("%1 is missing cartridge length!").arg(series->name->text()));
-				msg->setWindowTitle("Error");
-				msg->exec();
-				return;
+				qDebug() << series->name << "is missing cartridge length, bailing";
+
+				reportError(QString("%1 is missing cartridge length!").arg(series->name));
+				return false;
 			}
 
-			if ( series->groupSize && (series->groupSize->value() == 0) )
+			if ( series->manual && (series->groupSize == 0) )
 			{
-				qDebug() << series->name->text() << "is missing group size, bailing";
-
-				QMessageBox *msg = new QMessageBox();
-				msg->setIcon(QMessageBox::Critical);
-				msg->setText(QString("%1 is missing group size!").arg(series->name->text()));
-				msg->setWindowTitle("Error");
-				msg->exec();
-				return;
+				qDebug() << series->name << "is missing group size, bailing";
+
+				reportError(QString("%1 is missing group size!").arg(series->name));
+				return false;
 			}
 		}
 	}
@@ -2062,19 +2720,10 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	{
 		qDebug() << "Only" << numEnabled << "series enabled, bailing";
 
-		QMessageBox *msg = new QMessageBox();
-		msg->setIcon(QMessageBox::Critical);
-		msg->setText("At least two series are required to graph!");
-		msg->setWindowTitle("Error");
-		msg->exec();
-		return;
+		reportError("At least two series are required to graph!");
+		return false;
 	}
 
-	QCustomPlot *customPlot = new QCustomPlot();
-	// TODO: dynamically calculate width based on graph contents
-	customPlot->setGeometry(40, 40, 1440, 625);
-	customPlot->setAntialiasedElements(QCP::aeAll);
-
 	/* Make a copy of the subset of data actually being graphed */
 
 	QList<SeatingSeries *> seriesToGraph;
@@ -2084,11 +2733,11 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 
 		if ( series->deleted )
 		{
-			qDebug() << series->name->text() << "is deleted, skipping...";
+			qDebug() << series->name << "is deleted, skipping...";
 		}
-		else if ( ! series->enabled->isChecked() )
+		else if ( ! series->enabled )
 		{
-			qDebug() << series->name->text() << "is unchecked, skipping...";
+			qDebug() << series->name << "is unchecked, skipping...";
 		}
 		else
 		{
@@ -2109,10 +2758,19 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		{
 			SeatingSeries *series = seriesToGraph.at(i);
 
-			double cartridgeLength = series->cartridgeLength->value();
+			double cartridgeLength = series->cartridgeLength;
 
 			if ( cartridgeLength == lastCartridgeLength )
 			{
+				if ( headless )
+				{
+					qDebug() << "Duplicate cartridge length detected" << cartridgeLength << ", switching to constant x-axis spacing";
+
+					warnings.append(QString("Duplicate cartridge length %1, switched to constant x-axis spacing").arg(cartridgeLength));
+					xAxisSpacing->setCurrentIndex(CONSTANT);
+					break;
+				}
+
 				qDebug() << "Duplicate cartridge length detected" << cartridgeLength << ", prompting user to switch to constant x-axis spacing";
 
 				QMessageBox::StandardButton reply;
@@ -2128,7 +2786,7 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 				else
 				{
 					qDebug() << "User cancel, bailing out";
-					return;
+					return false;
 				}
 			}
 
@@ -2152,13 +2810,13 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	{
 		SeatingSeries *series = seriesToGraph.at(i);
 
-		double cartridgeLength = series->cartridgeLength->value();
+		double cartridgeLength = series->cartridgeLength;
 
 		double groupSize;
-		if ( series->groupSize )
+		if ( series->manual )
 		{
 			// If the user selected manual data entry
-			groupSize = series->groupSize->value();
+			groupSize = series->groupSize;
 		}
 		else
 		{
@@ -2182,6 +2840,14 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 				{
 					groupSize = series->radialStdev_sighters.at(groupUnits->currentIndex());
 				}
+				else if ( groupMeasurementType->currentIndex() == CEP50 )
+				{
+					groupSize = series->cep50_sighters.at(groupUnits->currentIndex());
+				}
+				else if ( groupMeasurementType->currentIndex() == CEP90 )
+				{
+					groupSize = series->cep90_sighters.at(groupUnits->currentIndex());
+				}
 				else
 				{
 					groupSize = series->meanRadius_sighters.at(groupUnits->currentIndex());
@@ -2205,6 +2871,14 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 				{
 					groupSize = series->radialStdev.at(groupUnits->currentIndex());
 				}
+				else if ( groupMeasurementType->currentIndex() == CEP50 )
+				{
+					groupSize = series->cep50.at(groupUnits->currentIndex());
+				}
+				else if ( groupMeasurementType->currentIndex() == CEP90 )
+				{
+					groupSize = series->cep90.at(groupUnits->currentIndex());
+				}
 				else
 				{
 					groupSize = series->meanRadius.at(groupUnits->currentIndex());
@@ -2212,7 +2886,7 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 			}
 		}
 
-		qDebug() << QString("%1 - %2, %3").arg(series->name->text()).arg(cartridgeLength).arg(groupSize);
+		qDebug() << QString("%1 - %2, %3").arg(series->name).arg(cartridgeLength).arg(groupSize);
 		qDebug() << "";
 
 		/*
@@ -2234,67 +2908,19 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		yPoints.push_back(groupSize);
 	}
 
-	/* Create scatter plot */
+	// Keep what's being graphed around so annotations and the trend line can be updated on their own
+	graphedSeries = seriesToGraph;
+	graphedX = xPoints;
+	graphedY = yPoints;
 
-	QPen seatingLinePen(Qt::SolidLine);
-	QColor seatingLineColor("#1c57eb");
-	seatingLineColor.setAlphaF(0.65);
-	seatingLinePen.setColor(seatingLineColor);
-	seatingLinePen.setWidthF(1.5);
+	/* Update scatter plot */
 
-	QCPSmoothGraph *scatterPlot = new QCPSmoothGraph(customPlot->xAxis, customPlot->yAxis);
-	scatterPlot->setName(QLatin1String("Graph ")+QString::number(customPlot->graphCount()));
-	scatterPlot->setSmooth(true);
 	scatterPlot->setData(xPoints, yPoints);
 	scatterPlot->rescaleAxes();
-	scatterPlot->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, QColor("#0536b0"), 6.0));
-	scatterPlot->setPen(seatingLinePen);
 
 	/* Draw trend line if necessary */
 
-	if ( trendCheckBox->isChecked() )
-	{
-		std::vector<double> res = GetLinearFit(xPoints, yPoints);
-		qDebug() << "linear fit:" << res[0] << res[1];
-
-		std::vector<SplineSet> res2a = spline(xPoints, yPoints);
-		SplineSet res2;
-		foreach ( res2, res2a )
-		{
-			qDebug() << "spline:" << res2.a << res2.b << res2.c << res2.d << res2.x;
-		}
-
-		QVector<double> xTrendPoints;
-		QVector<double> yTrendPoints;
-		xTrendPoints.push_back(xPoints.first());
-		yTrendPoints.push_back(res[1] + (xPoints.first() * res[0]));
-		xTrendPoints.push_back(xPoints.last());
-		yTrendPoints.push_back(res[1] + (xPoints.last() * res[0]));
-
-		qDebug() << "xTrendPoints:" << xTrendPoints;
-		qDebug() << "yTrendPoints:" << yTrendPoints;
-
-		Qt::PenStyle lineType;
-		if ( trendLineType->currentIndex() == SOLID_LINE )
-		{
-			lineType = Qt::SolidLine;
-		}
-		else
-		{
-			lineType = Qt::DashLine;
-		}
-
-		QPen trendLinePen(lineType);
-		QColor trendLineColor(Qt::red);
-		trendLineColor.setAlphaF(0.65);
-		trendLinePen.setColor(trendLineColor);
-		trendLinePen.setWidthF(1.5);
-
-		QCPGraph *trendLine = customPlot->addGraph();
-		trendLine->setData(xTrendPoints, yTrendPoints);
-		trendLine->setScatterStyle(QCPScatterStyle::ssNone);
-		trendLine->setPen(trendLinePen);
-	}
+	updateTrendLine();
 
 	/* Configure rest of the graph */
 
@@ -2335,6 +2961,14 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 	{
 		groupMeasurementType2 = "Radial Standard Deviation";
 	}
+	else if ( groupMeasurementType->currentIndex() == CEP50 )
+	{
+		groupMeasurementType2 = "Circular Error Probable (50%)";
+	}
+	else if ( groupMeasurementType->currentIndex() == CEP90 )
+	{
+		groupMeasurementType2 = "Circular Error Probable (90%)";
+	}
 	else
 	{
 		groupMeasurementType2 = "Mean Radius";
@@ -2358,197 +2992,183 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 		groupUnits2 = "mil";
 	}
 
-	QCPTextElement *title = new QCPTextElement(customPlot);
-	title->setText(QString("\n%1").arg(graphTitle->text()));
-	title->setFont(QFont("DejaVu Sans", scaleFontSize(24)));
-	title->setTextColor(QColor("#4d4d4d"));
-	customPlot->plotLayout()->insertRow(0);
-	customPlot->plotLayout()->addElement(0, 0, title);
+	plotTitle->setText(QString("\n%1").arg(graphTitle->text()));
 
-	QCPTextElement *subtitle = new QCPTextElement(customPlot);
 	QStringList subtitleText;
 	subtitleText << rifle->text() << propellant->text() << projectile->text() << brass->text() << primer->text() << weather->text() << distance->text();
-	subtitle->setText(StringListJoin(subtitleText, ", ") + "\n");
-	subtitle->setFont(QFont("DejaVu Sans", scaleFontSize(12)));
-	subtitle->setTextColor(QColor("#4d4d4d"));
-	customPlot->plotLayout()->insertRow(1);
-	customPlot->plotLayout()->addElement(1, 0, subtitle);
-
-	QPen gridPen(Qt::SolidLine);
-	gridPen.setColor("#d9d9d9");
-
-	QPen axisBasePen(Qt::SolidLine);
-	axisBasePen.setColor("#d9d9d9");
-	axisBasePen.setWidth(2);
+	plotSubtitle->setText(StringListJoin(subtitleText, ", ") + "\n");
 
 	customPlot->xAxis->setLabel(QString("%1 (%2)").arg(cartridgeMeasurementType2).arg(cartridgeUnits2));
 	customPlot->xAxis->scaleRange(1.1);
 	customPlot->xAxis->setTicker(textTicker);
-	customPlot->xAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
-	customPlot->xAxis->setTickLabelColor(QColor("#4d4d4d"));
-	customPlot->xAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
-	customPlot->xAxis->setLabelColor(QColor("#4d4d4d"));
-	customPlot->xAxis->grid()->setZeroLinePen(Qt::NoPen);
-	customPlot->xAxis->grid()->setPen(gridPen);
-	customPlot->xAxis->setBasePen(axisBasePen);
-	customPlot->xAxis->setTickPen(Qt::NoPen);
-	customPlot->xAxis->setSubTickPen(Qt::NoPen);
-	customPlot->xAxis->setLabelPadding(13);
-	customPlot->xAxis->setPadding(20);
-
-	customPlot->xAxis2->setBasePen(axisBasePen);
-	customPlot->xAxis2->setTickPen(Qt::NoPen);
-	customPlot->xAxis2->setSubTickPen(Qt::NoPen);
-	customPlot->xAxis2->setPadding(20);
 
 	customPlot->yAxis->setLabel(QString("%1 (%2)").arg(groupMeasurementType2).arg(groupUnits2));
 	customPlot->yAxis->scaleRange(1.3);
-	customPlot->yAxis->setTickLabelFont(QFont("DejaVu Sans", scaleFontSize(9)));
-	customPlot->yAxis->setTickLabelColor(QColor("#4d4d4d"));
-	customPlot->yAxis->setLabelFont(QFont("DejaVu Sans", scaleFontSize(12)));
-	customPlot->yAxis->setLabelColor(QColor("#4d4d4d"));
-	customPlot->yAxis->grid()->setZeroLinePen(Qt::NoPen);
-	customPlot->yAxis->grid()->setPen(gridPen);
-	customPlot->yAxis->setBasePen(axisBasePen);
-	customPlot->yAxis->setTickPen(Qt::NoPen);
-	customPlot->yAxis->setSubTickPen(Qt::NoPen);
-	customPlot->yAxis->setLabelPadding(20);
-	customPlot->yAxis->setPadding(20);
 
-	customPlot->yAxis2->setBasePen(axisBasePen);
-	customPlot->yAxis2->setTickPen(Qt::NoPen);
-	customPlot->yAxis2->setSubTickPen(Qt::NoPen);
-	customPlot->yAxis2->setPadding(20);
+	customPlot->axisRect()->setupFullAxesBox();
 
-	// seems to strike a good balance of tick frequency and readability
-	customPlot->yAxis->ticker()->setTickCount(6);
+	/* Shot patterns of the imported groups. The overlay has to be in place before annotations work out the canvas size. */
 
-	customPlot->axisRect()->setupFullAxesBox();
+	QList<ShotPattern::Group> patternGroups;
+	if ( patternCheckBox->isChecked() )
+	{
+		for ( int i = 0; i < graphedSeries.size(); i++ )
+		{
+			ShotPattern::Group group;
+			group.label = QString::number(graphedSeries.at(i)->cartridgeLength);
+			group.shots = graphedSeries.at(i)->coordinates;
+			group.sighters = ShotPattern::sightersOnly(graphedSeries.at(i)->coordinates_sighters, graphedSeries.at(i)->coordinates);
+			patternGroups.append(group);
+		}
+	}
+	patterns->setGroups(patternGroups);
 
-	// Render the graph off-screen
-	QPixmap picture(QSize(1440, 625));
-	QCPPainter painter(&picture);
-	customPlot->toPainter(&painter, 1440, 625);
+	/* Generate text annotations */
 
-	/*
-	 * Generate text annotations. We need to do this after rendering the graph so that coordToPixel() works.
-	 */
+	updateAnnotations();
+	updateEllipses();
+	patterns->layout(canvasSize);
 
-	bool prevSizeSet = false;
-	double prevSize = 0;
+	plottedKey = renderKey();
 
-	for ( int i = 0; i < seriesToGraph.size(); i++ )
+	return true;
+}
+
+/*
+ * Adds the enabled groups and their components to the load history, and their shots to the shot archive. Called on import and
+ * again on each graph. The session is keyed by every loaded coordinate, so recording the same data again with other
+ * cartridge lengths or components replaces its earlier record.
+ */
+void SeatingDepthTest::recordHistory ( void )
+{
+	// Manually entered groups have no shots to tell their sessions apart
+	if ( headless || isManualEntry() )
 	{
-		// Collect annotation contents
-		QStringList aboveAnnotationText;
-		QStringList belowAnnotationText;
+		return;
+	}
 
-		if ( groupSizeCheckBox->isChecked() )
+	QList<SeatingSeries *> recordedSeries;
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		SeatingSeries *series = seatingSeriesData.at(i);
+		if ( series->enabled && (! series->deleted) && (! (series->coordinates.isEmpty() && series->coordinates_sighters.isEmpty())) )
 		{
-			QString annotation = QString::number(yPoints.at(i), 'f', 3);
-			if ( groupSizeLocation->currentIndex() == ABOVE_STRING )
-			{
-				aboveAnnotationText.append(annotation);
-			}
-			else
-			{
-				belowAnnotationText.append(annotation);
-			}
+			recordedSeries.append(series);
 		}
+	}
 
-		if ( gsdCheckBox->isChecked() )
+	if ( recordedSeries.isEmpty() )
+	{
+		return;
+	}
+
+	// Sorted, so the fingerprint stays the same when shots are excluded
+	QVector<QPair<double, double> > loaded;
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		SeatingSeries *series = seatingSeriesData.at(i);
+		loaded += series->coordinates.toVector() + series->coordinates_sighters.toVector();
+		for ( int j = 0; j < series->excludedShots.size(); j++ )
 		{
-			if ( prevSizeSet )
+			loaded.append(series->excludedShots.at(j).coordinates);
+			if ( series->excludedShots.at(j).sighterIndex >= 0 )
 			{
-				QString sign;
-				double delta = yPoints.at(i) - prevSize;
-				if ( delta < 0 )
-				{
-					sign = QString("-");
-				}
-				else
-				{
-					sign = QString("+");
-				}
-
-				QString annotation = QString("%1%2").arg(sign).arg(fabs(delta), 0, 'f', 3);
-				if ( gsdLocation->currentIndex() == ABOVE_STRING )
-				{
-					aboveAnnotationText.append(annotation);
-				}
-				else
-				{
-					belowAnnotationText.append(annotation);
-				}
+				loaded.append(series->excludedShots.at(j).coordinates);
 			}
 		}
+	}
+	std::sort(loaded.begin(), loaded.end());
 
-		// Obtain pixel coordinates for points. We need the min/max points for scatter plots and stdev for line + SD bar charts.
+	QCryptographicHash hash(QCryptographicHash::Sha1);
+	for ( int i = 0; i < loaded.size(); i++ )
+	{
+		hash.addData((const char *)&loaded.at(i).first, sizeof(double));
+		hash.addData((const char *)&loaded.at(i).second, sizeof(double));
+	}
 
-		double yCoord;
+	History::Session session;
+	session.fingerprint = hash.result();
+	session.test = ARCHIVE_SEATING_DEPTH;
+	session.recorded = QDate::currentDate();
+	session.rifle = rifle->text();
+	session.projectile = projectile->text();
+	session.propellant = propellant->text();
+	session.brass = brass->text();
+	session.primer = primer->text();
+	session.weightUnits = (cartridgeUnits->currentIndex() == INCH) ? "in" : "cm";
+	session.groupUnits = QString("%1, %2").arg(groupMeasurementType->currentText()).arg(groupUnits->currentText());
 
-		yCoord = yPoints.at(i);
+	QVector<ShotArchive::Shot> shots;
+	for ( int i = 0; i < recordedSeries.size(); i++ )
+	{
+		SeatingSeries *series = recordedSeries.at(i);
 
-		QCPItemText *belowAnnotation = new QCPItemText(customPlot);
-		belowAnnotation->setText(belowAnnotationText.join('\n'));
-		belowAnnotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
-		belowAnnotation->setColor(QColor("#4d4d4d"));
-		belowAnnotation->position->setType(QCPItemPosition::ptAbsolute);
-		if ( xAxisSpacing->currentIndex() == CONSTANT )
-		{
-			belowAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(i), customPlot->yAxis->coordToPixel(yCoord) + 10);
-		}
-		else
-		{
-			belowAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(xPoints.at(i)), customPlot->yAxis->coordToPixel(yCoord) + 10);
-		}
-		belowAnnotation->setPositionAlignment(Qt::AlignHCenter | Qt::AlignTop);
-		belowAnnotation->setTextAlignment(Qt::AlignCenter);
-		belowAnnotation->setBrush(QBrush(Qt::white));
-		belowAnnotation->setClipToAxisRect(false);
-		belowAnnotation->setLayer(customPlot->layer(5));
-		qDebug() << "min pixel coords:" << belowAnnotation->position->pixelPosition() << "layer:" << belowAnnotation->layer()->name() << "rect:" << customPlot->axisRect()->layer()->name();
+		History::Series group;
+		group.name = series->name;
+		group.firstDate = series->firstDate;
+		group.charge = series->cartridgeLength;
+		group.shots = series->coordinates.size();
+		group.mean = group.sd = group.es = qQNaN();
+		group.groupSize = measuredGroupSize(series, groupMeasurementType->currentIndex(), groupUnits->currentIndex(), includeSightersCheckBox->isChecked());
+		session.series.append(group);
 
-		QCPItemText *aboveAnnotation = new QCPItemText(customPlot);
-		aboveAnnotation->setText(aboveAnnotationText.join('\n'));
-		aboveAnnotation->setFont(QFont("DejaVu Sans", scaleFontSize(9)));
-		aboveAnnotation->setColor(QColor("#4d4d4d"));
-		aboveAnnotation->position->setType(QCPItemPosition::ptAbsolute);
-		if ( xAxisSpacing->currentIndex() == CONSTANT )
+		qint64 time = ShotArchive::timestamp(series->firstDate, series->firstTime);
+
+		// coordinates_sighters holds the record shots too, so only the sighters are taken from it
+		QList<QPair<double, double> > sighterShots = ShotPattern::sightersOnly(series->coordinates_sighters, series->coordinates);
+
+		for ( int sighters = 0; sighters <= 1; sighters++ )
 		{
-			aboveAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(i), customPlot->yAxis->coordToPixel(yCoord) - 10);
+			const QList<QPair<double, double> > &coordinates = sighters ? sighterShots : series->coordinates;
+			for ( int j = 0; j < coordinates.size(); j++ )
+			{
+				ShotArchive::Shot shot;
+				shot.velocity = qQNaN();
+				shot.x = coordinates.at(j).first;
+				shot.y = coordinates.at(j).second;
+				shot.value = series->cartridgeLength;
+				shot.time = time;
+				shot.device = DEVICE_SHOTMARKER;
+				shot.sighter = sighters;
+				shots.append(shot);
+			}
 		}
-		else
+	}
+
+	History::record(session);
+	ShotArchive::append(ARCHIVE_SEATING_DEPTH, ShotArchive::sessionKey(session.fingerprint), shots);
+}
+
+void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
+{
+	qDebug() << "renderGraph displayGraphPreview =" << displayGraphPreview;
+
+	// Skip rebuilding the plot if nothing that goes into it has changed since the last time
+	if ( renderKey() == plottedKey )
+	{
+		qDebug() << "Plot is already up to date";
+	}
+	else
+	{
+		if ( ! populatePlot() )
 		{
-			aboveAnnotation->position->setCoords(customPlot->xAxis->coordToPixel(xPoints.at(i)), customPlot->yAxis->coordToPixel(yCoord) - 10);
+			return;
 		}
-		aboveAnnotation->setPositionAlignment(Qt::AlignHCenter | Qt::AlignBottom);
-		aboveAnnotation->setTextAlignment(Qt::AlignCenter);
-		aboveAnnotation->setBrush(QBrush(Qt::white));
-		aboveAnnotation->setClipToAxisRect(false);
-		aboveAnnotation->setLayer(customPlot->layer(5));
-		qDebug() << "max pixel coords:" << aboveAnnotation->position->pixelPosition() << "layer:" << aboveAnnotation->layer()->name() << "rect:" << customPlot->axisRect()->layer()->name();
 
-		prevSize = yCoord;
-		prevSizeSet = true;
+		recordHistory();
 	}
 
 	if ( displayGraphPreview )
 	{
 		qDebug() << "Showing graph preview";
 
-		//customPlot->show();
-		QPixmap preview = customPlot->toPixmap(1440, 625, 2.0);
-
-		if ( graphPreview )
-		{
-			graphPreview->deleteLater();
-		}
-
-		graphPreview = new GraphPreview(preview);
+		graphPreview->present();
 	}
 	else
 	{
+		// Keep an open preview in sync with what's being saved, and make sure the plot isn't left in its draft state for export
+		graphPreview->refresh();
+
 		QString fileName;
 		if ( graphTitle->text().isEmpty() )
 		{
@@ -2589,34 +3209,138 @@ void SeatingDepthTest::renderGraph ( bool displayGraphPreview )
 
 		qDebug() << "Using save path:" << path;
 
-		bool res;
+		// Images are rendered here, then compressed and written on a worker thread so the UI stays responsive
 		if ( pathExt == "png")
 		{
-			res = customPlot->savePng(path, 1440, 625, 2.0);
+			saveImageAsync(this, renderImage(), path, "PNG");
 		}
 		else if ( pathExt == "jpg" )
 		{
-			res = customPlot->saveJpg(path, 1440, 625, 2.0);
+			saveImageAsync(this, renderImage(), path, "JPG");
 		}
 		else if ( pathExt == "pdf" )
 		{
-			res = customPlot->savePdf(path, 1440, 625);
+			bool res = customPlot->savePdf(path, canvasSize.width(), canvasSize.height());
+			qDebug() << "save file res =" << res;
+
+			showSaveResult(this, path, res);
 		}
 		else
 		{
 			qDebug() << "error, shouldn't be reached";
-			res = false;
+			showSaveResult(this, path, false);
 		}
+	}
+}
 
-		qDebug() << "save file res =" << res;
+/*
+ * Hash of everything populatePlot() reads and the axis ranges it leaves. Two graphs with the same key are drawn identically.
+ */
+QByteArray SeatingDepthTest::renderKey ( void )
+{
+	QByteArray data;
+	QDataStream stream(&data, QIODevice::WriteOnly);
 
-		if ( res )
-		{
-			QMessageBox::information(this, "Save file", QString("Saved file to '%1'").arg(path), QMessageBox::Ok, QMessageBox::Ok);
-		}
-		if ( res == false )
+	// Tabs share the render cache, so keep their keys apart
+	stream << QString("seating");
+
+	for ( int i = 0; i < seatingSeriesData.size(); i++ )
+	{
+		SeatingSeries *series = seatingSeriesData.at(i);
+		if ( (! series->deleted) && series->enabled )
 		{
-			QMessageBox::warning(this, "Save file", QString("Unable to save file to '%1'\n\nPlease choose a different path").arg(path), QMessageBox::Ok, QMessageBox::Ok);
+			stream << series->name << series->cartridgeLength << series->targetDistance;
+			stream << series->coordinates << series->coordinates_sighters;
+
+			// Manually entered groups only have a size
+			if ( series->manual )
+			{
+				stream << series->groupSize;
+			}
 		}
 	}
+
+	stream << cartridgeMeasurementType->currentIndex() << cartridgeUnits->currentIndex();
+	stream << groupMeasurementType->currentIndex() << groupUnits->currentIndex() << xAxisSpacing->currentIndex();
+	stream << groupSizeCheckBox->isChecked() << groupSizeLocation->currentIndex();
+	stream << gsdCheckBox->isChecked() << gsdLocation->currentIndex();
+	stream << trendCheckBox->isChecked() << trendLineType->currentIndex();
+	stream << ellipseCheckBox->isChecked() << includeSightersCheckBox->isChecked() << patternCheckBox->isChecked();
+	stream << graphTitle->text() << rifle->text() << projectile->text() << propellant->text() << brass->text() << primer->text() << weather->text() << distance->text();
+
+	// Dragging or zooming the preview moves the axes away from where populatePlot() put them. Keying on the ranges means a moved
+	// view is never skipped as up to date or matched to a cached export of the untouched graph.
+	stream << customPlot->xAxis->range().lower << customPlot->xAxis->range().upper;
+	stream << customPlot->yAxis->range().lower << customPlot->yAxis->range().upper;
+
+	return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+/*
+ * The graph built by populatePlot() at export resolution, reusing an earlier render of the same graph if there is one
+ */
+QImage SeatingDepthTest::renderImage ( void )
+{
+	QByteArray key = renderKey();
+
+	QImage image = RenderCache::find(key);
+	if ( image.isNull() )
+	{
+		image = customPlot->toImage(canvasSize.width(), canvasSize.height(), 2.0);
+		RenderCache::insert(key, image);
+	}
+
+	return image;
+}
+
+/*
+ * Draws the graph built by populatePlot() into a painter that's already set up, at the same size it's exported at
+ */
+void SeatingDepthTest::paintGraph ( QCPPainter *painter )
+{
+	customPlot->toPainter(painter, canvasSize.width(), canvasSize.height());
+
+	// toPainter() only restores the viewport, so lay the plot back out for an open preview
+	LabelLayout::layoutAt(customPlot, customPlot->viewport().size());
+}
+
+/*
+ * The load details filled in on this tab, labeled as they are in the form
+ */
+QList<QPair<QString, QString> > SeatingDepthTest::reportDetails ( void )
+{
+	QList<QPair<QString, QString> > details;
+	details << qMakePair(QString("Rifle"), rifle->text());
+	details << qMakePair(QString("Projectile"), projectile->text());
+	details << qMakePair(QString("Propellant"), propellant->text());
+	details << qMakePair(QString("Brass"), brass->text());
+	details << qMakePair(QString("Primer"), primer->text());
+	details << qMakePair(QString("Weather"), weather->text());
+	details << qMakePair(QString("Distance"), distance->text());
+
+	return details;
+}
+
+/*
+ * Group size of each series in the last graph built by populatePlot(), with a header row first
+ */
+QList<QStringList> SeatingDepthTest::seriesTable ( void )
+{
+	QList<QStringList> table;
+	table << (QStringList() << "Series" << customPlot->xAxis->label() << "Shots" << customPlot->yAxis->label());
+
+	for ( int i = 0; i < graphedSeries.size(); i++ )
+	{
+		SeatingSeries *series = graphedSeries.at(i);
+
+		QStringList row;
+		row << series->name;
+		row << QString::number(series->cartridgeLength);
+		// Manually entered groups only have a size
+		row << (series->manual ? QString("-") : QString::number(series->coordinates.size()));
+		row << QString::number(graphedY.at(i), 'f', 3);
+		table << row;
+	}
+
+	return table;
 }
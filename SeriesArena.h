@@ -0,0 +1,63 @@
+#ifndef SERIESARENA_H
+#define SERIESARENA_H
+
+#include <QList>
+#include <QAtomicInt>
+#include <QDebug>
+
+/*
+ * Owns every series a tab has loaded since its data was last cleared. Series are adopted as they're parsed and freed together
+ * when the user loads new data, so nothing a session allocated outlives it no matter how the series list was reshuffled in
+ * between (round-robin conversion, deleted rows, rejected imports). live() counts series adopted and not yet freed across every
+ * arena of a type, which is the number to watch if memory keeps growing over a long session.
+ */
+
+template <typename T>
+class SeriesArena
+{
+	public:
+		SeriesArena() {};
+		~SeriesArena() { clear(); };
+
+		T *adopt ( T *item )
+		{
+			items.append(item);
+			liveCount.fetchAndAddRelaxed(1);
+			return item;
+		};
+
+		void adopt ( const QList<T *> &list )
+		{
+			for ( int i = 0; i < list.size(); i++ )
+			{
+				adopt(list.at(i));
+			}
+		};
+
+		void clear ( void )
+		{
+			if ( items.isEmpty() )
+			{
+				return;
+			}
+
+			int freed = items.size();
+			qDeleteAll(items);
+			items.clear();
+			liveCount.fetchAndAddRelaxed(-freed);
+
+			qDebug() << "Freed" << freed << "series," << live() << "still live";
+		};
+
+		int size ( void ) const { return items.size(); };
+		static int live ( void ) { return liveCount.load(); };
+
+	private:
+		Q_DISABLE_COPY(SeriesArena)
+		QList<T *> items;
+		static QAtomicInt liveCount;
+};
+
+template <typename T> QAtomicInt SeriesArena<T>::liveCount(0);
+
+#endif // SERIESARENA_H
@@ -0,0 +1,584 @@
+#include <cstring>
+#include <cstddef>
+#include <limits>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QDateTime>
+#include <QStringList>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QThreadPool>
+#include <QCoreApplication>
+#include <QtConcurrent>
+
+#include "ShotArchive.h"
+
+// Bump when the block layout changes. Older archives are then left alone and a new file is started.
+#define ARCHIVE_VERSION 1
+
+static const char archiveMagic[8] = { 'C', 'h', 'r', 'o', 'n', 'o', 'S', 'A' };
+
+// Magic, version, byte order mark and padding, keeping every block 8-byte aligned
+#define FILE_HEADER_SIZE 24
+
+// Written in native byte order, so an archive from a machine of the other endianness reads back swapped
+#define BYTE_ORDER_MARK 0x01020304
+
+// Starts every block, so a write cut short at the end of the file is recognized and cut off
+#define BLOCK_MAGIC 0x4b4c4253
+
+// Most shots in one block. Sessions with more than this are split, each block keeping its own ranges.
+#define BLOCK_ROWS 4096
+
+// The file is rewritten without superseded blocks once they take up at least this much, and more than the live ones do
+#define COMPACT_THRESHOLD (1024 * 1024)
+
+struct BlockHeader
+{
+	quint64 session;
+	double minValue;
+	double maxValue;
+	double minVelocity; // NaN if no shot in the block has a velocity
+	double maxVelocity;
+	qint64 minTime;
+	qint64 maxTime;
+	quint32 magic;
+	quint32 rows;
+	quint32 sequence; // counts up with every append, the latest for a session is the one scans use
+	quint8 test;
+	quint8 reserved[3];
+};
+
+Q_STATIC_ASSERT(sizeof(BlockHeader) == 72);
+
+/*
+ * Columns follow the header in this order: velocity, x, y and value as doubles, time as qint64, then device and flags as a byte
+ * each, padded out to a multiple of 8 bytes
+ */
+#define ROW_SIZE (5 * 8 + 2)
+#define FLAG_SIGHTER 0x01
+
+static qint64 blockSize ( quint32 rows )
+{
+	return (sizeof(BlockHeader) + (qint64)rows * ROW_SIZE + 7) & ~(qint64)7;
+}
+
+static QString archivePath ( void )
+{
+	QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+	QDir().mkpath(dir);
+	return QDir(dir).filePath(QString("shots-v%1.archive").arg(ARCHIVE_VERSION));
+}
+
+/*
+ * Offsets of every complete block in the file, and where the last one ends. Anything after that is a torn write.
+ */
+static QList<qint64> readBlocks ( const uchar *base, qint64 size, qint64 *end )
+{
+	QList<qint64> offsets;
+
+	qint64 offset = FILE_HEADER_SIZE;
+	while ( offset + (qint64)sizeof(BlockHeader) <= size )
+	{
+		BlockHeader header;
+		memcpy(&header, base + offset, sizeof(header));
+
+		if ( (header.magic != BLOCK_MAGIC) || (offset + blockSize(header.rows) > size) )
+		{
+			qDebug() << "Shot archive ends in an incomplete block at" << offset;
+			break;
+		}
+
+		offsets.append(offset);
+		offset += blockSize(header.rows);
+	}
+
+	*end = qMin(offset, size);
+
+	return offsets;
+}
+
+static bool validHeader ( const uchar *base, qint64 size )
+{
+	if ( (size < FILE_HEADER_SIZE) || (memcmp(base, archiveMagic, sizeof(archiveMagic)) != 0) )
+	{
+		return false;
+	}
+
+	quint32 byteOrderMark;
+	memcpy(&byteOrderMark, base + 12, sizeof(byteOrderMark));
+
+	return (byteOrderMark == BYTE_ORDER_MARK);
+}
+
+static void widen ( double value, double *low, double *high )
+{
+	if ( qIsNaN(value) )
+	{
+		return;
+	}
+
+	if ( qIsNaN(*low) || (value < *low) )
+	{
+		*low = value;
+	}
+	if ( qIsNaN(*high) || (value > *high) )
+	{
+		*high = value;
+	}
+}
+
+static QByteArray encodeBlock ( int test, quint64 session, quint32 sequence, const ShotArchive::Shot *shots, int rows )
+{
+	BlockHeader header;
+	memset(&header, 0, sizeof(header));
+	header.session = session;
+	header.magic = BLOCK_MAGIC;
+	header.rows = rows;
+	header.sequence = sequence;
+	header.test = test;
+	header.minValue = header.maxValue = header.minVelocity = header.maxVelocity = qQNaN();
+	header.minTime = std::numeric_limits<qint64>::max();
+	header.maxTime = std::numeric_limits<qint64>::min();
+
+	QByteArray block(blockSize(rows), '\0');
+	char *columns = block.data() + sizeof(header);
+
+	double *velocities = (double *)columns;
+	double *xs = velocities + rows;
+	double *ys = xs + rows;
+	double *values = ys + rows;
+	qint64 *times = (qint64 *)(values + rows);
+	quint8 *devices = (quint8 *)(times + rows);
+	quint8 *flags = devices + rows;
+
+	for ( int i = 0; i < rows; i++ )
+	{
+		const ShotArchive::Shot &shot = shots[i];
+
+		velocities[i] = shot.velocity;
+		xs[i] = shot.x;
+		ys[i] = shot.y;
+		values[i] = shot.value;
+		times[i] = shot.time;
+		devices[i] = shot.device;
+		flags[i] = shot.sighter ? FLAG_SIGHTER : 0;
+
+		widen(shot.value, &header.minValue, &header.maxValue);
+		widen(shot.velocity, &header.minVelocity, &header.maxVelocity);
+		header.minTime = qMin(header.minTime, shot.time);
+		header.maxTime = qMax(header.maxTime, shot.time);
+	}
+
+	memcpy(block.data(), &header, sizeof(header));
+
+	return block;
+}
+
+static QByteArray fileHeader ( void )
+{
+	QByteArray header(FILE_HEADER_SIZE, '\0');
+	quint32 version = ARCHIVE_VERSION;
+	quint32 byteOrderMark = BYTE_ORDER_MARK;
+	memcpy(header.data(), archiveMagic, sizeof(archiveMagic));
+	memcpy(header.data() + 8, &version, sizeof(version));
+	memcpy(header.data() + 12, &byteOrderMark, sizeof(byteOrderMark));
+	return header;
+}
+
+/*
+ * Appends happen one at a time, in the order they were made, off the GUI thread
+ */
+static QThreadPool *writer ( void )
+{
+	static QThreadPool *pool = NULL;
+
+	if ( pool == NULL )
+	{
+		pool = new QThreadPool(qApp);
+		pool->setMaxThreadCount(1);
+
+		// Don't lose an append that's still queued when the app exits
+		QObject::connect(qApp, &QCoreApplication::aboutToQuit, [] ( void ) { pool->waitForDone(); });
+	}
+
+	return pool;
+}
+
+/*
+ * Rewrites the archive with only the latest copy of each session, keeping blocks in the order they were appended
+ */
+static bool compact ( void )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	QFile file(archivePath());
+	if ( ! file.open(QIODevice::ReadOnly) )
+	{
+		return false;
+	}
+
+	const uchar *base = file.map(0, file.size());
+	if ( (base == NULL) || (! validHeader(base, file.size())) )
+	{
+		return false;
+	}
+
+	qint64 end;
+	QList<qint64> offsets = readBlocks(base, file.size(), &end);
+
+	QHash<quint64, quint32> latest;
+	for ( int i = 0; i < offsets.size(); i++ )
+	{
+		BlockHeader header;
+		memcpy(&header, base + offsets.at(i), sizeof(header));
+		latest.insert(header.session, header.sequence);
+	}
+
+	QSaveFile out(archivePath());
+	if ( ! out.open(QIODevice::WriteOnly) )
+	{
+		qDebug() << "Unable to compact shot archive:" << out.errorString();
+		return false;
+	}
+
+	out.write(fileHeader());
+
+	int kept = 0;
+	for ( int i = 0; i < offsets.size(); i++ )
+	{
+		BlockHeader header;
+		memcpy(&header, base + offsets.at(i), sizeof(header));
+
+		if ( latest.value(header.session) == header.sequence )
+		{
+			out.write((const char *)base + offsets.at(i), blockSize(header.rows));
+			kept++;
+		}
+	}
+
+	// The old file has to be let go of before it can be replaced
+	file.unmap((uchar *)base);
+	file.close();
+
+	bool res = out.commit();
+
+	qDebug() << "Compacted shot archive from" << offsets.size() << "to" << kept << "blocks in" << timer.elapsed() << "ms, res =" << res;
+
+	return res;
+}
+
+ShotArchive::Range::Range ( void )
+	: minValue(-std::numeric_limits<double>::infinity()), maxValue(std::numeric_limits<double>::infinity()),
+	  minVelocity(-std::numeric_limits<double>::infinity()), maxVelocity(std::numeric_limits<double>::infinity()),
+	  from(std::numeric_limits<qint64>::min()), to(std::numeric_limits<qint64>::max()), test(-1)
+{
+}
+
+/*
+ * Appends a session's shots, replacing whatever was archived for the same session before. Runs on the writer.
+ */
+static bool writeShots ( int test, quint64 session, const QVector<ShotArchive::Shot> &shots )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	// Sequence numbers are filled in once the file's been read
+	QList<QByteArray> blocks;
+	for ( int first = 0; first < shots.size(); first += BLOCK_ROWS )
+	{
+		blocks.append(encodeBlock(test, session, 0, shots.constData() + first, qMin(BLOCK_ROWS, shots.size() - first)));
+	}
+
+	QFile file(archivePath());
+	if ( ! file.open(QIODevice::ReadWrite) )
+	{
+		qDebug() << "Unable to open shot archive:" << file.errorString();
+		return false;
+	}
+
+	/* Pick up after the last complete block, cutting off anything a crash left behind */
+
+	quint32 sequence = 0;
+	qint64 end = FILE_HEADER_SIZE;
+	qint64 superseded = 0; // bytes of blocks no scan uses any more, counting the ones this append replaces
+
+	if ( file.size() == 0 )
+	{
+		file.write(fileHeader());
+	}
+	else
+	{
+		const uchar *base = file.map(0, file.size());
+		if ( (base == NULL) || (! validHeader(base, file.size())) )
+		{
+			qDebug() << "Shot archive" << file.fileName() << "isn't readable, leaving it alone";
+			return false;
+		}
+
+		QList<qint64> offsets = readBlocks(base, file.size(), &end);
+
+		// Sequence numbers count up through the file, so the session's latest copy is the last run of its blocks
+		QHash<quint64, quint32> latest;
+		QList<qint64> previous;
+		quint32 previousSequence = 0;
+		for ( int i = 0; i < offsets.size(); i++ )
+		{
+			BlockHeader header;
+			memcpy(&header, base + offsets.at(i), sizeof(header));
+			latest.insert(header.session, header.sequence);
+			sequence = header.sequence + 1;
+
+			if ( header.session == session )
+			{
+				if ( previous.isEmpty() || (header.sequence != previousSequence) )
+				{
+					previous.clear();
+					previousSequence = header.sequence;
+				}
+				previous.append(offsets.at(i));
+			}
+		}
+
+		/* Archiving the same shots again would only add a copy, so leave the file alone if the latest copy matches */
+
+		bool unchanged = (previous.size() == blocks.size());
+		for ( int i = 0; unchanged && (i < previous.size()); i++ )
+		{
+			BlockHeader header;
+			memcpy(&header, base + previous.at(i), sizeof(header));
+
+			const QByteArray &block = blocks.at(i);
+			unchanged = (header.test == test) && (blockSize(header.rows) == block.size()) &&
+			            (memcmp(base + previous.at(i) + sizeof(header), block.constData() + sizeof(header), block.size() - sizeof(header)) == 0);
+		}
+
+		if ( ! unchanged )
+		{
+			for ( int i = 0; i < offsets.size(); i++ )
+			{
+				BlockHeader header;
+				memcpy(&header, base + offsets.at(i), sizeof(header));
+				if ( (latest.value(header.session) != header.sequence) || (header.session == session) )
+				{
+					superseded += blockSize(header.rows);
+				}
+			}
+		}
+
+		file.unmap((uchar *)base);
+
+		if ( end < file.size() )
+		{
+			file.resize(end);
+		}
+
+		if ( unchanged )
+		{
+			qDebug() << "Session's shots are already archived";
+			return true;
+		}
+	}
+
+	file.seek(end);
+
+	for ( int i = 0; i < blocks.size(); i++ )
+	{
+		memcpy(blocks[i].data() + offsetof(BlockHeader, sequence), &sequence, sizeof(sequence));
+
+		if ( file.write(blocks.at(i)) != blocks.at(i).size() )
+		{
+			qDebug() << "Unable to write to shot archive:" << file.errorString();
+			file.resize(end);
+			return false;
+		}
+	}
+
+	qint64 live = file.size() - FILE_HEADER_SIZE - superseded;
+	file.close();
+
+	qDebug() << "Archived" << shots.size() << "shots in" << blocks.size() << "blocks in" << timer.elapsed() << "ms," << superseded << "bytes superseded";
+
+	if ( (superseded >= COMPACT_THRESHOLD) && (superseded > live) )
+	{
+		compact();
+	}
+
+	return true;
+}
+
+/*
+ * Queues a session's shots to be appended. The archive is a convenience, so failures are only logged.
+ */
+void ShotArchive::append ( int test, quint64 session, const QVector<Shot> &shots )
+{
+	if ( shots.isEmpty() )
+	{
+		return;
+	}
+
+	QtConcurrent::run(writer(), writeShots, test, session, shots);
+}
+
+/*
+ * Every shot in the range, in the order they were archived
+ */
+QVector<ShotArchive::Shot> ShotArchive::scan ( const Range &range )
+{
+	QVector<Shot> shots;
+
+	// Let queued appends land first, so the scan sees everything archived before it
+	writer()->waitForDone();
+
+	QFile file(archivePath());
+	if ( ! file.open(QIODevice::ReadOnly) )
+	{
+		return shots;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	qint64 size = file.size();
+
+	// Fall back on reading the whole file where it can't be mapped
+	QByteArray contents;
+	const uchar *base = file.map(0, size);
+	if ( base == NULL )
+	{
+		qDebug() << "Unable to map shot archive, reading it instead:" << file.errorString();
+		contents = file.readAll();
+		base = (const uchar *)contents.constData();
+	}
+
+	if ( ! validHeader(base, size) )
+	{
+		qDebug() << "Shot archive" << file.fileName() << "isn't readable";
+		return shots;
+	}
+
+	qint64 end;
+	QList<qint64> offsets = readBlocks(base, size, &end);
+
+	/* Only the latest append of each session counts */
+
+	QHash<quint64, quint32> latest;
+	for ( int i = 0; i < offsets.size(); i++ )
+	{
+		BlockHeader header;
+		memcpy(&header, base + offsets.at(i), sizeof(header));
+		latest.insert(header.session, header.sequence);
+	}
+
+	bool velocityBound = (range.minVelocity > -std::numeric_limits<double>::infinity()) || (range.maxVelocity < std::numeric_limits<double>::infinity());
+
+	int blocksRead = 0;
+	for ( int i = 0; i < offsets.size(); i++ )
+	{
+		BlockHeader header;
+		memcpy(&header, base + offsets.at(i), sizeof(header));
+
+		/* Skip the block on its header alone wherever possible */
+
+		if ( latest.value(header.session) != header.sequence )
+		{
+			continue;
+		}
+		if ( ((range.test >= 0) && (header.test != range.test)) || ((! range.sessions.isEmpty()) && (! range.sessions.contains(header.session))) )
+		{
+			continue;
+		}
+		if ( (header.maxTime < range.from) || (header.minTime > range.to) )
+		{
+			continue;
+		}
+		if ( qIsNaN(header.minValue) || (header.maxValue < range.minValue) || (header.minValue > range.maxValue) )
+		{
+			continue;
+		}
+		if ( velocityBound && (qIsNaN(header.minVelocity) || (header.maxVelocity < range.minVelocity) || (header.minVelocity > range.maxVelocity)) )
+		{
+			continue;
+		}
+
+		blocksRead++;
+
+		quint32 rows = header.rows;
+		const uchar *columns = base + offsets.at(i) + sizeof(header);
+		const uchar *velocities = columns;
+		const uchar *xs = velocities + rows * 8;
+		const uchar *ys = xs + rows * 8;
+		const uchar *values = ys + rows * 8;
+		const uchar *times = values + rows * 8;
+		const uchar *devices = times + rows * 8;
+		const uchar *flags = devices + rows;
+
+		for ( quint32 row = 0; row < rows; row++ )
+		{
+			Shot shot;
+			memcpy(&shot.value, values + row * 8, 8);
+			memcpy(&shot.time, times + row * 8, 8);
+			memcpy(&shot.velocity, velocities + row * 8, 8);
+
+			if ( (shot.value < range.minValue) || (shot.value > range.maxValue) || (shot.time < range.from) || (shot.time > range.to) )
+			{
+				continue;
+			}
+			if ( velocityBound && (! ((shot.velocity >= range.minVelocity) && (shot.velocity <= range.maxVelocity))) )
+			{
+				continue;
+			}
+
+			memcpy(&shot.x, xs + row * 8, 8);
+			memcpy(&shot.y, ys + row * 8, 8);
+			shot.device = devices[row];
+			shot.sighter = (flags[row] & FLAG_SIGHTER);
+			shot.test = header.test;
+			shot.session = header.session;
+			shots.append(shot);
+		}
+	}
+
+	qDebug() << "Shot archive scan read" << blocksRead << "of" << offsets.size() << "blocks and matched" << shots.size() << "shots in" << timer.elapsed() << "ms";
+
+	return shots;
+}
+
+/*
+ * Sessions are keyed by the start of the same fingerprint the load history uses, so the two can be matched up
+ */
+quint64 ShotArchive::sessionKey ( const QByteArray &fingerprint )
+{
+	quint64 key = 0;
+	memcpy(&key, fingerprint.constData(), qMin((int)sizeof(key), fingerprint.size()));
+	return key;
+}
+
+/*
+ * When a series was shot, from whichever date and time format its chronograph wrote. Series without a usable date count as
+ * shot at the start of today, so archiving them again later the same day still finds the same shots.
+ */
+qint64 ShotArchive::timestamp ( const QString &date, const QString &time )
+{
+	QString text = QString("%1 %2").arg(date).arg(time).trimmed();
+
+	QDateTime dateTime = QDateTime::fromString(text, Qt::TextDate);
+
+	QStringList formats;
+	formats << "MM-dd-yyyy hh:mm:ss" << "yyyy-MM-dd hh:mm:ss" << "MM/dd/yyyy hh:mm:ss" << "MMM d, yyyy h:mm AP" << "yyyy-MM-dd";
+	for ( int i = 0; (! dateTime.isValid()) && (i < formats.size()); i++ )
+	{
+		dateTime = QDateTime::fromString(text, formats.at(i));
+	}
+
+	if ( ! dateTime.isValid() )
+	{
+		return QDateTime(QDate::currentDate(), QTime(0, 0)).toMSecsSinceEpoch();
+	}
+
+	return dateTime.toMSecsSinceEpoch();
+}
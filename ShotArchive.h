@@ -0,0 +1,67 @@
+#ifndef SHOTARCHIVE_H
+#define SHOTARCHIVE_H
+
+#include <QVector>
+#include <QSet>
+#include <QString>
+#include <QByteArray>
+
+/*
+ * Every shot that gets graphed, appended to one column-oriented file in the user's app data directory. Shots are written in
+ * blocks, each holding one session's shots column by column behind a header with the session and the min/max of the charge,
+ * velocity and time columns. Scans memory-map the file and read only the headers until a block's ranges overlap what's asked
+ * for, so a narrow scan touches a handful of blocks no matter how big the archive gets.
+ *
+ * Blocks are only ever appended, on a background thread. Archiving a session again, with new charges say, appends a new copy
+ * that takes the place of the earlier one in every later scan, unless the shots are the same as the latest copy's. Once
+ * superseded copies take up more room than the live ones, the file is rewritten without them.
+ */
+
+#define ARCHIVE_POWDER 0
+#define ARCHIVE_SEATING_DEPTH 1
+#define ARCHIVE_TUNER 2
+
+#define DEVICE_UNKNOWN 0
+#define DEVICE_LABRADAR 1
+#define DEVICE_MAGNETOSPEED 2
+#define DEVICE_PROCHRONO 3
+#define DEVICE_GARMIN 4
+#define DEVICE_SHOTMARKER 5
+#define DEVICE_MANUAL 6
+
+namespace ShotArchive
+{
+	struct Shot
+	{
+		double velocity; // NaN for shots with only a position
+		double x; // in inches, NaN for shots with only a velocity
+		double y;
+		double value; // charge weight, cartridge length or tuner setting, depending on the test
+		qint64 time; // milliseconds since the epoch, UTC
+		quint8 device;
+		bool sighter;
+		int test;
+		quint64 session;
+	};
+
+	// Infinite bounds, a negative test and no sessions match everything
+	struct Range
+	{
+		Range ( void );
+		double minValue;
+		double maxValue;
+		double minVelocity;
+		double maxVelocity;
+		qint64 from;
+		qint64 to;
+		int test;
+		QSet<quint64> sessions;
+	};
+
+	void append ( int, quint64, const QVector<Shot> & );
+	QVector<Shot> scan ( const Range & );
+	quint64 sessionKey ( const QByteArray & );
+	qint64 timestamp ( const QString &, const QString & );
+};
+
+#endif // SHOTARCHIVE_H
@@ -0,0 +1,284 @@
+#include <QDebug>
+#include <QtMath>
+
+#include "ChronoPlotter.h"
+#include "ShotPattern.h"
+#include "LabelLayout.h"
+
+// Height the overlay's width is worked out for. Cells come out roughly square at the usual graph heights.
+#define PANEL_HEIGHT 450
+
+// Share of a cell's shorter side taken up by the widest group
+#define PATTERN_FILL 0.7
+
+using namespace ShotPattern;
+
+/*
+ * Record shots appear in the sighter-inclusive list in the same order as in the record list, so walking both together picks
+ * out the sighters
+ */
+QList<QPair<double, double> > ShotPattern::sightersOnly ( const QList<QPair<double, double> > &all, const QList<QPair<double, double> > &record )
+{
+	QList<QPair<double, double> > sighters;
+
+	int next = 0;
+	for ( int i = 0; i < all.size(); i++ )
+	{
+		if ( (next < record.size()) && (all.at(i) == record.at(next)) )
+		{
+			next++;
+		}
+		else
+		{
+			sighters.append(all.at(i));
+		}
+	}
+
+	return sighters;
+}
+
+Overlay::Overlay ( QCustomPlot *plot ) : QObject(plot), plot(plot), columns(0), rows(0)
+{
+	/* Move the main axis rect into a row of its own so the overlay can sit beside it, under the title and subtitle */
+
+	QCPAxisRect *mainRect = plot->axisRect();
+	QCPLayoutGrid *plotLayout = plot->plotLayout();
+
+	int mainRow = 0;
+	for ( int i = 0; i < plotLayout->rowCount(); i++ )
+	{
+		if ( plotLayout->element(i, 0) == mainRect )
+		{
+			mainRow = i;
+		}
+	}
+
+	plotLayout->take(mainRect);
+	row = new QCPLayoutGrid();
+	plotLayout->addElement(mainRow, 0, row);
+	row->addElement(0, 0, mainRect);
+
+	axisRect = new QCPAxisRect(plot);
+	axisRect->setRangeDrag(Qt::Orientations());
+	axisRect->setRangeZoom(Qt::Orientations());
+	axisRect->setVisible(false);
+
+	// Keep the overlay's cells level with the graph
+	QCPMarginGroup *marginGroup = new QCPMarginGroup(plot);
+	mainRect->setMarginGroup(QCP::msTop | QCP::msBottom, marginGroup);
+	axisRect->setMarginGroup(QCP::msTop | QCP::msBottom, marginGroup);
+
+	/* Cell borders are the grid lines at every whole coordinate */
+
+	QPen gridPen(Qt::SolidLine);
+	gridPen.setColor("#d9d9d9");
+
+	QPen axisBasePen(Qt::SolidLine);
+	axisBasePen.setColor("#d9d9d9");
+	axisBasePen.setWidth(2);
+
+	QSharedPointer<QCPAxisTickerFixed> cellTicker(new QCPAxisTickerFixed);
+	cellTicker->setTickStep(1);
+	cellTicker->setScaleStrategy(QCPAxisTickerFixed::ssNone);
+
+	QList<QCPAxis *> axes = axisRect->axes();
+	for ( int i = 0; i < axes.size(); i++ )
+	{
+		QCPAxis *axis = axes.at(i);
+		axis->setVisible(true);
+		axis->setTicker(cellTicker);
+		axis->setTickLabels(false);
+		axis->setTickPen(Qt::NoPen);
+		axis->setSubTickPen(Qt::NoPen);
+		axis->setBasePen(axisBasePen);
+		axis->grid()->setZeroLinePen(Qt::NoPen);
+		axis->grid()->setPen(gridPen);
+	}
+
+	// Rows count down from the top
+	axisRect->axis(QCPAxis::atLeft)->setRangeReversed(true);
+	axisRect->axis(QCPAxis::atRight)->setRangeReversed(true);
+
+	/* Every shot of every group goes into one of two graphs, so the shared scatter styles are only set up once */
+
+	shotGraph = plot->addGraph(axisRect->axis(QCPAxis::atBottom), axisRect->axis(QCPAxis::atLeft));
+	shotGraph->setLineStyle(QCPGraph::lsNone);
+	shotGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, QColor("#0536b0"), 4.0));
+	shotGraph->setLayer("scatter");
+	shotGraph->setVisible(false);
+
+	sighterGraph = plot->addGraph(axisRect->axis(QCPAxis::atBottom), axisRect->axis(QCPAxis::atLeft));
+	sighterGraph->setLineStyle(QCPGraph::lsNone);
+	sighterGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QColor("#878787"), 4.0));
+	sighterGraph->setLayer("scatter");
+	sighterGraph->setVisible(false);
+}
+
+/*
+ * Shows the overlay for the given groups, or hides it if there are none with shots. The overlay's width is fixed here so the
+ * graph's canvas size can account for it, the shots themselves are placed by layout() once that size is known.
+ */
+void Overlay::setGroups ( const QList<Group> &newGroups )
+{
+	groups.clear();
+	for ( int i = 0; i < newGroups.size(); i++ )
+	{
+		if ( (! newGroups.at(i).shots.isEmpty()) || (! newGroups.at(i).sighters.isEmpty()) )
+		{
+			groups.append(newGroups.at(i));
+		}
+	}
+
+	bool shown = (! groups.isEmpty());
+
+	if ( shown )
+	{
+		rows = qCeil(sqrt(groups.size()));
+		columns = qCeil(groups.size() / (double)rows);
+
+		int width = qCeil(columns * PANEL_HEIGHT / (double)rows);
+		axisRect->setMinimumSize(width, 0);
+		axisRect->setMaximumSize(width, QWIDGETSIZE_MAX);
+
+		axisRect->axis(QCPAxis::atBottom)->setRange(0, columns);
+		axisRect->axis(QCPAxis::atTop)->setRange(0, columns);
+		axisRect->axis(QCPAxis::atLeft)->setRange(0, rows);
+		axisRect->axis(QCPAxis::atRight)->setRange(0, rows);
+
+		if ( ! row->hasElement(0, 1) )
+		{
+			row->addElement(0, 1, axisRect);
+		}
+	}
+	else if ( row->hasElement(0, 1) )
+	{
+		row->take(axisRect);
+		row->simplify();
+	}
+
+	axisRect->setVisible(shown);
+	shotGraph->setVisible(shown);
+	sighterGraph->setVisible(shown);
+
+	if ( ! shown )
+	{
+		shotGraph->data()->clear();
+		sighterGraph->data()->clear();
+
+		for ( int i = 0; i < labels.size(); i++ )
+		{
+			labels.at(i)->setVisible(false);
+		}
+	}
+}
+
+/*
+ * Transform every shot into grid coordinates for a graph exported at the given size. Groups are centered on their mean record
+ * shot and share one scale, so their sizes can be compared at a glance, and x and y are scaled alike in pixels so patterns
+ * aren't stretched by cells that aren't square.
+ */
+void Overlay::layout ( const QSize &size )
+{
+	if ( groups.isEmpty() )
+	{
+		return;
+	}
+
+	QRect viewport = LabelLayout::layoutAt(plot, size);
+
+	double cellWidth = axisRect->width() / (double)columns;
+	double cellHeight = axisRect->height() / (double)rows;
+
+	/* Group centers and the widest spread from a center, which sets the scale for all of them */
+
+	QList<QPair<double, double> > centers;
+	double largest = 0;
+
+	for ( int i = 0; i < groups.size(); i++ )
+	{
+		const Group &group = groups.at(i);
+		const QList<QPair<double, double> > &centerShots = group.shots.isEmpty() ? group.sighters : group.shots;
+
+		QPair<double, double> center(0, 0);
+		for ( int j = 0; j < centerShots.size(); j++ )
+		{
+			center.first += centerShots.at(j).first / centerShots.size();
+			center.second += centerShots.at(j).second / centerShots.size();
+		}
+		centers.append(center);
+
+		for ( int j = 0; j < group.shots.size(); j++ )
+		{
+			largest = qMax(largest, qMax(qAbs(group.shots.at(j).first - center.first), qAbs(group.shots.at(j).second - center.second)));
+		}
+		for ( int j = 0; j < group.sighters.size(); j++ )
+		{
+			largest = qMax(largest, qMax(qAbs(group.sighters.at(j).first - center.first), qAbs(group.sighters.at(j).second - center.second)));
+		}
+	}
+
+	// Pixels per inch
+	double scale = (largest > 0) ? (PATTERN_FILL / 2) * qMin(cellWidth, cellHeight) / largest : 0;
+
+	/* Fill the point buffers */
+
+	QVector<double> shotX, shotY, sighterX, sighterY;
+
+	QFont labelFont("DejaVu Sans", scaleFontSize(7));
+
+	for ( int i = 0; i < groups.size(); i++ )
+	{
+		const Group &group = groups.at(i);
+		int column = i % columns;
+		int cellRow = i / columns;
+		double originX = column + 0.5;
+		double originY = cellRow + 0.5;
+
+		// Target y grows upward, rows grow downward
+		for ( int j = 0; j < group.shots.size(); j++ )
+		{
+			shotX.append(originX + (group.shots.at(j).first - centers.at(i).first) * scale / cellWidth);
+			shotY.append(originY - (group.shots.at(j).second - centers.at(i).second) * scale / cellHeight);
+		}
+		for ( int j = 0; j < group.sighters.size(); j++ )
+		{
+			sighterX.append(originX + (group.sighters.at(j).first - centers.at(i).first) * scale / cellWidth);
+			sighterY.append(originY - (group.sighters.at(j).second - centers.at(i).second) * scale / cellHeight);
+		}
+
+		QCPItemText *label;
+		if ( i < labels.size() )
+		{
+			label = labels.at(i);
+		}
+		else
+		{
+			label = new QCPItemText(plot);
+			label->setLayer("annotations");
+			label->setClipAxisRect(axisRect);
+			label->setClipToAxisRect(true);
+			label->position->setAxes(axisRect->axis(QCPAxis::atBottom), axisRect->axis(QCPAxis::atLeft));
+			label->setPositionAlignment(Qt::AlignLeft | Qt::AlignTop);
+			label->setFont(labelFont);
+			label->setColor(QColor("#4d4d4d"));
+			label->setPadding(QMargins(3, 2, 3, 2));
+			labels.append(label);
+		}
+		label->position->setCoords(column, cellRow);
+		label->setText(group.label);
+		label->setVisible(true);
+	}
+
+	for ( int i = groups.size(); i < labels.size(); i++ )
+	{
+		labels.at(i)->setVisible(false);
+	}
+
+	shotGraph->setData(shotX, shotY);
+	sighterGraph->setData(sighterX, sighterY);
+
+	qDebug() << "Shot patterns:" << groups.size() << "groups in" << columns << "x" << rows << "cells," << shotX.size() << "shots," << sighterX.size() << "sighters";
+
+	// Lay the graph back out for the on-screen preview
+	LabelLayout::layoutAt(plot, viewport.size());
+}
@@ -0,0 +1,49 @@
+#ifndef SHOTPATTERN_H
+#define SHOTPATTERN_H
+
+#include <QObject>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QSize>
+
+#include "qcustomplot/qcustomplot.h"
+
+/*
+ * Small multiples of each group's shot pattern, drawn in their own axis rect to the right of the main graph. Every group gets a
+ * cell in a grid and all shots are transformed into grid coordinates up front, so the whole overlay is two scatter graphs no
+ * matter how many groups there are.
+ */
+
+namespace ShotPattern
+{
+	struct Group
+	{
+		QString label;
+		QList<QPair<double, double> > shots; // record shots, in inches
+		QList<QPair<double, double> > sighters;
+	};
+
+	QList<QPair<double, double> > sightersOnly ( const QList<QPair<double, double> > &, const QList<QPair<double, double> > & );
+
+	class Overlay : public QObject
+	{
+		public:
+			Overlay ( QCustomPlot * );
+			void setGroups ( const QList<Group> & );
+			void layout ( const QSize & );
+
+		private:
+			QCustomPlot *plot;
+			QCPLayoutGrid *row; // main axis rect in column 0, the overlay in column 1 while shown
+			QCPAxisRect *axisRect;
+			QCPGraph *shotGraph;
+			QCPGraph *sighterGraph;
+			QList<QCPItemText *> labels;
+			QList<Group> groups;
+			int columns;
+			int rows;
+	};
+};
+
+#endif // SHOTPATTERN_H
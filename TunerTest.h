@@ -18,18 +18,32 @@
 #include <QDialog>
 #include <QMainWindow>
 #include <QTextEdit>
+#include <QAbstractTableModel>
+#include <QTableView>
 
 #include "ChronoPlotter.h"
+#include "SeriesArena.h"
+#include "Dispersion.h"
+#include "ShotPattern.h"
 
 namespace Tuner
 {
+	struct ExcludedShot
+	{
+		int index; // where the shot goes back in coordinates
+		int sighterIndex; // where it goes back in coordinates_sighters, or -1
+		QPair<double, double> coordinates;
+	};
+
 	struct TunerSeries
 	{
 		bool isValid;
 		int seriesNum;
-		QLabel *name;
+		QString name;
 		QList<QPair<double, double> > coordinates;
 		QList<QPair<double, double> > coordinates_sighters;
+		QVector<quint8> outlierFlags; // Outliers:: test bits for each shot in coordinates
+		QList<ExcludedShot> excludedShots; // flagged shots taken out, most recent last
 		QList<double> extremeSpread;
 		QList<double> extremeSpread_sighters;
 		QList<double> yStdev;
@@ -40,30 +54,52 @@ namespace Tuner
 		QList<double> radialStdev_sighters;
 		QList<double> meanRadius;
 		QList<double> meanRadius_sighters;
+		QList<double> cep50;
+		QList<double> cep50_sighters;
+		QList<double> cep90;
+		QList<double> cep90_sighters;
+		Dispersion::Ellipse dispersion; // in inches
+		Dispersion::Ellipse dispersion_sighters;
 		int targetDistance; // in yards
 		QString firstDate;
 		QString firstTime;
-		QSpinBox *tunerSetting;
-		QDoubleSpinBox *groupSize;
-		QLabel *groupSizeLabel;
-		QPushButton *deleteButton;
-		QCheckBox *enabled;
+		int tunerSetting;
+		bool manual; // group size entered by hand rather than measured from shots
+		double groupSize;
+		bool enabled;
 		bool deleted;
 	};
 
+	class SeriesModel;
+
 	class TunerTest : public QWidget
 	{
 		Q_OBJECT
 
 		public:
 			TunerTest(QWidget *parent = 0);
-			~TunerTest() {};
+			~TunerTest() { delete graphPreview; };
 			QList<TunerSeries *> tunerSeriesData;
+			bool headless; // report problems through errors and warnings instead of dialogs
+			QStringList errors;
+			QStringList warnings;
+			bool populatePlot ( void );
+			QByteArray renderKey ( void );
+			QImage renderImage ( void );
+			void paintGraph ( QCPPainter * );
+			QSize graphSize ( void ) { return canvasSize; };
+			QList<QStringList> seriesTable ( void );
+			QList<QPair<QString, QString> > reportDetails ( void );
+			QVariantMap saveOptions ( void );
+			bool isManualEntry ( void );
+			TunerTest *scratchCopy ( void );
+			void restoreProject ( const QVariantMap &, const QList<TunerSeries *> &, bool );
 
 		public slots:
 			void groupSizeCheckBoxChanged(bool);
 			void gsdCheckBoxChanged(bool);
 			void trendCheckBoxChanged(bool);
+			void ellipseCheckBoxChanged(bool);
 			void importedGroupIncludeSightersCheckBoxChanged(bool);
 			void xAxisSpacingChanged(int);
 			void groupMeasurementTypeChanged(int);
@@ -73,11 +109,10 @@ namespace Tuner
 			void selectShotMarkerFile(bool);
 			void manualDataEntry(bool);
 			void addNewClicked(bool);
-			void deleteClicked(bool);
 			void autofillClicked(bool);
+			void excludeOutliersClicked(bool);
+			void restoreShotsClicked(bool);
 			void headerCheckBoxChanged(int);
-			void seriesCheckBoxChanged(int);
-			void seriesManualCheckBoxChanged(int);
 			void showGraph(bool);
 			void saveGraph(bool);
 
@@ -90,23 +125,57 @@ namespace Tuner
 			static double pairSumX ( double, const QPair<double, double> );
 			static double pairSumY ( double, const QPair<double, double> );
 			double calculateMR ( QList<QPair<double, double> > );
+			void calculateGroupSizes ( TunerSeries * );
+			void refineGroupShapes ( void );
 			QList<TunerSeries *> ExtractShotMarkerSeriesTar ( QString );
 			QList<TunerSeries *> ExtractShotMarkerSeriesCsv ( QTextStream & );
 			void optionCheckBoxChanged(QCheckBox *, QLabel *, QComboBox *);
+			QList<QPair<QString, QWidget *> > optionWidgets ( void );
+			void unloadData ( void );
+			void showManualEntry ( void );
+			void clearSeries ( void );
 			void DisplaySeriesData ( void );
+			void addSeriesButtons ( int );
+			void updateSeriesButtons ( int, int );
+			void deleteClicked ( TunerSeries * );
+			void DetectOutliers ( void );
+			void setupPlot ( void );
+			QCPItemText *annotationItem ( QList<QCPItemText *> &, QList<QCPItemTracer *> &, int );
+			void updateTrendLine ( void );
+			void updateAnnotations ( void );
+			void updateEllipses ( void );
+			void replotAnnotations ( void );
+			void replotTrendLine ( void );
+			void reportError ( const QString & );
 			void renderGraph ( bool );
+			void recordHistory ( void );
 
 		private:
 			GraphPreview *graphPreview;
+			QByteArray plottedKey; // renderKey() of what the plot currently shows
+			QSize canvasSize; // export size, worked out from the graph contents on each render
+			QCustomPlot *customPlot;
+			QCPTextElement *plotTitle;
+			QCPTextElement *plotSubtitle;
+			QCPSmoothGraph *scatterPlot;
+			QCPGraph *trendLine;
+			QList<QCPItemText *> aboveAnnotations;
+			QList<QCPItemText *> belowAnnotations;
+			QList<QCPCurve *> ellipseCurves;
+			ShotPattern::Overlay *patterns;
+			QList<QCPItemTracer *> aboveAnchors;
+			QList<QCPItemTracer *> belowAnchors;
+			SeriesArena<TunerSeries> arena; // owns every series in tunerSeriesData and graphedSeries
+			QList<TunerSeries *> graphedSeries;
+			QVector<double> graphedX;
+			QVector<double> graphedY;
 			QString prevSaveDir;
 			QString prevShotMarkerDir;
 			QStackedWidget *stackedWidget;
 			QWidget *scrollWidget;
 			QVBoxLayout *scrollLayout;
-			QScrollArea *scrollArea;
-			QGridLayout *tunerSeriesGrid;
-			QLabel *headerLengthType;
-			QLabel *headerGroupType;
+			QTableView *seriesView;
+			SeriesModel *seriesModel;
 			QLineEdit *graphTitle;
 			QLineEdit *rifle;
 			QLineEdit *projectile;
@@ -116,38 +185,62 @@ namespace Tuner
 			QLineEdit *weather;
 			QLineEdit *distance;
 			QPushButton *addNewButton;
+			QPushButton *excludeOutliersButton;
+			QPushButton *restoreShotsButton;
 			QComboBox *groupMeasurementType;
 			QComboBox *groupUnits;
 			QComboBox *xAxisSpacing;
 			QCheckBox *groupSizeCheckBox;
 			QCheckBox *gsdCheckBox;
 			QCheckBox *trendCheckBox;
+			QCheckBox *ellipseCheckBox;
 			QCheckBox *includeSightersCheckBox;
+			QCheckBox *patternCheckBox;
 			QComboBox *groupSizeLocation;
 			QComboBox *gsdLocation;
 			QComboBox *trendLineType;
 			QLabel *groupSizeLabel;
 			QLabel *gsdLabel;
 			QLabel *trendLabel;
+			QLabel *ellipseLabel;
 			QLabel *includeSightersLabel;
+			QLabel *patternLabel;
 	};
 
-	class QCPSmoothGraph : public QCPGraph
+	/*
+	 * The loaded groups as a table, read straight out of the tab's tunerSeriesData so the view only touches the rows it has
+	 * on screen. Measured group sizes are shown in whichever type and units are selected. Manually entered groups get an
+	 * editable group size and a column for their delete buttons instead.
+	 */
+	class SeriesModel : public QAbstractTableModel
 	{
 		Q_OBJECT
 
 		public:
-			QCPSmoothGraph(QCPAxis *x, QCPAxis *y) : QCPGraph(x, y) {};
-			~QCPSmoothGraph() {};
-			//void drawLinePlot(QCPPainter *, const QVector<QPointF>&);
-			void drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines) const;
-			void setSmooth(bool smooth) {
-				mSmooth = smooth;
-			}
+			enum Column { ENABLED_COLUMN, NAME_COLUMN, SETTING_COLUMN, GROUP_COLUMN, DATE_COLUMN, DELETE_COLUMN = DATE_COLUMN };
 
-		private:
-			bool mSmooth;
+			SeriesModel(QList<TunerSeries *> *, QObject *parent = 0);
+			~SeriesModel() {};
+			void reload ( bool );
+			void appendSeries ( TunerSeries * );
+			void refresh ( void );
+			void setAllEnabled ( bool );
+			bool isManual ( void ) const { return manual; };
+			void setGroupDisplay ( int, int, bool );
+			bool isCheckable ( TunerSeries * ) const;
+			int rowCount ( const QModelIndex &parent = QModelIndex() ) const;
+			int columnCount ( const QModelIndex &parent = QModelIndex() ) const;
+			QVariant data ( const QModelIndex &, int role = Qt::DisplayRole ) const;
+			QVariant headerData ( int, Qt::Orientation, int role = Qt::DisplayRole ) const;
+			Qt::ItemFlags flags ( const QModelIndex & ) const;
+			bool setData ( const QModelIndex &, const QVariant &, int role = Qt::EditRole );
 
+		private:
+			QList<TunerSeries *> *seriesData;
+			bool manual; // rows were entered by hand rather than loaded from a file
+			int groupType;
+			int groupUnits;
+			bool includeSighters;
 	};
 
 	struct AutofillValues
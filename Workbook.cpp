@@ -0,0 +1,558 @@
+#include <functional>
+#include <QDebug>
+#include <QDir>
+#include <QBuffer>
+#include <QMap>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QFileInfo>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QtEndian>
+
+#include "xlsxdocument.h"
+#include "xlsxworksheet.h"
+#include "xlsxchart.h"
+#include "xlsxcellrange.h"
+#include "xlsxcellreference.h"
+#include "xlsxzipreader_p.h"
+
+#include "miniz.h"
+#include "ChronoPlotter.h"
+#include "Workbook.h"
+#include "PowderTest.h"
+#include "SeatingDepthTest.h"
+#include "TunerTest.h"
+
+// Shot sheet XML is handed to the compressor in pieces of about this size
+#define FLUSH_SIZE (64 * 1024)
+
+/*
+ * Zip archive written front to back. Entries are deflated as their data comes in, and their CRC and sizes go in a data
+ * descriptor after the data instead of the local header, so nothing but the central directory is kept until the end.
+ */
+class ZipStream
+{
+	public:
+		ZipStream ( QIODevice *device ) : device(device), position(0), ok(true), open(false)
+		{
+			QDateTime now = QDateTime::currentDateTime();
+			dosTime = (now.time().hour() << 11) | (now.time().minute() << 5) | (now.time().second() / 2);
+			dosDate = ((now.date().year() - 1980) << 9) | (now.date().month() << 5) | now.date().day();
+			output.resize(FLUSH_SIZE);
+		};
+
+		void begin ( const QString &name )
+		{
+			current.name = name.toUtf8();
+			current.crc = MZ_CRC32_INIT;
+			current.compressedSize = 0;
+			current.size = 0;
+			current.offset = position;
+
+			QByteArray header;
+			put32(header, 0x04034b50);
+			put16(header, 20); // version needed to extract
+			put16(header, 0x0808); // sizes in a data descriptor, UTF-8 names
+			put16(header, MZ_DEFLATED);
+			put16(header, dosTime);
+			put16(header, dosDate);
+			put32(header, 0);
+			put32(header, 0);
+			put32(header, 0);
+			put16(header, current.name.size());
+			put16(header, 0);
+			header.append(current.name);
+			send(header.constData(), header.size());
+
+			memset(&stream, 0, sizeof(stream));
+			if ( mz_deflateInit2(&stream, MZ_DEFAULT_LEVEL, MZ_DEFLATED, -MZ_DEFAULT_WINDOW_BITS, 9, MZ_DEFAULT_STRATEGY) != MZ_OK )
+			{
+				ok = false;
+			}
+			open = true;
+		};
+
+		void write ( const QByteArray &data )
+		{
+			current.crc = mz_crc32(current.crc, (const unsigned char *)data.constData(), data.size());
+			current.size += data.size();
+			deflate(data, MZ_NO_FLUSH);
+		};
+
+		void end ( void )
+		{
+			deflate(QByteArray(), MZ_FINISH);
+			mz_deflateEnd(&stream);
+			open = false;
+
+			QByteArray descriptor;
+			put32(descriptor, 0x08074b50);
+			put32(descriptor, current.crc);
+			put32(descriptor, current.compressedSize);
+			put32(descriptor, current.size);
+			send(descriptor.constData(), descriptor.size());
+
+			entries.append(current);
+		};
+
+		bool finish ( void )
+		{
+			if ( open )
+			{
+				mz_deflateEnd(&stream);
+				open = false;
+			}
+
+			QByteArray directory;
+			for ( int i = 0; i < entries.size(); i++ )
+			{
+				const Entry &entry = entries.at(i);
+				put32(directory, 0x02014b50);
+				put16(directory, 20); // version made by
+				put16(directory, 20);
+				put16(directory, 0x0808);
+				put16(directory, MZ_DEFLATED);
+				put16(directory, dosTime);
+				put16(directory, dosDate);
+				put32(directory, entry.crc);
+				put32(directory, entry.compressedSize);
+				put32(directory, entry.size);
+				put16(directory, entry.name.size());
+				put16(directory, 0);
+				put16(directory, 0);
+				put16(directory, 0);
+				put16(directory, 0);
+				put32(directory, 0);
+				put32(directory, entry.offset);
+				directory.append(entry.name);
+			}
+
+			quint32 directoryOffset = position;
+			quint32 directorySize = directory.size();
+
+			put32(directory, 0x06054b50);
+			put16(directory, 0);
+			put16(directory, 0);
+			put16(directory, entries.size());
+			put16(directory, entries.size());
+			put32(directory, directorySize);
+			put32(directory, directoryOffset);
+			put16(directory, 0);
+
+			send(directory.constData(), directory.size());
+
+			// Offsets and sizes are 32 bits, without the zip64 extensions
+			return ok && (position <= 0xffffffffu);
+		};
+
+	private:
+		struct Entry
+		{
+			QByteArray name;
+			quint32 crc;
+			quint32 compressedSize;
+			quint32 size;
+			quint32 offset;
+		};
+
+		QIODevice *device;
+		QList<Entry> entries;
+		Entry current;
+		mz_stream stream;
+		QByteArray output;
+		quint64 position;
+		quint16 dosTime;
+		quint16 dosDate;
+		bool ok;
+		bool open;
+
+		static void put16 ( QByteArray &buffer, quint16 value )
+		{
+			uchar bytes[2];
+			qToLittleEndian(value, bytes);
+			buffer.append((const char *)bytes, sizeof(bytes));
+		};
+
+		static void put32 ( QByteArray &buffer, quint32 value )
+		{
+			uchar bytes[4];
+			qToLittleEndian(value, bytes);
+			buffer.append((const char *)bytes, sizeof(bytes));
+		};
+
+		void send ( const char *data, qint64 size )
+		{
+			if ( ok && (device->write(data, size) != size) )
+			{
+				qDebug() << "Unable to write workbook:" << device->errorString();
+				ok = false;
+			}
+			position += size;
+		};
+
+		void deflate ( const QByteArray &data, int flush )
+		{
+			stream.next_in = (const unsigned char *)data.constData();
+			stream.avail_in = data.size();
+
+			while ( ok )
+			{
+				stream.next_out = (unsigned char *)output.data();
+				stream.avail_out = output.size();
+
+				int status = mz_deflate(&stream, flush);
+				if ( (status != MZ_OK) && (status != MZ_STREAM_END) && (status != MZ_BUF_ERROR) )
+				{
+					qDebug() << "Unable to compress workbook, status" << status;
+					ok = false;
+					return;
+				}
+
+				int produced = output.size() - stream.avail_out;
+				current.compressedSize += produced;
+				send(output.constData(), produced);
+
+				bool done = (flush == MZ_FINISH) ? (status == MZ_STREAM_END) : ((stream.avail_in == 0) && (stream.avail_out > 0));
+				if ( done )
+				{
+					return;
+				}
+			}
+		};
+};
+
+/*
+ * Worksheet XML for one sheet, written out in rows as they're added. Strings are inline, so the sheet doesn't need anything from
+ * the shared strings table QXlsx wrote for the rest of the workbook.
+ */
+class SheetStream
+{
+	public:
+		SheetStream ( ZipStream *zip ) : zip(zip), rowNum(0)
+		{
+			buffer.append("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n");
+			buffer.append("<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\" xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\">");
+			buffer.append("<sheetViews><sheetView workbookViewId=\"0\"><pane ySplit=\"1\" topLeftCell=\"A2\" activePane=\"bottomLeft\" state=\"frozen\"/></sheetView></sheetViews>");
+			buffer.append("<sheetData>");
+		};
+
+		void row ( const QVariantList &cells )
+		{
+			rowNum++;
+
+			buffer.append("<row r=\"").append(QByteArray::number(rowNum)).append("\">");
+
+			for ( int i = 0; i < cells.size(); i++ )
+			{
+				const QVariant &cell = cells.at(i);
+				QByteArray ref = QXlsx::CellReference(rowNum, i + 1).toString().toLatin1();
+
+				if ( cell.type() == QVariant::Double || cell.type() == QVariant::Int )
+				{
+					double value = cell.toDouble();
+					if ( ! qIsNaN(value) )
+					{
+						buffer.append("<c r=\"").append(ref).append("\"><v>").append(QByteArray::number(value, 'g', 15)).append("</v></c>");
+					}
+				}
+				else if ( ! cell.toString().isEmpty() )
+				{
+					buffer.append("<c r=\"").append(ref).append("\" t=\"inlineStr\"><is><t>").append(cell.toString().toHtmlEscaped().toUtf8()).append("</t></is></c>");
+				}
+			}
+
+			buffer.append("</row>");
+
+			if ( buffer.size() >= FLUSH_SIZE )
+			{
+				zip->write(buffer);
+				buffer.clear();
+			}
+		};
+
+		void finish ( void )
+		{
+			buffer.append("</sheetData></worksheet>");
+			zip->write(buffer);
+			buffer.clear();
+		};
+
+		int rows ( void )
+		{
+			return rowNum;
+		};
+
+	private:
+		ZipStream *zip;
+		QByteArray buffer;
+		int rowNum;
+};
+
+struct Section
+{
+	QString title;
+	QList<QStringList> table;
+	std::function<void ( SheetStream & )> writeShots;
+};
+
+static void writePowderShots ( Powder::PowderTest *tab, const QString &chargeHeader, SheetStream &sheet )
+{
+	sheet.row(QVariantList() << "Series" << chargeHeader << "Shot" << "Velocity" << "Units");
+
+	for ( int i = 0; i < tab->seriesData.size(); i++ )
+	{
+		Powder::ChronoSeries *series = tab->seriesData.at(i);
+		if ( (! series->enabled) || series->deleted )
+		{
+			continue;
+		}
+
+		for ( int j = 0; j < series->muzzleVelocities.size(); j++ )
+		{
+			sheet.row(QVariantList() << series->name << series->chargeWeight << (j + 1) << series->muzzleVelocities.at(j) << series->velocityUnits);
+		}
+	}
+}
+
+/*
+ * Record shots of each group, then its sighters
+ */
+template <typename T>
+static void writeGroupShots ( const QList<T *> &seriesData, const QString &valueHeader, std::function<double ( T * )> value, SheetStream &sheet )
+{
+	sheet.row(QVariantList() << "Series" << valueHeader << "Shot" << "X (in)" << "Y (in)" << "Sighter");
+
+	for ( int i = 0; i < seriesData.size(); i++ )
+	{
+		T *series = seriesData.at(i);
+		if ( (! series->enabled) || series->deleted )
+		{
+			continue;
+		}
+
+		for ( int j = 0; j < series->coordinates.size(); j++ )
+		{
+			sheet.row(QVariantList() << series->name << value(series) << (j + 1) << series->coordinates.at(j).first << series->coordinates.at(j).second);
+		}
+
+		// coordinates_sighters holds the record shots too
+		QList<QPair<double, double> > sighters = ShotPattern::sightersOnly(series->coordinates_sighters, series->coordinates);
+		for ( int j = 0; j < sighters.size(); j++ )
+		{
+			sheet.row(QVariantList() << series->name << value(series) << (j + 1) << sighters.at(j).first << sighters.at(j).second << "Yes");
+		}
+	}
+}
+
+/*
+ * Same as the report, a tab that can't be graphed is left out of the workbook and graphs are built in the tab's scratchCopy()
+ */
+template <typename T>
+static bool prepareSection ( T *tab, const QString &title, QList<Section> &sections, QStringList &skipped )
+{
+	tab->errors.clear();
+	tab->warnings.clear();
+
+	bool res = tab->populatePlot();
+
+	if ( ! res )
+	{
+		qDebug() << "Skipping" << title << "sheets:" << tab->errors;
+		skipped.append(QString("%1: %2").arg(title).arg(tab->errors.join(" ")));
+		return false;
+	}
+
+	Section section;
+	section.title = title;
+	section.table = tab->seriesTable();
+	sections.append(section);
+
+	return true;
+}
+
+/*
+ * Statistics go in as numbers wherever they are one, so they can be worked with in the spreadsheet. The x value and the plotted
+ * value lead the table so the chart's scatter series can take them as one range.
+ */
+static void writeStatistics ( QXlsx::Worksheet *sheet, const Section &section )
+{
+	QList<int> order;
+	order << 1 << 3 << 0 << 2;
+	for ( int i = 4; i < section.table.at(0).size(); i++ )
+	{
+		order << i;
+	}
+
+	for ( int row = 0; row < section.table.size(); row++ )
+	{
+		for ( int column = 0; column < order.size(); column++ )
+		{
+			QString text = section.table.at(row).at(order.at(column));
+
+			bool isNumber = false;
+			double number = text.toDouble(&isNumber);
+			sheet->write(row + 1, column + 1, isNumber ? QVariant(number) : QVariant(text));
+		}
+	}
+
+	// A scatter series needs at least two points
+	if ( section.table.size() < 3 )
+	{
+		return;
+	}
+
+	QXlsx::Chart *chart = sheet->insertChart(1, order.size() + 1, QSize(640, 400));
+	chart->setChartType(QXlsx::Chart::CT_ScatterChart);
+	chart->addSeries(QXlsx::CellRange(1, 1, section.table.size(), 2), NULL, true);
+	chart->setChartTitle(section.title);
+	chart->setAxisTitle(QXlsx::Chart::Bottom, section.table.at(0).at(1));
+	chart->setAxisTitle(QXlsx::Chart::Left, section.table.at(0).at(3));
+	chart->setChartLegend(QXlsx::Chart::None);
+	chart->setGridlinesEnable(true);
+}
+
+static bool writeWorkbook ( const QString &path, const QList<Section> &sections )
+{
+	QElapsedTimer timer;
+	timer.start();
+
+	/* Everything but the shots goes through QXlsx, with an empty sheet held in place for each section's shots */
+
+	QXlsx::Document xlsx;
+	QMap<QString, int> shotSheets;
+
+	for ( int i = 0; i < sections.size(); i++ )
+	{
+		const Section &section = sections.at(i);
+
+		xlsx.addSheet(section.title);
+		writeStatistics((QXlsx::Worksheet *)xlsx.sheet(section.title), section);
+
+		xlsx.addSheet(QString("%1 shots").arg(section.title));
+		shotSheets.insert(QString("xl/worksheets/sheet%1.xml").arg(2 * i + 2), i);
+	}
+
+	xlsx.selectSheet(sections.first().title);
+
+	QBuffer skeleton;
+	skeleton.open(QIODevice::ReadWrite);
+	if ( ! xlsx.saveAs(&skeleton) )
+	{
+		qDebug() << "Unable to build workbook";
+		return false;
+	}
+	skeleton.seek(0);
+
+	/* Copy it over, streaming the shot sheets in where the empty ones were */
+
+	QSaveFile file(path);
+	if ( ! file.open(QIODevice::WriteOnly) )
+	{
+		qDebug() << "Unable to open" << path << ":" << file.errorString();
+		return false;
+	}
+
+	ZipStream zip(&file);
+	int numShots = 0;
+
+	QXlsx::ZipReader reader(&skeleton);
+	QStringList filePaths = reader.filePaths();
+
+	for ( int i = 0; i < filePaths.size(); i++ )
+	{
+		zip.begin(filePaths.at(i));
+
+		if ( shotSheets.contains(filePaths.at(i)) )
+		{
+			SheetStream sheet(&zip);
+			sections.at(shotSheets.value(filePaths.at(i))).writeShots(sheet);
+			sheet.finish();
+			numShots += sheet.rows() - 1;
+		}
+		else
+		{
+			zip.write(reader.fileData(filePaths.at(i)));
+		}
+
+		zip.end();
+	}
+
+	if ( ! zip.finish() )
+	{
+		file.cancelWriting();
+		return false;
+	}
+
+	bool res = file.commit();
+
+	qDebug() << "Wrote workbook with" << sections.size() << "sections and" << numShots << "shots in" << timer.elapsed() << "ms, res =" << res;
+
+	return res;
+}
+
+void Workbook::saveWorkbook ( QWidget *parent, Powder::PowderTest *powderTest, SeatingDepth::SeatingDepthTest *seatingTest, Tuner::TunerTest *tunerTest )
+{
+	qDebug() << "saveWorkbook";
+
+	/* Build each tab's graph for its statistics, leaving out any that can't be graphed */
+
+	QList<Section> sections;
+	QStringList skipped;
+
+	QScopedPointer<Powder::PowderTest> powderScratch(powderTest->scratchCopy());
+	QScopedPointer<SeatingDepth::SeatingDepthTest> seatingScratch(seatingTest->scratchCopy());
+	QScopedPointer<Tuner::TunerTest> tunerScratch(tunerTest->scratchCopy());
+
+	if ( prepareSection(powderScratch.data(), "Powder charge", sections, skipped) )
+	{
+		QString chargeHeader = sections.last().table.at(0).at(1);
+		sections.last().writeShots = [&powderScratch, chargeHeader] ( SheetStream &sheet ) { writePowderShots(powderScratch.data(), chargeHeader, sheet); };
+	}
+
+	if ( prepareSection(seatingScratch.data(), "Seating depth", sections, skipped) )
+	{
+		QString lengthHeader = sections.last().table.at(0).at(1);
+		sections.last().writeShots = [&seatingScratch, lengthHeader] ( SheetStream &sheet ) {
+			writeGroupShots<SeatingDepth::SeatingSeries>(seatingScratch->seatingSeriesData, lengthHeader, [] ( SeatingDepth::SeatingSeries *series ) { return series->cartridgeLength; }, sheet);
+		};
+	}
+
+	if ( prepareSection(tunerScratch.data(), "Tuner", sections, skipped) )
+	{
+		QString settingHeader = sections.last().table.at(0).at(1);
+		sections.last().writeShots = [&tunerScratch, settingHeader] ( SheetStream &sheet ) {
+			writeGroupShots<Tuner::TunerSeries>(tunerScratch->tunerSeriesData, settingHeader, [] ( Tuner::TunerSeries *series ) { return (double)series->tunerSetting; }, sheet);
+		};
+	}
+
+	if ( sections.empty() )
+	{
+		QMessageBox msg;
+		msg.setIcon(QMessageBox::Critical);
+		msg.setText("At least one tab needs data to graph before a workbook can be created!");
+		msg.setWindowTitle("Error");
+		msg.exec();
+		return;
+	}
+
+	/* Pick where to save it */
+
+	QString path = QFileDialog::getSaveFileName(parent, "Save workbook", QDir::home().filePath("workbook.xlsx"), "Excel workbook (*.xlsx)");
+	qDebug() << "User selected save path:" << path;
+
+	if ( path.isEmpty() )
+	{
+		qDebug() << "No path selected, bailing";
+		return;
+	}
+
+	if ( QFileInfo(path).suffix().toLower() != "xlsx" )
+	{
+		path.append(".xlsx");
+	}
+
+	showSaveResult(parent, path, writeWorkbook(path, sections));
+}
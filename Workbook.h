@@ -0,0 +1,22 @@
+#ifndef WORKBOOK_H
+#define WORKBOOK_H
+
+#include <QWidget>
+
+namespace Powder { class PowderTest; };
+namespace SeatingDepth { class SeatingDepthTest; };
+namespace Tuner { class TunerTest; };
+
+/*
+ * Excel workbook of every tab that has enough data to graph: a sheet of per-series statistics with a native chart, followed by a
+ * sheet of every shot. QXlsx keeps each cell of a worksheet in memory until the whole document is saved, so it only builds the
+ * small statistics sheets. The shot sheets are written as XML straight into the deflate stream one row at a time, keeping
+ * memory use flat however many shots there are.
+ */
+
+namespace Workbook
+{
+	void saveWorkbook ( QWidget *, Powder::PowderTest *, SeatingDepth::SeatingDepthTest *, Tuner::TunerTest * );
+};
+
+#endif // WORKBOOK_H
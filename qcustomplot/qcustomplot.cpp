@@ -15634,7 +15634,7 @@ QList<QCPLayerable*> QCustomPlot::layerableListAt(const QPointF &pos, bool onlyS
 */
 bool QCustomPlot::saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality, int resolution, QCP::ResolutionUnit resolutionUnit)
 {
-  QImage buffer = toPixmap(width, height, scale).toImage();
+  QImage buffer = toImage(width, height, scale);
   
   int dotsPerMeter = 0;
   switch (resolutionUnit)
@@ -15703,6 +15703,66 @@ QPixmap QCustomPlot::toPixmap(int width, int height, double scale)
   return result;
 }
 
+/*!
+  Renders the plot to an image and returns it.
+  
+  This is the same as \ref toPixmap, but paints straight into a QImage. Unlike a QPixmap, the
+  result may be handed to and used by other threads (e.g. to compress and save it in the
+  background), and it doesn't need to be converted before saving.
+  
+  The plot itself must still only be rendered from the thread it lives in.
+  
+  \see toPixmap, saveRastered
+*/
+QImage QCustomPlot::toImage(int width, int height, double scale)
+{
+  // this method is somewhat similar to toPixmap. Change something here, and a change in toPixmap might be necessary, too.
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  int scaledWidth = qRound(scale*newWidth);
+  int scaledHeight = qRound(scale*newHeight);
+
+  QImage result(scaledWidth, scaledHeight, QImage::Format_ARGB32_Premultiplied);
+  if (result.isNull()) // width or height zero
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't create image of size" << scaledWidth << scaledHeight;
+    return QImage();
+  }
+  result.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : QColor(Qt::transparent)); // if using non-solid pattern, make transparent now and draw brush pattern later
+  QCPPainter painter;
+  painter.begin(&result);
+  if (painter.isActive())
+  {
+    QRect oldViewport = viewport();
+    setViewport(QRect(0, 0, newWidth, newHeight));
+    painter.setMode(QCPPainter::pmNoCaching);
+    if (!qFuzzyCompare(scale, 1.0))
+    {
+      if (scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines might disappear for very small scales
+        painter.setMode(QCPPainter::pmNonCosmetic);
+      painter.scale(scale, scale);
+    }
+    if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush) // solid fills were done a few lines above with QImage::fill
+      painter.fillRect(mViewport, mBackgroundBrush);
+    draw(&painter);
+    setViewport(oldViewport);
+    painter.end();
+  } else
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on image";
+    return QImage();
+  }
+  return result;
+}
+
 /*!
   Renders the plot using the passed \a painter.
   
@@ -21702,6 +21762,187 @@ int QCPGraph::findIndexBelowY(const QVector<QPointF> *data, double y) const
 /* end of 'src/plottables/plottable-graph.cpp' */
 
 
+/* including file 'src/plottables/plottable-smoothgraph.cpp'                 */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPSmoothGraph
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPSmoothGraph
+  \brief A QCPGraph that can draw its line as a smooth cubic Bezier spline through the data points
+  
+  When \ref setSmooth is enabled and the line style is \ref lsLine, the polyline between the data
+  points is replaced by a piecewise cubic Bezier curve whose control points are chosen such that
+  the curve passes through every data point with continuous first and second derivatives. NaN or
+  infinite points split the curve into independent segments, like gaps in a regular QCPGraph.
+  
+  Fitting the spline requires solving a tridiagonal system per segment. The resulting path is
+  cached together with the pixel coordinates it was built from, so replots that don't change the
+  data, the axis ranges or the axis rect (e.g. layer replots, or exports at a different scale
+  factor) reuse the cached path. The solve itself works on member scratch buffers that keep their
+  capacity between draws, so a refit doesn't allocate once the buffers have grown to the size of
+  the largest segment.
+*/
+
+/*!
+  Constructs a smooth graph which uses \a keyAxis as its key axis ("x") and \a valueAxis as its
+  value axis ("y"). Smoothing is disabled initially, so the graph behaves like a plain QCPGraph
+  until \ref setSmooth is called.
+*/
+QCPSmoothGraph::QCPSmoothGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPGraph(keyAxis, valueAxis),
+  mSmooth(false),
+  mCacheValid(false)
+{
+}
+
+QCPSmoothGraph::~QCPSmoothGraph()
+{
+}
+
+/*!
+  Sets whether the line between data points is drawn as a smooth spline (\a smooth true) or as the
+  regular polyline. Only takes effect when the line style is \ref lsLine.
+*/
+void QCPSmoothGraph::setSmooth(bool smooth)
+{
+  if (mSmooth != smooth)
+  {
+    mSmooth = smooth;
+    mCacheValid = false;
+  }
+}
+
+/*! \internal
+  
+  Draws the line as a smooth spline if \ref setSmooth is enabled and the line style is \ref lsLine,
+  otherwise falls back to the QCPGraph implementation.
+*/
+void QCPSmoothGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines) const
+{
+  if (!mSmooth || mLineStyle != lsLine)
+  {
+    QCPGraph::drawLinePlot(painter, lines);
+    return;
+  }
+  
+  if (painter->pen().style() != Qt::NoPen && painter->pen().color().alpha() != 0)
+  {
+    applyDefaultAntialiasingHint(painter);
+    painter->drawPath(smoothPath(lines));
+  }
+}
+
+/*! \internal
+  
+  Returns the smooth path through \a lines (given in pixel coordinates). The path is only rebuilt
+  if \a lines differ from the knots the cached path was built from, which happens when the data,
+  the axis ranges or the axis rect geometry changed.
+*/
+const QPainterPath &QCPSmoothGraph::smoothPath(const QVector<QPointF> &lines) const
+{
+  if (mCacheValid && mCachedKnots == lines)
+    return mCachedPath;
+  
+  mCachedPath = QPainterPath();
+  const QPointF *knots = lines.constData();
+  const int count = lines.size();
+  int segmentStart = 0;
+  for (int i=0; i<count; ++i)
+  {
+    if (qIsNaN(knots[i].x()) || qIsNaN(knots[i].y()) || qIsInf(knots[i].y()))
+    {
+      appendSmoothSegment(mCachedPath, knots+segmentStart, i-segmentStart);
+      segmentStart = i+1;
+    }
+  }
+  appendSmoothSegment(mCachedPath, knots+segmentStart, count-segmentStart);
+  
+  mCachedKnots = lines;
+  mCacheValid = true;
+  return mCachedPath;
+}
+
+/*! \internal
+  
+  Appends a cubic Bezier spline through the \a count points starting at \a knots to \a path. The
+  first control points are obtained from the tridiagonal system of the natural spline conditions
+  (see \ref solveFirstControlPoints), the second control points follow from C1 continuity at the
+  inner knots and the natural end condition at the last knot.
+*/
+void QCPSmoothGraph::appendSmoothSegment(QPainterPath &path, const QPointF *knots, int count) const
+{
+  if (count < 2)
+    return;
+  
+  const int n = count-1; // number of Bezier segments
+  path.moveTo(knots[0]);
+  if (n == 1)
+  {
+    // single segment degenerates to a straight line:
+    path.lineTo(knots[1]);
+    return;
+  }
+  
+  mRhsX.resize(n);
+  mRhsY.resize(n);
+  mSolX.resize(n);
+  mSolY.resize(n);
+  mDiag.resize(n);
+  double *rhsX = mRhsX.data();
+  double *rhsY = mRhsY.data();
+  double *xs = mSolX.data();
+  double *ys = mSolY.data();
+  
+  rhsX[0] = knots[0].x() + 2*knots[1].x();
+  rhsY[0] = knots[0].y() + 2*knots[1].y();
+  for (int i=1; i<n-1; ++i)
+  {
+    rhsX[i] = 4*knots[i].x() + 2*knots[i+1].x();
+    rhsY[i] = 4*knots[i].y() + 2*knots[i+1].y();
+  }
+  rhsX[n-1] = (8*knots[n-1].x() + knots[n].x())/2.0;
+  rhsY[n-1] = (8*knots[n-1].y() + knots[n].y())/2.0;
+  
+  solveFirstControlPoints(rhsX, xs, n);
+  solveFirstControlPoints(rhsY, ys, n);
+  
+  for (int i=0; i<n; ++i)
+  {
+    const QPointF c1(xs[i], ys[i]);
+    const QPointF c2 = i < n-1 ? QPointF(2*knots[i+1].x() - xs[i+1], 2*knots[i+1].y() - ys[i+1])
+                               : QPointF((knots[n].x() + xs[n-1])/2.0, (knots[n].y() + ys[n-1])/2.0);
+    path.cubicTo(c1, c2, knots[i+1]);
+  }
+}
+
+/*! \internal
+  
+  Solves the tridiagonal system for the first Bezier control point coordinates of \a n segments
+  with the Thomas algorithm. The sub- and super-diagonals are 1, the main diagonal is 2 for the
+  first row, 3.5 for the last row and 4 otherwise. \a rhs and \a result must hold \a n values; the
+  member buffer \a mDiag must already be sized to \a n and is used for the decomposition.
+*/
+void QCPSmoothGraph::solveFirstControlPoints(const double *rhs, double *result, int n) const
+{
+  double *tmp = mDiag.data();
+  double b = 2.0;
+  result[0] = rhs[0]/b;
+  
+  // decomposition and forward substitution:
+  for (int i=1; i<n; ++i)
+  {
+    tmp[i] = 1.0/b;
+    b = (i < n-1 ? 4.0 : 3.5) - tmp[i];
+    result[i] = (rhs[i] - result[i-1])/b;
+  }
+  // back substitution:
+  for (int i=1; i<n; ++i)
+    result[n-i-1] -= tmp[n-i]*result[n-i];
+}
+/* end of 'src/plottables/plottable-smoothgraph.cpp' */
+
+
 /* including file 'src/plottables/plottable-curve.cpp', size 63742           */
 /* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
 
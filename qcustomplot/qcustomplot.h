@@ -3733,6 +3733,7 @@ public:
   bool saveBmp(const QString &fileName, int width=0, int height=0, double scale=1.0, int resolution=96, QCP::ResolutionUnit resolutionUnit=QCP::ruDotsPerInch);
   bool saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality=-1, int resolution=96, QCP::ResolutionUnit resolutionUnit=QCP::ruDotsPerInch);
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
+  QImage toImage(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpRefreshHint);
   
@@ -5265,6 +5266,48 @@ Q_DECLARE_METATYPE(QCPGraph::LineStyle)
 /* end of 'src/plottables/plottable-graph.h' */
 
 
+/* including file 'src/plottables/plottable-smoothgraph.h'                   */
+
+class QCP_LIB_DECL QCPSmoothGraph : public QCPGraph
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(bool smooth READ smooth WRITE setSmooth)
+  /// \endcond
+public:
+  explicit QCPSmoothGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPSmoothGraph();
+  
+  // getters:
+  bool smooth() const { return mSmooth; }
+  
+  // setters:
+  void setSmooth(bool smooth);
+  
+protected:
+  // property members:
+  bool mSmooth;
+  
+  // smooth path cache, keyed on the pixel knots handed to drawLinePlot:
+  mutable QVector<QPointF> mCachedKnots;
+  mutable QPainterPath mCachedPath;
+  mutable bool mCacheValid;
+  
+  // scratch buffers for the tridiagonal solve, reused across draws so their capacity is retained:
+  mutable QVector<double> mRhsX, mRhsY, mSolX, mSolY, mDiag;
+  
+  // reimplemented virtual methods:
+  virtual void drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines) const Q_DECL_OVERRIDE;
+  
+  // non-virtual methods:
+  const QPainterPath &smoothPath(const QVector<QPointF> &lines) const;
+  void appendSmoothSegment(QPainterPath &path, const QPointF *knots, int count) const;
+  void solveFirstControlPoints(const double *rhs, double *result, int n) const;
+};
+
+/* end of 'src/plottables/plottable-smoothgraph.h' */
+
+
 /* including file 'src/plottables/plottable-curve.h', size 7409              */
 /* commit ce344b3f96a62e5f652585e55f1ae7c7883cd45b 2018-06-25 01:03:39 +0200 */
 